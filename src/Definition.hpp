@@ -95,14 +95,36 @@
         }               \
     } while(0)
 
-#define LOG4_FATAL(args...) Logger(neb::Logger::FATAL, __FILE__, __LINE__, __FUNCTION__, ##args)
-#define LOG4_ERROR(args...) Logger(neb::Logger::ERROR, __FILE__, __LINE__, __FUNCTION__, ##args)
-#define LOG4_WARNING(args...) Logger(neb::Logger::WARNING, __FILE__, __LINE__, __FUNCTION__, ##args)
-#define LOG4_NOTICE(args...) Logger(neb::Logger::NOTICE, __FILE__, __LINE__, __FUNCTION__, ##args)
-#define LOG4_INFO(args...) Logger(neb::Logger::INFO, __FILE__, __LINE__, __FUNCTION__, ##args)
-#define LOG4_CRITICAL(args...) Logger(neb::Logger::CRITICAL, __FILE__, __LINE__, __FUNCTION__, ##args)
-#define LOG4_DEBUG(args...) Logger(neb::Logger::DEBUG, __FILE__, __LINE__, __FUNCTION__, ##args)
-#define LOG4_TRACE(args...) Logger(neb::Logger::TRACE, __FILE__, __LINE__, __FUNCTION__, ##args)
+/**
+ * @brief 编译期日志级别下限
+ * @note 级别数值大于NEB_LOG_MIN_LEVEL（即比它更不重要）的LOG4_*调用在编译期即被去除，
+ * 如编译时加-DNEB_LOG_MIN_LEVEL=5则不产生DEBUG和TRACE日志代码。默认7（TRACE）保留全部日志。
+ */
+#ifndef NEB_LOG_MIN_LEVEL
+#define NEB_LOG_MIN_LEVEL 7
+#endif
+
+/**
+ * @brief 先判断日志级别再求值日志参数，未开启的级别不会执行参数中的函数调用和字符串拼接
+ * @note 使用LOG4_*的类须同时提供Logger()和IsLogEnabled()
+ */
+#define LOG4_LEVEL(iLev, args...) \
+    do \
+    { \
+        if ((iLev) <= NEB_LOG_MIN_LEVEL && IsLogEnabled(iLev)) \
+        { \
+            Logger(iLev, __FILE__, __LINE__, __FUNCTION__, ##args); \
+        } \
+    } while(0)
+
+#define LOG4_FATAL(args...) LOG4_LEVEL(neb::Logger::FATAL, ##args)
+#define LOG4_ERROR(args...) LOG4_LEVEL(neb::Logger::ERROR, ##args)
+#define LOG4_WARNING(args...) LOG4_LEVEL(neb::Logger::WARNING, ##args)
+#define LOG4_NOTICE(args...) LOG4_LEVEL(neb::Logger::NOTICE, ##args)
+#define LOG4_INFO(args...) LOG4_LEVEL(neb::Logger::INFO, ##args)
+#define LOG4_CRITICAL(args...) LOG4_LEVEL(neb::Logger::CRITICAL, ##args)
+#define LOG4_DEBUG(args...) LOG4_LEVEL(neb::Logger::DEBUG, ##args)
+#define LOG4_TRACE(args...) LOG4_LEVEL(neb::Logger::TRACE, ##args)
 //#define LOG4_TRACE(...) Logger(neb::Logger::TRACE, __FILE__, __LINE__, __FUNCTION__, __VA_ARGS__)
 
 typedef int8_t int8;
@@ -21,13 +21,13 @@ namespace neb
 Actor::Actor(ACTOR_TYPE eActorType, ev_tstamp dTimeout)
     : m_eActorType(eActorType),
       m_uiSequence(0), m_dActiveTime(0.0), m_dTimeout(dTimeout),
-      m_pLabor(nullptr), m_pTimerWatcher(NULL), m_pContext(nullptr)
+      m_pLabor(nullptr), m_pContext(nullptr)
 {
+    m_stTimerWatcher.data = this;    // (void*)(Actor*)
 }
 
 Actor::~Actor()
 {
-    FREE(m_pTimerWatcher);
     LOG4_TRACE("eActorType %d, seq %u, actor name \"%s\"",
             m_eActorType, GetSequence(), m_strActorName.c_str());
 }
@@ -184,29 +184,17 @@ bool Actor::SendTo(const std::string& strIdentify, int32 iCmd, uint32 uiSeq, con
 bool Actor::SendTo(const std::string& strHost, int iPort, const HttpMsg& oHttpMsg, uint32 uiStepSeq)
 {
     bool bWithSsl = false;
-    bool bPipeline = false;
     if (oHttpMsg.headers().find("x-trace-id") == oHttpMsg.headers().end())
     {
         (const_cast<HttpMsg&>(oHttpMsg)).mutable_headers()->insert({"x-trace-id", GetTraceId()});
     }
-    if (oHttpMsg.http_major() >= 2)
-    {
-        bPipeline = true;
-    }
     std::string strSchema = oHttpMsg.url().substr(0, oHttpMsg.url().find_first_of(":"));
     std::transform(strSchema.begin(), strSchema.end(), strSchema.begin(), [](unsigned char c)->unsigned char {return std::tolower(c);});
     if (strSchema == std::string("https"))
     {
         bWithSsl = true;
     }
-    if (oHttpMsg.http_major() == 2)
-    {
-        return(m_pLabor->GetDispatcher()->SendTo(strHost, iPort, SOCKET_STREAM, CODEC_HTTP2, bWithSsl, bPipeline, oHttpMsg, GetSequence()));
-    }
-    else
-    {
-        return(m_pLabor->GetDispatcher()->SendTo(strHost, iPort, SOCKET_STREAM, CODEC_HTTP, bWithSsl, bPipeline, oHttpMsg, GetSequence()));
-    }
+    return(m_pLabor->GetDispatcher()->SendHttpRequest(strHost, iPort, bWithSsl, oHttpMsg, GetSequence()));
 }
 
 bool Actor::SendTo(const std::string& strIdentify, const RedisMsg& oRedisMsg, bool bWithSsl, bool bPipeline, uint32 uiStepSeq)
@@ -317,6 +305,11 @@ bool Actor::CloseRawChannel(std::shared_ptr<SocketChannel> pChannel)
     return(false);
 }
 
+void Actor::SetChannelCork(std::shared_ptr<SocketChannel> pChannel, bool bCork)
+{
+    m_pLabor->GetDispatcher()->SetChannelCork(pChannel, bCork);
+}
+
 int32 Actor::GetStepNum() const
 {
     return(m_pLabor->GetActorBuilder()->GetStepNum());
@@ -336,18 +329,9 @@ uint32 Actor::ForceNewSequence()
     return(m_uiSequence);
 }
 
-ev_timer* Actor::MutableTimerWatcher()
+tagWheelTimer* Actor::MutableTimerWatcher()
 {
-    if (NULL == m_pTimerWatcher)
-    {
-        m_pTimerWatcher = (ev_timer*)malloc(sizeof(ev_timer));
-        if (NULL != m_pTimerWatcher)
-        {
-            memset(m_pTimerWatcher, 0, sizeof(ev_timer));
-            m_pTimerWatcher->data = this;    // (void*)(Actor*)
-        }
-    }
-    return(m_pTimerWatcher);
+    return(&m_stTimerWatcher);
 }
 
 void Actor::SetActorName(const std::string& strActorName)
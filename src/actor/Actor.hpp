@@ -31,6 +31,7 @@
 #include "channel/Channel.hpp"
 #include "labor/Labor.hpp"
 #include "codec/Codec.hpp"
+#include "ios/TimingWheel.hpp"
 #include "ActorBuilder.hpp"
 #include "ActorSender.hpp"
 
@@ -82,6 +83,7 @@ public:
     virtual ~Actor();
 
     template <typename ...Targs> void Logger(int iLogLevel, const char* szFileName, unsigned int uiFileLine, const char* szFunction, Targs&&... args) const;
+    bool IsLogEnabled(int iLogLevel) const;
     template <typename ...Targs> std::shared_ptr<Step> MakeSharedStep(const std::string& strStepName, Targs&&... args);
     template <typename ...Targs> std::shared_ptr<Session> MakeSharedSession(const std::string& strSessionName, Targs&&... args);
     template <typename ...Targs> std::shared_ptr<Context> MakeSharedContext(const std::string& strContextName, Targs&&... args);
@@ -307,6 +309,13 @@ protected:
      */
     virtual bool CloseRawChannel(std::shared_ptr<SocketChannel> pChannel);
 
+    /**
+     * @brief 设置连接是否合并写
+     * @note 开启write_coalescing配置时，一轮事件循环内发往同一连接的数据在循环进入等待前
+     * 合并发送；对时延敏感的连接（如行情推送）可关闭以保证每次SendTo()立即写socket。
+     */
+    void SetChannelCork(std::shared_ptr<SocketChannel> pChannel, bool bCork);
+
     int32 GetStepNum() const;
 
 protected:
@@ -328,7 +337,7 @@ protected:
 private:
     void SetLabor(Labor* pLabor);
     uint32 ForceNewSequence();
-    ev_timer* MutableTimerWatcher();
+    tagWheelTimer* MutableTimerWatcher();
     void SetActorName(const std::string& strActorName);
     void SetTraceId(const std::string& strTraceId);
 
@@ -338,7 +347,7 @@ private:
     ev_tstamp m_dActiveTime;
     ev_tstamp m_dTimeout;
     Labor* m_pLabor;
-    ev_timer* m_pTimerWatcher;
+    tagWheelTimer m_stTimerWatcher;     ///< 超时定时器，挂在Dispatcher的时间轮上
     std::string m_strActorName;
     std::string m_strTraceId;       // for log trace
     std::shared_ptr<Context> m_pContext;
@@ -350,6 +359,11 @@ private:
     friend class Chain;
 };
 
+inline bool Actor::IsLogEnabled(int iLogLevel) const
+{
+    return(m_pLabor->GetActorBuilder()->IsLogEnabled(iLogLevel));
+}
+
 template <typename ...Targs>
 void Actor::Logger(int iLogLevel, const char* szFileName, unsigned int uiFileLine, const char* szFunction, Targs&&... args) const
 {
@@ -28,6 +28,7 @@
 #include "ios/Dispatcher.hpp"
 #include "channel/SocketChannel.hpp"
 #include "channel/SelfChannel.hpp"
+#include "codec/RedisReplyView.hpp"
 
 namespace neb
 {
@@ -71,7 +72,7 @@ bool ActorBuilder::Init(CJsonObject& oDynamicLoadConf)
     return(true);
 }
 
-void ActorBuilder::StepTimeoutCallback(struct ev_loop* loop, ev_timer* watcher, int revents)
+void ActorBuilder::StepTimeoutCallback(tagWheelTimer* watcher)
 {
     if (watcher->data != NULL)
     {
@@ -80,7 +81,7 @@ void ActorBuilder::StepTimeoutCallback(struct ev_loop* loop, ev_timer* watcher,
     }
 }
 
-void ActorBuilder::SessionTimeoutCallback(struct ev_loop* loop, ev_timer* watcher, int revents)
+void ActorBuilder::SessionTimeoutCallback(tagWheelTimer* watcher)
 {
     if (watcher->data != NULL)
     {
@@ -89,7 +90,7 @@ void ActorBuilder::SessionTimeoutCallback(struct ev_loop* loop, ev_timer* watche
     }
 }
 
-void ActorBuilder::ChainTimeoutCallback(struct ev_loop* loop, ev_timer* watcher, int revents)
+void ActorBuilder::ChainTimeoutCallback(tagWheelTimer* watcher)
 {
     if (watcher->data != NULL)
     {
@@ -100,7 +101,7 @@ void ActorBuilder::ChainTimeoutCallback(struct ev_loop* loop, ev_timer* watcher,
 
 bool ActorBuilder::OnStepTimeout(std::shared_ptr<Step> pStep)
 {
-    ev_timer* watcher = pStep->MutableTimerWatcher();
+    tagWheelTimer* watcher = pStep->MutableTimerWatcher();
     ev_tstamp after = pStep->GetActiveTime() - m_pLabor->GetNowTime() + pStep->GetTimeout();
     if (after > 0)    // 在定时时间内被重新刷新过，重新设置定时器
     {
@@ -129,7 +130,7 @@ bool ActorBuilder::OnStepTimeout(std::shared_ptr<Step> pStep)
 
 bool ActorBuilder::OnSessionTimeout(std::shared_ptr<Session> pSession)
 {
-    ev_timer* watcher = pSession->MutableTimerWatcher();
+    tagWheelTimer* watcher = pSession->MutableTimerWatcher();
     //LOG4_TRACE("CHECK watchar = 0x%x", watcher);
     ev_tstamp after = pSession->GetActiveTime() - m_pLabor->GetNowTime() + pSession->GetTimeout();
     if (after > 0)    // 定时时间内被重新刷新过，重新设置定时器
@@ -155,7 +156,7 @@ bool ActorBuilder::OnSessionTimeout(std::shared_ptr<Session> pSession)
 
 bool ActorBuilder::OnChainTimeout(std::shared_ptr<Chain> pChain)
 {
-    ev_timer* watcher = pChain->MutableTimerWatcher();
+    tagWheelTimer* watcher = pChain->MutableTimerWatcher();
     LOG4_TRACE("CHECK watchar = 0x%x", watcher);
     ev_tstamp after = pChain->GetActiveTime() - m_pLabor->GetNowTime() + pChain->GetTimeout();
     if (after > 0)    // 定时时间内被重新刷新过，重新设置定时器
@@ -394,9 +395,9 @@ bool ActorBuilder::OnMessage(std::shared_ptr<SocketChannel> pChannel, const Http
     else
     {
         auto http_step_iter = m_mapCallbackStep.find(pChannel->m_pImpl->PopStepSeq(oHttpMsg.stream_id(), eCodecStatus));
-        if (!pChannel->IsPipeline() && pChannel->m_pImpl->GetPipelineStepSeq().empty())
+        if (CODEC_STATUS_OK == eCodecStatus)
         {
-            m_pLabor->GetDispatcher()->AddNamedSocketChannel(pChannel->GetIdentify(), pChannel);
+            m_pLabor->GetDispatcher()->ReleaseHttpChannel(pChannel, oHttpMsg);
         }
         if (http_step_iter == m_mapCallbackStep.end())
         {
@@ -496,6 +497,54 @@ bool ActorBuilder::OnMessage(std::shared_ptr<SocketChannel> pChannel, const Redi
     }
 }
 
+bool ActorBuilder::OnMessage(std::shared_ptr<SocketChannel> pChannel, const RedisReplyView& oReplyView)
+{
+    if (pChannel->IsClient() && !pChannel->m_pImpl->GetPipelineStepSeq().empty())
+    {
+        auto step_iter = m_mapCallbackStep.find(pChannel->m_pImpl->GetPipelineStepSeq().front());
+        if (step_iter != m_mapCallbackStep.end() && step_iter->second->WithRedisReplyView())
+        {
+            pChannel->m_pImpl->PopStepSeq();
+            if (!pChannel->IsPipeline() && pChannel->m_pImpl->GetPipelineStepSeq().empty())
+            {
+                m_pLabor->GetDispatcher()->AddNamedSocketChannel(pChannel->GetIdentify(), pChannel); // push back to named socket channel pool.
+            }
+            E_CMD_STATUS eResult;
+            step_iter->second->SetActiveTime(m_pLabor->GetNowTime());
+            eResult = step_iter->second->Callback(pChannel, oReplyView);
+            if (CMD_STATUS_RUNNING != eResult)
+            {
+                uint32 uiChainId = step_iter->second->GetChainId();
+                RemoveStep(step_iter->second);
+                if (CMD_STATUS_FAULT != eResult && 0 != uiChainId)
+                {
+                    auto chain_iter = m_mapChain.find(uiChainId);
+                    if (chain_iter != m_mapChain.end())
+                    {
+                        chain_iter->second->SetActiveTime(m_pLabor->GetNowTime());
+                        eResult = chain_iter->second->Next();
+                        if (CMD_STATUS_RUNNING != eResult)
+                        {
+                            RemoveChain(uiChainId);
+                        }
+                    }
+                }
+            }
+            return(eResult);
+        }
+    }
+    InboundMsgCache* pInboundMsgCache = m_pLabor->GetDispatcher()->GetInboundMsgCache();
+    if (nullptr == pInboundMsgCache)
+    {
+        RedisMsg oRedisMsg;
+        oReplyView.ToRedisReply(oRedisMsg);
+        return(OnMessage(pChannel, oRedisMsg));
+    }
+    RedisMsg& oRedisMsg = pInboundMsgCache->RedisMsgForDecode();
+    oReplyView.ToRedisReply(oRedisMsg);
+    return(OnMessage(pChannel, oRedisMsg));
+}
+
 bool ActorBuilder::OnMessage(std::shared_ptr<SocketChannel> pChannel, const CBuffer& oBuffer)
 {
     if (pChannel->IsClient())
@@ -1124,7 +1173,7 @@ bool ActorBuilder::TransformToSharedStep(Actor* pCreator, std::shared_ptr<Actor>
 {
     pSharedActor->m_dTimeout = (gc_dConfigTimeout == pSharedActor->m_dTimeout)
             ? m_pLabor->GetNodeInfo().dStepTimeout : pSharedActor->m_dTimeout;
-    ev_timer* timer_watcher = pSharedActor->MutableTimerWatcher();
+    tagWheelTimer* timer_watcher = pSharedActor->MutableTimerWatcher();
     if (NULL == timer_watcher)
     {
         return(false);
@@ -1174,7 +1223,7 @@ bool ActorBuilder::TransformToSharedStep(Actor* pCreator, std::shared_ptr<Actor>
 
 bool ActorBuilder::TransformToSharedSession(Actor* pCreator, std::shared_ptr<Actor> pSharedActor)
 {
-    ev_timer* timer_watcher = pSharedActor->MutableTimerWatcher();
+    tagWheelTimer* timer_watcher = pSharedActor->MutableTimerWatcher();
     if (NULL == timer_watcher)
     {
         return(false);
@@ -1298,7 +1347,7 @@ bool ActorBuilder::TransformToSharedOperator(Actor* pCreator, std::shared_ptr<Ac
 
 bool ActorBuilder::TransformToSharedChain(Actor* pCreator, std::shared_ptr<Actor> pSharedActor)
 {
-    ev_timer* timer_watcher = pSharedActor->MutableTimerWatcher();
+    tagWheelTimer* timer_watcher = pSharedActor->MutableTimerWatcher();
     if (NULL == timer_watcher)
     {
         return(false);
@@ -1431,9 +1480,8 @@ std::shared_ptr<Operator> ActorBuilder::GetOperator(const std::string& strOperat
 
 bool ActorBuilder::ResetTimeout(std::shared_ptr<Actor> pSharedActor)
 {
-    ev_timer* watcher = pSharedActor->MutableTimerWatcher();
-    ev_tstamp after = m_pLabor->GetNowTime() + pSharedActor->GetTimeout();
-    m_pLabor->GetDispatcher()->RefreshEvent(watcher, after);
+    tagWheelTimer* watcher = pSharedActor->MutableTimerWatcher();
+    m_pLabor->GetDispatcher()->RefreshEvent(watcher, pSharedActor->GetTimeout());
     return(true);
 }
 
@@ -1442,6 +1490,11 @@ int32 ActorBuilder::GetStepNum()
     return((int32)m_mapCallbackStep.size());
 }
 
+bool ActorBuilder::HasCallbackStep(uint32 uiStepSeq) const
+{
+    return(m_mapCallbackStep.find(uiStepSeq) != m_mapCallbackStep.end());
+}
+
 bool ActorBuilder::ReloadCmdConf()
 {
     for (auto cmd_iter = m_mapCmd.begin(); cmd_iter != m_mapCmd.end(); ++cmd_iter)
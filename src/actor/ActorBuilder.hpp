@@ -41,6 +41,7 @@
 #include "ActorFactory.hpp"
 #include "logger/NetLogger.hpp"
 #include "codec/Codec.hpp"
+#include "ios/TimingWheel.hpp"
 
 namespace neb
 {
@@ -49,6 +50,7 @@ typedef RedisReply RedisMsg;
 
 class Manager;
 class Worker;
+class RedisReplyView;
 
 class Actor;
 class Cmd;
@@ -88,15 +90,21 @@ public:
     bool Init(CJsonObject& oBootLoadConf, CJsonObject& oDynamicLoadConf);
     bool Init(CJsonObject& oDynamicLoadConf);
 
-    static void StepTimeoutCallback(struct ev_loop* loop, ev_timer* watcher, int revents);
-    static void SessionTimeoutCallback(struct ev_loop* loop, ev_timer* watcher, int revents);
-    static void ChainTimeoutCallback(struct ev_loop* loop, ev_timer* watcher, int revents);
+    static void StepTimeoutCallback(tagWheelTimer* watcher);
+    static void SessionTimeoutCallback(tagWheelTimer* watcher);
+    static void ChainTimeoutCallback(tagWheelTimer* watcher);
     bool OnStepTimeout(std::shared_ptr<Step> pStep);
     bool OnSessionTimeout(std::shared_ptr<Session> pSession);
     bool OnChainTimeout(std::shared_ptr<Chain> pChain);
     bool OnMessage(std::shared_ptr<SocketChannel> pChannel, const MsgHead& oMsgHead, const MsgBody& oMsgBody);
     bool OnMessage(std::shared_ptr<SocketChannel> pChannel, const HttpMsg& oHttpMsg, E_CODEC_STATUS eCodecStatus = CODEC_STATUS_OK);
     bool OnMessage(std::shared_ptr<SocketChannel> pChannel, const RedisMsg& oRedisMsg, uint32 uiFinalStepSeq = 0);
+    /**
+     * @brief redis回复的只读视图
+     * @note 等待回调的步骤WithRedisReplyView()为true时直接回调视图，否则转换为
+     * RedisMsg后按OnMessage(pChannel, oRedisMsg)处理。
+     */
+    bool OnMessage(std::shared_ptr<SocketChannel> pChannel, const RedisReplyView& oReplyView);
     bool OnMessage(std::shared_ptr<SocketChannel> pChannel, const CBuffer& oBuffer);
     bool OnSelfMessage(std::shared_ptr<SocketChannel> pChannel, const MsgHead& oMsgHead, const MsgBody& oMsgBody);
     bool OnSelfMessage(std::shared_ptr<SocketChannel> pChannel, const HttpMsg& oHttpMsg);
@@ -109,6 +117,7 @@ public:
         void Logger(int iLogLevel, const char* szFileName, unsigned int uiFileLine, const char* szFunction, Targs&&... args);
     template <typename ...Targs>
         void Logger(const std::string& strTraceId, int iLogLevel, const char* szFileName, unsigned int uiFileLine, const char* szFunction, Targs&&... args);
+    bool IsLogEnabled(int iLogLevel) const;
 
     template <typename ...Targs>
     std::shared_ptr<Actor> MakeSharedActor(Actor* pCreator, const std::string& strActorName, Targs&&... args);
@@ -151,6 +160,7 @@ public:
     virtual std::shared_ptr<Operator> GetOperator(const std::string& strOperatorName);
     virtual bool ResetTimeout(std::shared_ptr<Actor> pSharedActor);
     int32 GetStepNum();
+    bool HasCallbackStep(uint32 uiStepSeq) const;   ///< 步骤是否仍在等待回调（未超时、未结束）
     bool ReloadCmdConf();
     bool AddNetLogMsg(const MsgBody& oMsgBody);
     void AddChainConf(const std::string& strChainKey, std::queue<std::vector<std::string> >&& queChainBlocks);
@@ -206,6 +216,11 @@ private:
     friend class Chain;
 };
 
+inline bool ActorBuilder::IsLogEnabled(int iLogLevel) const
+{
+    return(m_pLogger->IsLevelEnabled(iLogLevel));
+}
+
 template <typename ...Targs>
 void ActorBuilder::Logger(int iLogLevel, const char* szFileName, unsigned int uiFileLine, const char* szFunction, Targs&&... args)
 {
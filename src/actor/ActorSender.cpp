@@ -63,29 +63,17 @@ bool ActorSender::SendTo(Actor* pActor, const std::string& strIdentify, int32 iC
 bool ActorSender::SendTo(Actor* pActor, const std::string& strHost, int iPort, const HttpMsg& oHttpMsg, uint32 uiStepSeq)
 {
     bool bWithSsl = false;
-    bool bPipeline = false;
     if (oHttpMsg.headers().find("x-trace-id") == oHttpMsg.headers().end())
     {
         (const_cast<HttpMsg&>(oHttpMsg)).mutable_headers()->insert({"x-trace-id", pActor->GetTraceId()});
     }
-    if (oHttpMsg.http_major() >= 2)
-    {
-        bPipeline = true;
-    }
     std::string strSchema = oHttpMsg.url().substr(0, oHttpMsg.url().find_first_of(":"));
     std::transform(strSchema.begin(), strSchema.end(), strSchema.begin(), [](unsigned char c)->unsigned char {return std::tolower(c);});
     if (strSchema == std::string("https"))
     {
         bWithSsl = true;
     }
-    if (oHttpMsg.http_major() == 2)
-    {
-        return(pActor->m_pLabor->GetDispatcher()->SendTo(strHost, iPort, CODEC_HTTP2, bWithSsl, bPipeline, oHttpMsg, pActor->GetSequence()));
-    }
-    else
-    {
-        return(pActor->m_pLabor->GetDispatcher()->SendTo(strHost, iPort, CODEC_HTTP, bWithSsl, bPipeline, oHttpMsg, pActor->GetSequence()));
-    }
+    return(pActor->m_pLabor->GetDispatcher()->SendHttpRequest(strHost, iPort, bWithSsl, oHttpMsg, pActor->GetSequence()));
 }
 
 bool ActorSender::SendTo(Actor* pActor, const std::string& strIdentify, const RedisMsg& oRedisMsg, bool bWithSsl, bool bPipeline, uint32 uiStepSeq)
@@ -30,9 +30,9 @@ std::mutex SessionManager::s_mutexWorker;
 std::vector<uint64> SessionManager::s_vecWorkerThreadId;
 
 SessionManager::SessionManager(bool bDirectToLoader)
-    : Session("neb::SessionManager", gc_dDefaultTimeout), m_bDirectToLoader(bDirectToLoader)
+    : Session("neb::SessionManager", gc_dDefaultTimeout), m_bDirectToLoader(bDirectToLoader),
+      m_oPlacementRandom((uint32)getpid())
 {
-    m_iterWorkerInfo = m_mapWorkerInfo.begin();
 }
 
 SessionManager::~SessionManager()
@@ -49,7 +49,7 @@ SessionManager::~SessionManager()
         it->second = nullptr;
     }
     m_mapWorkerInfo.clear();
-    m_iterWorkerInfo = m_mapWorkerInfo.begin();
+    m_vecPlacementWorker.clear();
     m_mapWorkerStartNum.clear();
     m_mapWorkerFdPid.clear();
     m_mapOnlineNodes.clear();
@@ -180,14 +180,12 @@ void SessionManager::AddWorkerInfo(int iWorkerIndex, int iPid, int iControlFd, i
     if (GetLabor(this)->GetNodeInfo().bThreadMode)
     {
         m_mapWorkerInfo.insert(std::make_pair(iWorkerIndex, pWorkerAttr));
-        m_iterWorkerInfo = m_mapWorkerInfo.begin();
         m_mapWorkerFdPid.insert(std::pair<int, int>(iControlFd, iWorkerIndex));
         m_mapWorkerFdPid.insert(std::pair<int, int>(iDataFd, iWorkerIndex));
     }
     else
     {
         m_mapWorkerInfo.insert(std::make_pair(iPid, pWorkerAttr));
-        m_iterWorkerInfo = m_mapWorkerInfo.begin();
         m_mapWorkerFdPid.insert(std::pair<int, int>(iControlFd, iPid));
         m_mapWorkerFdPid.insert(std::pair<int, int>(iDataFd, iPid));
     }
@@ -200,6 +198,7 @@ void SessionManager::AddWorkerInfo(int iWorkerIndex, int iPid, int iControlFd, i
     {
         start_num_iter->second++;
     }
+    ResetPlacement();
 }
 
 void SessionManager::AddLoaderInfo(int iWorkerIndex, int iPid, int iControlFd, int iDataFd)
@@ -285,6 +284,8 @@ bool SessionManager::SetWorkerLoad(int iWorkerFd, CJsonObject& oJsonLoad)
             oJsonLoad.Get("send_num", it->second->uiSendNum);
             oJsonLoad.Get("send_byte", it->second->uiSendByte);
             oJsonLoad.Get("client", it->second->uiClientNum);
+            // 只核销Worker确认收到的分派：心跳发出之后才分派或仍在传递途中的连接不在uiConnect中
+            oJsonLoad.Get("transferred", it->second->uiPlacedAcked);
             it->second->dBeatTime = GetNowTime();
             it->second->bStartBeatCheck = true;
             return(true);
@@ -316,30 +317,40 @@ int SessionManager::GetNextWorkerDataFd()
     {
         return(m_iLoaderDataFd);
     }
-    else
+    if (m_vecPlacementWorker.empty())
     {
-        if (m_mapWorkerInfo.empty())
-        {
-            return(-1);
-        }
-        ++m_iterWorkerInfo;
-        if (m_iterWorkerInfo == m_mapWorkerInfo.end())
-        {
-            m_iterWorkerInfo = m_mapWorkerInfo.begin();
-        }
-        if (m_iterWorkerInfo->second->iDataFd == m_iLoaderDataFd)
-        {
-            ++m_iterWorkerInfo;
-            if (m_iterWorkerInfo == m_mapWorkerInfo.end())
-            {
-                if (m_mapWorkerInfo.size() == 1)
-                {
-                    return(-1);
-                }
-                m_iterWorkerInfo = m_mapWorkerInfo.begin();
-            }
-        }
-        return(m_iterWorkerInfo->second->iDataFd);
+        return(-1);
+    }
+    WorkerInfo* pWorkerInfo = nullptr;
+    switch (GetLabor(this)->GetNodeInfo().iWorkerPlacement)
+    {
+        case WORKER_PLACEMENT_LEAST_CONN:
+            pWorkerInfo = PlaceLeastConn();
+            break;
+        case WORKER_PLACEMENT_POWER_OF_TWO:
+            pWorkerInfo = PlacePowerOfTwo();
+            break;
+        case WORKER_PLACEMENT_CPU_WEIGHTED:
+            pWorkerInfo = PlaceCpuWeighted();
+            break;
+        default:
+            pWorkerInfo = PlaceRoundRobin();
+    }
+    ++pWorkerInfo->uiPlaced;
+    return(pWorkerInfo->iDataFd);
+}
+
+void SessionManager::CancelPlacement(int iWorkerDataFd, uint32 uiNum)
+{
+    auto fd_pid_iter = m_mapWorkerFdPid.find(iWorkerDataFd);
+    if (fd_pid_iter == m_mapWorkerFdPid.end())
+    {
+        return;
+    }
+    auto it = m_mapWorkerInfo.find(fd_pid_iter->second);
+    if (it != m_mapWorkerInfo.end())
+    {
+        it->second->uiPlaced -= uiNum;
     }
 }
 
@@ -435,7 +446,7 @@ bool SessionManager::WorkerDeath(int iPid, int& iWorkerIndex, Labor::LABOR_TYPE&
         GetLabor(this)->GetDispatcher()->DiscardSocketChannel(pDataChannel);
         delete worker_iter->second;
         m_mapWorkerInfo.erase(worker_iter);
-        m_iterWorkerInfo = m_mapWorkerInfo.begin();
+        ResetPlacement();
 
         auto restart_num_iter = m_mapWorkerStartNum.find(iWorkerIndex);
         if (restart_num_iter != m_mapWorkerStartNum.end())
@@ -450,6 +461,97 @@ bool SessionManager::WorkerDeath(int iPid, int& iWorkerIndex, Labor::LABOR_TYPE&
     }
 }
 
+void SessionManager::ResetPlacement()
+{
+    m_vecPlacementWorker.clear();
+    for (auto iter = m_mapWorkerInfo.begin(); iter != m_mapWorkerInfo.end(); ++iter)
+    {
+        if (iter->second->iDataFd != m_iLoaderDataFd)
+        {
+            m_vecPlacementWorker.push_back(iter->second);
+        }
+    }
+    // unordered_map的遍历顺序与Worker序号无关，排序使轮询顺序稳定
+    std::sort(m_vecPlacementWorker.begin(), m_vecPlacementWorker.end(),
+            [](const WorkerInfo* a, const WorkerInfo* b){ return(a->iWorkerIndex < b->iWorkerIndex); });
+    m_uiRoundRobin = 0;
+
+    // 绑定CPU时序号为i的Worker（包括Loader）运行在CPU i % iCpuNum上，同一CPU上的Worker分摊该CPU
+    int iCpuNum = sysconf(_SC_NPROCESSORS_CONF);
+    std::unordered_map<int, uint32> mapCpuWorkerNum;
+    if (GetLabor(this)->GetNodeInfo().bCpuAffinity && iCpuNum > 0)
+    {
+        for (auto iter = m_mapWorkerInfo.begin(); iter != m_mapWorkerInfo.end(); ++iter)
+        {
+            ++mapCpuWorkerNum[iter->second->iWorkerIndex % iCpuNum];
+        }
+    }
+    for (auto pWorkerInfo : m_vecPlacementWorker)
+    {
+        pWorkerInfo->uiCpuShare = 1;
+        if (!mapCpuWorkerNum.empty())
+        {
+            pWorkerInfo->uiCpuShare = mapCpuWorkerNum[pWorkerInfo->iWorkerIndex % iCpuNum];
+        }
+    }
+}
+
+WorkerInfo* SessionManager::PlaceRoundRobin()
+{
+    if (m_uiRoundRobin >= m_vecPlacementWorker.size())
+    {
+        m_uiRoundRobin = 0;
+    }
+    return(m_vecPlacementWorker[m_uiRoundRobin++]);
+}
+
+WorkerInfo* SessionManager::PlaceLeastConn()
+{
+    // 从轮询位置开始扫描，连接数相同的Worker依次被选中，避免总是落在第一个Worker上
+    WorkerInfo* pMinWorker = PlaceRoundRobin();
+    uint32 uiWorkerNum = m_vecPlacementWorker.size();
+    for (uint32 i = 1; i < uiWorkerNum; ++i)
+    {
+        WorkerInfo* pWorkerInfo = m_vecPlacementWorker[(m_uiRoundRobin - 1 + i) % uiWorkerNum];
+        if (PlacementConnect(pWorkerInfo) < PlacementConnect(pMinWorker))
+        {
+            pMinWorker = pWorkerInfo;
+        }
+    }
+    return(pMinWorker);
+}
+
+WorkerInfo* SessionManager::PlacePowerOfTwo()
+{
+    uint32 uiWorkerNum = m_vecPlacementWorker.size();
+    if (uiWorkerNum == 1)
+    {
+        return(m_vecPlacementWorker[0]);
+    }
+    uint32 uiFirst = m_oPlacementRandom() % uiWorkerNum;
+    uint32 uiSecond = (uiFirst + 1 + m_oPlacementRandom() % (uiWorkerNum - 1)) % uiWorkerNum;
+    WorkerInfo* pFirst = m_vecPlacementWorker[uiFirst];
+    WorkerInfo* pSecond = m_vecPlacementWorker[uiSecond];
+    return((PlacementConnect(pSecond) < PlacementConnect(pFirst)) ? pSecond : pFirst);
+}
+
+WorkerInfo* SessionManager::PlaceCpuWeighted()
+{
+    // 权重为1 / uiCpuShare，比较(连接数 + 1) / 权重，独占CPU的Worker分得更多连接
+    WorkerInfo* pMinWorker = PlaceRoundRobin();
+    uint32 uiWorkerNum = m_vecPlacementWorker.size();
+    for (uint32 i = 1; i < uiWorkerNum; ++i)
+    {
+        WorkerInfo* pWorkerInfo = m_vecPlacementWorker[(m_uiRoundRobin - 1 + i) % uiWorkerNum];
+        if ((PlacementConnect(pWorkerInfo) + 1) * pWorkerInfo->uiCpuShare
+                < (PlacementConnect(pMinWorker) + 1) * pMinWorker->uiCpuShare)
+        {
+            pMinWorker = pWorkerInfo;
+        }
+    }
+    return(pMinWorker);
+}
+
 void SessionManager::SendOnlineNodesToWorker()
 {
     // 重启Worker进程后下发其他节点的信息
@@ -13,6 +13,7 @@
 
 #include <thread>
 #include <mutex>
+#include <random>
 #include "actor/ActorSys.hpp"
 #include "labor/NodeInfo.hpp"
 #include "actor/session/Session.hpp"
@@ -22,6 +23,19 @@ namespace neb
 
 class Loader;
 
+/**
+ * @brief 新连接在Worker间的分派策略（配置项worker_placement）
+ * @note 除轮询外，各策略依据的连接数为最近一次心跳上报的连接数加上此后分派给该
+ * Worker的连接数，每分派一个连接立即累加，不必等待下一次心跳。
+ */
+enum E_WORKER_PLACEMENT
+{
+    WORKER_PLACEMENT_ROUND_ROBIN    = 0,        ///< 轮询
+    WORKER_PLACEMENT_LEAST_CONN     = 1,        ///< 连接数最少
+    WORKER_PLACEMENT_POWER_OF_TWO   = 2,        ///< 随机取两个Worker，选连接数较少者
+    WORKER_PLACEMENT_CPU_WEIGHTED   = 3,        ///< 按所绑定CPU上的Worker数量加权的最少连接
+};
+
 class SessionManager : public Session,
     public DynamicCreator<SessionManager, bool>, public ActorSys
 {
@@ -43,7 +57,8 @@ public:
     const WorkerInfo* GetWorkerInfo(int32 iWorkerIndex) const;
     bool SetWorkerLoad(int iWorkerFd, CJsonObject& oJsonLoad);
     void SetLoaderActorBuilder(ActorBuilder* pActorBuilder);
-    int GetNextWorkerDataFd();
+    int GetNextWorkerDataFd();      // 按worker_placement策略选择接收新连接的Worker
+    void CancelPlacement(int iWorkerDataFd, uint32 uiNum);     // 连接未能传递给Worker时撤销分派计数
     std::pair<int, int> GetMinLoadWorkerDataFd();
     bool CheckWorker();
     bool WorkerDeath(int iPid, int& iWorkerIndex, Labor::LABOR_TYPE& eLaborType);
@@ -59,12 +74,28 @@ public:
     }
     static void AddWorkerThreadId(uint64 ullThreadId);
 
+protected:
+    void ResetPlacement();
+    WorkerInfo* PlaceRoundRobin();
+    WorkerInfo* PlaceLeastConn();
+    WorkerInfo* PlacePowerOfTwo();
+    WorkerInfo* PlaceCpuWeighted();
+
+    static uint64 PlacementConnect(const WorkerInfo* pWorkerInfo)
+    {
+        // 已分派但Worker尚未确认收到的连接；累计计数回绕后差值仍正确，为负（计数不同步）时按0计
+        int32 iUnacked = (int32)(pWorkerInfo->uiPlaced - pWorkerInfo->uiPlacedAcked);
+        return((uint64)pWorkerInfo->uiConnect + (iUnacked > 0 ? iUnacked : 0));
+    }
+
 private:
     bool m_bDirectToLoader = false;
     int m_iLoaderDataFd = -1;
     std::unordered_map<int, Worker*> m_mapWorker;               ///< only thread worker
     std::unordered_map<int, WorkerInfo*> m_mapWorkerInfo;       ///< 业务逻辑工作进程及进程属性，key为pid
-    std::unordered_map<int, WorkerInfo*>::iterator m_iterWorkerInfo;
+    uint32 m_uiRoundRobin = 0;
+    std::vector<WorkerInfo*> m_vecPlacementWorker;            ///< 可接收新连接的Worker（不含Loader）
+    std::minstd_rand m_oPlacementRandom;
     std::unordered_map<int, int> m_mapWorkerStartNum;       ///< 进程被启动次数，key为WorkerIdx
     std::unordered_map<int, int> m_mapWorkerFdPid;            ///< 工作进程通信FD对应的进程号
     std::unordered_map<std::string, std::string> m_mapOnlineNodes;     ///< 订阅的节点在线信息
@@ -14,7 +14,7 @@ namespace neb
 {
 
 HttpStep::HttpStep(std::shared_ptr<Step> pNextStep, ev_tstamp dTimeout)
-    : Step(ACT_HTTP_STEP, pNextStep, dTimeout)
+    : Step(ACT_HTTP_STEP, pNextStep, dTimeout), m_bHttp2(false)
 {
 }
 
@@ -25,8 +25,8 @@ HttpStep::~HttpStep()
 bool HttpStep::HttpGet(const std::string& strUrl)
 {
     HttpMsg oHttpMsg;
-    oHttpMsg.set_http_major(1);
-    oHttpMsg.set_http_minor(1);
+    oHttpMsg.set_http_major(m_bHttp2 ? 2 : 1);
+    oHttpMsg.set_http_minor(m_bHttp2 ? 0 : 1);
     oHttpMsg.set_type(HTTP_REQUEST);
     oHttpMsg.set_method(HTTP_GET);
     oHttpMsg.set_url(strUrl);
@@ -36,8 +36,8 @@ bool HttpStep::HttpGet(const std::string& strUrl)
 bool HttpStep::HttpGet(const std::string& strUrl, const std::unordered_map<std::string, std::string>& mapHeaders)
 {
     HttpMsg oHttpMsg;
-    oHttpMsg.set_http_major(1);
-    oHttpMsg.set_http_minor(1);
+    oHttpMsg.set_http_major(m_bHttp2 ? 2 : 1);
+    oHttpMsg.set_http_minor(m_bHttp2 ? 0 : 1);
     oHttpMsg.set_type(HTTP_REQUEST);
     oHttpMsg.set_method(HTTP_GET);
     oHttpMsg.set_url(strUrl);
@@ -51,8 +51,8 @@ bool HttpStep::HttpGet(const std::string& strUrl, const std::unordered_map<std::
 bool HttpStep::HttpGet(const std::string& strUrl, const ::google::protobuf::Map<std::string, std::string>& mapHeaders)
 {
     HttpMsg oHttpMsg;
-    oHttpMsg.set_http_major(1);
-    oHttpMsg.set_http_minor(1);
+    oHttpMsg.set_http_major(m_bHttp2 ? 2 : 1);
+    oHttpMsg.set_http_minor(m_bHttp2 ? 0 : 1);
     oHttpMsg.set_type(HTTP_REQUEST);
     oHttpMsg.set_method(HTTP_GET);
     oHttpMsg.set_url(strUrl);
@@ -66,8 +66,8 @@ bool HttpStep::HttpGet(const std::string& strUrl, const ::google::protobuf::Map<
 bool HttpStep::HttpPost(const std::string& strUrl, const std::string& strBody, const std::unordered_map<std::string, std::string>& mapHeaders)
 {
     HttpMsg oHttpMsg;
-    oHttpMsg.set_http_major(1);
-    oHttpMsg.set_http_minor(1);
+    oHttpMsg.set_http_major(m_bHttp2 ? 2 : 1);
+    oHttpMsg.set_http_minor(m_bHttp2 ? 0 : 1);
     oHttpMsg.set_type(HTTP_REQUEST);
     oHttpMsg.set_method(HTTP_POST);
     oHttpMsg.set_url(strUrl);
@@ -82,8 +82,8 @@ bool HttpStep::HttpPost(const std::string& strUrl, const std::string& strBody, c
 bool HttpStep::HttpPost(const std::string& strUrl, const std::string& strBody, const ::google::protobuf::Map<std::string, std::string>& mapHeaders)
 {
     HttpMsg oHttpMsg;
-    oHttpMsg.set_http_major(1);
-    oHttpMsg.set_http_minor(1);
+    oHttpMsg.set_http_major(m_bHttp2 ? 2 : 1);
+    oHttpMsg.set_http_minor(m_bHttp2 ? 0 : 1);
     oHttpMsg.set_type(HTTP_REQUEST);
     oHttpMsg.set_method(HTTP_POST);
     oHttpMsg.set_url(strUrl);
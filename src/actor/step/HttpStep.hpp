@@ -40,8 +40,18 @@ public:
     bool HttpPost(const std::string& strUrl, const std::string& strBody,
             const ::google::protobuf::Map<std::string, std::string>& mapHeaders);
 
+    /**
+     * @brief HttpGet()、HttpPost()以HTTP/2发出，同一上游的请求在一个连接上按流复用
+     */
+    void EnableHttp2(bool bEnable = true)
+    {
+        m_bHttp2 = bEnable;
+    }
+
 private:
     bool HttpRequest(const HttpMsg& oHttpMsg);
+
+    bool m_bHttp2;
 };
 
 } /* namespace neb */
@@ -8,6 +8,7 @@
  * Modify history:
  ******************************************************************************/
 #include "Step.hpp"
+#include "codec/RedisReplyView.hpp"
 
 namespace neb
 {
@@ -61,6 +62,14 @@ E_CMD_STATUS Step::Callback(std::shared_ptr<SocketChannel> pChannel,
     return(CMD_STATUS_FAULT);
 }
 
+E_CMD_STATUS Step::Callback(std::shared_ptr<SocketChannel> pChannel,
+            const RedisReplyView& oReplyView)
+{
+    RedisReply oRedisReply;
+    oReplyView.ToRedisReply(oRedisReply);
+    return(Callback(pChannel, oRedisReply));
+}
+
 E_CMD_STATUS Step::Callback(std::shared_ptr<SocketChannel> pChannel,
             const char* pRawData, uint32 uiRawDataSize)
 {
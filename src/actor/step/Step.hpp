@@ -18,6 +18,7 @@ namespace neb
 
 class ActorBuilder;
 class Chain;
+class RedisReplyView;
 
 class Step: public Actor
 {
@@ -60,6 +61,18 @@ public:
     virtual E_CMD_STATUS Callback(std::shared_ptr<SocketChannel> pChannel,
             const char* pRawData, uint32 uiRawDataSize);
 
+    /**
+     * @brief 是否以只读视图接收redis响应
+     * @note 返回true的步骤由框架回调Callback(pChannel, oReplyView)，响应不再转换为
+     * RedisReply，视图中的字符串直接指向接收缓冲区，只在回调期间有效。
+     */
+    virtual bool WithRedisReplyView() const
+    {
+        return(false);
+    }
+    virtual E_CMD_STATUS Callback(std::shared_ptr<SocketChannel> pChannel,
+            const RedisReplyView& oReplyView);
+
 protected:
     /**
      * @brief 执行当前步骤接下来的步骤
@@ -20,6 +20,7 @@ namespace neb
 {
 
 const uint16 StepRedisCluster::sc_unClusterSlots = 16384;
+const uint16 StepRedisCluster::sc_unNoRedisNode = 0xFFFF;
 
 const std::unordered_set<std::string> StepRedisCluster::s_setSupportExtractCmd =
 {
@@ -59,7 +60,7 @@ const std::unordered_set<std::string> StepRedisCluster::s_setReadCmd =
     // hashes
     "HEXISTS","HGET","HGETALL","HKEYS","HLEN","HMGET","HSTRLEN","HVALS","HSCAN",
     // lists
-    "LINDEX","LLEN","LRANGE",
+    "LINDEX","LLEN","LPOS","LRANGE",
     // sets
     "SCARD","SISMEMBER","SMISMEMBER","SMEMBERS","SRANDMEMBER","SSCAN",
     // sorted sets
@@ -78,15 +79,15 @@ const std::unordered_set<std::string> StepRedisCluster::s_setWriteCmd =
     // hashes
     "HDEL","HINCRBY","HINCRBYFLOAT","HMSET","HSET","HSETNX",
     // lists
-    "LINSERT","LPOS","LPUSH","LPUSHX","LREM","LSET","LTRIM","RPOP",
-    "PROPLPUSH","RPUSH","RPUSHX",
+    "LINSERT","LPOP","LPUSH","LPUSHX","LREM","LSET","LTRIM","RPOP",
+    "RPOPLPUSH","RPUSH","RPUSHX",
     // sets
     "SADD","SPOP","SREM",
     // sorted sets
     "ZADD","ZINCRBY","ZPOPMAX","ZPOPMIN",
     "ZREM","ZREMRANGEBYLEX","ZREMRANGEBYRANK","ZREMRANGEBYSCORE",
     // keys
-    "DEL","EXPIREAT","MOVE","PERSIST","PEXPIRE","PEXPIREAT",
+    "DEL","EXPIRE","EXPIREAT","MOVE","PERSIST","PEXPIRE","PEXPIREAT",
     "RESTORE","SORT","TOUCH","UNLINK"
 };
 
@@ -105,7 +106,8 @@ StepRedisCluster::StepRedisCluster(
     : RedisStep(nullptr, 10.0),
       m_bWithSsl(bWithSsl), m_bPipeline(bPipeline), m_bEnableReadOnly(bEnableReadOnly),
       m_uiAddressIndex(0),
-      m_strIdentify(strIdentify)
+      m_strIdentify(strIdentify),
+      m_vecSlot2Node(sc_unClusterSlots, sc_unNoRedisNode)
 {
     Split(strIdentify, ",", m_vecAddress);
 }
@@ -125,7 +127,7 @@ E_CMD_STATUS StepRedisCluster::Callback(
 {
     LOG4_TRACE("callback from %s:\n%s", pChannel->GetIdentify().c_str(), oRedisReply.DebugString().c_str());
     auto step_iter = m_mapPipelineRequest.find(pChannel->GetIdentify());
-    if (step_iter == m_mapPipelineRequest.end())
+    if (step_iter == m_mapPipelineRequest.end() || step_iter->second.empty())
     {
         LOG4_ERROR("no \"%s\" found in m_mapPipelineStep", pChannel->GetIdentify().c_str());
         return(CMD_STATUS_FAULT);
@@ -135,7 +137,7 @@ E_CMD_STATUS StepRedisCluster::Callback(
     step_iter->second.pop();
     if (uiRealStepSeq == GetSequence())
     {
-        if (pRedisRequest->element(0).str() == "ASK")
+        if (pRedisRequest->element(0).str() == "ASKING")
         {
             CmdAskingCallback(pChannel, pChannel->GetIdentify(), oRedisReply);
         }
@@ -151,154 +153,17 @@ E_CMD_STATUS StepRedisCluster::Callback(
     }
     else
     {
-        auto num_iter = m_mapStepEmitNum.find(uiRealStepSeq);
-        if (num_iter == m_mapStepEmitNum.end()) // 单key请求的响应
+        if (REDIS_REPLY_ERROR == oRedisReply.type() && Redirect(pRedisRequest, oRedisReply))
         {
-            if (REDIS_REPLY_ERROR == oRedisReply.type())
-            {
-                std::vector<std::string> vecMsg;
-                Split(oRedisReply.str(), " ", vecMsg);
-                if (vecMsg.size() >= 3)
-                {
-                    if (vecMsg[0] == "MOVED")
-                    {
-                        SendTo(vecMsg[2], pRedisRequest);
-                        SendCmdClusterSlots();
-                        return(CMD_STATUS_RUNNING);
-                    }
-                    if (vecMsg[0] == "ASK")
-                    {
-                        AddToAskingQueue(vecMsg[2], pRedisRequest);
-                        SendCmdAsking(vecMsg[2]);
-                        return(CMD_STATUS_RUNNING);
-                    }
-                }
-            }
-            GetLabor(this)->GetActorBuilder()->OnMessage(pChannel, oRedisReply, uiRealStepSeq);
+            return(CMD_STATUS_RUNNING);
         }
-        else    // 多key请求的响应
+        if (IsMultiKeyRequest(*pRedisRequest))  // 多key请求的响应
         {
-            if (REDIS_REPLY_ARRAY == oRedisReply.type())
-            {
-                auto reply_iter = m_mapReply.find(uiRealStepSeq);
-                if (reply_iter == m_mapReply.end())
-                {
-                    LOG4_ERROR("no m_mapReply found for step %u", uiRealStepSeq);
-                    return(CMD_STATUS_RUNNING);
-                }
-                std::vector<uint32> vecElementIndex;
-                for (int i = 1; i < pRedisRequest->element_size(); ++i)  // element(0).str() is cmd
-                {
-                    if (pRedisRequest->element(i).integer() > 0 || i == 1)
-                    {
-                        vecElementIndex.push_back((uint32)pRedisRequest->element(i).integer());
-                    }
-                }
-                for (uint32 j = 0; j < vecElementIndex.size(); ++j)
-                {
-                    if (vecElementIndex[j] < reply_iter->second.size())
-                    {
-                        if (reply_iter->second[vecElementIndex[j]] == nullptr)
-                        {
-                            reply_iter->second[vecElementIndex[j]] = new RedisReply();
-                        }
-                        reply_iter->second[vecElementIndex[j]]->CopyFrom(oRedisReply.element(j));
-                    }
-                    else
-                    {
-                        LOG4_ERROR("element index %u larger than reply size %u", vecElementIndex[j], reply_iter->second.size());
-                    }
-                }
-                uint32 uiReqReplyOdd = (pRedisRequest->element_size() - 1) % oRedisReply.element_size();
-                if (uiReqReplyOdd != 0)
-                {
-                    LOG4_ERROR("request and reply not match for %s", pRedisRequest->element(0).str().c_str());
-                }
-                num_iter->second--;
-                if (num_iter->second == 0)
-                {
-                    RedisReply oFinalReply;
-                    oFinalReply.set_type(oRedisReply.type());
-                    for (size_t k = 0; k < reply_iter->second.size(); ++k)
-                    {
-                        oFinalReply.mutable_element()->AddAllocated(reply_iter->second[k]);
-                        reply_iter->second[k] = nullptr;
-                    }
-                    GetLabor(this)->GetActorBuilder()->OnMessage(pChannel, oFinalReply, uiRealStepSeq);
-                    m_mapStepEmitNum.erase(num_iter);
-                    m_mapReply.erase(reply_iter);
-                }
-            }
-            else
-            {
-                if (REDIS_REPLY_ERROR == oRedisReply.type())
-                {
-                    std::vector<std::string> vecMsg;
-                    Split(oRedisReply.str(), " ", vecMsg);
-                    if (vecMsg.size() >= 3)
-                    {
-                        if (vecMsg[0] == "MOVED")
-                        {
-                            SendTo(vecMsg[2], pRedisRequest);
-                            SendCmdClusterSlots();
-                            return(CMD_STATUS_RUNNING);
-                        }
-                        if (vecMsg[0] == "ASK")
-                        {
-                            AddToAskingQueue(vecMsg[2], pRedisRequest);
-                            SendCmdAsking(vecMsg[2]);
-                            return(CMD_STATUS_RUNNING);
-                        }
-                        if (vecMsg[0] == "CROSSSLOT")
-                        {
-                            SendCmdClusterSlots();
-                        }
-                    }
-                }
-                auto reply_iter = m_mapReply.find(uiRealStepSeq);
-                if (reply_iter == m_mapReply.end())
-                {
-                    LOG4_ERROR("no m_mapReply found for step %u", uiRealStepSeq);
-                    return(CMD_STATUS_RUNNING);
-                }
-                std::vector<uint32> vecElementIndex;
-                for (int i = 1; i < pRedisRequest->element_size(); ++i)  // element(0).str() is cmd
-                {
-                    if (pRedisRequest->element(i).integer() > 0 || i == 1)
-                    {
-                        vecElementIndex.push_back((uint32)pRedisRequest->element(i).integer());
-                    }
-                }
-                for (uint32 j = 0; j < vecElementIndex.size(); ++j)
-                {
-                    if (vecElementIndex[j] < reply_iter->second.size())
-                    {
-                        if (reply_iter->second[vecElementIndex[j]] == nullptr)
-                        {
-                            reply_iter->second[vecElementIndex[j]] = new RedisReply();
-                        }
-                        reply_iter->second[vecElementIndex[j]]->CopyFrom(oRedisReply);
-                    }
-                    else
-                    {
-                        LOG4_ERROR("element index %u larger than reply size %u", vecElementIndex[j], reply_iter->second.size());
-                    }
-                }
-                num_iter->second--;
-                if (num_iter->second == 0)
-                {
-                    RedisReply oFinalReply;
-                    oFinalReply.set_type(oRedisReply.type());
-                    for (size_t k = 0; k < reply_iter->second.size(); ++k)
-                    {
-                        oFinalReply.mutable_element()->AddAllocated(reply_iter->second[k]);
-                        reply_iter->second[k] = nullptr;
-                    }
-                    GetLabor(this)->GetActorBuilder()->OnMessage(pChannel, oFinalReply, uiRealStepSeq);
-                    m_mapStepEmitNum.erase(num_iter);
-                    m_mapReply.erase(reply_iter);
-                }
-            }
+            OnMultiKeyReply(pChannel, *pRedisRequest, oRedisReply);
+        }
+        else    // 单key请求的响应
+        {
+            GetLabor(this)->GetActorBuilder()->OnMessage(pChannel, oRedisReply, uiRealStepSeq);
         }
     }
     return(CMD_STATUS_RUNNING);
@@ -306,32 +171,7 @@ E_CMD_STATUS StepRedisCluster::Callback(
 
 E_CMD_STATUS StepRedisCluster::Timeout()
 {
-    for (auto timeout_iter = m_mapTimeoutStep.begin(); timeout_iter != m_mapTimeoutStep.end(); )
-    {
-        if (GetNowTime() - timeout_iter->first >= GetTimeout())
-        {
-            for (uint32 i = 0; i < timeout_iter->second.size(); ++i)
-            {
-                auto reply_iter = m_mapReply.find(timeout_iter->second[i]);
-                if (reply_iter != m_mapReply.end())
-                {
-                    m_mapReply.erase(reply_iter);
-                }
-                auto num_iter = m_mapStepEmitNum.find(timeout_iter->second[i]);
-                if (num_iter != m_mapStepEmitNum.end())
-                {
-                    m_mapStepEmitNum.erase(num_iter);
-                }
-            }
-            timeout_iter->second.clear();
-            m_mapTimeoutStep.erase(timeout_iter);
-            timeout_iter = m_mapTimeoutStep.begin();
-        }
-        else
-        {
-            break;
-        }
-    }
+    ExpireMultiKeyReply();
     return(CMD_STATUS_RUNNING);
 }
 
@@ -346,6 +186,9 @@ E_CMD_STATUS StepRedisCluster::ErrBack(
     }
     else
     {
+        RedisReply oErrReply;
+        oErrReply.set_type(REDIS_REPLY_ERROR);
+        oErrReply.set_str(strErrMsg);
         while (step_iter->second.size() > 0)
         {
             auto pRedisRequest = step_iter->second.front();
@@ -355,62 +198,13 @@ E_CMD_STATUS StepRedisCluster::ErrBack(
             {
                 SendCmdClusterSlots();
             }
+            else if (IsMultiKeyRequest(*pRedisRequest))
+            {
+                OnMultiKeyReply(pChannel, *pRedisRequest, oErrReply);
+            }
             else
             {
-                auto num_iter = m_mapStepEmitNum.find(uiRealStepSeq);
-                if (num_iter == m_mapStepEmitNum.end()) // 单key请求的响应
-                {
-                    GetLabor(this)->GetActorBuilder()->OnError(pChannel, uiRealStepSeq, iErrno, strErrMsg);
-                }
-                else
-                {
-                    auto reply_iter = m_mapReply.find(uiRealStepSeq);
-                    if (reply_iter == m_mapReply.end())
-                    {
-                        LOG4_ERROR("no m_mapReply found for step %u", uiRealStepSeq);
-                        continue;
-                    }
-                    std::vector<uint32> vecElementIndex;
-                    for (int i = 1; i < pRedisRequest->element_size(); ++i)  // element(0).str() is cmd
-                    {
-                        if (pRedisRequest->element(i).integer() > 0 || i == 1)
-                        {
-                            vecElementIndex.push_back((uint32)pRedisRequest->element(i).integer());
-                        }
-                    }
-                    RedisReply oRedisReply;
-                    oRedisReply.set_type(REDIS_REPLY_ERROR);
-                    oRedisReply.set_str(strErrMsg);
-                    for (uint32 j = 0; j < vecElementIndex.size(); ++j)
-                    {
-                        if (vecElementIndex[j] < reply_iter->second.size())
-                        {
-                            if (reply_iter->second[vecElementIndex[j]] == nullptr)
-                            {
-                                reply_iter->second[vecElementIndex[j]] = new RedisReply();
-                            }
-                            reply_iter->second[vecElementIndex[j]]->CopyFrom(oRedisReply);
-                        }
-                        else
-                        {
-                            LOG4_ERROR("element index %u larger than reply size %u", vecElementIndex[j], reply_iter->second.size());
-                        }
-                    }
-                    num_iter->second--;
-                    if (num_iter->second == 0)
-                    {
-                        RedisReply oFinalReply;
-                        oFinalReply.set_type(REDIS_REPLY_ARRAY);
-                        for (size_t k = 0; k < reply_iter->second.size(); ++k)
-                        {
-                            oFinalReply.mutable_element()->AddAllocated(reply_iter->second[k]);
-                            reply_iter->second[k] = nullptr;
-                        }
-                        GetLabor(this)->GetActorBuilder()->OnMessage(pChannel, oFinalReply, uiRealStepSeq);
-                        m_mapStepEmitNum.erase(num_iter);
-                        m_mapReply.erase(reply_iter);
-                    }
-                }
+                GetLabor(this)->GetActorBuilder()->OnError(pChannel, uiRealStepSeq, iErrno, strErrMsg);
             }
         }
         AskingQueueErrBack(pChannel, iErrno, strErrMsg);
@@ -421,7 +215,7 @@ E_CMD_STATUS StepRedisCluster::ErrBack(
 bool StepRedisCluster::SendTo(const std::string& strIdentify, const RedisMsg& oRedisMsg,
             bool bWithSsl, bool bPipeline, uint32 uiStepSeq)
 {
-    if (m_mapSlot2Node.size() > 0)
+    if (m_vecRedisNode.size() > 0)
     {
         return(Dispatch(oRedisMsg, uiStepSeq));
     }
@@ -454,40 +248,31 @@ bool StepRedisCluster::SendTo(const std::string& strIdentify, std::shared_ptr<Re
     return(bResult);
 }
 
-bool StepRedisCluster::ExtractCmd(const RedisMsg& oRedisMsg,
-        std::string& strCmd, std::vector<std::string>& vecHashKeys,
-        int& iReadOrWrite, int& iKeyInterval)
+bool StepRedisCluster::SendTo(const std::string& strIdentify, const std::vector<std::shared_ptr<RedisMsg>>& vecRedisMsg)
 {
-    auto GetTag = [](const std::string& strKey, std::string& strTag)->void
+    std::vector<const RedisMsg*> vecRedisMsgToSend;
+    vecRedisMsgToSend.reserve(vecRedisMsg.size());
+    for (size_t i = 0; i < vecRedisMsg.size(); ++i)
     {
-        size_t uiTagBegin = strKey.find_first_of("{");
-        if (std::string::npos == uiTagBegin)
-        {
-            strTag = strKey;
-        }
-        else
+        vecRedisMsgToSend.push_back(vecRedisMsg[i].get());
+    }
+    bool bResult = GetLabor(this)->GetDispatcher()->SendTo(strIdentify,
+            SOCKET_STREAM, CODEC_RESP, m_bWithSsl, m_bPipeline, vecRedisMsgToSend, GetSequence());
+    if (bResult)
+    {
+        auto& queRequest = m_mapPipelineRequest[strIdentify];
+        for (size_t i = 0; i < vecRedisMsg.size(); ++i)
         {
-            size_t uiTagEnd = strKey.find_last_of("}");
-            if (std::string::npos == uiTagEnd || uiTagEnd <= uiTagBegin + 1)
-            {
-                strTag = strKey;
-            }
-            else
-            {
-                ++uiTagBegin;
-                size_t uiTagLen = uiTagEnd - uiTagBegin;
-                if (uiTagLen > 0)
-                {
-                    strTag = strKey.substr(uiTagBegin, uiTagLen);
-                }
-                else
-                {
-                    strTag = strKey;
-                }
-            }
+            queRequest.push(vecRedisMsg[i]);
         }
-    };
+    }
+    return(bResult);
+}
 
+bool StepRedisCluster::ExtractCmd(const RedisMsg& oRedisMsg,
+        std::string& strCmd, std::vector<uint16>& vecSlot,
+        int& iReadOrWrite, int& iKeyInterval)
+{
     if (REDIS_REPLY_ARRAY == oRedisMsg.type())
     {
         if (oRedisMsg.element_size() == 0)
@@ -508,7 +293,14 @@ bool StepRedisCluster::ExtractCmd(const RedisMsg& oRedisMsg,
             LOG4_ERROR("cmd %s not supported by StepRedisCluster", strCmd.c_str());
             return(false);
         }
-        std::string strTag;
+        if (s_setReadCmd.find(strCmd) == s_setReadCmd.end())
+        {
+            iReadOrWrite = REDIS_CMD_WRITE;     // 未明确为读的命令都发往主节点
+        }
+        else
+        {
+            iReadOrWrite = REDIS_CMD_READ;
+        }
         if (s_setMultipleKeyCmd.find(strCmd) != s_setMultipleKeyCmd.end())
         {
             if (oRedisMsg.element_size() < 2)
@@ -517,6 +309,7 @@ bool StepRedisCluster::ExtractCmd(const RedisMsg& oRedisMsg,
                         strCmd.c_str(), oRedisMsg.DebugString().c_str());
                 return(false);
             }
+            vecSlot.reserve(oRedisMsg.element_size() - 1);
             for (int i = 1; i < oRedisMsg.element_size(); ++i)
             {
                 if (REDIS_REPLY_STRING != oRedisMsg.element(i).type() || oRedisMsg.element(i).str().size() == 0)
@@ -525,18 +318,9 @@ bool StepRedisCluster::ExtractCmd(const RedisMsg& oRedisMsg,
                             "invalid redis cmd: %s", oRedisMsg.DebugString().c_str());
                     return(false);
                 }
-                GetTag(oRedisMsg.element(i).str(), strTag);
-                vecHashKeys.push_back(strTag);
+                vecSlot.push_back(KeySlot(oRedisMsg.element(i).str()));
             }
             iKeyInterval = 1;
-            if (s_setWriteCmd.find(strCmd) == s_setWriteCmd.end())
-            {
-                iReadOrWrite = REDIS_CMD_READ;
-            }
-            else
-            {
-                iReadOrWrite = REDIS_CMD_WRITE;
-            }
             return(true);
         }
         else if (s_setMultipleKeyValueCmd.find(strCmd) != s_setMultipleKeyValueCmd.end())
@@ -547,29 +331,18 @@ bool StepRedisCluster::ExtractCmd(const RedisMsg& oRedisMsg,
                         strCmd.c_str(), oRedisMsg.DebugString().c_str());
                 return(false);
             }
-            for (int i = 1; i < oRedisMsg.element_size(); ++i)
+            vecSlot.reserve(oRedisMsg.element_size() / 2);
+            for (int i = 1; i < oRedisMsg.element_size(); i += 2)
             {
-                if (i & 0x0001) // (i % 2 == 1)
+                if (REDIS_REPLY_STRING != oRedisMsg.element(i).type() || oRedisMsg.element(i).str().size() == 0)
                 {
-                    if (REDIS_REPLY_STRING != oRedisMsg.element(i).type() || oRedisMsg.element(i).str().size() == 0)
-                    {
-                        LOG4_ERROR("cmd element be a REDIS_REPLY_STRING and key length can not be 0, "
-                                "invalid redis cmd: %s", oRedisMsg.DebugString().c_str());
-                        return(false);
-                    }
-                    GetTag(oRedisMsg.element(i).str(), strTag);
-                    vecHashKeys.push_back(strTag);
+                    LOG4_ERROR("cmd element be a REDIS_REPLY_STRING and key length can not be 0, "
+                            "invalid redis cmd: %s", oRedisMsg.DebugString().c_str());
+                    return(false);
                 }
+                vecSlot.push_back(KeySlot(oRedisMsg.element(i).str()));
             }
             iKeyInterval = 2;
-            if (s_setWriteCmd.find(strCmd) == s_setWriteCmd.end())
-            {
-                iReadOrWrite = REDIS_CMD_READ;
-            }
-            else
-            {
-                iReadOrWrite = REDIS_CMD_WRITE;
-            }
             LOG4_TRACE("oRedisMsg.element_size() = %d", oRedisMsg.element_size());
             return(true);
         }
@@ -577,7 +350,7 @@ bool StepRedisCluster::ExtractCmd(const RedisMsg& oRedisMsg,
         {
             if (oRedisMsg.element_size() < 2)
             {
-                strTag = "";
+                vecSlot.push_back(KeySlot(""));
             }
             else
             {
@@ -586,16 +359,7 @@ bool StepRedisCluster::ExtractCmd(const RedisMsg& oRedisMsg,
                     LOG4_ERROR("cmd element be a REDIS_REPLY_STRING, invalid redis cmd: %s", oRedisMsg.DebugString().c_str());
                     return(false);
                 }
-                GetTag(oRedisMsg.element(1).str(), strTag);
-            }
-            vecHashKeys.emplace_back(std::move(strTag));
-            if (s_setWriteCmd.find(strCmd) == s_setWriteCmd.end())
-            {
-                iReadOrWrite = REDIS_CMD_WRITE;
-            }
-            else
-            {
-                iReadOrWrite = REDIS_CMD_READ;
+                vecSlot.push_back(KeySlot(oRedisMsg.element(1).str()));
             }
             return(true);
         }
@@ -607,29 +371,29 @@ bool StepRedisCluster::ExtractCmd(const RedisMsg& oRedisMsg,
     }
 }
 
-bool StepRedisCluster::GetRedisNode(int iSlotId, int iReadOrWrite, std::string& strNodeIdentify, bool& bIsMaster) const
+bool StepRedisCluster::GetRedisNode(uint16 unSlotId, int iReadOrWrite, std::string& strNodeIdentify, bool& bIsMaster)
 {
-    auto slot_iter = m_mapSlot2Node.find(iSlotId);
-    if (slot_iter == m_mapSlot2Node.end())
+    if (unSlotId >= m_vecSlot2Node.size() || sc_unNoRedisNode == m_vecSlot2Node[unSlotId])
     {
-        LOG4_ERROR("no redis node found for slot %d", iSlotId);
+        LOG4_ERROR("no redis node found for slot %u", unSlotId);
         return(false);
     }
+    RedisNode& stNode = m_vecRedisNode[m_vecSlot2Node[unSlotId]];
     if ((REDIS_CMD_WRITE == iReadOrWrite)
-            || (slot_iter->second->setFllower.size() == 0)
+            || (stNode.setFllower.size() == 0)
             || (!m_bEnableReadOnly))
     {
-        strNodeIdentify = slot_iter->second->strMaster;
+        strNodeIdentify = stNode.strMaster;
         bIsMaster = true;
     }
     else
     {
-        slot_iter->second->iterFllower++;
-        if (slot_iter->second->iterFllower == slot_iter->second->setFllower.end())
+        stNode.iterFllower++;
+        if (stNode.iterFllower == stNode.setFllower.end())
         {
-            slot_iter->second->iterFllower = slot_iter->second->setFllower.begin();
+            stNode.iterFllower = stNode.setFllower.begin();
         }
-        strNodeIdentify = *(slot_iter->second->iterFllower);
+        strNodeIdentify = *(stNode.iterFllower);
         bIsMaster = false;
     }
     return(true);
@@ -669,6 +433,8 @@ bool StepRedisCluster::CmdClusterSlotsCallback(const RedisReply& oRedisReply)
 {
     if (REDIS_REPLY_ARRAY == oRedisReply.type())
     {
+        std::vector<RedisNode> vecRedisNode;
+        std::vector<uint16> vecSlot2Node(sc_unClusterSlots, sc_unNoRedisNode);
         int iFromSlot = 0;
         int iToSlot = 0;
         for (int i = 0; i < oRedisReply.element_size(); ++i)
@@ -690,7 +456,13 @@ bool StepRedisCluster::CmdClusterSlotsCallback(const RedisReply& oRedisReply)
                 }
                 iFromSlot = oRedisReply.element(i).element(0).integer();
                 iToSlot = oRedisReply.element(i).element(1).integer();
-                auto pRedisNode = std::make_shared<RedisNode>();
+                if (iFromSlot < 0 || iToSlot >= (int)sc_unClusterSlots || iFromSlot > iToSlot
+                        || vecRedisNode.size() >= sc_unNoRedisNode)
+                {
+                    LOG4_ERROR("invalid slot range [%d, %d] in element(%d)", iFromSlot, iToSlot, i);
+                    continue;
+                }
+                RedisNode stRedisNode;
                 for (int j = 2; j < oRedisReply.element(i).element_size(); ++j)
                 {
                     if (REDIS_REPLY_STRING != oRedisReply.element(i).element(j).element(0).type()
@@ -707,35 +479,40 @@ bool StepRedisCluster::CmdClusterSlotsCallback(const RedisReply& oRedisReply)
                             << oRedisReply.element(i).element(j).element(1).integer();
                     if (j == 2)
                     {
-                        pRedisNode->strMaster = oss.str();
+                        stRedisNode.strMaster = oss.str();
                     }
                     else
                     {
-                        pRedisNode->setFllower.insert(oss.str());
+                        stRedisNode.setFllower.insert(oss.str());
                     }
                 }
-                pRedisNode->iterFllower = pRedisNode->setFllower.begin();
+                vecRedisNode.push_back(std::move(stRedisNode));
+                uint16 unNodeIndex = vecRedisNode.size() - 1;
                 for (int iSlotId = iFromSlot; iSlotId <= iToSlot; ++iSlotId)
                 {
-                    auto it = m_mapSlot2Node.find(iSlotId);
-                    if (it == m_mapSlot2Node.end())
-                    {
-                        m_mapSlot2Node.insert(std::make_pair(iSlotId, pRedisNode));
-                    }
-                    else
-                    {
-                        it->second = pRedisNode;
-                    }
+                    vecSlot2Node[iSlotId] = unNodeIndex;
                 }
             }
             else
             {
-                LOG4_ERROR("redis reply type %d is invalid for CLUSTER SLOTS in element(%d)", i);
+                LOG4_ERROR("redis reply type %d is invalid for CLUSTER SLOTS in element(%d)",
+                        oRedisReply.element(i).type(), i);
             }
         }
+        if (vecRedisNode.empty())
+        {
+            LOG4_ERROR("no slot found in CLUSTER SLOTS reply");
+            return(false);
+        }
+        for (size_t k = 0; k < vecRedisNode.size(); ++k)
+        {
+            vecRedisNode[k].iterFllower = vecRedisNode[k].setFllower.begin();
+        }
+        m_vecRedisNode.swap(vecRedisNode);
+        m_vecSlot2Node.swap(vecSlot2Node);
         return(true);
     }
-    LOG4_ERROR("redis reply type %d is invalid for CLUSTER SLOTS");
+    LOG4_ERROR("redis reply type %d is invalid for CLUSTER SLOTS", oRedisReply.type());
     return(false);
 }
 
@@ -832,6 +609,9 @@ void StepRedisCluster::AskingQueueErrBack(
     }
     else
     {
+        RedisReply oErrReply;
+        oErrReply.set_type(REDIS_REPLY_ERROR);
+        oErrReply.set_str(strErrMsg);
         while (step_iter->second.size() > 0)
         {
             auto pRedisRequest = step_iter->second.front();
@@ -841,62 +621,13 @@ void StepRedisCluster::AskingQueueErrBack(
             {
                 SendCmdClusterSlots();
             }
+            else if (IsMultiKeyRequest(*pRedisRequest))
+            {
+                OnMultiKeyReply(pChannel, *pRedisRequest, oErrReply);
+            }
             else
             {
-                auto num_iter = m_mapStepEmitNum.find(uiRealStepSeq);
-                if (num_iter == m_mapStepEmitNum.end()) // 单key请求的响应
-                {
-                    GetLabor(this)->GetActorBuilder()->OnError(pChannel, uiRealStepSeq, iErrno, strErrMsg);
-                }
-                else
-                {
-                    auto reply_iter = m_mapReply.find(uiRealStepSeq);
-                    if (reply_iter == m_mapReply.end())
-                    {
-                        LOG4_ERROR("no m_mapReply found for step %u", uiRealStepSeq);
-                        continue;
-                    }
-                    std::vector<uint32> vecElementIndex;
-                    for (int i = 1; i < pRedisRequest->element_size(); ++i)  // element(0).str() is cmd
-                    {
-                        if (pRedisRequest->element(i).integer() > 0 || i == 1)
-                        {
-                            vecElementIndex.push_back((uint32)pRedisRequest->element(i).integer());
-                        }
-                    }
-                    RedisReply oRedisReply;
-                    oRedisReply.set_type(REDIS_REPLY_ERROR);
-                    oRedisReply.set_str(strErrMsg);
-                    for (uint32 j = 0; j < vecElementIndex.size(); ++j)
-                    {
-                        if (vecElementIndex[j] < reply_iter->second.size())
-                        {
-                            if (reply_iter->second[vecElementIndex[j]] == nullptr)
-                            {
-                                reply_iter->second[vecElementIndex[j]] = new RedisReply();
-                            }
-                            reply_iter->second[vecElementIndex[j]]->CopyFrom(oRedisReply);
-                        }
-                        else
-                        {
-                            LOG4_ERROR("element index %u larger than reply size %u", vecElementIndex[j], reply_iter->second.size());
-                        }
-                    }
-                    num_iter->second--;
-                    if (num_iter->second == 0)
-                    {
-                        RedisReply oFinalReply;
-                        oFinalReply.set_type(REDIS_REPLY_ARRAY);
-                        for (size_t k = 0; k < reply_iter->second.size(); ++k)
-                        {
-                            oFinalReply.mutable_element()->AddAllocated(reply_iter->second[k]);
-                            reply_iter->second[k] = nullptr;
-                        }
-                        GetLabor(this)->GetActorBuilder()->OnMessage(pChannel, oFinalReply, uiRealStepSeq);
-                        m_mapStepEmitNum.erase(num_iter);
-                        m_mapReply.erase(reply_iter);
-                    }
-                }
+                GetLabor(this)->GetActorBuilder()->OnError(pChannel, uiRealStepSeq, iErrno, strErrMsg);
             }
         }
     }
@@ -905,123 +636,294 @@ void StepRedisCluster::AskingQueueErrBack(
 bool StepRedisCluster::Dispatch(const RedisMsg& oRedisMsg, uint32 uiStepSeq)
 {
     std::string strCmd;
-    std::vector<std::string> vecHashKey;
+    std::vector<uint16> vecSlot;
     int iKeyInterval = 0;
     int iReadOrWrite = 0;
-    if (!ExtractCmd(oRedisMsg, strCmd, vecHashKey, iReadOrWrite, iKeyInterval))
+    if (!ExtractCmd(oRedisMsg, strCmd, vecSlot, iReadOrWrite, iKeyInterval))
     {
         return(false);
     }
-    bool bIsMasterNode = false;
-    std::string strRedisNode;
-    if (vecHashKey.size() == 1)
+    if (vecSlot.size() == 1)
     {
-        uint16 unHash = crc16(vecHashKey[0].c_str(), vecHashKey[0].size());
-        int iSlotId =  (int)(unHash % sc_unClusterSlots);
-        if (!GetRedisNode(iSlotId, iReadOrWrite, strRedisNode, bIsMasterNode))
+        bool bIsMasterNode = false;
+        std::string strRedisNode;
+        if (!GetRedisNode(vecSlot[0], iReadOrWrite, strRedisNode, bIsMasterNode))
         {
             return(false);
         }
         auto pRedisRequest = std::make_shared<RedisMsg>(oRedisMsg);
         pRedisRequest->set_integer(uiStepSeq);    // 借用integer暂存seq
+        if (pRedisRequest->element_size() > 1)
+        {
+            pRedisRequest->mutable_element(1)->set_integer(0);  // 单key请求，见IsMultiKeyRequest()
+        }
         if (!bIsMasterNode && NeedSetReadOnly(strRedisNode))
         {
             SendCmdReadOnly(strRedisNode);
         }
         return(SendTo(strRedisNode, pRedisRequest));
     }
-    else if (vecHashKey.size() > 1)
+    else if (vecSlot.size() > 1)
     {
-        if ((int)vecHashKey.size() * iKeyInterval >= oRedisMsg.element_size())
+        if ((int)vecSlot.size() * iKeyInterval >= oRedisMsg.element_size())
         {
             LOG4_ERROR("element size error.");
             return(false);
         }
-        std::unordered_map<int, std::shared_ptr<RedisMsg>> mapRedisRequest;
-        for (uint32 i = 0; i < vecHashKey.size(); ++i)
+        return(DispatchMultiKey(oRedisMsg, strCmd, uiStepSeq, vecSlot, iReadOrWrite, iKeyInterval));
+    }
+    else
+    {
+        LOG4_ERROR("no hash key for %s", strCmd.c_str());
+        return(false);
+    }
+}
+
+bool StepRedisCluster::DispatchMultiKey(const RedisMsg& oRedisMsg, const std::string& strCmd, uint32 uiStepSeq,
+        const std::vector<uint16>& vecSlot, int iReadOrWrite, int iKeyInterval)
+{
+    // 排序键：节点下标(16位) | 槽位(16位) | key序号(32位)。排序后同一节点的key相邻，
+    // 节点内同一槽位的key相邻且保持原始顺序；同一槽位的key合并为一个子请求（redis cluster
+    // 要求一个命令的所有key在同一槽位），同一节点的子请求一次写出。
+    std::vector<uint64> vecDispatchKey;
+    vecDispatchKey.reserve(vecSlot.size());
+    for (uint32 i = 0; i < vecSlot.size(); ++i)
+    {
+        uint16 unNodeIndex = m_vecSlot2Node[vecSlot[i]];
+        if (sc_unNoRedisNode == unNodeIndex)
+        {
+            LOG4_ERROR("no redis node found for slot %u", vecSlot[i]);
+            return(false);
+        }
+        vecDispatchKey.push_back(((uint64)unNodeIndex << 48) | ((uint64)vecSlot[i] << 32) | i);
+    }
+    std::sort(vecDispatchKey.begin(), vecDispatchKey.end());
+    uint32 uiSubRequestNum = 1;
+    for (size_t i = 1; i < vecDispatchKey.size(); ++i)
+    {
+        if ((vecDispatchKey[i] >> 32) != (vecDispatchKey[i - 1] >> 32))
+        {
+            ++uiSubRequestNum;
+        }
+    }
+
+    tagMultiKeyReply& stMultiKeyReply = m_mapMultiKeyReply[uiStepSeq];
+    stMultiKeyReply.uiPendingNum = uiSubRequestNum;
+    stMultiKeyReply.oReply.Clear();
+    if ("MGET" == strCmd)
+    {
+        stMultiKeyReply.iMergeType = REDIS_MERGE_ARRAY;
+        stMultiKeyReply.oReply.set_type(REDIS_REPLY_ARRAY);
+        stMultiKeyReply.oReply.mutable_element()->Reserve(vecSlot.size());
+        for (size_t i = 0; i < vecSlot.size(); ++i)
+        {
+            stMultiKeyReply.oReply.add_element()->set_type(REDIS_REPLY_NIL);
+        }
+    }
+    else if ("MSET" == strCmd)
+    {
+        stMultiKeyReply.iMergeType = REDIS_MERGE_STATUS;
+        stMultiKeyReply.oReply.set_type(REDIS_REPLY_STATUS);
+        stMultiKeyReply.oReply.set_str("OK");
+    }
+    else if ("MSETNX" == strCmd)
+    {
+        stMultiKeyReply.iMergeType = REDIS_MERGE_ALL;
+        stMultiKeyReply.oReply.set_type(REDIS_REPLY_INTEGER);
+        stMultiKeyReply.oReply.set_integer(1);
+    }
+    else
+    {
+        stMultiKeyReply.iMergeType = REDIS_MERGE_SUM;
+        stMultiKeyReply.oReply.set_type(REDIS_REPLY_INTEGER);
+        stMultiKeyReply.oReply.set_integer(0);
+    }
+    ExpireMultiKeyReply();
+    m_dequeMultiKeyTimeout.push_back(std::make_pair(GetNowTime(), uiStepSeq));
+
+    bool bIsMasterNode = false;
+    std::string strRedisNode;
+    std::vector<std::shared_ptr<RedisMsg>> vecSubRequest;
+    std::shared_ptr<RedisMsg> pSubRequest;
+    size_t uiNodeBegin = 0;
+    while (uiNodeBegin < vecDispatchKey.size())
+    {
+        uint64 ullNodeIndex = vecDispatchKey[uiNodeBegin] >> 48;
+        size_t uiNodeEnd = uiNodeBegin;
+        vecSubRequest.clear();
+        for (; uiNodeEnd < vecDispatchKey.size() && (vecDispatchKey[uiNodeEnd] >> 48) == ullNodeIndex; ++uiNodeEnd)
         {
-            uint16 unHash = crc16(vecHashKey[i].c_str(), vecHashKey[i].size());
-            int iSlotId =  (int)(unHash % sc_unClusterSlots);
-            auto req_iter = mapRedisRequest.find(iSlotId);
-            if (req_iter == mapRedisRequest.end())
+            uint32 uiKeyIndex = (uint32)vecDispatchKey[uiNodeEnd];
+            if (uiNodeEnd == uiNodeBegin || (vecDispatchKey[uiNodeEnd] >> 32) != (vecDispatchKey[uiNodeEnd - 1] >> 32))
             {
-                auto pSubRequest = std::make_shared<RedisMsg>();
+                pSubRequest = std::make_shared<RedisMsg>();
                 pSubRequest->set_type(oRedisMsg.type());
-                auto pElement = pSubRequest->add_element();
-                pElement->CopyFrom(oRedisMsg.element(0));   // cmd
-                pElement = pSubRequest->add_element();
-                pElement->CopyFrom(oRedisMsg.element(i * iKeyInterval + 1)); // key
-                pElement->set_integer(i);    // 借用integer暂存key的序号
-                for (int j = 2; j <= iKeyInterval; ++j)
-                {
-                    pElement = pSubRequest->add_element();
-                    pElement->CopyFrom(oRedisMsg.element(i * iKeyInterval + j));  // value
-                }
                 pSubRequest->set_integer(uiStepSeq);    // 借用integer暂存seq
-                mapRedisRequest.insert(std::make_pair(iSlotId, pSubRequest));
+                pSubRequest->add_element()->CopyFrom(oRedisMsg.element(0));   // cmd
+                vecSubRequest.push_back(pSubRequest);
             }
-            else
+            auto pElement = pSubRequest->add_element();
+            pElement->CopyFrom(oRedisMsg.element(uiKeyIndex * iKeyInterval + 1)); // key
+            pElement->set_integer(uiKeyIndex + 1);    // 借用integer暂存key的序号加1
+            for (int j = 2; j <= iKeyInterval; ++j)
             {
-                auto pElement = req_iter->second->add_element();
-                pElement->CopyFrom(oRedisMsg.element(i * iKeyInterval + 1));  // key
-                pElement->set_integer(i);    // 借用integer暂存key的序号
-                for (int j = 2; j <= iKeyInterval; ++j)
-                {
-                    pElement = req_iter->second->add_element();
-                    pElement->CopyFrom(oRedisMsg.element(i * iKeyInterval + j));   // value
-                }
+                pElement = pSubRequest->add_element();
+                pElement->CopyFrom(oRedisMsg.element(uiKeyIndex * iKeyInterval + j));  // value
+                pElement->set_integer(0);
             }
         }
-        for (auto req_iter = mapRedisRequest.begin(); req_iter != mapRedisRequest.end(); ++req_iter)
+        if (!GetRedisNode((uint16)(vecDispatchKey[uiNodeBegin] >> 32), iReadOrWrite, strRedisNode, bIsMasterNode))
         {
-            if (!GetRedisNode(req_iter->first, iReadOrWrite, strRedisNode, bIsMasterNode))
+            m_mapMultiKeyReply.erase(uiStepSeq);
+            m_dequeMultiKeyTimeout.pop_back();
+            return(false);
+        }
+        if (!bIsMasterNode && NeedSetReadOnly(strRedisNode))
+        {
+            SendCmdReadOnly(strRedisNode);
+        }
+        if (!SendTo(strRedisNode, vecSubRequest))
+        {
+            // 已发出的子请求的响应找不到合并状态时丢弃
+            m_mapMultiKeyReply.erase(uiStepSeq);
+            m_dequeMultiKeyTimeout.pop_back();
+            return(false);
+        }
+        uiNodeBegin = uiNodeEnd;
+    }
+    return(true);
+}
+
+bool StepRedisCluster::Redirect(std::shared_ptr<RedisRequest> pRedisRequest, const RedisReply& oRedisReply)
+{
+    std::vector<std::string> vecMsg;
+    Split(oRedisReply.str(), " ", vecMsg);
+    if (vecMsg.size() >= 3)
+    {
+        if (vecMsg[0] == "MOVED")
+        {
+            SendTo(vecMsg[2], pRedisRequest);
+            SendCmdClusterSlots();
+            return(true);
+        }
+        if (vecMsg[0] == "ASK")
+        {
+            AddToAskingQueue(vecMsg[2], pRedisRequest);
+            SendCmdAsking(vecMsg[2]);
+            return(true);
+        }
+    }
+    if (vecMsg.size() > 0 && vecMsg[0] == "CROSSSLOT")
+    {
+        SendCmdClusterSlots();
+    }
+    return(false);
+}
+
+void StepRedisCluster::OnMultiKeyReply(std::shared_ptr<SocketChannel> pChannel,
+        const RedisRequest& oSubRequest, const RedisReply& oSubReply)
+{
+    uint32 uiStepSeq = (uint32)oSubRequest.integer();
+    auto reply_iter = m_mapMultiKeyReply.find(uiStepSeq);
+    if (reply_iter == m_mapMultiKeyReply.end())
+    {
+        LOG4_ERROR("no multi key reply found for step %u", uiStepSeq);
+        return;
+    }
+    tagMultiKeyReply& stMultiKeyReply = reply_iter->second;
+    RedisReply& oReply = stMultiKeyReply.oReply;
+    if (REDIS_MERGE_ARRAY == stMultiKeyReply.iMergeType)
+    {
+        int iSubReplyIndex = 0;
+        for (int i = 1; i < oSubRequest.element_size(); ++i)  // element(0).str() is cmd
+        {
+            if (oSubRequest.element(i).integer() <= 0)
             {
-                return(false);
+                continue;
             }
-            if (!bIsMasterNode && NeedSetReadOnly(strRedisNode))
+            int iKeyIndex = (int)oSubRequest.element(i).integer() - 1;
+            if (iKeyIndex >= oReply.element_size())
             {
-                SendCmdReadOnly(strRedisNode);
+                LOG4_ERROR("element index %d larger than reply size %d", iKeyIndex, oReply.element_size());
+                continue;
+            }
+            if (REDIS_REPLY_ARRAY == oSubReply.type())
+            {
+                if (iSubReplyIndex < oSubReply.element_size())
+                {
+                    oReply.mutable_element(iKeyIndex)->CopyFrom(oSubReply.element(iSubReplyIndex));
+                }
+                ++iSubReplyIndex;
+            }
+            else    // 错误响应放到该子请求的每个key的位置
+            {
+                oReply.mutable_element(iKeyIndex)->CopyFrom(oSubReply);
             }
-            SendTo(strRedisNode, req_iter->second);
         }
-        m_mapStepEmitNum[uiStepSeq] = mapRedisRequest.size();
-        std::vector<RedisReply*> vecReply;
-        auto iter_bool = m_mapReply.insert(std::make_pair(uiStepSeq, vecReply));
-        if (iter_bool.second == true)
+        if (REDIS_REPLY_ARRAY == oSubReply.type() && iSubReplyIndex != oSubReply.element_size())
         {
-            iter_bool.first->second.resize(vecHashKey.size(), nullptr);
+            LOG4_ERROR("request and reply not match for %s", oSubRequest.element(0).str().c_str());
         }
-        return(iter_bool.second);
     }
-    else
+    else if (REDIS_REPLY_ERROR != oReply.type())    // 出现错误之后的子响应不再合并
     {
-        LOG4_ERROR("no hash key for %s", strCmd.c_str());
-        return(false);
+        if (REDIS_REPLY_ERROR == oSubReply.type())
+        {
+            oReply.CopyFrom(oSubReply);
+        }
+        else if (REDIS_MERGE_STATUS == stMultiKeyReply.iMergeType)
+        {
+            if (REDIS_REPLY_STATUS != oSubReply.type())
+            {
+                oReply.set_type(REDIS_REPLY_ERROR);
+                oReply.set_str("unexpected reply type for " + oSubRequest.element(0).str());
+            }
+        }
+        else if (REDIS_REPLY_INTEGER != oSubReply.type())
+        {
+            oReply.set_type(REDIS_REPLY_ERROR);
+            oReply.set_str("unexpected reply type for " + oSubRequest.element(0).str());
+        }
+        else if (REDIS_MERGE_SUM == stMultiKeyReply.iMergeType)
+        {
+            oReply.set_integer(oReply.integer() + oSubReply.integer());
+        }
+        else if (0 == oSubReply.integer())  // REDIS_MERGE_ALL
+        {
+            oReply.set_integer(0);
+        }
+    }
+    if (--stMultiKeyReply.uiPendingNum == 0)
+    {
+        GetLabor(this)->GetActorBuilder()->OnMessage(pChannel, oReply, uiStepSeq);
+        m_mapMultiKeyReply.erase(uiStepSeq);
+        ExpireMultiKeyReply();
     }
 }
 
-void StepRedisCluster::SendWaittingRequest()
+void StepRedisCluster::ExpireMultiKeyReply()
 {
-    for (size_t i = 0; i < m_vecWaittingRequest.size(); ++i)
+    ev_tstamp dNow = GetNowTime();
+    while (!m_dequeMultiKeyTimeout.empty())
     {
-        Dispatch(m_vecWaittingRequest[i].second, m_vecWaittingRequest[i].first);
+        uint32 uiStepSeq = m_dequeMultiKeyTimeout.front().second;
+        if (dNow - m_dequeMultiKeyTimeout.front().first < GetTimeout()
+                && m_mapMultiKeyReply.find(uiStepSeq) != m_mapMultiKeyReply.end())
+        {
+            break;
+        }
+        m_mapMultiKeyReply.erase(uiStepSeq);    // 已完成的请求无需再删除，超时的请求丢弃合并状态
+        m_dequeMultiKeyTimeout.pop_front();
     }
-    m_vecWaittingRequest.clear();
 }
 
-void StepRedisCluster::RegisterStep(uint32 uiStepSeq)
+void StepRedisCluster::SendWaittingRequest()
 {
-    auto iter = m_mapTimeoutStep.find(uiStepSeq);
-    if (iter == m_mapTimeoutStep.end())
-    {
-        std::vector<uint32> vecStep;
-        vecStep.push_back(uiStepSeq);
-        m_mapTimeoutStep.insert(std::make_pair(GetNowTime(), std::move(vecStep)));
-    }
-    else
+    for (size_t i = 0; i < m_vecWaittingRequest.size(); ++i)
     {
-        iter->second.push_back(uiStepSeq);
+        Dispatch(m_vecWaittingRequest[i].second, m_vecWaittingRequest[i].first);
     }
+    m_vecWaittingRequest.clear();
 }
 
 void StepRedisCluster::AddToAskingQueue(const std::string& strIdentify, std::shared_ptr<RedisMsg> pRedisMsg)
@@ -1039,6 +941,21 @@ void StepRedisCluster::AddToAskingQueue(const std::string& strIdentify, std::sha
     }
 }
 
+uint16 StepRedisCluster::KeySlot(const std::string& strKey)
+{
+    // hash tag：第一个'{'与其后第一个'}'之间非空时只对其间的内容计算槽位
+    size_t uiTagBegin = strKey.find('{');
+    if (std::string::npos != uiTagBegin)
+    {
+        size_t uiTagEnd = strKey.find('}', uiTagBegin + 1);
+        if (std::string::npos != uiTagEnd && uiTagEnd > uiTagBegin + 1)
+        {
+            return(crc16(strKey.data() + uiTagBegin + 1, uiTagEnd - uiTagBegin - 1) & (sc_unClusterSlots - 1));
+        }
+    }
+    return(crc16(strKey.data(), strKey.size()) & (sc_unClusterSlots - 1));
+}
+
 } /* namespace neb */
 
 
@@ -12,6 +12,7 @@
 
 #include <string>
 #include <vector>
+#include <deque>
 #include <unordered_map>
 #include <unordered_set>
 #include <memory>
@@ -32,6 +33,17 @@ enum E_REDIS_CMD_TYPE
     REDIS_CMD_WRITE = 1,
 };
 
+/**
+ * @brief 多key命令按槽位拆分后子响应的合并方式
+ */
+enum E_REDIS_MERGE_TYPE
+{
+    REDIS_MERGE_ARRAY   = 0,    ///< MGET：子响应的数组元素按原始key顺序放回
+    REDIS_MERGE_SUM     = 1,    ///< DEL、EXISTS、TOUCH、UNLINK：整数响应求和
+    REDIS_MERGE_ALL     = 2,    ///< MSETNX：全部为1时为1，否则为0
+    REDIS_MERGE_STATUS  = 3,    ///< MSET：全部成功时为OK
+};
+
 struct RedisNode
 {
     std::string strMaster;
@@ -81,9 +93,13 @@ public:
 
 protected:
     bool SendTo(const std::string& strIdentify, std::shared_ptr<RedisMsg> pRedisMsg);
+    /**
+     * @brief 发往同一节点的多个子请求一次写出（pipeline）
+     */
+    bool SendTo(const std::string& strIdentify, const std::vector<std::shared_ptr<RedisMsg>>& vecRedisMsg);
     bool ExtractCmd(const RedisMsg& oRedisMsg, std::string& strCmd,
-            std::vector<std::string>& vecHashKeys, int& iReadOrWrite, int& iKeyInterval);
-    bool GetRedisNode(int iSlotId, int iReadOrWrite, std::string& strNodeIdentify, bool& bIsMaster) const;
+            std::vector<uint16>& vecSlot, int& iReadOrWrite, int& iKeyInterval);
+    bool GetRedisNode(uint16 unSlotId, int iReadOrWrite, std::string& strNodeIdentify, bool& bIsMaster);
     bool NeedSetReadOnly(const std::string& strNode) const;
     bool SendCmdClusterSlots();
     bool CmdClusterSlotsCallback(const RedisReply& oRedisReply);
@@ -94,11 +110,39 @@ protected:
     void AskingQueueErrBack(std::shared_ptr<SocketChannel> pChannel,
             int iErrno, const std::string& strErrMsg);
     bool Dispatch(const RedisMsg& oRedisMsg, uint32 uiStepSeq);
+    bool DispatchMultiKey(const RedisMsg& oRedisMsg, const std::string& strCmd, uint32 uiStepSeq,
+            const std::vector<uint16>& vecSlot, int iReadOrWrite, int iKeyInterval);
+    /**
+     * @brief 处理MOVED、ASK、CROSSSLOT错误
+     * @return 请求已被重定向，不需要再回调
+     */
+    bool Redirect(std::shared_ptr<RedisRequest> pRedisRequest, const RedisReply& oRedisReply);
+    /**
+     * @brief 合并多key命令的一个子响应，全部子响应到齐后回调发起请求的步骤
+     */
+    void OnMultiKeyReply(std::shared_ptr<SocketChannel> pChannel,
+            const RedisRequest& oSubRequest, const RedisReply& oSubReply);
+    /**
+     * @brief 从最早发出的多key命令开始，清理已完成及超时未完成的合并状态
+     */
+    void ExpireMultiKeyReply();
     void SendWaittingRequest();
-    void RegisterStep(uint32 uiStepSeq);
     void AddToAskingQueue(const std::string& strIdentify, std::shared_ptr<RedisMsg> pRedisMsg);
 
+    static uint16 KeySlot(const std::string& strKey);
+    static bool IsMultiKeyRequest(const RedisRequest& oRedisRequest)
+    {
+        return(oRedisRequest.element_size() > 1 && oRedisRequest.element(1).integer() > 0);
+    }
+
 private:
+    struct tagMultiKeyReply
+    {
+        int iMergeType = REDIS_MERGE_ARRAY;     ///< E_REDIS_MERGE_TYPE
+        uint32 uiPendingNum = 0;                ///< 尚未响应的子请求数量
+        RedisReply oReply;                      ///< 合并后的响应，MGET按key数量预先分配元素
+    };
+
     bool m_bWithSsl;                        ///< 是否支持SSL
     bool m_bPipeline;                       ///< 是否支持pipeline
     bool m_bEnableReadOnly;                 ///< 是否对从节点启用只读
@@ -106,15 +150,16 @@ private:
 
     std::string m_strIdentify;      ///< 地址标识，由m_vecAddress合并而成，形如 192.168.47.101:6379,198.168.47.102:6379,192.168.47.103:6379
     std::vector<std::string> m_vecAddress;  ///< 集群地址
-    std::unordered_map<int, std::shared_ptr<RedisNode>> m_mapSlot2Node;    // redis cluster slot对应的节点
+    std::vector<RedisNode> m_vecRedisNode;  ///< redis cluster节点
+    std::vector<uint16> m_vecSlot2Node;     ///< 槽位到m_vecRedisNode下标，sc_unClusterSlots个元素
     std::unordered_map<std::string, std::queue<std::shared_ptr<RedisRequest>>> m_mapPipelineRequest;  ///< 等待回调的请求
     std::unordered_map<std::string, std::queue<std::shared_ptr<RedisRequest>>> m_mapAskingRequest;  ///< 等待Asking的请求
-    std::unordered_map<uint32, uint32> m_mapStepEmitNum;    // 每个step发出请求（等待响应）数量
-    std::unordered_map<uint32, std::vector<RedisReply*>> m_mapReply;
-    std::map<time_t, std::vector<uint32>> m_mapTimeoutStep;
+    std::unordered_map<uint32, tagMultiKeyReply> m_mapMultiKeyReply;        ///< 多key命令（step seq）的响应合并状态
+    std::deque<std::pair<ev_tstamp, uint32>> m_dequeMultiKeyTimeout;        ///< 多key命令发出时间，按时间先后排列
     std::vector<std::pair<uint32, RedisRequest>> m_vecWaittingRequest;
 
     static const uint16 sc_unClusterSlots;  ///< redis cluster槽位数
+    static const uint16 sc_unNoRedisNode;   ///< 槽位未分配节点
     static const std::unordered_set<std::string> s_setSupportExtractCmd;
     static const std::unordered_set<std::string> s_setReadCmd;
     static const std::unordered_set<std::string> s_setWriteCmd;
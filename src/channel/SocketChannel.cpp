@@ -8,6 +8,8 @@
  * Modify history:
  ******************************************************************************/
 #include <memory>
+#include <cstring>
+#include <unistd.h>
 #include <sys/types.h>
 #include <sys/socket.h>
 #include <netinet/in.h>
@@ -153,6 +155,130 @@ int SocketChannel::SendChannelFd(int iSocketFd, int iSendFd, int iAiFamily, int
     return(ERR_OK);
 }
 
+int SocketChannel::SendChannelFds(int iSocketFd, const int* pSendFds, int iFdNum, int iAiFamily, int iCodecType, std::shared_ptr<NetLogger> pLogger)
+{
+    if (iFdNum <= 0 || iFdNum > MAX_TRANSFER_FD_NUM)
+    {
+        return(ERR_TRANSFER_FD);
+    }
+    ssize_t             n;
+    struct iovec        iov[1];
+    struct msghdr       msg;
+    tagChannelCtx aCh[MAX_TRANSFER_FD_NUM];
+    int iError = 0;
+
+    union
+    {
+        struct cmsghdr  cm;
+        char            space[CMSG_SPACE(sizeof(int) * MAX_TRANSFER_FD_NUM)];
+    } cmsg;
+
+    for (int i = 0; i < iFdNum; ++i)
+    {
+        aCh[i].iFd = pSendFds[i];
+        aCh[i].iAiFamily = iAiFamily;
+        aCh[i].iCodecType = iCodecType;
+    }
+
+    memset(&cmsg, 0, sizeof(cmsg));
+    msg.msg_control = (caddr_t) &cmsg;
+    msg.msg_controllen = CMSG_SPACE(sizeof(int) * iFdNum);
+    cmsg.cm.cmsg_len = CMSG_LEN(sizeof(int) * iFdNum);
+    cmsg.cm.cmsg_level = SOL_SOCKET;
+    cmsg.cm.cmsg_type = SCM_RIGHTS;
+    memcpy(CMSG_DATA(&cmsg.cm), pSendFds, sizeof(int) * iFdNum);
+
+    msg.msg_flags = 0;
+
+    iov[0].iov_base = (char*)aCh;
+    iov[0].iov_len = sizeof(tagChannelCtx) * iFdNum;
+
+    msg.msg_name = NULL;
+    msg.msg_namelen = 0;
+    msg.msg_iov = iov;
+    msg.msg_iovlen = 1;
+
+    n = sendmsg(iSocketFd, &msg, 0);
+
+    if (n == -1)
+    {
+        pLogger->WriteLog(neb::Logger::ERROR, __FILE__, __LINE__, __FUNCTION__, "sendmsg() failed, errno %d", errno);
+        iError = (errno == 0) ? ERR_TRANSFER_FD : errno;
+        return(iError);
+    }
+    if ((size_t)n < iov[0].iov_len)
+    {
+        pLogger->WriteLog(neb::Logger::ERROR, __FILE__, __LINE__, __FUNCTION__, "sendmsg() sent %d of %d bytes", (int)n, (int)iov[0].iov_len);
+        return(ERR_TRANSFER_FD);
+    }
+
+    return(ERR_OK);
+}
+
+int SocketChannel::RecvChannelFds(int iSocketFd, tagChannelCtx* pChannelCtx, int& iFdNum, std::shared_ptr<NetLogger> pLogger)
+{
+    ssize_t             n;
+    struct iovec        iov[1];
+    struct msghdr       msg;
+    int iError = 0;
+    iFdNum = 0;
+
+    union {
+        struct cmsghdr  cm;
+        char            space[CMSG_SPACE(sizeof(int) * MAX_TRANSFER_FD_NUM)];
+    } cmsg;
+
+    iov[0].iov_base = (char*)pChannelCtx;
+    iov[0].iov_len = sizeof(tagChannelCtx) * MAX_TRANSFER_FD_NUM;
+
+    msg.msg_name = NULL;
+    msg.msg_namelen = 0;
+    msg.msg_iov = iov;
+    msg.msg_iovlen = 1;
+
+    msg.msg_control = (caddr_t) &cmsg;
+    msg.msg_controllen = sizeof(cmsg);
+
+    n = recvmsg(iSocketFd, &msg, 0);
+
+    if (n == -1) {
+        pLogger->WriteLog(neb::Logger::ERROR, __FILE__, __LINE__, __FUNCTION__, "recvmsg() failed, errno %d", errno);
+        iError = (errno == 0) ? ERR_TRANSFER_FD : errno;
+        return(iError);
+    }
+
+    if (n == 0) {
+        pLogger->WriteLog(neb::Logger::WARNING, __FILE__, __LINE__, __FUNCTION__, "recvmsg() return zero, errno %d", errno);
+        return(ERR_CHANNEL_EOF);
+    }
+
+    struct cmsghdr* pCmsg = CMSG_FIRSTHDR(&msg);
+    int iRecvFdNum = 0;
+    if (pCmsg != NULL && pCmsg->cmsg_level == SOL_SOCKET && pCmsg->cmsg_type == SCM_RIGHTS)
+    {
+        iRecvFdNum = (pCmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+    }
+    int* pRecvFds = (pCmsg != NULL) ? (int*)CMSG_DATA(pCmsg) : NULL;
+    if (iRecvFdNum == 0 || (size_t)n != sizeof(tagChannelCtx) * iRecvFdNum
+            || (msg.msg_flags & (MSG_TRUNC|MSG_CTRUNC)))
+    {
+        pLogger->WriteLog(neb::Logger::ERROR, __FILE__, __LINE__, __FUNCTION__,
+                "recvmsg() returned %d bytes with %d fds, msg_flags %d", (int)n, iRecvFdNum, msg.msg_flags);
+        for (int i = 0; i < iRecvFdNum; ++i)
+        {
+            close(pRecvFds[i]);
+        }
+        return(ERR_TRANSFER_FD);
+    }
+
+    for (int i = 0; i < iRecvFdNum; ++i)
+    {
+        pChannelCtx[i].iFd = pRecvFds[i];   // 发送方的文件描述符在本进程中无意义，以接收到的为准
+    }
+    iFdNum = iRecvFdNum;
+    return(ERR_OK);
+}
+
 int SocketChannel::RecvChannelFd(int iSocketFd, int& iRecvFd, int& iAiFamily, int& iCodecType, std::shared_ptr<NetLogger> pLogger)
 {
     ssize_t             n;
@@ -37,6 +37,21 @@ public:
     static int SendChannelFd(int iSocketFd, int iSendFd, int iAiFamily, int iCodecType, std::shared_ptr<NetLogger> pLogger);
     static int RecvChannelFd(int iSocketFd, int& iRecvFd, int& iAiFamily, int& iCodecType, std::shared_ptr<NetLogger> pLogger);
 
+    static const int MAX_TRANSFER_FD_NUM = 64;      ///< 一次sendmsg最多传递的文件描述符数量
+
+    /**
+     * @brief 以一次sendmsg传递多个文件描述符
+     * @param iFdNum 文件描述符数量，不超过MAX_TRANSFER_FD_NUM
+     */
+    static int SendChannelFds(int iSocketFd, const int* pSendFds, int iFdNum, int iAiFamily, int iCodecType, std::shared_ptr<NetLogger> pLogger);
+
+    /**
+     * @brief 接收一次sendmsg传递的（一个或多个）文件描述符，兼容SendChannelFd()发送的单个文件描述符
+     * @param pChannelCtx 至少能容纳MAX_TRANSFER_FD_NUM个元素的数组
+     * @param[out] iFdNum 接收到的文件描述符数量
+     */
+    static int RecvChannelFds(int iSocketFd, tagChannelCtx* pChannelCtx, int& iFdNum, std::shared_ptr<NetLogger> pLogger);
+
     virtual bool Init(E_CODEC_TYPE eCodecType, bool bIsClient = false);
 
     virtual int GetFd() const;
@@ -56,6 +71,7 @@ private:
     
     friend class Dispatcher;
     friend class ActorBuilder;
+    friend class SocketChannelPool;
 };
 
 } /* namespace neb */
@@ -7,6 +7,8 @@
  * @note
  * Modify history:
  ******************************************************************************/
+#include <sys/ioctl.h>
+#include <linux/sockios.h>
 #include <cstring>
 #include "codec/CodecProto.hpp"
 #include "codec/CodecPrivate.hpp"
@@ -15,6 +17,7 @@
 #include "codec/CodecResp.hpp"
 #include "labor/Labor.hpp"
 #include "labor/Manager.hpp"
+#include "ios/Dispatcher.hpp"
 #include "logger/NetLogger.hpp"
 #include "SocketChannelImpl.hpp"
 
@@ -24,11 +27,12 @@ namespace neb
 SocketChannelImpl::SocketChannelImpl(SocketChannel* pSocketChannel, std::shared_ptr<NetLogger> pLogger, int iFd, uint32 ulSeq, ev_tstamp dKeepAlive)
     : m_ucChannelStatus(CHANNEL_STATUS_INIT),m_eLastCodecStatus(CODEC_STATUS_OK), m_bIsClientConnection(false),
       m_iRemoteWorkerIdx(-1), m_iFd(iFd), m_uiSeq(ulSeq), m_uiForeignSeq(0), m_bPipeline(true),
+      m_bCork(false), m_bCorkPending(false), m_bMailboxFallback(false),
       m_uiUnitTimeMsgNum(0), m_uiMsgNum(0),
       m_dActiveTime(0.0), m_dKeepAlive(dKeepAlive),
       m_pIoWatcher(NULL), m_pTimerWatcher(NULL),
-      m_pRecvBuff(nullptr), m_pSendBuff(nullptr), m_pWaitForSendBuff(nullptr),
-      m_pCodec(nullptr), m_pHoldingHttpMsg(nullptr), m_iErrno(0), m_pLabor(nullptr), m_pSocketChannel(pSocketChannel), m_pLogger(pLogger)
+      m_pRecvBuff(nullptr), m_pSendQueue(nullptr), m_pWaitForSendBuff(nullptr),
+      m_pCodec(nullptr), m_pHoldingHttpMsg(nullptr), m_iErrno(0), m_iPeerFd(-1), m_pLabor(nullptr), m_pSocketChannel(pSocketChannel), m_pLogger(pLogger)
 {
     memset(m_szErrBuff, 0, sizeof(m_szErrBuff));
 }
@@ -44,7 +48,7 @@ SocketChannelImpl::~SocketChannelImpl()
     FREE(m_pIoWatcher);
     FREE(m_pTimerWatcher);
     DELETE(m_pRecvBuff);
-    DELETE(m_pSendBuff);
+    DELETE(m_pSendQueue);
     DELETE(m_pWaitForSendBuff);
     DELETE(m_pHoldingHttpMsg);
     DELETE(m_pCodec);
@@ -54,15 +58,16 @@ bool SocketChannelImpl::Init(E_CODEC_TYPE eCodecType, bool bIsClient)
 {
     LOG4_TRACE("fd[%d], codec_type[%d]", m_iFd, eCodecType);
     m_bIsClientConnection = bIsClient;
+    m_bCork = m_pLabor->GetNodeInfo().bWriteCoalescing;
     try
     {
         if (m_pRecvBuff == nullptr)
         {
             m_pRecvBuff = new CBuffer();
         }
-        if (m_pSendBuff == nullptr)
+        if (m_pSendQueue == nullptr)
         {
-            m_pSendBuff = new CBuffer();
+            m_pSendQueue = new CSendQueue();
         }
         if (m_pWaitForSendBuff == nullptr)
         {
@@ -86,7 +91,7 @@ bool SocketChannelImpl::Init(E_CODEC_TYPE eCodecType, bool bIsClient)
                 break;
             case CODEC_HTTP2:
                 m_pCodec = new CodecHttp2(m_pLogger, eCodecType, m_bIsClientConnection);
-                ((CodecHttp2*)m_pCodec)->ConnectionSetting(m_pSendBuff);
+                ((CodecHttp2*)m_pCodec)->ConnectionSetting(m_pSendQueue->MutableTailBuffer());
                 m_pCodec->SetKey(m_strKey);
                 break;
             case CODEC_RESP:
@@ -145,6 +150,16 @@ uint32 SocketChannelImpl::PopStepSeq(uint32 uiStreamId, E_CODEC_STATUS eCodecSta
     }
 }
 
+bool SocketChannelImpl::IsStreamAvailable() const
+{
+    if (m_pCodec == nullptr || CODEC_HTTP2 != m_pCodec->GetCodecType())
+    {
+        return(false);
+    }
+    CodecHttp2* pCodec = (CodecHttp2*)m_pCodec;
+    return(!pCodec->IsGoaway() && m_mapStreamStepSeq.size() < pCodec->GetMaxConcurrentStreams());
+}
+
 ev_tstamp SocketChannelImpl::GetKeepAlive()
 {
     if (CODEC_HTTP == m_pCodec->GetCodecType())
@@ -187,7 +202,7 @@ E_CODEC_STATUS SocketChannelImpl::Send()
         return(CODEC_STATUS_ERR);
     }
     int iNeedWriteLen = 0;
-    iNeedWriteLen = m_pSendBuff->ReadableBytes();
+    iNeedWriteLen = m_pSendQueue->ReadableBytes();
     if (0 == iNeedWriteLen)
     {
         iNeedWriteLen = m_pWaitForSendBuff->ReadableBytes();
@@ -198,9 +213,7 @@ E_CODEC_STATUS SocketChannelImpl::Send()
         }
         else
         {
-            CBuffer* pExchangeBuff = m_pSendBuff;
-            m_pSendBuff = m_pWaitForSendBuff;
-            m_pWaitForSendBuff = pExchangeBuff;
+            m_pSendQueue->Append(m_pWaitForSendBuff);
             m_pWaitForSendBuff->Compact(1);
         }
     }
@@ -210,22 +223,18 @@ E_CODEC_STATUS SocketChannelImpl::Send()
     int iWrittenLen = 0;
     do
     {
-        iWrittenLen = Write(m_pSendBuff, m_iErrno);
+        iWrittenLen = Write(m_pSendQueue, m_iErrno);
         if (iWrittenLen > 0)
         {
             iHadWrittenLen += iWrittenLen;
         }
     }
     while (iWrittenLen > 0 && iHadWrittenLen < iNeedWriteLen);
+    m_pSendQueue->Retain();     // 未发送完的借用数据（如包体引用）在返回前拷贝到发送队列
     LOG4_TRACE("iNeedWriteLen = %d, iHadWrittenLen = %d", iNeedWriteLen, iHadWrittenLen);
     if (iHadWrittenLen >= 0)
     {
         m_pLabor->IoStatAddSendBytes(m_iFd, iHadWrittenLen);
-        if (m_pSendBuff->Capacity() > CBuffer::BUFFER_MAX_READ
-            && (m_pSendBuff->ReadableBytes() < m_pSendBuff->Capacity() / 2))
-        {
-            m_pSendBuff->Compact(m_pSendBuff->ReadableBytes() * 2);
-        }
         m_dActiveTime = m_pLabor->GetNowTime();
         if (iNeedWriteLen == iHadWrittenLen && 0 == m_pWaitForSendBuff->ReadableBytes())
         {
@@ -251,9 +260,104 @@ E_CODEC_STATUS SocketChannelImpl::Send()
     }
 }
 
+E_CODEC_STATUS SocketChannelImpl::Uncork()
+{
+    m_bCorkPending = false;
+    return(Send());
+}
+
+bool SocketChannelImpl::Cork(int iNeedWriteLen)
+{
+    if (!m_bCork || CHANNEL_STATUS_ESTABLISHED != m_ucChannelStatus
+            || (uint32)iNeedWriteLen >= m_pLabor->GetNodeInfo().uiWriteCoalescingBytes)
+    {
+        return(false);
+    }
+    if (!m_bCorkPending)
+    {
+        if (!m_pLabor->GetDispatcher()->AddCorkedChannel(m_pSocketChannel->shared_from_this()))
+        {
+            return(false);
+        }
+        m_bCorkPending = true;
+    }
+    m_pSendQueue->Retain();     // 借用数据在本轮事件循环结束前可能失效
+    return(true);
+}
+
+bool SocketChannelImpl::IsSocketDrained() const
+{
+    if (m_pSendQueue->ReadableBytes() > 0)
+    {
+        return(false);
+    }
+    int iUnreadBytes = 0;   // unix域socket的SIOCOUTQ为对端尚未读取的字节数
+    if (ioctl(m_iFd, SIOCOUTQ, &iUnreadBytes) < 0)
+    {
+        return(false);
+    }
+    return(0 == iUnreadBytes);
+}
+
+bool SocketChannelImpl::IsPeerMailboxUsable() const
+{
+    return(nullptr != m_pPeerMailbox && CHANNEL_STATUS_ESTABLISHED == m_ucChannelStatus
+            && (!m_bMailboxFallback || IsSocketDrained()));
+}
+
+bool SocketChannelImpl::PostToPeer(tagMailItem& stItem)
+{
+    if (m_pPeerMailbox->Post(stItem))
+    {
+        m_bMailboxFallback = false;
+        m_dActiveTime = m_pLabor->GetNowTime();
+        return(true);
+    }
+    LOG4_WARNING("channel_fd[%d] peer mailbox is full, send by socket instead.", m_iFd);
+    m_bMailboxFallback = true;
+    return(false);
+}
+
 E_CODEC_STATUS SocketChannelImpl::Send(int32 iCmd, uint32 uiSeq, const MsgBody& oMsgBody)
 {
     LOG4_TRACE("channel_fd[%d], channel_seq[%d], cmd[%u], seq[%u]", m_iFd, m_uiSeq, iCmd, uiSeq);
+    if (IsPeerMailboxUsable())
+    {
+        tagMailItem stItem;
+        stItem.iFd = m_iPeerFd;
+        stItem.oMsgHead.set_cmd(iCmd);
+        stItem.oMsgHead.set_seq(uiSeq);
+        stItem.oMsgBody.CopyFrom(oMsgBody);
+        if (PostToPeer(stItem))
+        {
+            return(CODEC_STATUS_OK);
+        }
+    }
+    return(SendBySocket(iCmd, uiSeq, oMsgBody));
+}
+
+E_CODEC_STATUS SocketChannelImpl::Send(int32 iCmd, uint32 uiSeq, MsgBody&& oMsgBody)
+{
+    if (!IsPeerMailboxUsable())
+    {
+        return(Send(iCmd, uiSeq, (const MsgBody&)oMsgBody));
+    }
+    LOG4_TRACE("channel_fd[%d], channel_seq[%d], cmd[%u], seq[%u]", m_iFd, m_uiSeq, iCmd, uiSeq);
+    tagMailItem stItem;
+    stItem.iFd = m_iPeerFd;
+    stItem.oMsgHead.set_cmd(iCmd);
+    stItem.oMsgHead.set_seq(uiSeq);
+    stItem.oMsgBody.Swap(&oMsgBody);
+    if (PostToPeer(stItem))
+    {
+        return(CODEC_STATUS_OK);
+    }
+    oMsgBody.Swap(&stItem.oMsgBody);    // 信箱满时Post()不改变stItem，包体换回后经socket发送
+    return(SendBySocket(iCmd, uiSeq, oMsgBody));
+}
+
+E_CODEC_STATUS SocketChannelImpl::SendBySocket(int32 iCmd, uint32 uiSeq, const MsgBody& oMsgBody)
+{
     if (m_pCodec == nullptr)
     {
         LOG4_ERROR("no codec found, please check whether the CODEC_TYPE is valid.");
@@ -269,7 +373,7 @@ E_CODEC_STATUS SocketChannelImpl::Send(int32 iCmd, uint32 uiSeq, const MsgBody&
     switch (m_ucChannelStatus)
     {
         case CHANNEL_STATUS_ESTABLISHED:
-            eCodecStatus = m_pCodec->Encode(oMsgHead, oMsgBody, m_pSendBuff);
+            eCodecStatus = m_pCodec->Encode(oMsgHead, oMsgBody, m_pSendQueue);
             break;
         case CHANNEL_STATUS_CLOSED:
         case CHANNEL_STATUS_BROKEN:
@@ -288,19 +392,19 @@ E_CODEC_STATUS SocketChannelImpl::Send(int32 iCmd, uint32 uiSeq, const MsgBody&
                 case CMD_RSP_TELL_WORKER:
                     m_ucChannelStatus = CHANNEL_STATUS_ESTABLISHED;
                     m_dKeepAlive = m_pLabor->GetNodeInfo().dIoTimeout;
-                    eCodecStatus = m_pCodec->Encode(oMsgHead, oMsgBody, m_pSendBuff);
+                    eCodecStatus = m_pCodec->Encode(oMsgHead, oMsgBody, m_pSendQueue);
                     break;
                 case CMD_REQ_TELL_WORKER:
                     m_ucChannelStatus = CHANNEL_STATUS_TELL_WORKER;
-                    eCodecStatus = m_pCodec->Encode(oMsgHead, oMsgBody, m_pSendBuff);
+                    eCodecStatus = m_pCodec->Encode(oMsgHead, oMsgBody, m_pSendQueue);
                     break;
                 case CMD_RSP_CONNECT_TO_WORKER:
                     m_ucChannelStatus = CHANNEL_STATUS_WORKER;
-                    eCodecStatus = m_pCodec->Encode(oMsgHead, oMsgBody, m_pSendBuff);
+                    eCodecStatus = m_pCodec->Encode(oMsgHead, oMsgBody, m_pSendQueue);
                     break;
                 case CMD_REQ_CONNECT_TO_WORKER:
                     m_ucChannelStatus = CHANNEL_STATUS_TRANSFER_TO_WORKER;
-                    eCodecStatus = m_pCodec->Encode(oMsgHead, oMsgBody, m_pSendBuff);
+                    eCodecStatus = m_pCodec->Encode(oMsgHead, oMsgBody, m_pSendQueue);
                     break;
                 default:
                     eCodecStatus = m_pCodec->Encode(oMsgHead, oMsgBody, m_pWaitForSendBuff);
@@ -323,33 +427,34 @@ E_CODEC_STATUS SocketChannelImpl::Send(int32 iCmd, uint32 uiSeq, const MsgBody&
         return(eCodecStatus);
     }
 
-    int iNeedWriteLen = m_pSendBuff->ReadableBytes();
+    int iNeedWriteLen = m_pSendQueue->ReadableBytes();
     if (iNeedWriteLen <= 0)
     {
         return(eCodecStatus);
     }
 
+    if (CMD_RSP_TELL_WORKER != iCmd && Cork(iNeedWriteLen))
+    {
+        return(eCodecStatus);
+    }
+
     errno = 0;
     int iHadWrittenLen = 0;
     int iWrittenLen = 0;
     do
     {
-        iWrittenLen = Write(m_pSendBuff, m_iErrno);
+        iWrittenLen = Write(m_pSendQueue, m_iErrno);
         if (iWrittenLen > 0)
         {
             iHadWrittenLen += iWrittenLen;
         }
     }
     while (iWrittenLen > 0 && iHadWrittenLen < iNeedWriteLen);
+    m_pSendQueue->Retain();     // 未发送完的借用数据（如包体引用）在返回前拷贝到发送队列
     LOG4_TRACE("iNeedWriteLen = %d, iHadWrittenLen = %d", iNeedWriteLen, iHadWrittenLen);
     if (iHadWrittenLen >= 0)
     {
         m_pLabor->IoStatAddSendBytes(m_iFd, iHadWrittenLen);
-        if (m_pSendBuff->Capacity() > CBuffer::BUFFER_MAX_READ
-            && (m_pSendBuff->ReadableBytes() < m_pSendBuff->Capacity() / 2))
-        {
-            m_pSendBuff->Compact(m_pSendBuff->ReadableBytes() * 2);
-        }
         m_dActiveTime = m_pLabor->GetNowTime();
         if (iNeedWriteLen == iHadWrittenLen)
         {
@@ -402,11 +507,11 @@ E_CODEC_STATUS SocketChannelImpl::Send(const HttpMsg& oHttpMsg, uint32 uiStepSeq
         case CHANNEL_STATUS_ESTABLISHED:
             if (CODEC_HTTP == m_pCodec->GetCodecType())
             {
-                eCodecStatus = ((CodecHttp*)m_pCodec)->Encode(oHttpMsg, m_pSendBuff);
+                eCodecStatus = ((CodecHttp*)m_pCodec)->Encode(oHttpMsg, m_pSendQueue);
             }
             else
             {
-                eCodecStatus = ((CodecHttp2*)m_pCodec)->Encode(oHttpMsg, m_pSendBuff);
+                eCodecStatus = ((CodecHttp2*)m_pCodec)->Encode(oHttpMsg, m_pSendQueue->MutableTailBuffer());
             }
             if (CODEC_STATUS_OK == eCodecStatus && uiStepSeq > 0)
             {
@@ -462,32 +567,34 @@ E_CODEC_STATUS SocketChannelImpl::Send(const HttpMsg& oHttpMsg, uint32 uiStepSeq
         return(eCodecStatus);
     }
 
-    int iNeedWriteLen = m_pSendBuff->ReadableBytes();
+    int iNeedWriteLen = m_pSendQueue->ReadableBytes();
     if (iNeedWriteLen <= 0)
     {
         return(eCodecStatus);
     }
 
+    if (!(m_pCodec->GetCodecType() == CODEC_HTTP && ((CodecHttp*)m_pCodec)->GetKeepAlive() == 0.0)
+            && Cork(iNeedWriteLen))     // 短连接的响应发送完即关闭，不合并
+    {
+        return(eCodecStatus);
+    }
+
     int iHadWrittenLen = 0;
     int iWrittenLen = 0;
     do
     {
-        iWrittenLen = Write(m_pSendBuff, m_iErrno);
+        iWrittenLen = Write(m_pSendQueue, m_iErrno);
         if (iWrittenLen > 0)
         {
             iHadWrittenLen += iWrittenLen;
         }
     }
     while (iWrittenLen > 0 && iHadWrittenLen < iNeedWriteLen);
+    m_pSendQueue->Retain();     // 未发送完的借用数据（如包体引用）在返回前拷贝到发送队列
     LOG4_TRACE("iNeedWriteLen = %d, iHadWrittenLen = %d", iNeedWriteLen, iHadWrittenLen);
     if (iHadWrittenLen >= 0)
     {
         m_pLabor->IoStatAddSendBytes(m_iFd, iHadWrittenLen);
-        if (m_pSendBuff->Capacity() > CBuffer::BUFFER_MAX_READ
-            && (m_pSendBuff->ReadableBytes() < m_pSendBuff->Capacity() / 2))
-        {
-            m_pSendBuff->Compact(m_pSendBuff->ReadableBytes() * 2);
-        }
         m_dActiveTime = m_pLabor->GetNowTime();
         if (iNeedWriteLen == iHadWrittenLen)
         {
@@ -519,6 +626,37 @@ E_CODEC_STATUS SocketChannelImpl::Send(const HttpMsg& oHttpMsg, uint32 uiStepSeq
 }
 
 E_CODEC_STATUS SocketChannelImpl::Send(const RedisMsg& oRedisMsg, uint32 uiStepSeq)
+{
+    const RedisMsg* pRedisMsg = &oRedisMsg;
+    return(SendRedis(&pRedisMsg, 1, uiStepSeq));
+}
+
+E_CODEC_STATUS SocketChannelImpl::Send(const std::vector<const RedisMsg*>& vecRedisMsg, uint32 uiStepSeq)
+{
+    if (vecRedisMsg.empty())
+    {
+        return(CODEC_STATUS_OK);
+    }
+    return(SendRedis(&vecRedisMsg[0], vecRedisMsg.size(), uiStepSeq));
+}
+
+E_CODEC_STATUS SocketChannelImpl::EncodeRedis(const RedisMsg* const* ppRedisMsg, uint32 uiMsgNum, CBuffer* pBuff)
+{
+    // 编码过程中缓冲区可能被整理（读位置移动），按可读字节数回退
+    size_t uiReadableBytes = pBuff->ReadableBytes();
+    E_CODEC_STATUS eCodecStatus = CODEC_STATUS_OK;
+    for (uint32 i = 0; i < uiMsgNum && CODEC_STATUS_OK == eCodecStatus; ++i)
+    {
+        eCodecStatus = ((CodecResp*)m_pCodec)->Encode(*ppRedisMsg[i], pBuff);
+    }
+    if (CODEC_STATUS_OK != eCodecStatus)
+    {
+        pBuff->SetWriteIndex(pBuff->GetReadIndex() + uiReadableBytes);
+    }
+    return(eCodecStatus);
+}
+
+E_CODEC_STATUS SocketChannelImpl::SendRedis(const RedisMsg* const* ppRedisMsg, uint32 uiMsgNum, uint32 uiStepSeq)
 {
     LOG4_TRACE("channel_fd[%d], channel_seq[%d], channel_status[%d]", m_iFd, m_uiSeq, (int)m_ucChannelStatus);
     if (m_pCodec == nullptr)
@@ -535,7 +673,7 @@ E_CODEC_STATUS SocketChannelImpl::Send(const RedisMsg& oRedisMsg, uint32 uiStepS
     switch (m_ucChannelStatus)
     {
         case CHANNEL_STATUS_ESTABLISHED:
-            eCodecStatus = ((CodecResp*)m_pCodec)->Encode(oRedisMsg, m_pSendBuff);
+            eCodecStatus = EncodeRedis(ppRedisMsg, uiMsgNum, m_pSendQueue->MutableTailBuffer());
             break;
         case CHANNEL_STATUS_CLOSED:
         case CHANNEL_STATUS_BROKEN:
@@ -548,11 +686,11 @@ E_CODEC_STATUS SocketChannelImpl::Send(const RedisMsg& oRedisMsg, uint32 uiStepS
         case CHANNEL_STATUS_CONNECTED:
         case CHANNEL_STATUS_TRY_CONNECT:
         case CHANNEL_STATUS_INIT:
-            eCodecStatus = ((CodecResp*)m_pCodec)->Encode(oRedisMsg, m_pWaitForSendBuff);
+            eCodecStatus = EncodeRedis(ppRedisMsg, uiMsgNum, m_pWaitForSendBuff);
             if (CODEC_STATUS_OK == eCodecStatus && uiStepSeq > 0)
             {
                 eCodecStatus = CODEC_STATUS_PAUSE;
-                m_listPipelineStepSeq.push_back(uiStepSeq);
+                m_listPipelineStepSeq.insert(m_listPipelineStepSeq.end(), uiMsgNum, uiStepSeq);
             }
             break;
         default:
@@ -564,37 +702,38 @@ E_CODEC_STATUS SocketChannelImpl::Send(const RedisMsg& oRedisMsg, uint32 uiStepS
     {
         return(eCodecStatus);
     }
+    if (uiStepSeq > 0)  // 数据已在发送队列中（包括合并写暂缓发送），响应按此顺序回调
+    {
+        m_listPipelineStepSeq.insert(m_listPipelineStepSeq.end(), uiMsgNum, uiStepSeq);
+    }
 
-    int iNeedWriteLen = m_pSendBuff->ReadableBytes();
+    int iNeedWriteLen = m_pSendQueue->ReadableBytes();
     if (iNeedWriteLen <= 0)
     {
         return(eCodecStatus);
     }
 
+    if (Cork(iNeedWriteLen))
+    {
+        return(eCodecStatus);
+    }
+
     int iHadWrittenLen = 0;
     int iWrittenLen = 0;
     do
     {
-        iWrittenLen = Write(m_pSendBuff, m_iErrno);
+        iWrittenLen = Write(m_pSendQueue, m_iErrno);
         if (iWrittenLen > 0)
         {
             iHadWrittenLen += iWrittenLen;
         }
     }
     while (iWrittenLen > 0 && iHadWrittenLen < iNeedWriteLen);
+    m_pSendQueue->Retain();     // 未发送完的借用数据（如包体引用）在返回前拷贝到发送队列
     LOG4_TRACE("iNeedWriteLen = %d, iHadWrittenLen = %d", iNeedWriteLen, iHadWrittenLen);
     if (iHadWrittenLen >= 0)
     {
         m_pLabor->IoStatAddSendBytes(m_iFd, iHadWrittenLen);
-        if (m_pSendBuff->Capacity() > CBuffer::BUFFER_MAX_READ
-            && (m_pSendBuff->ReadableBytes() < m_pSendBuff->Capacity() / 2))
-        {
-            m_pSendBuff->Compact(m_pSendBuff->ReadableBytes() * 2);
-        }
-        if (uiStepSeq > 0)
-        {
-            m_listPipelineStepSeq.push_back(uiStepSeq);
-        }
         m_dActiveTime = m_pLabor->GetNowTime();
         if (iNeedWriteLen == iHadWrittenLen)
         {
@@ -627,7 +766,7 @@ E_CODEC_STATUS SocketChannelImpl::Send(const char* pRaw, uint32 uiRawSize, uint3
     switch (m_ucChannelStatus)
     {
         case CHANNEL_STATUS_ESTABLISHED:
-            m_pSendBuff->Write(pRaw, uiRawSize);
+            m_pSendQueue->Reference(pRaw, uiRawSize);
             break;
         case CHANNEL_STATUS_CLOSED:
         case CHANNEL_STATUS_BROKEN:
@@ -652,37 +791,38 @@ E_CODEC_STATUS SocketChannelImpl::Send(const char* pRaw, uint32 uiRawSize, uint3
     {
         return(eCodecStatus);
     }
+    if (uiStepSeq > 0)  // 数据已在发送队列中（包括合并写暂缓发送），响应按此顺序回调
+    {
+        m_listPipelineStepSeq.push_back(uiStepSeq);
+    }
 
-    int iNeedWriteLen = m_pSendBuff->ReadableBytes();
+    int iNeedWriteLen = m_pSendQueue->ReadableBytes();
     if (iNeedWriteLen <= 0)
     {
         return(eCodecStatus);
     }
 
+    if (Cork(iNeedWriteLen))
+    {
+        return(eCodecStatus);
+    }
+
     int iHadWrittenLen = 0;
     int iWrittenLen = 0;
     do
     {
-        iWrittenLen = Write(m_pSendBuff, m_iErrno);
+        iWrittenLen = Write(m_pSendQueue, m_iErrno);
         if (iWrittenLen > 0)
         {
             iHadWrittenLen += iWrittenLen;
         }
     }
     while (iWrittenLen > 0 && iHadWrittenLen < iNeedWriteLen);
+    m_pSendQueue->Retain();     // 未发送完的借用数据（如包体引用）在返回前拷贝到发送队列
     LOG4_TRACE("iNeedWriteLen = %d, iHadWrittenLen = %d", iNeedWriteLen, iHadWrittenLen);
     if (iHadWrittenLen >= 0)
     {
         m_pLabor->IoStatAddSendBytes(m_iFd, iHadWrittenLen);
-        if (m_pSendBuff->Capacity() > CBuffer::BUFFER_MAX_READ
-            && (m_pSendBuff->ReadableBytes() < m_pSendBuff->Capacity() / 2))
-        {
-            m_pSendBuff->Compact(m_pSendBuff->ReadableBytes() * 2);
-        }
-        if (uiStepSeq > 0)
-        {
-            m_listPipelineStepSeq.push_back(uiStepSeq);
-        }
         m_dActiveTime = m_pLabor->GetNowTime();
         if (iNeedWriteLen == iHadWrittenLen)
         {
@@ -899,9 +1039,9 @@ E_CODEC_STATUS SocketChannelImpl::Recv(HttpMsg& oHttpMsg)
         }
         else
         {
-            size_t uiSendBuffLen = m_pSendBuff->ReadableBytes();
-            eCodecStatus = ((CodecHttp2*)m_pCodec)->Decode(m_pRecvBuff, oHttpMsg, m_pSendBuff);
-            if (m_pSendBuff->ReadableBytes() > uiSendBuffLen
+            size_t uiSendBuffLen = m_pSendQueue->ReadableBytes();
+            eCodecStatus = ((CodecHttp2*)m_pCodec)->Decode(m_pRecvBuff, oHttpMsg, m_pSendQueue->MutableTailBuffer());
+            if (m_pSendQueue->ReadableBytes() > uiSendBuffLen
                     && (eCodecStatus == CODEC_STATUS_OK || eCodecStatus == CODEC_STATUS_PART_OK))
             {
                 Send();
@@ -943,7 +1083,7 @@ E_CODEC_STATUS SocketChannelImpl::Recv(HttpMsg& oHttpMsg)
             {
                 if (!m_bIsClientConnection)
                 {
-                    m_pSendBuff->Clear();
+                    m_pSendQueue->Clear();
                 }
                 return(CODEC_STATUS_INVALID);
             }
@@ -958,6 +1098,17 @@ E_CODEC_STATUS SocketChannelImpl::Recv(HttpMsg& oHttpMsg)
 }
 
 E_CODEC_STATUS SocketChannelImpl::Recv(RedisReply& oRedisReply)
+{
+    const RedisReplyView* pReplyView = nullptr;
+    E_CODEC_STATUS eCodecStatus = Recv(pReplyView);
+    if (CODEC_STATUS_OK == eCodecStatus)
+    {
+        pReplyView->ToRedisReply(oRedisReply);
+    }
+    return(eCodecStatus);
+}
+
+E_CODEC_STATUS SocketChannelImpl::Recv(const RedisReplyView*& pReplyView)
 {
     LOG4_TRACE("channel_fd[%d], channel_seq[%d]", m_iFd, m_uiSeq);
     if (CHANNEL_STATUS_CLOSED == m_ucChannelStatus || CHANNEL_STATUS_BROKEN == m_ucChannelStatus)
@@ -1016,7 +1167,7 @@ E_CODEC_STATUS SocketChannelImpl::Recv(RedisReply& oRedisReply)
             m_pRecvBuff->Compact(m_pRecvBuff->ReadableBytes() * 2);
         }
         m_dActiveTime = m_pLabor->GetNowTime();
-        E_CODEC_STATUS eCodecStatus = ((CodecResp*)m_pCodec)->Decode(m_pRecvBuff, oRedisReply);
+        E_CODEC_STATUS eCodecStatus = ((CodecResp*)m_pCodec)->Decode(m_pRecvBuff, pReplyView);
         if (CODEC_STATUS_OK == eCodecStatus)
         {
             ++m_uiUnitTimeMsgNum;
@@ -1166,9 +1317,9 @@ E_CODEC_STATUS SocketChannelImpl::Fetch(HttpMsg& oHttpMsg)
     }
     else
     {
-        size_t uiSendBuffLen = m_pSendBuff->ReadableBytes();
-        eCodecStatus = ((CodecHttp2*)m_pCodec)->Decode(m_pRecvBuff, oHttpMsg, m_pSendBuff);
-        if (m_pSendBuff->ReadableBytes() > uiSendBuffLen
+        size_t uiSendBuffLen = m_pSendQueue->ReadableBytes();
+        eCodecStatus = ((CodecHttp2*)m_pCodec)->Decode(m_pRecvBuff, oHttpMsg, m_pSendQueue->MutableTailBuffer());
+        if (m_pSendQueue->ReadableBytes() > uiSendBuffLen
                 && (eCodecStatus == CODEC_STATUS_OK || eCodecStatus == CODEC_STATUS_PART_OK))
         {
             Send();
@@ -1221,6 +1372,17 @@ E_CODEC_STATUS SocketChannelImpl::Fetch(HttpMsg& oHttpMsg)
 }
 
 E_CODEC_STATUS SocketChannelImpl::Fetch(RedisReply& oRedisReply)
+{
+    const RedisReplyView* pReplyView = nullptr;
+    E_CODEC_STATUS eCodecStatus = Fetch(pReplyView);
+    if (CODEC_STATUS_OK == eCodecStatus)
+    {
+        pReplyView->ToRedisReply(oRedisReply);
+    }
+    return(eCodecStatus);
+}
+
+E_CODEC_STATUS SocketChannelImpl::Fetch(const RedisReplyView*& pReplyView)
 {
     LOG4_TRACE("channel_fd[%d], channel_seq[%d]", m_iFd, m_uiSeq);
     if (CHANNEL_STATUS_CLOSED == m_ucChannelStatus || CHANNEL_STATUS_BROKEN == m_ucChannelStatus)
@@ -1229,7 +1391,7 @@ E_CODEC_STATUS SocketChannelImpl::Fetch(RedisReply& oRedisReply)
                 m_strIdentify.c_str(), m_iFd, m_uiSeq, (int)m_ucChannelStatus, m_strRemoteAddr.c_str());
         return(CODEC_STATUS_ERR);
     }
-    E_CODEC_STATUS eCodecStatus = ((CodecResp*)m_pCodec)->Decode(m_pRecvBuff, oRedisReply);
+    E_CODEC_STATUS eCodecStatus = ((CodecResp*)m_pCodec)->Decode(m_pRecvBuff, pReplyView);
     if (CODEC_STATUS_OK == eCodecStatus)
     {
         ++m_uiUnitTimeMsgNum;
@@ -1423,7 +1585,6 @@ bool SocketChannelImpl::Close()
     LOG4_TRACE("channel[%d] channel_status %d", m_iFd, (int)m_ucChannelStatus);
     if (CHANNEL_STATUS_CLOSED != m_ucChannelStatus)
     {
-        m_pSendBuff->Compact(1);
         m_pWaitForSendBuff->Compact(1);
         if (0 == close(m_iFd))
         {
@@ -1444,10 +1605,83 @@ bool SocketChannelImpl::Close()
     }
 }
 
-int SocketChannelImpl::Write(CBuffer* pBuff, int& iErrno)
+bool SocketChannelImpl::IsRecyclable() const
+{
+    if (CHANNEL_STATUS_CLOSED != m_ucChannelStatus)
+    {
+        return(false);
+    }
+    if ((NULL != m_pIoWatcher && ev_is_active(m_pIoWatcher))
+            || (NULL != m_pTimerWatcher && ev_is_active(m_pTimerWatcher)))
+    {
+        return(false);
+    }
+    return(true);
+}
+
+void SocketChannelImpl::Reset(int iFd, uint32 ulSeq, ev_tstamp dKeepAlive)
+{
+    m_ucChannelStatus = CHANNEL_STATUS_INIT;
+    m_eLastCodecStatus = CODEC_STATUS_OK;
+    m_bIsClientConnection = false;
+    m_iRemoteWorkerIdx = -1;
+    m_iFd = iFd;
+    m_uiSeq = ulSeq;
+    m_uiForeignSeq = 0;
+    m_bPipeline = true;
+    m_bCork = false;
+    m_bCorkPending = false;
+    m_bMailboxFallback = false;
+    m_uiUnitTimeMsgNum = 0;
+    m_uiMsgNum = 0;
+    m_dActiveTime = 0.0;
+    m_dKeepAlive = dKeepAlive;
+    m_iErrno = 0;
+    m_iPeerFd = -1;
+    m_pPeerMailbox = nullptr;
+    if (NULL != m_pIoWatcher)
+    {
+        memset(m_pIoWatcher, 0, sizeof(ev_io));
+        m_pIoWatcher->data = m_pSocketChannel;
+        m_pIoWatcher->fd = iFd;
+    }
+    if (NULL != m_pTimerWatcher)
+    {
+        memset(m_pTimerWatcher, 0, sizeof(ev_timer));
+        m_pTimerWatcher->data = m_pSocketChannel;
+    }
+    CBuffer* apBuff[2] = {m_pRecvBuff, m_pWaitForSendBuff};
+    for (int i = 0; i < 2; ++i)
+    {
+        if (nullptr != apBuff[i])
+        {
+            apBuff[i]->Clear();
+            if (apBuff[i]->Capacity() > CBuffer::BUFFER_MAX_READ)
+            {
+                apBuff[i]->Compact(0);
+            }
+        }
+    }
+    if (nullptr != m_pSendQueue)
+    {
+        m_pSendQueue->Clear();
+    }
+    DELETE(m_pHoldingHttpMsg);
+    DELETE(m_pCodec);
+    m_strKey.clear();
+    m_strClientData.clear();
+    m_strErrMsg.clear();
+    m_strIdentify.clear();
+    m_strRemoteAddr.clear();
+    m_listPipelineStepSeq.clear();
+    m_mapStreamStepSeq.clear();
+    m_setSkipCodecType.clear();
+}
+
+int SocketChannelImpl::Write(CSendQueue* pSendQueue, int& iErrno)
 {
     LOG4_TRACE("fd[%d], channel_seq[%u]", GetFd(), GetSequence());
-    return(pBuff->WriteFD(m_iFd, iErrno));
+    return(pSendQueue->WriteFD(m_iFd, iErrno));
 }
 
 int SocketChannelImpl::Read(CBuffer* pBuff, int& iErrno)
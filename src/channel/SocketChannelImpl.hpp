@@ -11,6 +11,7 @@
 #define SRC_CHANNEL_SOCKETCHANNELIMPL_HPP_
 
 #include <memory>
+#include <vector>
 
 #ifdef __GNUC__
 #pragma GCC diagnostic push
@@ -22,6 +23,7 @@
 #endif
 
 #include "util/CBuffer.hpp"
+#include "util/CSendQueue.hpp"
 #include "util/StreamCodec.hpp"
 #include "util/json/CJsonObject.hpp"
 
@@ -29,6 +31,7 @@
 #include "pb/redis.pb.h"
 #include "codec/Codec.hpp"
 #include "Channel.hpp"
+#include "ThreadMailbox.hpp"
 #include "Definition.hpp"
 #include "logger/NetLogger.hpp"
 
@@ -40,6 +43,7 @@ typedef RedisReply RedisMsg;
 class Labor;
 class NetLogger;
 class SocketChannel;
+class RedisReplyView;
 
 class SocketChannelImpl: public Channel
 {
@@ -53,8 +57,18 @@ public:
 
     virtual E_CODEC_STATUS Send();
     virtual E_CODEC_STATUS Send(int32 iCmd, uint32 uiSeq, const MsgBody& oMsgBody);
+    /**
+     * @brief 发送后不再使用的包体：投递到对端信箱时用Swap()转移而不拷贝，
+     * 不经信箱时同Send(iCmd, uiSeq, const MsgBody&)
+     */
+    E_CODEC_STATUS Send(int32 iCmd, uint32 uiSeq, MsgBody&& oMsgBody);
     virtual E_CODEC_STATUS Send(const HttpMsg& oHttpMsg, uint32 uiStepSeq);
     virtual E_CODEC_STATUS Send(const RedisMsg& oRedisMsg, uint32 uiStepSeq);
+    /**
+     * @brief 批量发送redis命令
+     * @note 所有命令编码到发送缓冲后一次写出，每个命令各等待一个响应（pipeline）。
+     */
+    E_CODEC_STATUS Send(const std::vector<const RedisMsg*>& vecRedisMsg, uint32 uiStepSeq);
     virtual E_CODEC_STATUS Send(const char* pRaw, uint32 uiRawSize, uint32 uiStepSeq);
     virtual E_CODEC_STATUS Recv(MsgHead& oMsgHead, MsgBody& oMsgBody);
     virtual E_CODEC_STATUS Recv(HttpMsg& oHttpMsg);
@@ -65,7 +79,15 @@ public:
     E_CODEC_STATUS Fetch(RedisReply& oRedisReply);
     E_CODEC_STATUS Fetch(CBuffer& oRawBuff);
 
+    /**
+     * @brief 接收redis回复的只读视图
+     * @note 视图指向接收缓冲区，在同一通道下一次Recv()或Fetch()之前有效。
+     */
+    E_CODEC_STATUS Recv(const RedisReplyView*& pReplyView);
+    E_CODEC_STATUS Fetch(const RedisReplyView*& pReplyView);
+
     template <typename ...Targs> void Logger(int iLogLevel, const char* szFileName, unsigned int uiFileLine, const char* szFunction, Targs&&... args);
+    bool IsLogEnabled(int iLogLevel) const;
 
 public:
     int GetFd() const
@@ -149,6 +171,11 @@ public:
         return(m_mapStreamStepSeq);
     }
 
+    /**
+     * @brief HTTP/2连接上能否再发起请求（等待响应的流数量小于对端SETTINGS_MAX_CONCURRENT_STREAMS且未收到GOAWAY）
+     */
+    bool IsStreamAvailable() const;
+
     Labor* GetLabor()
     {
         return(m_pLabor);
@@ -192,6 +219,19 @@ public:
         m_bPipeline = bPipeline;
     }
 
+    /**
+     * @brief 设置连接是否合并写（默认取write_coalescing配置），对时延敏感的连接可单独关闭
+     */
+    void SetCork(bool bCork)
+    {
+        m_bCork = bCork;
+    }
+
+    bool IsCorkPending() const
+    {
+        return(m_bCorkPending);
+    }
+
     void SetClientData(const std::string& strClientData)
     {
         m_strClientData = strClientData;
@@ -220,11 +260,73 @@ public:
 
     virtual bool Close();
 
+    /**
+     * @brief 连接已关闭且io、timer事件均已停止，可以回收到SocketChannelPool
+     */
+    bool IsRecyclable() const;
+
+    /**
+     * @brief 按新连接重置（SocketChannelPool复用对象时调用）
+     * @note 清空连接标识、pipeline和stream等待的step、缓冲区，释放编解码器（由Init()
+     * 按新连接的编解码类型重新创建），保留已分配的缓冲区和事件watcher。
+     */
+    void Reset(int iFd, uint32 ulSeq, ev_tstamp dKeepAlive);
+
+    /**
+     * @brief 线程模型下把进程内通道（CODEC_NEBULA_IN_NODE）绑定到对端线程的信箱
+     * @note 绑定后Send(iCmd, uiSeq, oMsgBody)直接把消息投递到对端信箱，对端按iPeerFd
+     * 找到它那一端的SocketChannel分发；信箱满时仍走socket。
+     */
+    void SetThreadPeer(std::shared_ptr<ThreadMailbox> pPeerMailbox, int iPeerFd)
+    {
+        m_pPeerMailbox = pPeerMailbox;
+        m_iPeerFd = iPeerFd;
+    }
+
+    const std::shared_ptr<ThreadMailbox>& GetPeerMailbox() const
+    {
+        return(m_pPeerMailbox);
+    }
+
+    int GetPeerFd() const
+    {
+        return(m_iPeerFd);
+    }
+
+    /**
+     * @brief 发送合并写暂存在发送队列中的数据（由Dispatcher在事件循环进入等待前调用）
+     */
+    E_CODEC_STATUS Uncork();
+
 protected:
-    virtual int Write(CBuffer* pBuff, int& iErrno);
+    virtual int Write(CSendQueue* pSendQueue, int& iErrno);
     virtual int Read(CBuffer* pBuff, int& iErrno);
 
 private:
+    /**
+     * @brief 合并写：发送队列积压未达到合并写上限时不立即写socket，登记到Dispatcher
+     * 的待发送列表，在本轮事件循环进入等待前统一发送
+     * @return 是否已暂存（返回false时调用方立即发送）
+     */
+    bool Cork(int iNeedWriteLen);
+    /**
+     * @brief 信箱满改经socket发送之后，socket上的消息都已被对端读取才能恢复经信箱发送，
+     * 否则对端分别处理信箱和socket上的消息会导致乱序
+     */
+    bool IsSocketDrained() const;
+    bool IsPeerMailboxUsable() const;
+    /**
+     * @brief 投递到对端信箱，信箱满时记录改经socket发送，stItem保持不变
+     */
+    bool PostToPeer(tagMailItem& stItem);
+    E_CODEC_STATUS SendBySocket(int32 iCmd, uint32 uiSeq, const MsgBody& oMsgBody);
+    /**
+     * @brief 一批redis命令全部编码成功才保留在缓冲区中，任一命令编码失败时整批回退，
+     * 避免已编码的命令被发出却没有对应的step seq
+     */
+    E_CODEC_STATUS EncodeRedis(const RedisMsg* const* ppRedisMsg, uint32 uiMsgNum, CBuffer* pBuff);
+    E_CODEC_STATUS SendRedis(const RedisMsg* const* ppRedisMsg, uint32 uiMsgNum, uint32 uiStepSeq);
+
     uint8 m_ucChannelStatus;
     E_CODEC_STATUS m_eLastCodecStatus;    ///< 连接关闭前的最后一个编解码状态（当且仅当连接的应用层读缓冲区有数据未处理完而对端关闭连接时使用）
     char m_szErrBuff[256];
@@ -234,6 +336,9 @@ private:
     uint32 m_uiSeq;                       ///< 文件描述符创建时对应的序列号
     uint32 m_uiForeignSeq;                ///< 外来的seq，每个连接的包都是有序的，用作接入Server数据包检查，防止篡包
     uint32 m_bPipeline;                   ///< 是否支持pipeline
+    bool m_bCork;                         ///< 是否合并写
+    bool m_bCorkPending;                  ///< 是否已登记到Dispatcher的合并写待发送列表
+    bool m_bMailboxFallback;              ///< 线程模型下信箱满后是否正经socket发送
     uint32 m_uiUnitTimeMsgNum;            ///< 统计单位时间内接收消息数量
     uint32 m_uiMsgNum;                    ///< 接收消息数量
     ev_tstamp m_dActiveTime;              ///< 最后一次访问时间
@@ -241,11 +346,13 @@ private:
     ev_io* m_pIoWatcher;                  ///< 不在结构体析构时回收
     ev_timer* m_pTimerWatcher;            ///< 不在结构体析构时回收
     CBuffer* m_pRecvBuff;
-    CBuffer* m_pSendBuff;
+    CSendQueue* m_pSendQueue;             ///< 发送队列
     CBuffer* m_pWaitForSendBuff;    ///< 等待发送的数据缓冲区（数据到达时，连接并未建立，等连接建立并且pSendBuff发送完毕后立即发送）
     Codec* m_pCodec;                      ///< 编解码器
     HttpMsg* m_pHoldingHttpMsg;           // 如果有http协议转换
     int m_iErrno;
+    int m_iPeerFd;                        ///< 线程模型下对端线程中同一socketpair另一端的fd
+    std::shared_ptr<ThreadMailbox> m_pPeerMailbox;  ///< 线程模型下对端线程的信箱
     std::string m_strKey;                 ///< 密钥
     std::string m_strClientData;         ///< 客户端相关数据（例如IM里的用户昵称、头像等，登录或连接时保存起来，后续发消息或其他操作无须客户端再带上来）
     std::string m_strErrMsg;
@@ -259,6 +366,11 @@ private:
     std::shared_ptr<NetLogger> m_pLogger;
 };
 
+inline bool SocketChannelImpl::IsLogEnabled(int iLogLevel) const
+{
+    return(m_pLogger->IsLevelEnabled(iLogLevel));
+}
+
 template <typename ...Targs>
 void SocketChannelImpl::Logger(int iLogLevel, const char* szFileName, unsigned int uiFileLine, const char* szFunction, Targs&&... args)
 {
@@ -0,0 +1,78 @@
+/*******************************************************************************
+ * Project:  Nebula
+ * @file     SocketChannelPool.cpp
+ * @brief    SocketChannel对象池
+ * @author   Bwar
+ * @date:    2026年10月17日
+ * @note
+ * Modify history:
+ ******************************************************************************/
+
+#include "SocketChannelPool.hpp"
+
+namespace neb
+{
+
+SocketChannelPool::SocketChannelPool(std::shared_ptr<NetLogger> pLogger, uint32 uiMaxIdleNum)
+    : m_pLogger(pLogger), m_uiMaxIdleNum(uiMaxIdleNum)
+{
+    m_vecIdleChannel.reserve(m_uiMaxIdleNum);
+}
+
+SocketChannelPool::~SocketChannelPool()
+{
+    for (auto pChannel : m_vecIdleChannel)
+    {
+        delete pChannel;
+    }
+    m_vecIdleChannel.clear();
+}
+
+std::shared_ptr<SocketChannel> SocketChannelPool::Acquire(int iFd, uint32 uiSeq, ev_tstamp dKeepAlive)
+{
+    SocketChannel* pChannel = nullptr;
+    if (m_vecIdleChannel.empty())
+    {
+        pChannel = new SocketChannel(m_pLogger, iFd, uiSeq, false, dKeepAlive);
+        ++m_stStat.ullNew;
+    }
+    else
+    {
+        pChannel = m_vecIdleChannel.back();
+        m_vecIdleChannel.pop_back();
+        pChannel->m_pImpl->Reset(iFd, uiSeq, dKeepAlive);
+        ++m_stStat.ullReuse;
+    }
+    // 池先于连接销毁（如Dispatcher析构时仍有Actor持有连接）时，连接按原方式析构
+    std::weak_ptr<SocketChannelPool> pWeakPool = shared_from_this();
+    return(std::shared_ptr<SocketChannel>(pChannel,
+            [pWeakPool](SocketChannel* p){ SocketChannelPool::Recycle(pWeakPool, p); }));
+}
+
+void SocketChannelPool::Recycle(std::weak_ptr<SocketChannelPool> pWeakPool, SocketChannel* pChannel)
+{
+    std::shared_ptr<SocketChannelPool> pPool = pWeakPool.lock();
+    if (nullptr == pPool || !pPool->Push(pChannel))
+    {
+        delete pChannel;
+    }
+}
+
+bool SocketChannelPool::Push(SocketChannel* pChannel)
+{
+    if (m_vecIdleChannel.size() >= m_uiMaxIdleNum)
+    {
+        return(false);
+    }
+    if (!pChannel->m_pImpl->IsRecyclable())
+    {
+        return(false);
+    }
+    // 回收时即释放连接相关的状态和大块缓冲区，池中空闲对象只保留小块内存
+    pChannel->m_pImpl->Reset(-1, 0, 0.0);
+    m_vecIdleChannel.push_back(pChannel);
+    ++m_stStat.ullRecycle;
+    return(true);
+}
+
+} /* namespace neb */
@@ -0,0 +1,73 @@
+/*******************************************************************************
+ * Project:  Nebula
+ * @file     SocketChannelPool.hpp
+ * @brief    SocketChannel对象池
+ * @author   Bwar
+ * @date:    2026年10月17日
+ * @note     每个Dispatcher一个池，只在Dispatcher所在线程使用。通过Acquire()得到的
+ * SocketChannel在最后一个shared_ptr释放时回到池中（连接须已关闭且io、timer事件
+ * 已停止），连同其SocketChannelImpl、读写缓冲区和事件watcher一起被下一个连接复用。
+ * SSL连接带有SSL会话状态，不经过对象池。
+ * Modify history:
+ ******************************************************************************/
+#ifndef SRC_CHANNEL_SOCKETCHANNELPOOL_HPP_
+#define SRC_CHANNEL_SOCKETCHANNELPOOL_HPP_
+
+#include <memory>
+#include <vector>
+#include "SocketChannel.hpp"
+
+namespace neb
+{
+
+class SocketChannelPool: public std::enable_shared_from_this<SocketChannelPool>
+{
+public:
+    struct tagStat
+    {
+        uint64 ullReuse = 0;            ///< 从池中复用的次数
+        uint64 ullNew = 0;              ///< 池中无空闲对象而新建的次数
+        uint64 ullRecycle = 0;          ///< 回收到池中的次数
+    };
+
+    SocketChannelPool(std::shared_ptr<NetLogger> pLogger, uint32 uiMaxIdleNum);
+    SocketChannelPool(const SocketChannelPool&) = delete;
+    SocketChannelPool& operator=(const SocketChannelPool&) = delete;
+    ~SocketChannelPool();
+
+    /**
+     * @brief 取一个（非SSL）SocketChannel，返回前已按新连接重置，尚需调用Init()
+     */
+    std::shared_ptr<SocketChannel> Acquire(int iFd, uint32 uiSeq, ev_tstamp dKeepAlive);
+
+    uint32 GetIdleNum() const
+    {
+        return(m_vecIdleChannel.size());
+    }
+
+    const tagStat& GetStat() const
+    {
+        return(m_stStat);
+    }
+
+    void ResetStat()
+    {
+        m_stStat.ullReuse = 0;
+        m_stStat.ullNew = 0;
+        m_stStat.ullRecycle = 0;
+    }
+
+private:
+    static void Recycle(std::weak_ptr<SocketChannelPool> pWeakPool, SocketChannel* pChannel);
+    bool Push(SocketChannel* pChannel);
+
+private:
+    std::shared_ptr<NetLogger> m_pLogger;
+    uint32 m_uiMaxIdleNum;
+    std::vector<SocketChannel*> m_vecIdleChannel;
+    tagStat m_stStat;
+};
+
+} /* namespace neb */
+
+#endif /* SRC_CHANNEL_SOCKETCHANNELPOOL_HPP_ */
@@ -9,6 +9,10 @@
  ******************************************************************************/
 
 #ifdef WITH_OPENSSL
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <sstream>
 #include "SocketChannelSslImpl.hpp"
 
 namespace neb
@@ -16,11 +20,16 @@ namespace neb
 
 SSL_CTX* SocketChannelSslImpl::s_pServerSslCtx = NULL;
 SSL_CTX* SocketChannelSslImpl::s_pClientSslCtx = NULL;
+tagSslSessionConf SocketChannelSslImpl::s_stSessionConf;
+std::string SocketChannelSslImpl::s_strTicketSecret;
+std::mutex SocketChannelSslImpl::s_mutexClientSession;
+std::unordered_map<std::string, SSL_SESSION*> SocketChannelSslImpl::s_mapClientSession;
 
 SocketChannelSslImpl::SocketChannelSslImpl(
     SocketChannel* pSocketChannel, std::shared_ptr<NetLogger> pLogger, int iFd, uint32 ulSeq, ev_tstamp dKeepAlive)
     : SocketChannelImpl(pSocketChannel, pLogger, iFd, ulSeq, dKeepAlive),
-      m_eSslChannelStatus(SSL_CHANNEL_INIT), m_bIsClientConnection(false), m_pSslConnection(NULL)
+      m_eSslChannelStatus(SSL_CHANNEL_INIT), m_bIsClientConnection(false), m_bSessionOffered(false),
+      m_pSslConnection(NULL)
 {
 }
 
@@ -143,6 +152,79 @@ int SocketChannelSslImpl::SslServerCertificate(std::shared_ptr<NetLogger> pLogge
     return(ERR_OK);
 }
 
+int SocketChannelSslImpl::SslSessionCreate(std::shared_ptr<NetLogger> pLogger, const tagSslSessionConf& stConf)
+{
+    s_stSessionConf = stConf;
+    if (s_stSessionConf.uiTicketRotate == 0)
+    {
+        s_stSessionConf.uiTicketRotate = 3600;
+    }
+#ifndef SSL_OP_ENABLE_KTLS
+    if (s_stSessionConf.bKtls)
+    {
+        pLogger->WriteLog(neb::Logger::WARNING, __FILE__, __LINE__, __FUNCTION__,
+            "ktls was configured but the openssl version does not support it, ignored.");
+    }
+#endif
+    if (s_pServerSslCtx == NULL)
+    {
+        return(ERR_OK);
+    }
+
+    static const unsigned char s_szSessionIdContext[] = "nebula";
+    SSL_CTX_set_session_id_context(s_pServerSslCtx, s_szSessionIdContext, sizeof(s_szSessionIdContext) - 1);
+    SSL_CTX_set_timeout(s_pServerSslCtx, s_stSessionConf.uiSessionTimeout);
+    if (s_stSessionConf.uiServerCacheSize > 0)
+    {
+        SSL_CTX_set_session_cache_mode(s_pServerSslCtx, SSL_SESS_CACHE_SERVER);
+        SSL_CTX_sess_set_cache_size(s_pServerSslCtx, s_stSessionConf.uiServerCacheSize);
+    }
+    else
+    {
+        SSL_CTX_set_session_cache_mode(s_pServerSslCtx, SSL_SESS_CACHE_OFF);
+    }
+
+    if (s_stSessionConf.strTicketSecretFile.length() > 0)
+    {
+        std::ifstream fin(s_stSessionConf.strTicketSecretFile.c_str(), std::ios::in | std::ios::binary);
+        if (!fin.good())
+        {
+            pLogger->WriteLog(neb::Logger::ERROR, __FILE__, __LINE__, __FUNCTION__,
+                "failed to open session ticket secret file \"%s\"!", s_stSessionConf.strTicketSecretFile.c_str());
+            return(ERR_SSL_CTX);
+        }
+        std::ostringstream oss;
+        oss << fin.rdbuf();
+        s_strTicketSecret = oss.str();
+        if (s_strTicketSecret.size() < 32)
+        {
+            pLogger->WriteLog(neb::Logger::ERROR, __FILE__, __LINE__, __FUNCTION__,
+                "session ticket secret file \"%s\" must contain at least 32 bytes!",
+                s_stSessionConf.strTicketSecretFile.c_str());
+            return(ERR_SSL_CTX);
+        }
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+        SSL_CTX_set_tlsext_ticket_key_evp_cb(s_pServerSslCtx, SslTicketKeyCallback);
+#else
+        SSL_CTX_set_tlsext_ticket_key_cb(s_pServerSslCtx, SslTicketKeyCallback);
+#endif
+    }
+
+    else
+    {
+        pLogger->WriteLog(neb::Logger::WARNING, __FILE__, __LINE__, __FUNCTION__,
+                "no session ticket secret file configured, in process mode ssl sessions "
+                "can only be resumed on the worker that created them.");
+    }
+
+    SslSetKtls(s_pServerSslCtx);
+    pLogger->WriteLog(neb::Logger::INFO, __FILE__, __LINE__, __FUNCTION__,
+            "ssl session cache size %u, session timeout %u, ticket secret file \"%s\", ktls %d",
+            s_stSessionConf.uiServerCacheSize, s_stSessionConf.uiSessionTimeout,
+            s_stSessionConf.strTicketSecretFile.c_str(), s_stSessionConf.bKtls);
+    return(ERR_OK);
+}
+
 void SocketChannelSslImpl::SslFree()
 {
     if (s_pServerSslCtx)
@@ -155,6 +237,12 @@ void SocketChannelSslImpl::SslFree()
         SSL_CTX_free(s_pClientSslCtx);
         s_pClientSslCtx = NULL;
     }
+    std::lock_guard<std::mutex> oLock(s_mutexClientSession);
+    for (auto iter = s_mapClientSession.begin(); iter != s_mapClientSession.end(); ++iter)
+    {
+        SSL_SESSION_free(iter->second);
+    }
+    s_mapClientSession.clear();
 }
 
 int SocketChannelSslImpl::SslClientCtxCreate()
@@ -167,6 +255,13 @@ int SocketChannelSslImpl::SslClientCtxCreate()
             LOG4_ERROR("SSL_CTX_new() failed!");
             return(ERR_SSL_CTX);
         }
+        if (s_stSessionConf.uiClientCacheSize > 0)
+        {
+            // 会话由SslClientSessionNew()按连接标识保存，不使用OpenSSL的内部缓存（客户端不会查找它）
+            SSL_CTX_set_session_cache_mode(s_pClientSslCtx, SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL_STORE);
+            SSL_CTX_sess_set_new_cb(s_pClientSslCtx, SslClientSessionNew);
+        }
+        SslSetKtls(s_pClientSslCtx);
     }
     return(ERR_OK);
 }
@@ -193,6 +288,9 @@ int SocketChannelSslImpl::SslCreateConnection()
         LOG4_ERROR("SSL_set_fd() failed!");
         return(ERR_SSL_NEW_CONNECTION);
     }
+    SSL_set_app_data(m_pSslConnection, this);
+    // 发送队列中的数据在SSL_write()重试之间可能被移动（借用数据Retain()或队尾缓冲区扩容）
+    SSL_set_mode(m_pSslConnection, SSL_MODE_ACCEPT_MOVING_WRITE_BUFFER);
 
     if (m_bIsClientConnection)
     {
@@ -209,10 +307,21 @@ int SocketChannelSslImpl::SslCreateConnection()
 int SocketChannelSslImpl::SslHandshake()
 {
     LOG4_TRACE("");
+    if (m_bIsClientConnection && SSL_in_before(m_pSslConnection))
+    {
+        // 连接标识在Init()之后才设置，所以在发出ClientHello之前才查找缓存的会话
+        SslClientSessionResume();
+    }
     int iHandshakeResult = SSL_do_handshake(m_pSslConnection);
     if (iHandshakeResult == 1)
     {
-        LOG4_TRACE("fd %d ssl handshake was successful.", GetFd());
+#ifdef BIO_get_ktls_send
+        LOG4_TRACE("fd %d ssl handshake was successful, session reused %d, ktls send %d.", GetFd(),
+                SSL_session_reused(m_pSslConnection), (int)BIO_get_ktls_send(SSL_get_wbio(m_pSslConnection)));
+#else
+        LOG4_TRACE("fd %d ssl handshake was successful, session reused %d.", GetFd(),
+                SSL_session_reused(m_pSslConnection));
+#endif
         m_eSslChannelStatus = SSL_CHANNEL_ESTABLISHED;
         return(ERR_OK);
     }
@@ -269,6 +378,7 @@ int SocketChannelSslImpl::SslHandshake()
                 }
             case SSL_ERROR_SSL:
                 LOG4_ERROR("A failure in the SSL library occurred, usually a protocol error. The OpenSSL error queue contains more information on the error.");
+                SslClientSessionDrop();
                 return(ERR_SSL_HANDSHAKE);
             case SSL_ERROR_NONE:    // if and only if iHandshakeResult > 0
                 break;
@@ -374,15 +484,6 @@ int SocketChannelSslImpl::SslShutdown()
         m_eSslChannelStatus = SSL_CHANNEL_SHUTDOWN;
     }
 
-    if (m_bIsClientConnection)
-    {
-        SSL_CTX_remove_session(s_pClientSslCtx, SSL_get0_session(m_pSslConnection));
-    }
-    else
-    {
-        SSL_CTX_remove_session(s_pServerSslCtx, SSL_get0_session(m_pSslConnection));
-    }
-
     SSL_free(m_pSslConnection);
     m_pSslConnection = NULL;
 
@@ -398,6 +499,173 @@ int SocketChannelSslImpl::SslShutdown()
     return(ERR_OK);
 }
 
+void SocketChannelSslImpl::SslClientSessionResume()
+{
+    if (s_stSessionConf.uiClientCacheSize == 0 || GetIdentify().empty())
+    {
+        return;
+    }
+    std::lock_guard<std::mutex> oLock(s_mutexClientSession);
+    auto iter = s_mapClientSession.find(GetIdentify());
+    if (iter != s_mapClientSession.end())
+    {
+        m_bSessionOffered = (SSL_set_session(m_pSslConnection, iter->second) == 1);
+    }
+}
+
+void SocketChannelSslImpl::SslClientSessionDrop()
+{
+    if (!m_bSessionOffered)
+    {
+        return;
+    }
+    // 带着缓存的会话握手失败，丢弃该会话，下次重连做完整握手
+    std::lock_guard<std::mutex> oLock(s_mutexClientSession);
+    auto iter = s_mapClientSession.find(GetIdentify());
+    if (iter != s_mapClientSession.end())
+    {
+        SSL_SESSION_free(iter->second);
+        s_mapClientSession.erase(iter);
+    }
+    m_bSessionOffered = false;
+}
+
+void SocketChannelSslImpl::SslSetKtls(SSL_CTX* pSslCtx)
+{
+#ifdef SSL_OP_ENABLE_KTLS
+    if (s_stSessionConf.bKtls)
+    {
+        // 内核或加密套件不支持时OpenSSL自动回退到用户态加密
+        SSL_CTX_set_options(pSslCtx, SSL_OP_ENABLE_KTLS);
+    }
+#endif
+}
+
+int SocketChannelSslImpl::SslClientSessionNew(SSL* pSsl, SSL_SESSION* pSession)
+{
+    SocketChannelSslImpl* pChannel = (SocketChannelSslImpl*)SSL_get_app_data(pSsl);
+    if (pChannel == NULL || pChannel->GetIdentify().empty())
+    {
+        return(0);
+    }
+#if OPENSSL_VERSION_NUMBER >= 0x10101000L
+    if (!SSL_SESSION_is_resumable(pSession))
+    {
+        return(0);
+    }
+#endif
+    std::lock_guard<std::mutex> oLock(s_mutexClientSession);
+    auto iter = s_mapClientSession.find(pChannel->GetIdentify());
+    if (iter != s_mapClientSession.end())
+    {
+        SSL_SESSION_free(iter->second);
+        iter->second = pSession;
+    }
+    else
+    {
+        if (s_mapClientSession.size() >= s_stSessionConf.uiClientCacheSize)
+        {
+            SSL_SESSION_free(s_mapClientSession.begin()->second);
+            s_mapClientSession.erase(s_mapClientSession.begin());
+        }
+        s_mapClientSession.insert(std::make_pair(pChannel->GetIdentify(), pSession));
+    }
+    return(1);      // 返回1表示会话的引用由回调持有
+}
+
+bool SocketChannelSslImpl::SslTicketKeyDerive(uint64 ullPeriod, unsigned char* pKeyName,
+        unsigned char* pAesKey, unsigned char* pHmacKey)
+{
+    // key_name 16字节、AES-256密钥32字节、HMAC-SHA256密钥32字节，分别由共享密钥对“用途标签+周期”做HMAC得到
+    static const char* s_szLabel[3] = {"nebula tk name", "nebula tk aes", "nebula tk hmac"};
+    unsigned char* pOutput[3] = {pKeyName, pAesKey, pHmacKey};
+    size_t uiOutputLen[3] = {16, 32, 32};
+    unsigned char szMessage[32];
+    unsigned char szDigest[EVP_MAX_MD_SIZE];
+    unsigned int uiDigestLen = 0;
+    for (int i = 0; i < 3; ++i)
+    {
+        size_t uiLabelLen = strlen(s_szLabel[i]);
+        memcpy(szMessage, s_szLabel[i], uiLabelLen);
+        for (int j = 0; j < 8; ++j)
+        {
+            szMessage[uiLabelLen + j] = (unsigned char)(ullPeriod >> (56 - j * 8));
+        }
+        if (NULL == HMAC(EVP_sha256(), s_strTicketSecret.data(), (int)s_strTicketSecret.size(),
+                szMessage, uiLabelLen + 8, szDigest, &uiDigestLen))
+        {
+            return(false);
+        }
+        memcpy(pOutput[i], szDigest, uiOutputLen[i]);
+    }
+    return(true);
+}
+
+bool SocketChannelSslImpl::SslTicketHmacInit(SslTicketHmacCtx* pHmacCtx, const unsigned char* pHmacKey)
+{
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+    OSSL_PARAM astParams[2];
+    astParams[0] = OSSL_PARAM_construct_utf8_string(OSSL_MAC_PARAM_DIGEST, const_cast<char*>("SHA256"), 0);
+    astParams[1] = OSSL_PARAM_construct_end();
+    return(EVP_MAC_CTX_set_params(pHmacCtx, astParams) == 1
+            && EVP_MAC_init(pHmacCtx, pHmacKey, 32, NULL) == 1);
+#else
+    return(HMAC_Init_ex(pHmacCtx, pHmacKey, 32, EVP_sha256(), NULL) == 1);
+#endif
+}
+
+int SocketChannelSslImpl::SslTicketKeyCallback(SSL* pSsl, unsigned char* pKeyName, unsigned char* pIv,
+        EVP_CIPHER_CTX* pCipherCtx, SslTicketHmacCtx* pHmacCtx, int iEncrypt)
+{
+    unsigned char szKeyName[16];
+    unsigned char szAesKey[32];
+    unsigned char szHmacKey[32];
+    uint64 ullPeriod = (uint64)time(NULL) / s_stSessionConf.uiTicketRotate;
+    if (iEncrypt == 1)
+    {
+        if (!SslTicketKeyDerive(ullPeriod, szKeyName, szAesKey, szHmacKey)
+                || RAND_bytes(pIv, EVP_CIPHER_iv_length(EVP_aes_256_cbc())) != 1
+                || EVP_EncryptInit_ex(pCipherCtx, EVP_aes_256_cbc(), NULL, szAesKey, pIv) != 1
+                || !SslTicketHmacInit(pHmacCtx, szHmacKey))
+        {
+            return(-1);
+        }
+        memcpy(pKeyName, szKeyName, sizeof(szKeyName));
+        return(1);
+    }
+
+    // 在ticket有效期覆盖的周期内查找密钥，多查下一个周期以容忍节点之间的时钟偏差
+    int64 llOldest = -(int64)(s_stSessionConf.uiSessionTimeout / s_stSessionConf.uiTicketRotate) - 1;
+    for (int64 i = 1; i >= llOldest; --i)
+    {
+        if ((int64)ullPeriod + i < 0)
+        {
+            break;
+        }
+        if (!SslTicketKeyDerive(ullPeriod + i, szKeyName, szAesKey, szHmacKey))
+        {
+            return(-1);
+        }
+        if (memcmp(pKeyName, szKeyName, sizeof(szKeyName)) != 0)
+        {
+            continue;
+        }
+        if (EVP_DecryptInit_ex(pCipherCtx, EVP_aes_256_cbc(), NULL, szAesKey, pIv) != 1
+                || !SslTicketHmacInit(pHmacCtx, szHmacKey))
+        {
+            return(-1);
+        }
+        // 返回2：解密成功且需要签发新ticket。旧周期密钥加密的ticket需要换新；TLSv1.3客户端的会话
+        // 只能用一次，返回1时OpenSSL在复用握手之后不再签发ticket，客户端下次重连只能完整握手
+        if (i < 0 || SSL_version(pSsl) >= TLS1_3_VERSION)
+        {
+            return(2);
+        }
+        return(1);
+    }
+    return(0);
+}
+
 bool SocketChannelSslImpl::Init(E_CODEC_TYPE eCodecType, bool bIsClient)
 {
     if (!SocketChannelImpl::Init(eCodecType, bIsClient))
@@ -833,14 +1101,19 @@ bool SocketChannelSslImpl::Close()
     return(SocketChannelImpl::Close());
 }
 
-int SocketChannelSslImpl::Write(CBuffer* pBuff, int& iErrno)
+int SocketChannelSslImpl::Write(CSendQueue* pSendQueue, int& iErrno)
 {
     LOG4_TRACE("");
-    int iNeedWriteLen = (int)pBuff->ReadableBytes();
-    int iWritenLen = SSL_write(m_pSslConnection, pBuff->GetRawReadBuffer(), iNeedWriteLen);
+    size_t uiNeedWriteLen = 0;
+    const char* pData = pSendQueue->Front(uiNeedWriteLen);
+    if (nullptr == pData)
+    {
+        return(0);
+    }
+    int iWritenLen = SSL_write(m_pSslConnection, pData, (int)uiNeedWriteLen);
     if (iWritenLen > 0)
     {
-        pBuff->AdvanceReadIndex(iWritenLen);
+        pSendQueue->Skip(iWritenLen);
     }
     else
     {
@@ -29,7 +29,12 @@
 #include <openssl/rsa.h>
 #include <openssl/x509.h>
 #include <openssl/x509v3.h>
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+#include <openssl/core_names.h>
+#endif
 
+#include <mutex>
+#include <unordered_map>
 #include "SocketChannelImpl.hpp"
 
 namespace neb 
@@ -45,6 +50,29 @@ enum E_SSL_CHANNEL_STATUS
     SSL_CHANNEL_SHUTING_WANT_WRITE      = 5,        ///< SslShutDown() in progress
     SSL_CHANNEL_SHUTDOWN                = 6,        ///< SslShutDown() done
 };
+
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+typedef EVP_MAC_CTX SslTicketHmacCtx;
+#else
+typedef HMAC_CTX SslTicketHmacCtx;
+#endif
+
+/**
+ * @brief SSL会话复用配置
+ * @note 进程模式下每个Worker是独立进程，OpenSSL内置的服务端会话缓存只在本Worker内有效，
+ * 客户端重连到其他Worker时只能靠session ticket复用。配置了strTicketSecretFile时，
+ * ticket密钥由该文件内容和时间周期派生，同一集群所有Worker（包括其他节点）使用同一
+ * 文件即可得到相同的密钥，并每uiTicketRotate秒自动轮换，不需要在Worker之间分发密钥。
+ */
+struct tagSslSessionConf
+{
+    uint32 uiServerCacheSize = 20480;   ///< 服务端会话缓存条数，0为关闭服务端会话缓存
+    uint32 uiSessionTimeout = 300;      ///< 会话（包括ticket）有效期，单位秒
+    uint32 uiTicketRotate = 3600;       ///< ticket密钥轮换周期，单位秒
+    uint32 uiClientCacheSize = 1024;    ///< 客户端按连接标识缓存的会话条数，0为不复用
+    bool bKtls = false;                 ///< 启用内核TLS（SSL_OP_ENABLE_KTLS），由内核完成记录加密
+    std::string strTicketSecretFile;    ///< ticket密钥派生用的共享密钥文件，为空则使用OpenSSL为每个进程随机生成的密钥（进程模式下跨Worker复用会话必须配置）
+};
     
 class SocketChannelSslImpl : public SocketChannelImpl 
 {
@@ -56,6 +84,7 @@ public:
     static int SslServerCtxCreate(std::shared_ptr<NetLogger> pLogger);
     static int SslServerCertificate(std::shared_ptr<NetLogger> pLogger,
                 const std::string& strCertFile, const std::string& strKeyFile);
+    static int SslSessionCreate(std::shared_ptr<NetLogger> pLogger, const tagSslSessionConf& stConf);
     static void SslFree();
 
     int SslClientCtxCreate();
@@ -73,16 +102,32 @@ public:
     virtual bool Close() override;
 
 protected:
-    virtual int Write(CBuffer* pBuff, int& iErrno) override;
+    virtual int Write(CSendQueue* pSendQueue, int& iErrno) override;
     virtual int Read(CBuffer* pBuff, int& iErrno) override;
 
+private:
+    void SslClientSessionResume();
+    void SslClientSessionDrop();
+    static void SslSetKtls(SSL_CTX* pSslCtx);
+    static int SslClientSessionNew(SSL* pSsl, SSL_SESSION* pSession);
+    static bool SslTicketKeyDerive(uint64 ullPeriod, unsigned char* pKeyName,
+            unsigned char* pAesKey, unsigned char* pHmacKey);
+    static bool SslTicketHmacInit(SslTicketHmacCtx* pHmacCtx, const unsigned char* pHmacKey);
+    static int SslTicketKeyCallback(SSL* pSsl, unsigned char* pKeyName, unsigned char* pIv,
+            EVP_CIPHER_CTX* pCipherCtx, SslTicketHmacCtx* pHmacCtx, int iEncrypt);
+
 private: 
     E_SSL_CHANNEL_STATUS m_eSslChannelStatus;
     bool m_bIsClientConnection;
+    bool m_bSessionOffered;             ///< 客户端连接握手时带上了缓存的会话
     SSL* m_pSslConnection;
 
     static SSL_CTX* s_pServerSslCtx;
     static SSL_CTX* s_pClientSslCtx;
+    static tagSslSessionConf s_stSessionConf;
+    static std::string s_strTicketSecret;
+    static std::mutex s_mutexClientSession;     ///< 线程模型下各Worker共用客户端SSL_CTX和会话缓存
+    static std::unordered_map<std::string, SSL_SESSION*> s_mapClientSession;
 };
 
 }
@@ -0,0 +1,158 @@
+/*******************************************************************************
+ * Project:  Nebula
+ * @file     ThreadMailbox.cpp
+ * @brief    线程模型下Labor之间的进程内消息队列
+ * @author   Bwar
+ * @date:    2026年10月17日
+ * @note
+ * Modify history:
+ ******************************************************************************/
+#include <unistd.h>
+#include <sched.h>
+#include <sys/eventfd.h>
+#include <cerrno>
+#include <utility>
+#include "ThreadMailbox.hpp"
+
+namespace neb
+{
+
+void tagMailItem::Swap(tagMailItem& stOther)
+{
+    std::swap(iFd, stOther.iFd);
+    std::swap(iTransferFd, stOther.iTransferFd);
+    std::swap(iAiFamily, stOther.iAiFamily);
+    std::swap(iCodecType, stOther.iCodecType);
+    oMsgHead.Swap(&stOther.oMsgHead);
+    oMsgBody.Swap(&stOther.oMsgBody);
+    strRemoteAddr.swap(stOther.strRemoteAddr);
+}
+
+void tagMailItem::Clear()
+{
+    iFd = -1;
+    iTransferFd = -1;
+    iAiFamily = 0;
+    iCodecType = 0;
+    oMsgHead.Clear();
+    oMsgBody.Clear();       // Clear()保留已分配的内存，供下一次投递复用
+    strRemoteAddr.clear();
+}
+
+ThreadMailbox::ThreadMailbox(uint32 uiCapacity)
+    : m_pCells(nullptr), m_ullMask(0), m_iEventFd(-1),
+      m_ullEnqueuePos(0), m_bNotified(false), m_ullDequeuePos(0)
+{
+    uint64 ullCapacity = 64;
+    while (ullCapacity < uiCapacity)     // 取2的幂，位置取模用位运算
+    {
+        ullCapacity <<= 1;
+    }
+    m_ullMask = ullCapacity - 1;
+    m_pCells = new tagCell[ullCapacity];
+    for (uint64 i = 0; i < ullCapacity; ++i)
+    {
+        m_pCells[i].ullSequence.store(i, std::memory_order_relaxed);
+    }
+}
+
+ThreadMailbox::~ThreadMailbox()
+{
+    // 未被取走的移交连接由信箱关闭
+    tagMailItem stItem;
+    while (Fetch(stItem))
+    {
+        if (stItem.iTransferFd >= 0)
+        {
+            close(stItem.iTransferFd);
+        }
+    }
+    if (m_iEventFd >= 0)
+    {
+        close(m_iEventFd);
+    }
+    delete[] m_pCells;
+}
+
+bool ThreadMailbox::Init()
+{
+    m_iEventFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    return(m_iEventFd >= 0);
+}
+
+bool ThreadMailbox::Post(tagMailItem& stItem)
+{
+    tagCell* pCell = nullptr;
+    uint64 ullPos = m_ullEnqueuePos.load(std::memory_order_relaxed);
+    while (true)
+    {
+        pCell = &m_pCells[ullPos & m_ullMask];
+        uint64 ullSequence = pCell->ullSequence.load(std::memory_order_acquire);
+        int64 llDiff = (int64)ullSequence - (int64)ullPos;
+        if (llDiff == 0)
+        {
+            if (m_ullEnqueuePos.compare_exchange_weak(ullPos, ullPos + 1, std::memory_order_relaxed))
+            {
+                break;
+            }
+        }
+        else if (llDiff < 0)
+        {
+            return(false);      // 队列满
+        }
+        else
+        {
+            ullPos = m_ullEnqueuePos.load(std::memory_order_relaxed);
+        }
+    }
+    pCell->stItem.Swap(stItem);
+    pCell->ullSequence.store(ullPos + 1, std::memory_order_release);
+
+    if (!m_bNotified.exchange(true))
+    {
+        uint64 ullOne = 1;
+        while (write(m_iEventFd, &ullOne, sizeof(ullOne)) < 0 && EINTR == errno)
+        {
+        }
+    }
+    return(true);
+}
+
+bool ThreadMailbox::Fetch(tagMailItem& stItem)
+{
+    tagCell* pCell = &m_pCells[m_ullDequeuePos & m_ullMask];
+    if (pCell->ullSequence.load(std::memory_order_acquire) != m_ullDequeuePos + 1)
+    {
+        return(false);
+    }
+    stItem.Swap(pCell->stItem);
+    pCell->stItem.Clear();
+    pCell->ullSequence.store(m_ullDequeuePos + m_ullMask + 1, std::memory_order_release);
+    ++m_ullDequeuePos;
+    return(true);
+}
+
+bool ThreadMailbox::FetchUntil(tagMailItem& stItem, uint64 ullUntilPos)
+{
+    while (m_ullDequeuePos < ullUntilPos)
+    {
+        if (Fetch(stItem))
+        {
+            return(true);
+        }
+        sched_yield();      // 生产者已占用该位置，正在写入
+    }
+    return(false);
+}
+
+void ThreadMailbox::ClearNotify()
+{
+    uint64 ullCount = 0;
+    while (read(m_iEventFd, &ullCount, sizeof(ullCount)) < 0 && EINTR == errno)
+    {
+    }
+    // 先清标志再取队列：清标志之后的投递会重新写eventfd，不会丢失唤醒
+    m_bNotified.store(false);
+}
+
+} /* namespace neb */
@@ -0,0 +1,109 @@
+/*******************************************************************************
+ * Project:  Nebula
+ * @file     ThreadMailbox.hpp
+ * @brief    线程模型下Labor之间的进程内消息队列
+ * @author   Bwar
+ * @date:    2026年10月17日
+ * @note     thread_mode下每个Labor（Manager、Worker、Loader）的Dispatcher拥有一个信箱：
+ * 有界多生产者单消费者无锁队列加一个eventfd。其他线程把MsgHead、MsgBody（通过
+ * Swap转移，不做protobuf编解码）或移交的客户端连接fd投递到信箱，必要时写eventfd
+ * 唤醒信箱所属线程的事件循环，由该线程取出并分发。
+ * Modify history:
+ ******************************************************************************/
+#ifndef SRC_CHANNEL_THREADMAILBOX_HPP_
+#define SRC_CHANNEL_THREADMAILBOX_HPP_
+
+#include <atomic>
+#include <string>
+#include "Definition.hpp"
+#include "pb/msg.pb.h"
+
+namespace neb
+{
+
+struct tagMailItem
+{
+    int iFd                 = -1;       ///< 接收方的通道fd，消息按此fd对应的SocketChannel分发
+    int iTransferFd         = -1;       ///< 移交给接收方的客户端连接fd，-1表示这是一条消息
+    int iAiFamily           = 0;        ///< 移交连接的地址族
+    int iCodecType          = 0;        ///< 移交连接的编解码类型
+    MsgHead oMsgHead;
+    MsgBody oMsgBody;
+    std::string strRemoteAddr;          ///< 移交连接的对端地址，接收方无需再getpeername
+
+    void Swap(tagMailItem& stOther);
+    void Clear();
+};
+
+class ThreadMailbox
+{
+public:
+    explicit ThreadMailbox(uint32 uiCapacity);
+    ThreadMailbox(const ThreadMailbox&) = delete;
+    ThreadMailbox& operator=(const ThreadMailbox&) = delete;
+    ~ThreadMailbox();
+
+    /**
+     * @brief 创建eventfd
+     */
+    bool Init();
+
+    int GetEventFd() const
+    {
+        return(m_iEventFd);
+    }
+
+    /**
+     * @brief 投递（任意线程调用）
+     * @note 成功时stItem的内容被交换进队列，stItem变为队列中原有的空闲对象
+     * @return 队列满时返回false，stItem保持不变，由调用方改走socket通道
+     */
+    bool Post(tagMailItem& stItem);
+
+    /**
+     * @brief 取出一个（只能由信箱所属线程调用）
+     * @return 队列为空时返回false
+     */
+    bool Fetch(tagMailItem& stItem);
+
+    /**
+     * @brief 取出一个，位置在ullUntilPos之前的投递已占用位置但尚未写完时等待其写完
+     * （只能由信箱所属线程调用）
+     * @param ullUntilPos 通常为GetEnqueuePos()的快照，保证快照之前的投递都被取出
+     * @return 已取到ullUntilPos时返回false
+     */
+    bool FetchUntil(tagMailItem& stItem, uint64 ullUntilPos);
+
+    /**
+     * @brief 已被投递占用的位置数（包括尚未写完的投递）
+     */
+    uint64 GetEnqueuePos() const
+    {
+        return(m_ullEnqueuePos.load(std::memory_order_acquire));
+    }
+
+    /**
+     * @brief 消费eventfd上的唤醒通知（只能由信箱所属线程调用，须在Fetch()取空队列之前调用）
+     */
+    void ClearNotify();
+
+private:
+    struct tagCell
+    {
+        std::atomic<uint64> ullSequence;
+        tagMailItem stItem;
+    };
+
+    tagCell* m_pCells;
+    uint64 m_ullMask;
+    int m_iEventFd;
+    char m_szPadding1[64];                  ///< 生产者、消费者位置分处不同缓存行，避免伪共享
+    std::atomic<uint64> m_ullEnqueuePos;
+    std::atomic<bool> m_bNotified;          ///< 已写eventfd且消费者尚未响应，期间的投递不再写eventfd
+    char m_szPadding2[64];
+    uint64 m_ullDequeuePos;                 ///< 只在消费者线程中访问
+};
+
+} /* namespace neb */
+
+#endif /* SRC_CHANNEL_THREADMAILBOX_HPP_ */
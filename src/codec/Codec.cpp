@@ -245,4 +245,27 @@ bool Codec::AesDecrypt(const std::string& strSrc, std::string& strDest)
     return(CodecUtil::AesDecrypt(GetKey(), strSrc, strDest));
 }
 
+bool Codec::SerializeToBuffer(const google::protobuf::MessageLite& oMsg, int iByteSize, CBuffer* pBuff)
+{
+    if (iByteSize <= 0)
+    {
+        return(0 == iByteSize);
+    }
+    if (!pBuff->EnsureWritableBytes(iByteSize))
+    {
+        LOG4_ERROR("pBuff->EnsureWritableBytes(%d) failed!", iByteSize);
+        return(false);
+    }
+    uint8* pWrite = (uint8*)pBuff->GetRawWriteBuffer();
+    uint8* pEnd = oMsg.SerializeWithCachedSizesToArray(pWrite);
+    if (pEnd - pWrite != iByteSize)
+    {
+        LOG4_ERROR("serialized size %d != ByteSize() %d, message modified after ByteSize()?",
+                (int)(pEnd - pWrite), iByteSize);
+        return(false);
+    }
+    pBuff->AdvanceWriteIndex(iByteSize);
+    return(true);
+}
+
 } /* namespace neb */
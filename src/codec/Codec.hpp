@@ -17,6 +17,7 @@
 #include <vector>
 #include <actor/cmd/CW.hpp>
 #include "util/CBuffer.hpp"
+#include "util/CSendQueue.hpp"
 #include "pb/msg.pb.h"
 #include "Error.hpp"
 #include "Definition.hpp"
@@ -88,6 +89,19 @@ public:
      */
     virtual E_CODEC_STATUS Encode(const MsgHead& oMsgHead, const MsgBody& oMsgBody, CBuffer* pBuff) = 0;
 
+    /**
+     * @brief 字节流编码到发送队列
+     * @note 支持的编解码器把较大的包体以引用方式加入发送队列，避免拷贝；默认编码到队尾缓冲区。
+     * @param[in] oMsgHead  消息包头
+     * @param[in] oMsgBody  消息包体
+     * @param[out] pSendQueue  发送队列
+     * @return 编解码状态
+     */
+    virtual E_CODEC_STATUS Encode(const MsgHead& oMsgHead, const MsgBody& oMsgBody, CSendQueue* pSendQueue)
+    {
+        return(Encode(oMsgHead, oMsgBody, pSendQueue->MutableTailBuffer()));
+    }
+
     /**
      * @brief 字节流解码
      * @param[in,out] pBuff 数据缓冲区
@@ -111,6 +125,7 @@ public:
     static void AddAutoSwitchCodecType(E_CODEC_TYPE eCodecType);
 
     template <typename ...Targs> void Logger(int iLogLevel, const char* szFileName, unsigned int uiFileLine, const char* szFunction, Targs&&... args);
+    bool IsLogEnabled(int iLogLevel) const;
 
     inline void SetErrno(int32 iErrno)
     {
@@ -131,6 +146,15 @@ protected:
     bool AesEncrypt(const std::string& strSrc, std::string& strDest);
     bool AesDecrypt(const std::string& strSrc, std::string& strDest);
 
+    /**
+     * @brief 把protobuf消息直接序列化到缓冲区的可写空间，不经过临时std::string
+     * @param[in] oMsg 待序列化消息
+     * @param[in] iByteSize 紧邻调用的oMsg.ByteSize()返回值（ByteSize()同时缓存了各字段长度）
+     * @param[out] pBuff 数据缓冲区
+     * @return 是否序列化成功，失败时缓冲区写位置不变
+     */
+    bool SerializeToBuffer(const google::protobuf::MessageLite& oMsg, int iByteSize, CBuffer* pBuff);
+
 protected:
     std::shared_ptr<NetLogger> m_pLogger;
 
@@ -143,6 +167,11 @@ private:
     friend class SocketChannel;
 };
 
+inline bool Codec::IsLogEnabled(int iLogLevel) const
+{
+    return(m_pLogger->IsLevelEnabled(iLogLevel));
+}
+
 template <typename ...Targs>
 void Codec::Logger(int iLogLevel, const char* szFileName, unsigned int uiFileLine, const char* szFunction, Targs&&... args)
 {
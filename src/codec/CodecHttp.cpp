@@ -7,6 +7,7 @@
  * @note
  * Modify history:
  ******************************************************************************/
+#include <climits>
 #include <algorithm>
 #include "util/StringCoder.hpp"
 #include "logger/NetLogger.hpp"
@@ -78,11 +79,27 @@ static const char * status_string(int code)
 namespace neb
 {
 
+uint32 CodecHttp::s_uiMaxHeaderSize = 65536;
+uint32 CodecHttp::s_uiMaxBodySize = 67108864;
+
 CodecHttp::CodecHttp(std::shared_ptr<NetLogger> pLogger, E_CODEC_TYPE eCodecType, ev_tstamp dKeepAlive)
     : Codec(pLogger, eCodecType),
-      m_bChannelIsClient(false), m_bIsDecoding(false), m_uiEncodedNum(0), m_uiDecodedNum(0),
-      m_iHttpMajor(1), m_iHttpMinor(1), m_dKeepAlive(dKeepAlive)
+      m_bChannelIsClient(false), m_bIsDecoding(false), m_bMessageComplete(false), m_bParsingHeaderValue(false),
+      m_uiEncodedNum(0), m_uiDecodedNum(0),
+      m_iHttpMajor(1), m_iHttpMinor(1), m_dKeepAlive(dKeepAlive),
+      m_uiParsedHeaderSize(0), m_ullParsedBodySize(0)
 {
+    memset(&m_parser_setting, 0, sizeof(m_parser_setting));
+    m_parser_setting.on_message_begin = OnMessageBegin;
+    m_parser_setting.on_url = OnUrl;
+    m_parser_setting.on_status = OnStatus;
+    m_parser_setting.on_header_field = OnHeaderField;
+    m_parser_setting.on_header_value = OnHeaderValue;
+    m_parser_setting.on_headers_complete = OnHeadersComplete;
+    m_parser_setting.on_body = OnBody;
+    m_parser_setting.on_message_complete = OnMessageComplete;
+    m_parser_setting.on_chunk_header = OnChunkHeader;
+    m_parser_setting.on_chunk_complete = OnChunkComplete;
 }
 
 CodecHttp::~CodecHttp()
@@ -146,6 +163,16 @@ E_CODEC_STATUS CodecHttp::Decode(CBuffer* pBuff, MsgHead& oMsgHead, MsgBody& oMs
 }
 
 E_CODEC_STATUS CodecHttp::Encode(const HttpMsg& oHttpMsg, CBuffer* pBuff)
+{
+    return(Encode(oHttpMsg, pBuff, nullptr));
+}
+
+E_CODEC_STATUS CodecHttp::Encode(const HttpMsg& oHttpMsg, CSendQueue* pSendQueue)
+{
+    return(Encode(oHttpMsg, pSendQueue->MutableTailBuffer(), pSendQueue));
+}
+
+E_CODEC_STATUS CodecHttp::Encode(const HttpMsg& oHttpMsg, CBuffer* pBuff, CSendQueue* pSendQueue)
 {
     LOG4_TRACE("pBuff->ReadableBytes() = %u, ReadIndex = %u, WriteIndex = %u",
                     pBuff->ReadableBytes(), pBuff->GetReadIndex(), pBuff->GetWriteIndex());
@@ -471,7 +498,16 @@ E_CODEC_STATUS CodecHttp::Encode(const HttpMsg& oHttpMsg, CBuffer* pBuff)
                 {
                     iHadEncodedSize += iWriteSize;
                 }
-                iWriteSize = pBuff->Write(oHttpMsg.body().c_str(), oHttpMsg.body().size());
+                if (nullptr != pSendQueue && oHttpMsg.body().size() >= CSendQueue::REFERENCE_MIN_SIZE)
+                {
+                    // 包体是最后一段数据，直接引用，由channel在Send()返回前发送完毕或Retain()
+                    pSendQueue->Reference(oHttpMsg.body().data(), oHttpMsg.body().size());
+                    iWriteSize = (int)oHttpMsg.body().size();
+                }
+                else
+                {
+                    iWriteSize = pBuff->Write(oHttpMsg.body().c_str(), oHttpMsg.body().size());
+                }
                 if (iWriteSize < 0)
                 {
                     pBuff->SetWriteIndex(pBuff->GetWriteIndex() - iHadEncodedSize);
@@ -551,38 +587,21 @@ E_CODEC_STATUS CodecHttp::Decode(CBuffer* pBuff, HttpMsg& oHttpMsg)
     {
         return(CODEC_STATUS_PAUSE);
     }
-    ++m_uiDecodedNum;
-    m_oParsingHttpMsg.Clear();
-    m_parser_setting.on_message_begin = OnMessageBegin;
-    m_parser_setting.on_url = OnUrl;
-    m_parser_setting.on_status = OnStatus;
-    m_parser_setting.on_header_field = OnHeaderField;
-    m_parser_setting.on_header_value = OnHeaderValue;
-    m_parser_setting.on_headers_complete = OnHeadersComplete;
-    m_parser_setting.on_body = OnBody;
-    m_parser_setting.on_message_complete = OnMessageComplete;
-    m_parser_setting.on_chunk_header = OnChunkHeader;
-    m_parser_setting.on_chunk_complete = OnChunkComplete;
-    m_parser.data = this;
-    m_bIsDecoding = false;
-    http_parser_init(&m_parser, HTTP_BOTH);
+    if (!m_bIsDecoding)
+    {
+        ++m_uiDecodedNum;
+        StartParsing();
+    }
+    m_bMessageComplete = false;
     const char* pDecodeBuff = pBuff->GetRawReadBuffer();
     size_t uiDecodeBuffLen = pBuff->ReadableBytes();
     size_t uiLen = http_parser_execute(&m_parser, &m_parser_setting,
                     pDecodeBuff, uiDecodeBuffLen);
-    if (m_parser.http_errno == HPE_PAUSED)
-    {
-        LOG4_TRACE("wait for message to complete...");
-        return(CODEC_STATUS_PAUSE);
-    }
-    if(m_parser.http_errno == HPE_OK)
+    if (m_bMessageComplete)     // OnMessageComplete()暂停了解析器，缓冲区中剩余的数据属于下一个http包
     {
-        if (m_bIsDecoding)
-        {
-            LOG4_TRACE("wait for message to complete...");
-            return(CODEC_STATUS_PAUSE);
-        }
+        http_parser_pause(&m_parser, 0);
         pBuff->AdvanceReadIndex(uiLen);
+        m_bIsDecoding = false;
         if (HTTP_REQUEST == m_oParsingHttpMsg.type())
         {
             m_iHttpMajor = m_oParsingHttpMsg.http_major();
@@ -611,12 +630,20 @@ E_CODEC_STATUS CodecHttp::Decode(CBuffer* pBuff, HttpMsg& oHttpMsg)
             m_oParsingHttpMsg.set_keep_alive(0.0);
             m_dKeepAlive = 0.0;
         }
-        oHttpMsg = std::move(m_oParsingHttpMsg);
+        oHttpMsg.Swap(&m_oParsingHttpMsg);     // 交换而非拷贝（protobuf 3.0生成的消息没有移动赋值），传入的空消息留作下一个请求的解析对象
         LOG4_TRACE("%s", ToString(oHttpMsg).c_str());
         return(CODEC_STATUS_OK);
     }
-    LOG4_WARNING("Failed to parse http message for cause:%s, message %s",
-            http_errno_name((http_errno)m_parser.http_errno), pDecodeBuff);
+    if (m_parser.http_errno == HPE_OK)
+    {
+        // 已解析的数据均已通过回调保存到m_oParsingHttpMsg，下次只需解析新收到的数据
+        pBuff->AdvanceReadIndex(uiLen);
+        LOG4_TRACE("wait for message to complete...");
+        return(CODEC_STATUS_PAUSE);
+    }
+    m_bIsDecoding = false;
+    LOG4_WARNING("Failed to parse http message for cause:%s, parsed header size %u, parsed body size %llu",
+            http_errno_name((http_errno)m_parser.http_errno), m_uiParsedHeaderSize, m_ullParsedBodySize);
     return(CODEC_STATUS_ERR);
 }
 
@@ -668,6 +695,12 @@ const std::string& CodecHttp::ToString(const HttpMsg& oHttpMsg)
     return(m_strHttpString);
 }
 
+void CodecHttp::SetMessageLimit(uint32 uiMaxHeaderSize, uint32 uiMaxBodySize)
+{
+    s_uiMaxHeaderSize = uiMaxHeaderSize;
+    s_uiMaxBodySize = uiMaxBodySize;
+}
+
 bool CodecHttp::CloseRightAway() const
 {
     if (m_bChannelIsClient)
@@ -687,64 +720,99 @@ bool CodecHttp::CloseRightAway() const
     }
 }
 
-int CodecHttp::OnMessageBegin(http_parser *parser)
+void CodecHttp::StartParsing()
 {
-    CodecHttp* pCodec = (CodecHttp*)parser->data;
-    pCodec->m_bIsDecoding = true;
-    return(0);
+    m_oParsingHttpMsg.Clear();
+    m_strParsingHeaderName.clear();
+    m_strParsingHeaderValue.clear();
+    m_bParsingHeaderValue = false;
+    m_uiParsedHeaderSize = 0;
+    m_ullParsedBodySize = 0;
+    http_parser_init(&m_parser, HTTP_BOTH);
+    m_parser.data = this;
+    m_bIsDecoding = true;
 }
 
-int CodecHttp::OnUrl(http_parser *parser, const char *at, size_t len)
+bool CodecHttp::AddHeaderSize(size_t uiLen)
 {
-    CodecHttp* pCodec = (CodecHttp*)parser->data;
-    pCodec->MutableParsingHttpMsg()->set_url(at, len);
-    struct http_parser_url stUrl;
-    if(0 == http_parser_parse_url(at, len, 0, &stUrl))
-    {
-//        if(stUrl.field_set & (1 << UF_PORT))
-//        {
-//            pHttpMsg->set_port(stUrl.port);
-//        }
-//        else
-//        {
-//            pHttpMsg->set_port(80);
-//        }
-//
-//        if(stUrl.field_set & (1 << UF_HOST) )
-//        {
-//            char* host = (char*)malloc(stUrl.field_data[UF_HOST].len+1);
-//            strncpy(host, at+stUrl.field_data[UF_HOST].off, stUrl.field_data[UF_HOST].len);
-//            host[stUrl.field_data[UF_HOST].len] = 0;
-//            pHttpMsg->set_host(host, stUrl.field_data[UF_HOST].len+1);
-//            free(host);
-//        }
+    m_uiParsedHeaderSize += uiLen;
+    if (s_uiMaxHeaderSize > 0 && m_uiParsedHeaderSize > s_uiMaxHeaderSize)
+    {
+        LOG4_WARNING("http header size exceed %u!", s_uiMaxHeaderSize);
+        SetErrno(431);  // Request Header Fields Too Large
+        return(false);
+    }
+    return(true);
+}
 
-        if(stUrl.field_set & (1 << UF_PATH))
+bool CodecHttp::CheckBodySize(uint64 ullBodySize)
+{
+    if (s_uiMaxBodySize > 0 && ullBodySize > s_uiMaxBodySize)
+    {
+        LOG4_WARNING("http body size %llu exceed %u!", ullBodySize, s_uiMaxBodySize);
+        SetErrno(413);  // Request Entity Too Large
+        return(false);
+    }
+    return(true);
+}
+
+void CodecHttp::AddParsingHeader()
+{
+    if (m_strParsingHeaderName.empty())
+    {
+        return;
+    }
+    if (m_strParsingHeaderName == std::string("Keep-Alive"))
+    {
+        m_oParsingHttpMsg.set_keep_alive(atof(m_strParsingHeaderValue.c_str()));
+    }
+    else if (std::string("Connection") == m_strParsingHeaderName)
+    {
+        size_t uiPos = 0;
+        uiPos = m_strParsingHeaderValue.find_first_of("Upgrade");
+        if (0 == uiPos)
         {
-            char *path = (char*)malloc(stUrl.field_data[UF_PATH].len);
-            strncpy(path, at+stUrl.field_data[UF_PATH].off, stUrl.field_data[UF_PATH].len);
-            pCodec->MutableParsingHttpMsg()->set_path(path, stUrl.field_data[UF_PATH].len);
-            free(path);
+            m_oParsingHttpMsg.mutable_upgrade()->set_is_upgrade(true);
         }
-
-        if (stUrl.field_set & (1 << UF_QUERY))
+        else
         {
-            std::string strQuery;
-            strQuery.assign(at+stUrl.field_data[UF_QUERY].off, stUrl.field_data[UF_QUERY].len);
-            std::map<std::string, std::string> mapParam;
-            DecodeParameter(strQuery, mapParam);
-            for (auto it = mapParam.begin(); it != mapParam.end(); ++it)
-            {
-                (*pCodec->MutableParsingHttpMsg()->mutable_params())[it->first] = it->second;
-            }
+            m_oParsingHttpMsg.mutable_upgrade()->set_is_upgrade(false);
         }
     }
-    return 0;
+    else if (std::string("Upgrade") == m_strParsingHeaderName)
+    {
+        m_oParsingHttpMsg.mutable_upgrade()->set_protocol(m_strParsingHeaderValue);
+    }
+    m_oParsingHttpMsg.mutable_headers()->insert(google::protobuf::MapPair<std::string, std::string>(
+            m_strParsingHeaderName, m_strParsingHeaderValue));
+    m_strParsingHeaderName.clear();
+    m_strParsingHeaderValue.clear();
+}
+
+int CodecHttp::OnMessageBegin(http_parser *parser)
+{
+    return(0);
+}
+
+int CodecHttp::OnUrl(http_parser *parser, const char *at, size_t len)
+{
+    // url可能跨越多个数据包而分多次回调，在OnHeadersComplete()中再解析path和参数
+    CodecHttp* pCodec = (CodecHttp*)parser->data;
+    if (!pCodec->AddHeaderSize(len))
+    {
+        return(-1);
+    }
+    pCodec->MutableParsingHttpMsg()->mutable_url()->append(at, len);
+    return(0);
 }
 
 int CodecHttp::OnStatus(http_parser *parser, const char *at, size_t len)
 {
     CodecHttp* pCodec = (CodecHttp*) parser->data;
+    if (!pCodec->AddHeaderSize(len))
+    {
+        return(-1);
+    }
     pCodec->MutableParsingHttpMsg()->set_status_code(parser->status_code);
     return(0);
 }
@@ -752,58 +820,86 @@ int CodecHttp::OnStatus(http_parser *parser, const char *at, size_t len)
 int CodecHttp::OnHeaderField(http_parser *parser, const char *at, size_t len)
 {
     CodecHttp* pCodec = (CodecHttp*) parser->data;
-    pCodec->MutableParsingHttpMsg()->set_body(at, len);        // 用body暂存head_name，解析完head_value后再填充到head里
+    if (!pCodec->AddHeaderSize(len))
+    {
+        return(-1);
+    }
+    if (pCodec->m_bParsingHeaderValue)
+    {
+        pCodec->AddParsingHeader();
+        pCodec->m_bParsingHeaderValue = false;
+    }
+    pCodec->m_strParsingHeaderName.append(at, len);
     return(0);
 }
 
 int CodecHttp::OnHeaderValue(http_parser *parser, const char *at, size_t len)
 {
     CodecHttp* pCodec = (CodecHttp*) parser->data;
-    std::string strHeadName = pCodec->MutableParsingHttpMsg()->body();
-    std::string strHeadValue;
-    strHeadValue.assign(at, len);
-    pCodec->MutableParsingHttpMsg()->set_body("");
-    pCodec->MutableParsingHttpMsg()->mutable_headers()->insert(google::protobuf::MapPair<std::string, std::string>(strHeadName, strHeadValue));
-    if (strHeadName == std::string("Keep-Alive"))
+    if (!pCodec->AddHeaderSize(len))
     {
-        pCodec->MutableParsingHttpMsg()->set_keep_alive(atof(strHeadValue.c_str()));
+        return(-1);
     }
-    else if (std::string("Connection") == strHeadName)
+    pCodec->m_bParsingHeaderValue = true;
+    pCodec->m_strParsingHeaderValue.append(at, len);
+    return(0);
+}
+
+int CodecHttp::OnHeadersComplete(http_parser *parser)
+{
+    CodecHttp* pCodec = (CodecHttp*) parser->data;
+    pCodec->AddParsingHeader();
+    pCodec->m_bParsingHeaderValue = false;
+    // 包体长度已知时提前拒绝超限的包；预分配不超过sc_uiMaxBodyReserve，不能让对端
+    // 声称的长度在包体到达之前就占用大量内存，更长的包体随数据到达增长
+    if (parser->content_length > 0 && parser->content_length != ULLONG_MAX)
     {
-        size_t uiPos = 0;
-        uiPos = strHeadValue.find_first_of("Upgrade");
-        if (0 == uiPos)
+        if (!pCodec->CheckBodySize(parser->content_length))
         {
-            pCodec->MutableParsingHttpMsg()->mutable_upgrade()->set_is_upgrade(true);
-        }
-        else
-        {
-            pCodec->MutableParsingHttpMsg()->mutable_upgrade()->set_is_upgrade(false);
+            return(-1);
         }
+        pCodec->MutableParsingHttpMsg()->mutable_body()->reserve(
+                (size_t)std::min(parser->content_length, (uint64_t)sc_uiMaxBodyReserve));
     }
-    else if (std::string("Upgrade") == strHeadName)
+
+    const std::string& strUrl = pCodec->MutableParsingHttpMsg()->url();
+    if (strUrl.empty())
     {
-        pCodec->MutableParsingHttpMsg()->mutable_upgrade()->set_protocol(strHeadValue);
+        return(0);
     }
-    return(0);
-}
+    struct http_parser_url stUrl;
+    if(0 == http_parser_parse_url(strUrl.c_str(), strUrl.size(), 0, &stUrl))
+    {
+        if(stUrl.field_set & (1 << UF_PATH))
+        {
+            pCodec->MutableParsingHttpMsg()->set_path(strUrl.c_str() + stUrl.field_data[UF_PATH].off,
+                    stUrl.field_data[UF_PATH].len);
+        }
 
-int CodecHttp::OnHeadersComplete(http_parser *parser)
-{
+        if (stUrl.field_set & (1 << UF_QUERY))
+        {
+            std::string strQuery;
+            strQuery.assign(strUrl.c_str() + stUrl.field_data[UF_QUERY].off, stUrl.field_data[UF_QUERY].len);
+            std::map<std::string, std::string> mapParam;
+            DecodeParameter(strQuery, mapParam);
+            for (auto it = mapParam.begin(); it != mapParam.end(); ++it)
+            {
+                (*pCodec->MutableParsingHttpMsg()->mutable_params())[it->first] = it->second;
+            }
+        }
+    }
     return(0);
 }
 
 int CodecHttp::OnBody(http_parser *parser, const char *at, size_t len)
 {
     CodecHttp* pCodec = (CodecHttp*) parser->data;
-    if (pCodec->MutableParsingHttpMsg()->body().size() > 0)
-    {
-        pCodec->MutableParsingHttpMsg()->mutable_body()->append(at, len);
-    }
-    else
+    pCodec->m_ullParsedBodySize += len;
+    if (!pCodec->CheckBodySize(pCodec->m_ullParsedBodySize))
     {
-        pCodec->MutableParsingHttpMsg()->set_body(at, len);
+        return(-1);
     }
+    pCodec->MutableParsingHttpMsg()->mutable_body()->append(at, len);
     return(0);
 }
 
@@ -822,6 +918,8 @@ int CodecHttp::OnMessageComplete(http_parser *parser)
     }
     pCodec->MutableParsingHttpMsg()->set_http_major(parser->http_major);
     pCodec->MutableParsingHttpMsg()->set_http_minor(parser->http_minor);
+    pCodec->m_bMessageComplete = true;
+    http_parser_pause(parser, 1);   // 每次Decode只解一个http包
     return(0);
 }
 
@@ -4,7 +4,8 @@
  * @brief 
  * @author   Bwar
  * @date:    2016年8月11日
- * @note
+ * @note     解码是流式的：未解完的http包的解析器状态和已解出的HttpMsg保留在编解码器中，
+ * 后续收到的数据从断点处继续解析，已解析的数据即从缓冲区移除。
  * Modify history:
  ******************************************************************************/
 #ifndef SRC_CODEC_CODECHTTP_HPP_
@@ -29,6 +30,11 @@ public:
     virtual E_CODEC_STATUS Encode(const HttpMsg& oHttpMsg, CBuffer* pBuff);
     virtual E_CODEC_STATUS Decode(CBuffer* pBuff, HttpMsg& oHttpMsg);
 
+    /**
+     * @brief 编码到发送队列，较大的包体以引用方式加入队列，不拷贝
+     */
+    virtual E_CODEC_STATUS Encode(const HttpMsg& oHttpMsg, CSendQueue* pSendQueue);
+
     /**
      * @brief 添加http头
      * @note 在encode前，允许框架根据连接属性添加http头
@@ -37,6 +43,13 @@ public:
 
     const std::string& ToString(const HttpMsg& oHttpMsg);
 
+    /**
+     * @brief 设置解码时http包头和包体的长度上限（0为不限制）
+     * @note 超限的包在解析到超限位置时即被拒绝，Decode()返回CODEC_STATUS_ERR，
+     * GetErrno()返回对应的http状态码（431或413）。
+     */
+    static void SetMessageLimit(uint32 uiMaxHeaderSize, uint32 uiMaxBodySize);
+
 public:
     ev_tstamp GetKeepAlive() const
     {
@@ -46,6 +59,8 @@ public:
     bool CloseRightAway() const;
 
 protected:
+    E_CODEC_STATUS Encode(const HttpMsg& oHttpMsg, CBuffer* pBuff, CSendQueue* pSendQueue);
+
     static int OnMessageBegin(http_parser *parser);
     static int OnUrl(http_parser *parser, const char *at, size_t len);
     static int OnStatus(http_parser *parser, const char *at, size_t len);
@@ -62,9 +77,17 @@ protected:
         return(&m_oParsingHttpMsg);
     }
 
+private:
+    void StartParsing();
+    bool AddHeaderSize(size_t uiLen);
+    bool CheckBodySize(uint64 ullBodySize);
+    void AddParsingHeader();
+
 private:
     bool m_bChannelIsClient;    // 当前编解码器所在channel是作为http客户端还是作为http服务端
-    bool m_bIsDecoding;         // 是否編解碼完成
+    bool m_bIsDecoding;         // 是否有未解完的http包（解析器状态需保留到下次Decode）
+    bool m_bMessageComplete;    // 本次Decode是否解完了一个http包
+    bool m_bParsingHeaderValue; // 上一个回调是否为OnHeaderValue（header name或value可能分多次回调）
     uint32 m_uiEncodedNum;
     uint32 m_uiDecodedNum;
     int32 m_iHttpMajor;
@@ -72,9 +95,17 @@ private:
     ev_tstamp m_dKeepAlive;
     http_parser_settings m_parser_setting;
     http_parser m_parser;
-    HttpMsg m_oParsingHttpMsg;      // TODO 如果是较大的http包只解了一部分，要记录断点位置，收到信的数据再从断点位置开始解
+    uint32 m_uiParsedHeaderSize;
+    uint64 m_ullParsedBodySize;
+    HttpMsg m_oParsingHttpMsg;
+    std::string m_strParsingHeaderName;
+    std::string m_strParsingHeaderValue;
     std::string m_strHttpString;
     std::unordered_map<std::string, std::string> m_mapAddingHttpHeader;       ///< encode前添加的http头，encode之后要清空
+
+    static uint32 s_uiMaxHeaderSize;
+    static uint32 s_uiMaxBodySize;
+    static const uint32 sc_uiMaxBodyReserve = 65536;    ///< 按Content-Length预分配包体空间的上限
 };
 
 } /* namespace neb */
@@ -67,15 +67,15 @@ E_CODEC_STATUS CodecPrivate::Encode(const MsgHead& oMsgHead, const MsgBody& oMsg
             pBuff->SetWriteIndex(pBuff->GetWriteIndex() - iHadWriteLen);
             return(CODEC_STATUS_ERR);
         }
+        iHadWriteLen += iWriteLen;
         iNeedWriteLen = oMsgBody.ByteSize();
-        oMsgBody.SerializeToString(&strTmpData);
-        iWriteLen = pBuff->Write(strTmpData.c_str(), oMsgBody.ByteSize());
-        if (iWriteLen != iNeedWriteLen)
+        if (!SerializeToBuffer(oMsgBody, iNeedWriteLen, pBuff))    // 直接序列化到缓冲区
         {
-            LOG4_ERROR("buff write head iWriteLen != sizeof(stClientMsgHead)");
+            LOG4_ERROR("buff write body error!");
             pBuff->SetWriteIndex(pBuff->GetWriteIndex() - iHadWriteLen);
             return(CODEC_STATUS_ERR);
         }
+        iWriteLen = iNeedWriteLen;
         iHadWriteLen += iWriteLen;
     }
     else
@@ -175,13 +175,12 @@ E_CODEC_STATUS CodecPrivate::Encode(const MsgHead& oMsgHead, const MsgBody& oMsg
             }
             iHadWriteLen += iWriteLen;
             iNeedWriteLen = oMsgBody.ByteSize();
-            oMsgBody.SerializeToString(&strTmpData);
-            iWriteLen = pBuff->Write(strTmpData.c_str(), oMsgBody.ByteSize());
-            if (iWriteLen != iNeedWriteLen)
+            if (!SerializeToBuffer(oMsgBody, iNeedWriteLen, pBuff))
             {
                 pBuff->SetWriteIndex(pBuff->GetWriteIndex() - iHadWriteLen);
                 return(CODEC_STATUS_ERR);
             }
+            iWriteLen = iNeedWriteLen;
             iHadWriteLen += iWriteLen;
         }
     }
@@ -8,12 +8,27 @@
  * Modify history:
  ******************************************************************************/
 
+#include <google/protobuf/io/coded_stream.h>
 #include "logger/NetLogger.hpp"
 #include "CodecProto.hpp"
 
 namespace neb
 {
 
+// protobuf fixed32为小端字节序，逐字节读写以兼容任意主机字节序和未对齐地址
+static inline void WriteFixed32(uint32 uiValue, uint8* pDest)
+{
+    pDest[0] = (uint8)uiValue;
+    pDest[1] = (uint8)(uiValue >> 8);
+    pDest[2] = (uint8)(uiValue >> 16);
+    pDest[3] = (uint8)(uiValue >> 24);
+}
+
+static inline uint32 ReadFixed32(const uint8* pSrc)
+{
+    return((uint32)pSrc[0] | ((uint32)pSrc[1] << 8) | ((uint32)pSrc[2] << 16) | ((uint32)pSrc[3] << 24));
+}
+
 CodecProto::CodecProto(std::shared_ptr<NetLogger> pLogger, E_CODEC_TYPE eCodecType)
     : Codec(pLogger, eCodecType)
 {
@@ -25,46 +40,91 @@ CodecProto::~CodecProto()
 
 E_CODEC_STATUS CodecProto::Encode(const MsgHead& oMsgHead, const MsgBody& oMsgBody, CBuffer* pBuff)
 {
-    LOG4_TRACE("pBuff->ReadableBytes()=%u, oMsgHead.ByteSize() = %d", pBuff->ReadableBytes(), oMsgHead.ByteSize());
-    int iHadWriteLen = 0;
-    int iWriteLen = 0;
-    int iNeedWriteLen = gc_uiMsgHeadSize;
-    std::string strTmpData;
-    oMsgHead.SerializeToString(&strTmpData);
-    iWriteLen = pBuff->Write(strTmpData.c_str(), gc_uiMsgHeadSize);
-    if (iWriteLen != iNeedWriteLen)
-    {
-        LOG4_ERROR("buff write head iWriteLen != iNeedWriteLen!");
-        pBuff->SetWriteIndex(pBuff->GetWriteIndex() - iHadWriteLen);
-        return(CODEC_STATUS_ERR);
-    }
-    iHadWriteLen += iWriteLen;
+    LOG4_TRACE("pBuff->ReadableBytes()=%u, oMsgHead.len() = %d", pBuff->ReadableBytes(), oMsgHead.len());
     if (oMsgHead.len() <= 0)    // 无包体（心跳包等），nebula在proto3的使用上以-1表示包体长度为0
     {
+        if (!WriteMsgHead(oMsgHead, pBuff))
+        {
+            LOG4_ERROR("buff write head error!");
+            return(CODEC_STATUS_ERR);
+        }
         return(CODEC_STATUS_OK);
     }
-    iNeedWriteLen = oMsgBody.ByteSize();
-    oMsgBody.SerializeToString(&strTmpData);
-    iWriteLen = pBuff->Write(strTmpData.c_str(), oMsgBody.ByteSize());
-    if (iWriteLen == iNeedWriteLen)
+    int iBodySize = oMsgBody.ByteSize();
+    // 包头和包体一次预留，包体直接序列化到缓冲区，避免经过临时std::string的两次拷贝
+    if (!pBuff->EnsureWritableBytes(gc_uiMsgHeadSize + iBodySize))
+    {
+        LOG4_ERROR("buff EnsureWritableBytes(%d) error!", gc_uiMsgHeadSize + iBodySize);
+        return(CODEC_STATUS_ERR);
+    }
+    WriteMsgHead(oMsgHead, pBuff);
+    if (SerializeToBuffer(oMsgBody, iBodySize, pBuff))
     {
         return(CODEC_STATUS_OK);
     }
     else
     {
-        LOG4_ERROR("buff write body iWriteLen != iNeedWriteLen!");
-        pBuff->SetWriteIndex(pBuff->GetWriteIndex() - iHadWriteLen);
+        LOG4_ERROR("buff write body error!");
+        pBuff->SetWriteIndex(pBuff->GetWriteIndex() - gc_uiMsgHeadSize);
         return(CODEC_STATUS_ERR);
     }
 }
 
+E_CODEC_STATUS CodecProto::Encode(const MsgHead& oMsgHead, const MsgBody& oMsgBody, CSendQueue* pSendQueue)
+{
+    CBuffer* pBuff = pSendQueue->MutableTailBuffer();
+    if (oMsgHead.len() <= 0 || oMsgBody.data().size() < CSendQueue::REFERENCE_MIN_SIZE)
+    {
+        return(Encode(oMsgHead, oMsgBody, pBuff));
+    }
+
+    /* data以外的字段先编码，data（length-delimited）放在最后并以引用方式加入发送队列。
+     * protobuf解码不依赖字段顺序，编码结果的长度与oMsgBody.ByteSize()一致。 */
+    MsgBody oMsgBodyWithoutData;
+    if (oMsgBody.has_req_target())
+    {
+        *oMsgBodyWithoutData.mutable_req_target() = oMsgBody.req_target();
+    }
+    else if (oMsgBody.has_rsp_result())
+    {
+        *oMsgBodyWithoutData.mutable_rsp_result() = oMsgBody.rsp_result();
+    }
+    oMsgBodyWithoutData.set_add_on(oMsgBody.add_on());
+    oMsgBodyWithoutData.set_trace_id(oMsgBody.trace_id());
+    uint32 uiDataSize = oMsgBody.data().size();
+    uint32 uiDataTag = ((uint32)MsgBody::kDataFieldNumber << 3) | 2;
+    int iPrefixSize = oMsgBodyWithoutData.ByteSize();
+    int iDataPrefixSize = google::protobuf::io::CodedOutputStream::VarintSize32(uiDataTag)
+            + google::protobuf::io::CodedOutputStream::VarintSize32(uiDataSize);
+    if (iPrefixSize + iDataPrefixSize + (int)uiDataSize != oMsgHead.len())
+    {
+        // MsgBody有新增字段未在此处理，退回到整包拷贝编码
+        return(Encode(oMsgHead, oMsgBody, pBuff));
+    }
+
+    if (!pBuff->EnsureWritableBytes(gc_uiMsgHeadSize + iPrefixSize + iDataPrefixSize))
+    {
+        LOG4_ERROR("buff write head error!");
+        return(CODEC_STATUS_ERR);
+    }
+    WriteMsgHead(oMsgHead, pBuff);
+    uint8* pWrite = (uint8*)pBuff->GetRawWriteBuffer();
+    oMsgBodyWithoutData.SerializeWithCachedSizesToArray(pWrite);
+    pWrite += iPrefixSize;
+    pWrite = google::protobuf::io::CodedOutputStream::WriteVarint32ToArray(uiDataTag, pWrite);
+    google::protobuf::io::CodedOutputStream::WriteVarint32ToArray(uiDataSize, pWrite);
+    pBuff->AdvanceWriteIndex(iPrefixSize + iDataPrefixSize);
+    pSendQueue->Reference(oMsgBody.data().data(), uiDataSize);
+    return(CODEC_STATUS_OK);
+}
+
 E_CODEC_STATUS CodecProto::Decode(CBuffer* pBuff, MsgHead& oMsgHead, MsgBody& oMsgBody)
 {
     LOG4_TRACE("pBuff->ReadableBytes()=%d, pBuff->GetReadIndex()=%d",
                     pBuff->ReadableBytes(), pBuff->GetReadIndex());
     if (pBuff->ReadableBytes() >= gc_uiMsgHeadSize)
     {
-        bool bResult = oMsgHead.ParseFromArray(pBuff->GetRawReadBuffer(), gc_uiMsgHeadSize);
+        bool bResult = ReadMsgHead(pBuff->GetRawReadBuffer(), oMsgHead);
         if (bResult)
         {
             LOG4_TRACE("pBuff->ReadableBytes()=%d, oMsgHead.len()=%d",
@@ -76,6 +136,7 @@ E_CODEC_STATUS CodecProto::Decode(CBuffer* pBuff, MsgHead& oMsgHead, MsgBody& oM
             }
             if (pBuff->ReadableBytes() >= gc_uiMsgHeadSize + oMsgHead.len())
             {
+                // 包体直接在接收缓冲区上解析，不拷贝
                 bResult = oMsgBody.ParseFromArray(
                                 pBuff->GetRawReadBuffer() + gc_uiMsgHeadSize, oMsgHead.len());
                 LOG4_TRACE("pBuff->ReadableBytes()=%d, oMsgBody.ByteSize()=%d", pBuff->ReadableBytes(), oMsgBody.ByteSize());
@@ -97,7 +158,7 @@ E_CODEC_STATUS CodecProto::Decode(CBuffer* pBuff, MsgHead& oMsgHead, MsgBody& oM
         }
         else
         {
-            LOG4_TRACE("oMsgHead.ParseFromArray() error!");   // maybe port scan from operation and maintenance system.
+            LOG4_TRACE("ReadMsgHead() error!");   // maybe port scan from operation and maintenance system.
             return(CODEC_STATUS_ERR);
         }
     }
@@ -107,4 +168,36 @@ E_CODEC_STATUS CodecProto::Decode(CBuffer* pBuff, MsgHead& oMsgHead, MsgBody& oM
     }
 }
 
+bool CodecProto::WriteMsgHead(const MsgHead& oMsgHead, CBuffer* pBuff)
+{
+    if (!pBuff->EnsureWritableBytes(gc_uiMsgHeadSize))
+    {
+        return(false);
+    }
+    uint8* pWrite = (uint8*)pBuff->GetRawWriteBuffer();
+    pWrite[0] = (MsgHead::kCmdFieldNumber << 3) | 5;    // wire type 5: fixed32
+    WriteFixed32(oMsgHead.cmd(), pWrite + 1);
+    pWrite[5] = (MsgHead::kSeqFieldNumber << 3) | 5;
+    WriteFixed32(oMsgHead.seq(), pWrite + 6);
+    pWrite[10] = (MsgHead::kLenFieldNumber << 3) | 5;
+    WriteFixed32((uint32)oMsgHead.len(), pWrite + 11);
+    pBuff->AdvanceWriteIndex(gc_uiMsgHeadSize);
+    return(true);
+}
+
+bool CodecProto::ReadMsgHead(const char* pData, MsgHead& oMsgHead)
+{
+    const uint8* pRead = (const uint8*)pData;
+    if (pRead[0] == ((MsgHead::kCmdFieldNumber << 3) | 5)
+            && pRead[5] == ((MsgHead::kSeqFieldNumber << 3) | 5)
+            && pRead[10] == ((MsgHead::kLenFieldNumber << 3) | 5))
+    {
+        oMsgHead.set_cmd(ReadFixed32(pRead + 1));
+        oMsgHead.set_seq(ReadFixed32(pRead + 6));
+        oMsgHead.set_len((int32)ReadFixed32(pRead + 11));
+        return(true);
+    }
+    return(oMsgHead.ParseFromArray(pData, gc_uiMsgHeadSize));
+}
+
 } /* namespace neb */
@@ -22,7 +22,20 @@ public:
     virtual ~CodecProto();
 
     virtual E_CODEC_STATUS Encode(const MsgHead& oMsgHead, const MsgBody& oMsgBody, CBuffer* pBuff);
+    virtual E_CODEC_STATUS Encode(const MsgHead& oMsgHead, const MsgBody& oMsgBody, CSendQueue* pSendQueue);
     virtual E_CODEC_STATUS Decode(CBuffer* pBuff, MsgHead& oMsgHead, MsgBody& oMsgBody);
+
+protected:
+    /**
+     * @brief 按固定15字节格式（三个fixed32字段，均带tag）写入消息头
+     * @note 与protobuf序列化结果相同，但proto3中值为0的字段也会写出，保证消息头总是15字节。
+     */
+    static bool WriteMsgHead(const MsgHead& oMsgHead, CBuffer* pBuff);
+
+    /**
+     * @brief 从固定15字节格式读取消息头，字段顺序或tag不符时按protobuf格式解析
+     */
+    static bool ReadMsgHead(const char* pData, MsgHead& oMsgHead);
 };
 
 } /* namespace neb */
@@ -8,7 +8,9 @@
  * Modify history:
  ******************************************************************************/
 #include "CodecResp.hpp"
+#include <cstring>
 #include "util/StringConverter.hpp"
+#include "util/ByteScanner.hpp"
 
 namespace neb
 {
@@ -18,9 +20,21 @@ const char CodecResp::RESP_ERROR = '-';
 const char CodecResp::RESP_INTEGER = ':';
 const char CodecResp::RESP_BULK_STRING = '$';
 const char CodecResp::RESP_ARRAY = '*';
+const char CodecResp::RESP_NULL = '_';
+const char CodecResp::RESP_BOOLEAN = '#';
+const char CodecResp::RESP_DOUBLE = ',';
+const char CodecResp::RESP_BIG_NUMBER = '(';
+const char CodecResp::RESP_BLOB_ERROR = '!';
+const char CodecResp::RESP_VERBATIM_STRING = '=';
+const char CodecResp::RESP_MAP = '%';
+const char CodecResp::RESP_SET = '~';
+const char CodecResp::RESP_ATTRIBUTE = '|';
+const char CodecResp::RESP_PUSH = '>';
+const uint32 CodecResp::sc_uiMaxNodeHeld = 65536;
 
 CodecResp::CodecResp(std::shared_ptr<NetLogger> pLogger, E_CODEC_TYPE eCodecType)
-    : Codec(pLogger, eCodecType)
+    : Codec(pLogger, eCodecType),
+      m_uiParsedLen(0), m_bReplyReady(false)
 {
 }
 
@@ -75,41 +89,39 @@ E_CODEC_STATUS CodecResp::Encode(const RedisReply& oReply, CBuffer* pBuff)
 
 E_CODEC_STATUS CodecResp::Decode(CBuffer* pBuff, RedisReply& oReply)
 {
-    if (pBuff->ReadableBytes() < 1)
+    const RedisReplyView* pReplyView = nullptr;
+    E_CODEC_STATUS eStatus = Decode(pBuff, pReplyView);
+    if (CODEC_STATUS_OK == eStatus)
     {
-        return(CODEC_STATUS_PAUSE);
+        pReplyView->ToRedisReply(oReply);
+        pBuff->AdvanceReadIndex(m_uiParsedLen);
+        ResetParser();
     }
-    char cFirstByte = 0;
-    size_t uiReadIndex = pBuff->GetReadIndex();
-    pBuff->ReadByte(cFirstByte);
-    E_CODEC_STATUS eStatus = CODEC_STATUS_OK;
-    switch (cFirstByte)
+    else if (CODEC_STATUS_ERR == eStatus)
     {
-        case RESP_SIMPLE_STRING:
-            eStatus = DecodeSimpleString(pBuff, oReply);
-            break;
-        case RESP_INTEGER:
-            eStatus = DecodeInteger(pBuff, oReply);
-            break;
-        case RESP_BULK_STRING:
-            eStatus = DecodeBulkString(pBuff, oReply);
-            break;
-        case RESP_ARRAY:
-            eStatus = DecodeArray(pBuff, oReply);
-            break;
-        case RESP_ERROR:
-            eStatus = DecodeError(pBuff, oReply);
-            break;
-        default:
-            oReply.set_type(REDIS_REPLY_ERROR);
-            oReply.set_integer(REDIS_ERR_PROTOCOL);
-            pBuff->SetReadIndex(uiReadIndex);
-            LOG4_TRACE("cFirstByte = %d", int(cFirstByte));
-            return(CODEC_STATUS_ERR);
+        oReply.set_type(REDIS_REPLY_ERROR);
+        oReply.set_integer(REDIS_ERR_PROTOCOL);
     }
-    if (CODEC_STATUS_OK != eStatus)
+    return(eStatus);
+}
+
+E_CODEC_STATUS CodecResp::Decode(CBuffer* pBuff, const RedisReplyView*& pReplyView)
+{
+    if (m_bReplyReady)
     {
-        pBuff->SetReadIndex(uiReadIndex);
+        pBuff->AdvanceReadIndex(m_uiParsedLen);
+        ResetParser();
+    }
+    E_CODEC_STATUS eStatus = Parse(pBuff);
+    if (CODEC_STATUS_OK == eStatus)
+    {
+        m_bReplyReady = true;
+        m_oReplyView.m_pBase = pBuff->GetRawReadBuffer();
+        pReplyView = &m_oReplyView;
+    }
+    else if (CODEC_STATUS_ERR == eStatus)
+    {
+        ResetParser();
     }
     return(eStatus);
 }
@@ -215,261 +227,216 @@ E_CODEC_STATUS CodecResp::EncodeNull(const RedisReply& oReply, CBuffer* pBuff)
     return(CODEC_STATUS_OK);
 }
 
-E_CODEC_STATUS CodecResp::DecodeSimpleString(CBuffer* pBuff, RedisReply& oReply)
+E_CODEC_STATUS CodecResp::Parse(CBuffer* pBuff)
 {
-    size_t uiReadableBytes = pBuff->ReadableBytes();
-    char cLastChar = 0;
-    uint32 uiStringLen = 0;
     const char* pData = pBuff->GetRawReadBuffer();
-    const char* pPartBegin = pData;
-    for (size_t i = 0; i < uiReadableBytes; ++i)
+    size_t uiReadableBytes = pBuff->ReadableBytes();
+    if (uiReadableBytes > 0xFFFFFFFF)
+    {
+        LOG4_ERROR("redis reply too large, %u bytes had been read.", uiReadableBytes);
+        return(CODEC_STATUS_ERR);
+    }
+    const char* pEnd = pData + uiReadableBytes;
+    std::vector<tagRespNode>& vecNode = m_oReplyView.m_vecNode;
+    while (m_uiParsedLen < uiReadableBytes)
     {
-        switch (pData[i])
+        // 每次解析一个完整的元素（类型行，bulk string还包括数据），不完整时下次从该元素重新开始
+        const char* pLine = pData + m_uiParsedLen;
+        const char* pContent = pLine + 1;
+        const char* pCr = ByteScanner::FindCrlf(pContent, pEnd);
+        // 行内不允许单独的'\r'：找到行尾时检查行尾之前，未找到时检查后面已有数据的'\r'
+        const char* pBareCrEnd = (pCr == nullptr) ? pEnd - 1 : pCr;
+        if (pBareCrEnd > pContent && memchr(pContent, '\r', pBareCrEnd - pContent) != nullptr)
         {
-            case '\n':
-                if ('\r' == cLastChar)
+            LOG4_ERROR("invalid line end at offset %u, type %d", m_uiParsedLen, (int)pLine[0]);
+            return(CODEC_STATUS_ERR);
+        }
+        if (pCr == nullptr)
+        {
+            return(CODEC_STATUS_PAUSE);
+        }
+        uint32 uiContentLen = pCr - pContent;
+        size_t uiElementLen = pCr + 2 - pLine;
+        int64 llLen = 0;
+        tagRespNode stNode;
+        stNode.uiNext = vecNode.size() + 1;
+        stNode.uiOffset = pContent - pData;
+        stNode.uiLen = uiContentLen;
+        switch (pLine[0])
+        {
+            case RESP_SIMPLE_STRING:
+                stNode.iType = REDIS_VIEW_STATUS;
+                break;
+            case RESP_ERROR:
+                stNode.iType = REDIS_VIEW_ERROR;
+                break;
+            case RESP_DOUBLE:
+                stNode.iType = REDIS_VIEW_DOUBLE;
+                break;
+            case RESP_BIG_NUMBER:
+                stNode.iType = REDIS_VIEW_BIGNUM;
+                break;
+            case RESP_INTEGER:
+                stNode.iType = REDIS_VIEW_INTEGER;
+                stNode.llInteger = StringConverter::RapidAtoi<int64>(pContent);
+                break;
+            case RESP_BOOLEAN:
+                stNode.iType = REDIS_VIEW_BOOL;
+                stNode.llInteger = ('t' == pContent[0]) ? 1 : 0;
+                break;
+            case RESP_NULL:
+                stNode.iType = REDIS_VIEW_NIL;
+                break;
+            case RESP_BULK_STRING:
+            case RESP_BLOB_ERROR:
+            case RESP_VERBATIM_STRING:
+                if (!ParseLength(pContent, uiContentLen, llLen) || llLen < -1)
                 {
-                    cLastChar = '\n';
-                    oReply.set_type(REDIS_REPLY_STATUS);
-                    oReply.set_str(pPartBegin, uiStringLen);
-                    pBuff->AdvanceReadIndex(i + 1);
-                    return(CODEC_STATUS_OK);
+                    LOG4_ERROR("invalid bulk string length at offset %u", m_uiParsedLen);
+                    return(CODEC_STATUS_ERR);
                 }
-                else
+                if (llLen == -1)
                 {
-                    LOG4_ERROR("uiReadableBytes = %u, i = %d, cLastChar = %d, pData[i] = %d",
-                            uiReadableBytes, i, int(cLastChar), (int)pData[i]);
-                    return(CODEC_STATUS_ERR);
+                    stNode.iType = REDIS_VIEW_NIL;
+                    break;
                 }
-                break;
-            case '\r':
-                cLastChar = '\r';
-                break;
-            default:
-                ++uiStringLen;
-        }
-    }
-    return(CODEC_STATUS_PAUSE);
-}
-
-E_CODEC_STATUS CodecResp::DecodeError(CBuffer* pBuff, RedisReply& oReply)
-{
-    size_t uiReadableBytes = pBuff->ReadableBytes();
-    char cLastChar = 0;
-    uint32 uiStringLen = 0;
-    const char* pData = pBuff->GetRawReadBuffer();
-    const char* pPartBegin = pData;
-    for (size_t i = 0; i < uiReadableBytes; ++i)
-    {
-        switch (pData[i])
-        {
-            case '\n':
-                if ('\r' == cLastChar)
+                if ((size_t)(pEnd - pCr - 2) < (size_t)llLen + 2)
                 {
-                    cLastChar = '\n';
-                    oReply.set_type(REDIS_REPLY_ERROR);
-                    oReply.set_str(pPartBegin, uiStringLen);
-                    pBuff->AdvanceReadIndex(i + 1);
-                    return(CODEC_STATUS_OK);
+                    return(CODEC_STATUS_PAUSE);
                 }
-                else
+                if ('\r' != pCr[2 + llLen] || '\n' != pCr[3 + llLen])
                 {
-                    LOG4_ERROR("uiReadableBytes = %u, i = %d, cLastChar = %d, pData[i] = %d",
-                            uiReadableBytes, i, int(cLastChar), (int)pData[i]);
+                    LOG4_ERROR("bulk string at offset %u not end with CRLF", m_uiParsedLen);
                     return(CODEC_STATUS_ERR);
                 }
+                stNode.iType = (RESP_BULK_STRING == pLine[0]) ? REDIS_VIEW_STRING
+                        : ((RESP_BLOB_ERROR == pLine[0]) ? REDIS_VIEW_ERROR : REDIS_VIEW_VERB);
+                stNode.uiOffset = pCr + 2 - pData;
+                stNode.uiLen = (uint32)llLen;
+                uiElementLen += (size_t)llLen + 2;
                 break;
-            case '\r':
-                cLastChar = '\r';
+            case RESP_ARRAY:
+            case RESP_SET:
+            case RESP_PUSH:
+            case RESP_MAP:
+            case RESP_ATTRIBUTE:
+                if (!ParseLength(pContent, uiContentLen, llLen) || llLen < -1)
+                {
+                    LOG4_ERROR("invalid aggregate length at offset %u", m_uiParsedLen);
+                    return(CODEC_STATUS_ERR);
+                }
+                if (llLen == -1)
+                {
+                    stNode.iType = REDIS_VIEW_NIL;
+                    break;
+                }
+                switch (pLine[0])
+                {
+                    case RESP_ARRAY:
+                        stNode.iType = REDIS_VIEW_ARRAY;
+                        break;
+                    case RESP_SET:
+                        stNode.iType = REDIS_VIEW_SET;
+                        break;
+                    case RESP_PUSH:
+                        stNode.iType = REDIS_VIEW_PUSH;
+                        break;
+                    case RESP_MAP:
+                        stNode.iType = REDIS_VIEW_MAP;
+                        llLen *= 2;
+                        break;
+                    default:
+                        stNode.iType = REDIS_VIEW_ATTRIBUTE;
+                        llLen *= 2;
+                }
+                stNode.uiElementNum = (uint32)llLen;
+                stNode.uiLen = 0;
                 break;
             default:
-                ++uiStringLen;
+                LOG4_ERROR("invalid redis reply type %d at offset %u", (int)pLine[0], m_uiParsedLen);
+                return(CODEC_STATUS_ERR);
+        }
+        if (m_vecFrame.empty() && REDIS_VIEW_ATTRIBUTE != stNode.iType)
+        {
+            m_oReplyView.m_uiRoot = vecNode.size();
+        }
+        vecNode.push_back(stNode);
+        m_uiParsedLen += uiElementLen;
+        if (stNode.uiElementNum > 0)
+        {
+            tagRespFrame stFrame;
+            stFrame.uiNode = vecNode.size() - 1;
+            stFrame.uiRemain = stNode.uiElementNum;
+            m_vecFrame.push_back(stFrame);
+        }
+        else if (ElementDone(REDIS_VIEW_ATTRIBUTE == stNode.iType))
+        {
+            return(CODEC_STATUS_OK);
         }
     }
     return(CODEC_STATUS_PAUSE);
 }
 
-E_CODEC_STATUS CodecResp::DecodeInteger(CBuffer* pBuff, RedisReply& oReply)
+bool CodecResp::ElementDone(bool bAttribute)
 {
-    size_t uiReadableBytes = pBuff->ReadableBytes();
-    char cLastChar = 0;
-    const char* pData = pBuff->GetRawReadBuffer();
-    const char* pPartBegin = pData;
-    for (size_t i = 0; i < uiReadableBytes; ++i)
+    // attribute不计入所在聚合类型的元素数量，也不是一个完整的回复
+    uint32 uiEnd = m_oReplyView.m_vecNode.size();
+    while (!bAttribute)
     {
-        switch (pData[i])
+        if (m_vecFrame.empty())
         {
-            case '\n':
-                if ('\r' == cLastChar)
-                {
-                    cLastChar = '\n';
-                    oReply.set_type(REDIS_REPLY_INTEGER);
-                    oReply.set_integer(StringConverter::RapidAtoi<int64>(pPartBegin));
-                    pBuff->AdvanceReadIndex(i + 1);
-                    return(CODEC_STATUS_OK);
-                }
-                else
-                {
-                    LOG4_ERROR("uiReadableBytes = %u, i = %d, cLastChar = %d, pData[i] = %d",
-                            uiReadableBytes, i, int(cLastChar), (int)pData[i]);
-                    return(CODEC_STATUS_ERR);
-                }
-                break;
-            case '\r':
-                cLastChar = '\r';
-                break;
-            default:
-                ;
+            return(true);
         }
+        tagRespFrame& stFrame = m_vecFrame.back();
+        if (--stFrame.uiRemain > 0)
+        {
+            return(false);
+        }
+        tagRespNode& stNode = m_oReplyView.m_vecNode[stFrame.uiNode];
+        stNode.uiNext = uiEnd;
+        bAttribute = (REDIS_VIEW_ATTRIBUTE == stNode.iType);
+        m_vecFrame.pop_back();
     }
-    return(CODEC_STATUS_PAUSE);
+    return(false);
 }
 
-E_CODEC_STATUS CodecResp::DecodeBulkString(CBuffer* pBuff, RedisReply& oReply)
+void CodecResp::ResetParser()
 {
-    size_t uiReadableBytes = pBuff->ReadableBytes();
-    char cLastChar = 0;
-    int32 iStringLen = 0;
-    bool bGotStringLen = false;
-    const char* pData = pBuff->GetRawReadBuffer();
-    const char* pPartBegin = pData;
-    for (size_t i = 0; i < uiReadableBytes; ++i)
+    m_uiParsedLen = 0;
+    m_bReplyReady = false;
+    m_vecFrame.clear();
+    m_oReplyView.m_uiRoot = 0;
+    m_oReplyView.m_pBase = nullptr;
+    if (m_oReplyView.m_vecNode.capacity() > sc_uiMaxNodeHeld)
     {
-        switch (pData[i])
-        {
-            case '\n':
-                if ('\r' == cLastChar)
-                {
-                    cLastChar = '\n';
-                    if (bGotStringLen)
-                    {
-                        oReply.set_type(REDIS_REPLY_STRING);
-                        oReply.set_str(pPartBegin, iStringLen);
-                        pBuff->AdvanceReadIndex(i + 1);
-                        return(CODEC_STATUS_OK);
-                    }
-                    else
-                    {
-                        iStringLen = StringConverter::RapidAtoi<int32>(pPartBegin);
-                        pPartBegin = pData + i + 1;
-                        bGotStringLen = true;
-                        if (iStringLen == -1)
-                        {
-                            oReply.set_type(REDIS_REPLY_NIL);
-                            pBuff->AdvanceReadIndex(i + 1);
-                            return(CODEC_STATUS_OK);
-                        }
-                        i += (uint32)iStringLen;
-                        if (uiReadableBytes < (i + 1 + 2)) // not enough data (pos i + 1 is the end of bulk string)
-                        {
-                            return(CODEC_STATUS_PAUSE);
-                        }
-                    }
-                }
-                else
-                {
-                    LOG4_ERROR("uiReadableBytes = %u, i = %d, iStringLen = %d, cLastChar = %d, pData[i] = %d",
-                            uiReadableBytes, i, iStringLen, int(cLastChar), (int)pData[i]);
-                    return(CODEC_STATUS_ERR);
-                }
-                break;
-            case '\r':
-                cLastChar = '\r';
-                break;
-            default:
-                ;
-        }
+        std::vector<tagRespNode>().swap(m_oReplyView.m_vecNode);
+    }
+    else
+    {
+        m_oReplyView.m_vecNode.clear();
     }
-    return(CODEC_STATUS_PAUSE);
 }
 
-E_CODEC_STATUS CodecResp::DecodeArray(CBuffer* pBuff, RedisReply& oReply)
+bool CodecResp::ParseLength(const char* pData, uint32 uiLen, int64& llLen)
 {
-    size_t uiReadableBytes = pBuff->ReadableBytes();
-    char cLastChar = 0;
-    int32 iArraySize = 0;
-    size_t uiReadIndex = pBuff->GetReadIndex();
-    const char* pData = pBuff->GetRawReadBuffer();
-    const char* pPartBegin = pData;
-    for (size_t i = 0; i < uiReadableBytes; ++i)
+    if (uiLen == 0 || uiLen > 11)
+    {
+        return(false);
+    }
+    uint32 i = ('-' == pData[0]) ? 1 : 0;
+    if (i == uiLen)
     {
-        switch (pData[i])
+        return(false);
+    }
+    for (; i < uiLen; ++i)
+    {
+        if (pData[i] < '0' || pData[i] > '9')
         {
-            case '\n':
-                if ('\r' == cLastChar)
-                {
-                    cLastChar = '\n';
-                    iArraySize = StringConverter::RapidAtoi<int32>(pPartBegin);
-                    pBuff->AdvanceReadIndex(i + 1);
-
-                    if (iArraySize == -1)
-                    {
-                        oReply.set_type(REDIS_REPLY_NIL);
-                        return(CODEC_STATUS_OK);
-                    }
-                    else
-                    {
-                        oReply.set_type(REDIS_REPLY_ARRAY);
-                        for (int32 j = 0; j < iArraySize; ++j)
-                        {
-                            if (pBuff->ReadableBytes() == 0)
-                            {
-                                return(CODEC_STATUS_PAUSE);
-                            }
-                            uiReadIndex = pBuff->GetReadIndex();
-                            char cFirstByte = 0;
-                            auto pElement = oReply.add_element();
-                            pBuff->ReadByte(cFirstByte);
-                            E_CODEC_STATUS eStatus = CODEC_STATUS_OK;
-                            switch (cFirstByte)
-                            {
-                                case RESP_SIMPLE_STRING:
-                                    eStatus = DecodeSimpleString(pBuff, *pElement);
-                                    break;
-                                case RESP_INTEGER:
-                                    eStatus = DecodeInteger(pBuff, *pElement);
-                                    break;
-                                case RESP_BULK_STRING:
-                                    eStatus = DecodeBulkString(pBuff, *pElement);
-                                    break;
-                                case RESP_ARRAY:
-                                    eStatus = DecodeArray(pBuff, *pElement);
-                                    break;
-                                case RESP_ERROR:
-                                    eStatus = DecodeError(pBuff, *pElement);
-                                    break;
-                                default:
-                                    oReply.set_type(REDIS_REPLY_ERROR);
-                                    oReply.set_integer(REDIS_ERR_PROTOCOL);
-                                    LOG4_ERROR("uiReadableBytes = %u, i = %d, cFirstByte = %d, cLastChar = %d, pData[i] = %d",
-                                        uiReadableBytes, i, (int)cFirstByte, (int)cLastChar, (int)pData[i]);
-                                    return(CODEC_STATUS_ERR);
-                            }
-                            if (CODEC_STATUS_OK != eStatus)
-                            {
-                                return(eStatus);
-                            }
-                            i += (pBuff->GetReadIndex() - uiReadIndex);
-                        }
-                        return(CODEC_STATUS_OK);
-                    }
-                }
-                else
-                {
-                    LOG4_ERROR("uiReadableBytes = %u, i = %d, cLastChar = %d, pData[i] = %d",
-                        uiReadableBytes, i, (int)cLastChar, (int)pData[i]);
-                    return(CODEC_STATUS_ERR);
-                }
-                break;
-            case '\r':
-                cLastChar = '\r';
-                break;
-            default:
-                ;
+            return(false);
         }
     }
-    return(CODEC_STATUS_PAUSE);
+    llLen = StringConverter::RapidAtoi<int64>(pData);
+    return(llLen <= 0x7FFFFFFF);
 }
 
 }
-
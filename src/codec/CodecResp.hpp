@@ -10,7 +10,9 @@
 #ifndef SRC_CODEC_CODECRESP_HPP_
 #define SRC_CODEC_CODECRESP_HPP_
 
+#include <vector>
 #include "Codec.hpp"
+#include "RedisReplyView.hpp"
 #include "pb/redis.pb.h"
 
 namespace neb
@@ -30,6 +32,14 @@ public:
     virtual E_CODEC_STATUS Encode(const RedisReply& oReply, CBuffer* pBuff);
     virtual E_CODEC_STATUS Decode(CBuffer* pBuff, RedisReply& oReply);
 
+    /**
+     * @brief 解码为只读视图
+     * @note 数据不完整时保留已解析的节点和位置，下次从未完成的元素处继续解析，读索引
+     * 在整个回复解析完成之前不移动。返回的视图指向pBuff中的数据，在下一次Decode之前
+     * 有效，下一次Decode时才移动读索引跳过该回复。
+     */
+    E_CODEC_STATUS Decode(CBuffer* pBuff, const RedisReplyView*& pReplyView);
+
 protected:
     E_CODEC_STATUS EncodeSimpleString(const RedisReply& oReply, CBuffer* pBuff);
     E_CODEC_STATUS EncodeError(const RedisReply& oReply, CBuffer* pBuff);
@@ -37,18 +47,41 @@ protected:
     E_CODEC_STATUS EncodeBulkString(const RedisReply& oReply, CBuffer* pBuff);
     E_CODEC_STATUS EncodeArray(const RedisReply& oReply, CBuffer* pBuff);
     E_CODEC_STATUS EncodeNull(const RedisReply& oReply, CBuffer* pBuff);
-    E_CODEC_STATUS DecodeSimpleString(CBuffer* pBuff, RedisReply& oReply);
-    E_CODEC_STATUS DecodeError(CBuffer* pBuff, RedisReply& oReply);
-    E_CODEC_STATUS DecodeInteger(CBuffer* pBuff, RedisReply& oReply);
-    E_CODEC_STATUS DecodeBulkString(CBuffer* pBuff, RedisReply& oReply);
-    E_CODEC_STATUS DecodeArray(CBuffer* pBuff, RedisReply& oReply);
+    E_CODEC_STATUS Parse(CBuffer* pBuff);
+    bool ElementDone(bool bAttribute);
+    void ResetParser();
+    static bool ParseLength(const char* pData, uint32 uiLen, int64& llLen);
 
 private:
+    struct tagRespFrame
+    {
+        uint32 uiNode;                  ///< 聚合类型节点下标
+        uint32 uiRemain;                ///< 尚未解析完成的子元素数量
+    };
+
+    size_t m_uiParsedLen;               ///< 当前回复已解析的字节数（相对读索引）
+    bool m_bReplyReady;                 ///< m_oReplyView中是已解析完成但读索引尚未跳过的回复
+    std::vector<tagRespFrame> m_vecFrame;   ///< 未完成的聚合类型节点
+    RedisReplyView m_oReplyView;
+
+    static const uint32 sc_uiMaxNodeHeld;   ///< 回复解析完后保留的节点数组容量上限
+
     static const char RESP_SIMPLE_STRING;
     static const char RESP_ERROR;
     static const char RESP_INTEGER;
     static const char RESP_BULK_STRING;
     static const char RESP_ARRAY;
+    // RESP3
+    static const char RESP_NULL;
+    static const char RESP_BOOLEAN;
+    static const char RESP_DOUBLE;
+    static const char RESP_BIG_NUMBER;
+    static const char RESP_BLOB_ERROR;
+    static const char RESP_VERBATIM_STRING;
+    static const char RESP_MAP;
+    static const char RESP_SET;
+    static const char RESP_ATTRIBUTE;
+    static const char RESP_PUSH;
 };
 
 } /* namespace neb */
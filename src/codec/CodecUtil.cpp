@@ -8,6 +8,13 @@
 * Modify history:
 ******************************************************************************/
 #include "CodecUtil.hpp"
+#include <cstring>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#if defined(NEB_WS_MASK_AVX2)
+#include <immintrin.h>
+#endif
 #include <cryptopp/default.h>
 #include <cryptopp/cryptlib.h>
 #include <cryptopp/aes.h>
@@ -191,5 +198,93 @@ bool CodecUtil::AesDecrypt(const std::string& strKey, const std::string& strSrc,
     return(true);
 }
 
+/* WebSocket掩码：以下实现均要求pData[0]对应掩码第0字节（由WsMask()轮转掩码保证），
+ * 向量宽度都是4的倍数，每个向量块内的掩码相位相同。 */
+void CodecUtil::WsMaskWord(char* pData, size_t uiLen, uint64 ullKey)
+{
+    size_t i = 0;
+    for (; i + 8 <= uiLen; i += 8)
+    {
+        uint64 ullWord;
+        memcpy(&ullWord, pData + i, 8);
+        ullWord ^= ullKey;
+        memcpy(pData + i, &ullWord, 8);
+    }
+    const char* pKey = (const char*)&ullKey;
+    for (; i < uiLen; ++i)
+    {
+        pData[i] ^= pKey[i & 7];
+    }
+}
+
+#if defined(__SSE2__)
+void CodecUtil::WsMaskSse2(char* pData, size_t uiLen, uint64 ullKey)
+{
+    __m128i xmmKey = _mm_set1_epi64x((long long)ullKey);
+    size_t i = 0;
+    for (; i + 16 <= uiLen; i += 16)
+    {
+        __m128i xmmData = _mm_loadu_si128((const __m128i*)(pData + i));
+        _mm_storeu_si128((__m128i*)(pData + i), _mm_xor_si128(xmmData, xmmKey));
+    }
+    WsMaskWord(pData + i, uiLen - i, ullKey);
 }
+#endif
 
+#if defined(NEB_WS_MASK_AVX2)
+__attribute__((target("avx2")))
+void CodecUtil::WsMaskAvx2(char* pData, size_t uiLen, uint64 ullKey)
+{
+    __m256i ymmKey = _mm256_set1_epi64x((long long)ullKey);
+    size_t i = 0;
+    for (; i + 32 <= uiLen; i += 32)
+    {
+        __m256i ymmData = _mm256_loadu_si256((const __m256i*)(pData + i));
+        _mm256_storeu_si256((__m256i*)(pData + i), _mm256_xor_si256(ymmData, ymmKey));
+    }
+    if (i + 16 <= uiLen)    // 尾部不调用WsMaskSse2()，避免AVX与非VEX编码SSE指令混用的切换开销
+    {
+        __m128i xmmData = _mm_loadu_si128((const __m128i*)(pData + i));
+        _mm_storeu_si128((__m128i*)(pData + i), _mm_xor_si128(xmmData, _mm256_castsi256_si128(ymmKey)));
+        i += 16;
+    }
+    WsMaskWord(pData + i, uiLen - i, ullKey);
+}
+#endif
+
+CodecUtil::WsMaskFunc CodecUtil::SelectWsMask()
+{
+#if defined(NEB_WS_MASK_AVX2)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+    {
+        return(&CodecUtil::WsMaskAvx2);
+    }
+#endif
+#if defined(__SSE2__)
+    return(&CodecUtil::WsMaskSse2);
+#else
+    return(&CodecUtil::WsMaskWord);
+#endif
+}
+
+const CodecUtil::WsMaskFunc CodecUtil::s_pfnWsMask = CodecUtil::SelectWsMask();
+
+void CodecUtil::WsMask(char* pData, size_t uiLen, const char* szMaskKey, size_t uiKeyOffset)
+{
+    char szKey[8];
+    for (int i = 0; i < 8; ++i)
+    {
+        szKey[i] = szMaskKey[(uiKeyOffset + i) & 3];
+    }
+    uint64 ullKey;
+    memcpy(&ullKey, szKey, 8);
+    if (uiLen < 16)
+    {
+        WsMaskWord(pData, uiLen, ullKey);
+        return;
+    }
+    s_pfnWsMask(pData, uiLen, ullKey);
+}
+
+}
@@ -13,6 +13,10 @@
 #include <string>
 #include "Definition.hpp"
 
+#if defined(__x86_64__) && (defined(__clang__) || (defined(__GNUC__) && __GNUC__ >= 5))
+#define NEB_WS_MASK_AVX2
+#endif
+
 namespace neb
 {
 
@@ -57,6 +61,16 @@ public:
     static bool AesEncrypt(const std::string& strKey, const std::string& strSrc, std::string& strDest);
     static bool AesDecrypt(const std::string& strKey, const std::string& strSrc, std::string& strDest);
 
+    /**
+     * @brief WebSocket掩码（掩码与去掩码是同一运算），原地异或
+     * @param pData 数据起始位置，无对齐要求
+     * @param uiLen 数据长度
+     * @param szMaskKey 4字节掩码
+     * @param uiKeyOffset pData[0]在帧载荷中的偏移（分段处理同一帧时用于对齐掩码）
+     * @note 运行时按CPU选择AVX2、SSE2或64位字实现。
+     */
+    static void WsMask(char* pData, size_t uiLen, const char* szMaskKey, size_t uiKeyOffset = 0);
+
 protected:
     static inline bool IsLittleEndian()
     {
@@ -68,8 +82,24 @@ protected:
         return('B' == (uint8)s_uHostOrder.uiOrder);
     }
 
+    typedef void (*WsMaskFunc)(char*, size_t, uint64);
+
+    /**
+     * @brief WebSocket掩码的各个实现，pData[0]对应掩码第0字节，ullKey为轮转后重复两次的掩码
+     * @note 各实现结果必须与逐字节异或一致，由test/codec/CodecUtilCheck.cpp校验
+     */
+    static void WsMaskWord(char* pData, size_t uiLen, uint64 ullKey);
+#if defined(__SSE2__)
+    static void WsMaskSse2(char* pData, size_t uiLen, uint64 ullKey);
+#endif
+#if defined(NEB_WS_MASK_AVX2)
+    static void WsMaskAvx2(char* pData, size_t uiLen, uint64 ullKey);
+#endif
+    static WsMaskFunc SelectWsMask();
+
 private:
     static UnionHostOrder s_uHostOrder;
+    static const WsMaskFunc s_pfnWsMask;
 };
 
 }
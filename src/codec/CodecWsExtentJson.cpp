@@ -241,8 +241,6 @@ E_CODEC_STATUS CodecWsExtentJson::Decode(CBuffer* pBuff,
             return (CODEC_STATUS_OK);
         }
 
-        char cData;
-        const char* pRawData;
         char szMaskKey[4] = {0};
         uint32 uiPayload = 0;
         if (WEBSOCKET_PAYLOAD_LEN_UINT64 == (WEBSOCKET_PAYLOAD_LEN & ucSecondByte))
@@ -296,12 +294,7 @@ E_CODEC_STATUS CodecWsExtentJson::Decode(CBuffer* pBuff,
             }
             uiPayload = (uint32)ucPayload;
         }
-        pRawData = pBuff->GetRawReadBuffer();
-        for (uint32 i = pBuff->GetReadIndex(), j = 0; j < uiPayload; ++i, ++j)
-        {
-            cData = pRawData[i] ^ szMaskKey[j % 4];
-            pBuff->SetBytes(&cData, 1, i);
-        }
+        CodecUtil::WsMask(pBuff->GetRawReadBuffer(), uiPayload, szMaskKey);
         tagMsgHead stMsgHead;
         pBuff->Read(&stMsgHead, uiHeadSize);
         stMsgHead.cmd = ntohs(stMsgHead.cmd);
@@ -184,11 +184,10 @@ E_CODEC_STATUS CodecWsExtentPb::Encode(const MsgHead& oMsgHead,
             iNeedWriteLen = strCompressData.size();
             iWriteLen = pBuff->Write(strCompressData.c_str(), strCompressData.size());
         }
-        else    // 无效的压缩或加密算法，打包原数据
+        else    // 无效的压缩或加密算法，打包原数据（直接序列化到缓冲区）
         {
             iNeedWriteLen = oMsgBody.ByteSize();
-            oMsgBody.SerializeToString(&strTmpData);
-            iWriteLen = pBuff->Write(strTmpData.c_str(), oMsgBody.ByteSize());
+            iWriteLen = SerializeToBuffer(oMsgBody, iNeedWriteLen, pBuff) ? iNeedWriteLen : 0;
         }
         if (iWriteLen != iNeedWriteLen)
         {
@@ -238,8 +237,6 @@ E_CODEC_STATUS CodecWsExtentPb::Decode(CBuffer* pBuff,
             return (CODEC_STATUS_OK);
         }
 
-        char cData;
-        const char* pRawData;
         char szMaskKey[4] = {0};
         uint32 uiPayload = 0;
         if (WEBSOCKET_PAYLOAD_LEN_UINT64 == (WEBSOCKET_PAYLOAD_LEN & ucSecondByte))
@@ -293,12 +290,7 @@ E_CODEC_STATUS CodecWsExtentPb::Decode(CBuffer* pBuff,
             }
             uiPayload = (uint32)ucPayload;
         }
-        pRawData = pBuff->GetRawReadBuffer();
-        for (uint32 i = pBuff->GetReadIndex(), j = 0; j < uiPayload; ++i, ++j)
-        {
-            cData = pRawData[i] ^ szMaskKey[j % 4];
-            pBuff->SetBytes(&cData, 1, i);
-        }
+        CodecUtil::WsMask(pBuff->GetRawReadBuffer(), uiPayload, szMaskKey);
         tagMsgHead stMsgHead;
         pBuff->Read(&stMsgHead, uiHeadSize);
         stMsgHead.cmd = ntohs(stMsgHead.cmd);
@@ -0,0 +1,85 @@
+/*******************************************************************************
+ * Project:  Nebula
+ * @file     RedisReplyView.cpp
+ * @brief    redis回复的只读视图
+ * @author   Bwar
+ * @date:    2026年10月17日
+ * @note
+ * Modify history:
+ ******************************************************************************/
+#include "RedisReplyView.hpp"
+
+namespace neb
+{
+
+RedisReplyView::RedisReplyView()
+    : m_pBase(nullptr), m_uiRoot(0)
+{
+}
+
+RedisReplyView::~RedisReplyView()
+{
+}
+
+void RedisReplyView::ToRedisReply(RedisReply& oReply) const
+{
+    if (m_uiRoot < m_vecNode.size())
+    {
+        ToRedisReply(m_uiRoot, oReply);
+    }
+}
+
+void RedisReplyView::ToRedisReply(uint32 uiNode, RedisReply& oReply) const
+{
+    const tagRespNode& stNode = m_vecNode[uiNode];
+    switch (stNode.iType)
+    {
+        case REDIS_VIEW_STRING:
+        case REDIS_VIEW_DOUBLE:
+        case REDIS_VIEW_BIGNUM:
+            oReply.set_type(REDIS_REPLY_STRING);
+            oReply.set_str(m_pBase + stNode.uiOffset, stNode.uiLen);
+            break;
+        case REDIS_VIEW_VERB:   // "txt:" or "mkd:"
+            oReply.set_type(REDIS_REPLY_STRING);
+            if (stNode.uiLen >= 4)
+            {
+                oReply.set_str(m_pBase + stNode.uiOffset + 4, stNode.uiLen - 4);
+            }
+            else
+            {
+                oReply.set_str(m_pBase + stNode.uiOffset, stNode.uiLen);
+            }
+            break;
+        case REDIS_VIEW_STATUS:
+            oReply.set_type(REDIS_REPLY_STATUS);
+            oReply.set_str(m_pBase + stNode.uiOffset, stNode.uiLen);
+            break;
+        case REDIS_VIEW_ERROR:
+            oReply.set_type(REDIS_REPLY_ERROR);
+            oReply.set_str(m_pBase + stNode.uiOffset, stNode.uiLen);
+            break;
+        case REDIS_VIEW_INTEGER:
+        case REDIS_VIEW_BOOL:
+            oReply.set_type(REDIS_REPLY_INTEGER);
+            oReply.set_integer(stNode.llInteger);
+            break;
+        case REDIS_VIEW_ARRAY:
+        case REDIS_VIEW_MAP:
+        case REDIS_VIEW_SET:
+        case REDIS_VIEW_PUSH:
+            oReply.set_type(REDIS_REPLY_ARRAY);
+            for (uint32 i = uiNode + 1; i < stNode.uiNext; i = m_vecNode[i].uiNext)
+            {
+                if (REDIS_VIEW_ATTRIBUTE != m_vecNode[i].iType)
+                {
+                    ToRedisReply(i, *oReply.add_element());
+                }
+            }
+            break;
+        default:
+            oReply.set_type(REDIS_REPLY_NIL);
+    }
+}
+
+} /* namespace neb */
@@ -0,0 +1,158 @@
+/*******************************************************************************
+ * Project:  Nebula
+ * @file     RedisReplyView.hpp
+ * @brief    redis回复的只读视图
+ * @author   Bwar
+ * @date:    2026年10月17日
+ * @note     CodecResp解析出的回复以扁平节点数组表示：节点按先序排列，聚合类型的
+ * 第一个子节点紧随其后，uiNext指向跳过整个子树后的下一个兄弟节点。字符串不拷贝，
+ * 只记录相对回复起点的偏移和长度，取值时与接收缓冲区中的回复起点相加。
+ * 视图只在Step::Callback(pChannel, oReplyView)回调期间有效，需要保留的须自行拷贝。
+ * Modify history:
+ ******************************************************************************/
+#ifndef SRC_CODEC_REDISREPLYVIEW_HPP_
+#define SRC_CODEC_REDISREPLYVIEW_HPP_
+
+#include <string>
+#include <vector>
+#include "Definition.hpp"
+#include "pb/redis.pb.h"
+
+namespace neb
+{
+
+/**
+ * @brief 回复节点类型
+ * @note 前6种与E_REDIS_REPLY取值相同，其余为RESP3类型（取值与hiredis一致）。
+ */
+enum E_REDIS_REPLY_VIEW_TYPE
+{
+    REDIS_VIEW_STRING       = REDIS_REPLY_STRING,
+    REDIS_VIEW_ARRAY        = REDIS_REPLY_ARRAY,
+    REDIS_VIEW_INTEGER      = REDIS_REPLY_INTEGER,
+    REDIS_VIEW_NIL          = REDIS_REPLY_NIL,
+    REDIS_VIEW_STATUS       = REDIS_REPLY_STATUS,
+    REDIS_VIEW_ERROR        = REDIS_REPLY_ERROR,
+    REDIS_VIEW_DOUBLE       = 7,
+    REDIS_VIEW_BOOL         = 8,
+    REDIS_VIEW_MAP          = 9,
+    REDIS_VIEW_SET          = 10,
+    REDIS_VIEW_ATTRIBUTE    = 11,
+    REDIS_VIEW_PUSH         = 12,
+    REDIS_VIEW_BIGNUM       = 13,
+    REDIS_VIEW_VERB         = 14,
+};
+
+/**
+ * @brief 指向接收缓冲区的字符串片段（C++14没有std::string_view）
+ */
+struct tagStrView
+{
+    const char* pData = nullptr;
+    uint32 uiLen = 0;
+
+    std::string ToString() const
+    {
+        return(std::string(pData, uiLen));
+    }
+};
+
+struct tagRespNode
+{
+    int32 iType = 0;                ///< E_REDIS_REPLY_VIEW_TYPE
+    uint32 uiElementNum = 0;        ///< 聚合类型的子节点数量（map和attribute为键与值的总数）
+    uint32 uiNext = 0;              ///< 跳过本节点子树之后的节点下标
+    uint32 uiOffset = 0;            ///< 字符串相对回复起点的偏移
+    uint32 uiLen = 0;               ///< 字符串长度
+    int64 llInteger = 0;            ///< 整数值（bool为0或1）
+};
+
+class RedisReplyView
+{
+public:
+    RedisReplyView();
+    RedisReplyView(const RedisReplyView&) = delete;
+    RedisReplyView& operator=(const RedisReplyView&) = delete;
+    ~RedisReplyView();
+
+    /**
+     * @brief 回复根节点下标（回复前面带RESP3 attribute时不为0）
+     */
+    uint32 Root() const
+    {
+        return(m_uiRoot);
+    }
+
+    uint32 NodeNum() const
+    {
+        return((uint32)m_vecNode.size());
+    }
+
+    const tagRespNode& Node(uint32 uiNode) const
+    {
+        return(m_vecNode[uiNode]);
+    }
+
+    int32 Type(uint32 uiNode) const
+    {
+        return(m_vecNode[uiNode].iType);
+    }
+
+    int64 Integer(uint32 uiNode) const
+    {
+        return(m_vecNode[uiNode].llInteger);
+    }
+
+    tagStrView Str(uint32 uiNode) const
+    {
+        tagStrView stStr;
+        stStr.pData = m_pBase + m_vecNode[uiNode].uiOffset;
+        stStr.uiLen = m_vecNode[uiNode].uiLen;
+        return(stStr);
+    }
+
+    uint32 ElementNum(uint32 uiNode) const
+    {
+        return(m_vecNode[uiNode].uiElementNum);
+    }
+
+    /**
+     * @brief 遍历子节点：for (uint32 i = FirstChild(n); i < EndChild(n); i = NextSibling(i))
+     */
+    uint32 FirstChild(uint32 uiNode) const
+    {
+        return(uiNode + 1);
+    }
+
+    uint32 EndChild(uint32 uiNode) const
+    {
+        return(m_vecNode[uiNode].uiNext);
+    }
+
+    uint32 NextSibling(uint32 uiNode) const
+    {
+        return(m_vecNode[uiNode].uiNext);
+    }
+
+    /**
+     * @brief 转换为RedisReply
+     * @note RESP3类型映射到已有的RedisReply类型：map、set、push转为数组（map的键
+     * 值依次排列），double和big number转为字符串，bool转为整数，verbatim string去掉
+     * 格式前缀后转为字符串，attribute丢弃。
+     */
+    void ToRedisReply(RedisReply& oReply) const;
+
+protected:
+    void ToRedisReply(uint32 uiNode, RedisReply& oReply) const;
+
+private:
+    const char* m_pBase;
+    uint32 m_uiRoot;
+    std::vector<tagRespNode> m_vecNode;
+
+    friend class CodecResp;
+};
+
+} /* namespace neb */
+
+#endif /* SRC_CODEC_REDISREPLYVIEW_HPP_ */
@@ -21,7 +21,8 @@ namespace neb
 CodecHttp2::CodecHttp2(std::shared_ptr<NetLogger> pLogger,
         E_CODEC_TYPE eCodecType, bool bChannelIsClient)
     : Codec(pLogger, eCodecType),
-      m_bChannelIsClient(bChannelIsClient)
+      m_bChannelIsClient(bChannelIsClient),
+      m_oEncodingDynamicTable(true), m_oDecodingDynamicTable(false)
 {
     try
     {
@@ -29,12 +30,6 @@ CodecHttp2::CodecHttp2(std::shared_ptr<NetLogger> pLogger,
         m_pStreamWeightRoot = new TreeNode<tagStreamWeight>();
         m_pStreamWeightRoot->pData = new tagStreamWeight();
         m_pStreamWeightRoot->pData->uiStreamId = 0;
-
-        Http2Header oHeader("", "");
-        m_vecEncodingDynamicTable.assign(8, oHeader);
-        m_iNextEncodingDynamicTableHeaderIndex = m_vecEncodingDynamicTable.size() - 1;
-        m_vecDecodingDynamicTable.assign(8, oHeader);
-        m_iNextDecodingDynamicTableHeaderIndex = m_vecDecodingDynamicTable.size() - 1;
     }
     catch(std::bad_alloc& e)
     {
@@ -500,7 +495,23 @@ E_H2_ERR_CODE CodecHttp2::Setting(const std::vector<tagSetting>& vecSetting, boo
             case H2_SETTINGS_HEADER_TABLE_SIZE:
                 if (vecSetting[i].uiValue <= SETTINGS_MAX_FRAME_SIZE)
                 {
-                    m_uiSettingsHeaderTableSize = vecSetting[i].uiValue;
+                    if (bRecvSetting)
+                    {
+                        // 编码端动态表不超过默认的4096，对端调小时立即淘汰并在下一个header block通知对端
+                        m_uiSettingsEncodeHeaderTableSize = vecSetting[i].uiValue;
+                        uint32 uiTableSize = std::min(m_uiSettingsEncodeHeaderTableSize, (uint32)4096);
+                        if (uiTableSize != m_oEncodingDynamicTable.GetMaxSize())
+                        {
+                            m_uiEncodingTableSizeUpdateMin = m_bEncodingTableSizeUpdate
+                                ? std::min(m_uiEncodingTableSizeUpdateMin, uiTableSize) : uiTableSize;
+                            m_bEncodingTableSizeUpdate = true;
+                            m_oEncodingDynamicTable.SetMaxSize(uiTableSize);
+                        }
+                    }
+                    else
+                    {
+                        m_uiSettingsHeaderTableSize = vecSetting[i].uiValue;
+                    }
                 }
                 break;
             case H2_SETTINGS_ENABLE_PUSH:
@@ -637,19 +648,7 @@ E_CODEC_STATUS CodecHttp2::UnpackHeader(uint32 uiHeaderBlockEndPos, CBuffer* pBu
                 return(eStatus);
             }
         }
-        else if (H2_HPACK_CONDITION_LITERAL_HEADER_NEVER_INDEXED & B)
-        {
-            eStatus = UnpackHeaderLiteralIndexing(pBuff, B,
-                    H2_HPACK_PREFIX_4_BITS,
-                    strHeaderName, strHeaderValue, bWithHuffman);
-            ClassifyHeader(strHeaderName, strHeaderValue, oHttpMsg);
-            if (eStatus != CODEC_STATUS_PART_OK)
-            {
-                return(eStatus);
-            }
-            oHttpMsg.add_adding_never_index_headers(strHeaderName);
-        }
-        else if (H2_HPACK_CONDITION_DYNAMIC_TABLE_SIZE_UPDATE & B)
+        else if (H2_HPACK_CONDITION_DYNAMIC_TABLE_SIZE_UPDATE & B)     // 001xxxxx，须在0001xxxx之前判断
         {
             uint32 uiTableSize = (uint32)Http2Header::DecodeInt(H2_HPACK_PREFIX_5_BITS, pBuff);
             LOG4_TRACE("uiTableSize = %u", uiTableSize);
@@ -661,7 +660,19 @@ E_CODEC_STATUS CodecHttp2::UnpackHeader(uint32 uiHeaderBlockEndPos, CBuffer* pBu
                         " protocol using HPACK!");
                 return(CODEC_STATUS_ERR);
             }
-            UpdateDecodingDynamicTable(uiTableSize);
+            m_oDecodingDynamicTable.SetMaxSize(uiTableSize);
+        }
+        else if (H2_HPACK_CONDITION_LITERAL_HEADER_NEVER_INDEXED & B)
+        {
+            eStatus = UnpackHeaderLiteralIndexing(pBuff, B,
+                    H2_HPACK_PREFIX_4_BITS,
+                    strHeaderName, strHeaderValue, bWithHuffman);
+            ClassifyHeader(strHeaderName, strHeaderValue, oHttpMsg);
+            if (eStatus != CODEC_STATUS_PART_OK)
+            {
+                return(eStatus);
+            }
+            oHttpMsg.add_adding_never_index_headers(strHeaderName);
         }
         else    // H2_HPACK_CONDITION_LITERAL_HEADER_WITHOUT_INDEXING
         {
@@ -682,17 +693,33 @@ E_CODEC_STATUS CodecHttp2::UnpackHeader(uint32 uiHeaderBlockEndPos, CBuffer* pBu
 
 void CodecHttp2::PackHeader(const HttpMsg& oHttpMsg, int iHeaderType, CBuffer* pBuff)
 {
+    uint32 uiTableSize = m_oEncodingDynamicTable.GetMaxSize();
     if (oHttpMsg.dynamic_table_update_size() > 0)
     {
-        if (oHttpMsg.dynamic_table_update_size() > SETTINGS_MAX_FRAME_SIZE)
+        if (oHttpMsg.dynamic_table_update_size() > m_uiSettingsEncodeHeaderTableSize)
         {
             LOG4_WARNING("invalid dynamic table update size %u, the size must smaller than %u.",
-                    oHttpMsg.dynamic_table_update_size(), SETTINGS_MAX_FRAME_SIZE);
+                    oHttpMsg.dynamic_table_update_size(), m_uiSettingsEncodeHeaderTableSize);
         }
         else
         {
-            PackHeaderDynamicTableSize(oHttpMsg.dynamic_table_update_size(), pBuff);
+            uiTableSize = oHttpMsg.dynamic_table_update_size();
+            if (!m_bEncodingTableSizeUpdate || uiTableSize < m_uiEncodingTableSizeUpdateMin)
+            {
+                m_uiEncodingTableSizeUpdateMin = uiTableSize;
+            }
+            m_bEncodingTableSizeUpdate = true;
+            m_oEncodingDynamicTable.SetMaxSize(uiTableSize);
+        }
+    }
+    if (m_bEncodingTableSizeUpdate)
+    {
+        if (m_uiEncodingTableSizeUpdateMin < uiTableSize)
+        {
+            PackHeaderDynamicTableSize(m_uiEncodingTableSizeUpdateMin, pBuff);
         }
+        PackHeaderDynamicTableSize(uiTableSize, pBuff);
+        m_bEncodingTableSizeUpdate = false;
     }
 
     if (iHeaderType & H2_HEADER_PSEUDO)
@@ -938,11 +965,10 @@ E_CODEC_STATUS CodecHttp2::UnpackHeaderIndexed(CBuffer* pBuff, HttpMsg& oHttpMsg
     }
     else
     {
-        uint32 uiDynamicTableIndex = DecodingDynamicTableIndex2VectorIndex(uiTableIndex - Http2Header::sc_uiMaxStaticTableLength);
-        if (uiDynamicTableIndex < m_vecDecodingDynamicTable.size())
+        const Http2Header* pHeader = m_oDecodingDynamicTable.Get(uiTableIndex - Http2Header::sc_uiMaxStaticTableLength);
+        if (pHeader != nullptr)
         {
-            ClassifyHeader(m_vecDecodingDynamicTable[uiDynamicTableIndex].Name(),
-                    m_vecDecodingDynamicTable[uiDynamicTableIndex].Value(), oHttpMsg);
+            ClassifyHeader(pHeader->Name(), pHeader->Value(), oHttpMsg);
             return(CODEC_STATUS_PART_OK);
         }
         else
@@ -985,14 +1011,14 @@ E_CODEC_STATUS CodecHttp2::UnpackHeaderLiteralIndexing(CBuffer* pBuff, uint8 ucF
             strHeaderName = Http2Header::sc_vecStaticTable[uiTableIndex].first;
             if (H2_HPACK_CONDITION_LITERAL_HEADER_WITH_INDEXING & ucFirstByte)
             {
-                UpdateDecodingDynamicTable(-1, strHeaderName, strHeaderValue);
+                m_oDecodingDynamicTable.Add(strHeaderName, strHeaderValue);
             }
             return(CODEC_STATUS_PART_OK);
         }
         else
         {
-            uint32 uiVectorIndex = DecodingDynamicTableIndex2VectorIndex(uiTableIndex - Http2Header::sc_uiMaxStaticTableLength);
-            if (uiVectorIndex < m_vecDecodingDynamicTable.size())
+            const Http2Header* pHeader = m_oDecodingDynamicTable.Get(uiTableIndex - Http2Header::sc_uiMaxStaticTableLength);
+            if (pHeader != nullptr)
             {
                 if (!Http2Header::DecodeStringLiteral(pBuff, strHeaderValue, bWithHuffman))
                 {
@@ -1000,10 +1026,11 @@ E_CODEC_STATUS CodecHttp2::UnpackHeaderLiteralIndexing(CBuffer* pBuff, uint8 ucF
                     LOG4_ERROR("DecodeStringLiteral failed!");
                     return(CODEC_STATUS_ERR);
                 }
-                strHeaderName = m_vecDecodingDynamicTable[uiVectorIndex].Name();
+                strHeaderName = pHeader->Name();
                 if (H2_HPACK_CONDITION_LITERAL_HEADER_WITH_INDEXING & ucFirstByte)
                 {
-                    UpdateDecodingDynamicTable(uiVectorIndex, strHeaderName, strHeaderValue);
+                    // 引用已有表项的名字，新增一个表项（rfc7541 6.2.1），而不是替换被引用的表项
+                    m_oDecodingDynamicTable.Add(strHeaderName, strHeaderValue);
                 }
                 return(CODEC_STATUS_PART_OK);
             }
@@ -1025,7 +1052,7 @@ E_CODEC_STATUS CodecHttp2::UnpackHeaderLiteralIndexing(CBuffer* pBuff, uint8 ucF
         {
             if (H2_HPACK_CONDITION_LITERAL_HEADER_WITH_INDEXING & ucFirstByte)
             {
-                UpdateDecodingDynamicTable(-1, strHeaderName, strHeaderValue);
+                m_oDecodingDynamicTable.Add(strHeaderName, strHeaderValue);
             }
             return(CODEC_STATUS_PART_OK);
         }
@@ -1178,7 +1205,7 @@ void CodecHttp2::PackHeaderWithIndexing(const std::string& strHeaderName,
         {
             Http2Header::EncodeStringLiteral(strHeaderValue, pBuff);
         }
-        UpdateEncodingDynamicTable(strHeaderName, strHeaderValue);
+        m_oEncodingDynamicTable.Add(strHeaderName, strHeaderValue);
     }
     else    // Literal Header Field with Incremental Indexing - New Name.
     {
@@ -1194,7 +1221,7 @@ void CodecHttp2::PackHeaderWithIndexing(const std::string& strHeaderName,
             Http2Header::EncodeStringLiteral(strHeaderName, pBuff);
             Http2Header::EncodeStringLiteral(strHeaderValue, pBuff);
         }
-        UpdateEncodingDynamicTable(strHeaderName, strHeaderValue);
+        m_oEncodingDynamicTable.Add(strHeaderName, strHeaderValue);
     }
 }
 
@@ -1281,219 +1308,17 @@ uint32 CodecHttp2::GetEncodingTableIndex(const std::string& strHeaderName, const
     {
         return(uiTableIndex);
     }
-    int iEncodingDynamicTableLength = (int)m_vecEncodingDynamicTable.size();
-    for (int i = m_iNextEncodingDynamicTableHeaderIndex + 1; i < iEncodingDynamicTableLength; ++i)
-    {
-        if (m_vecEncodingDynamicTable[i].Name() == strHeaderName)
-        {
-            if (m_vecEncodingDynamicTable[i].Value() == strHeaderValue)
-            {
-                uiTableIndex = i - m_iNextEncodingDynamicTableHeaderIndex + Http2Header::sc_uiMaxStaticTableIndex;
-                break;
-            }
-            else if (uiNameIndex == 0)
-            {
-                uiNameIndex = i - m_iNextEncodingDynamicTableHeaderIndex + Http2Header::sc_uiMaxStaticTableIndex;
-            }
-        }
-    }
-    return(uiTableIndex);
-}
-
-uint32 CodecHttp2::GetDecodingTableIndex(const std::string& strHeaderName, const std::string& strHeaderValue, uint32& uiNameIndex)
-{
-    uiNameIndex = 0;
-    uint32 uiTableIndex = 0;
-    uiTableIndex = Http2Header::GetStaticTableIndex(strHeaderName, strHeaderValue, uiNameIndex);
+    bool bNameInStaticTable = (uiNameIndex > 0);
+    uiTableIndex = m_oEncodingDynamicTable.Find(strHeaderName, strHeaderValue, uiNameIndex);
     if (uiTableIndex > 0)
     {
-        return(uiTableIndex);
-    }
-    int iDecodingDynamicTableLength = (int)m_vecDecodingDynamicTable.size();
-    for (int i = m_iNextDecodingDynamicTableHeaderIndex + 1; i < iDecodingDynamicTableLength; ++i)
-    {
-        if (m_vecDecodingDynamicTable[i].Name() == strHeaderName)
-        {
-            if (m_vecDecodingDynamicTable[i].Value() == strHeaderValue)
-            {
-                uiTableIndex = i - m_iNextDecodingDynamicTableHeaderIndex + Http2Header::sc_uiMaxStaticTableIndex;
-                break;
-            }
-            else if (uiNameIndex == 0)
-            {
-                uiNameIndex = i - m_iNextDecodingDynamicTableHeaderIndex + Http2Header::sc_uiMaxStaticTableIndex;
-            }
-        }
-    }
-    return(uiTableIndex);
-}
-
-void CodecHttp2::UpdateEncodingDynamicTable(const std::string& strHeaderName, const std::string& strHeaderValue)
-{
-    Http2Header oHeader(strHeaderName, strHeaderValue);
-    uint32 uiEntrySize = oHeader.HpackSize();
-    // if the new header is too big, drop all entries
-    if (uiEntrySize > m_uiSettingsHeaderTableSize)
-    {
-        m_uiEncodingDynamicTableSize = 0;
-        m_uiEncodingDynamicTableHeaderCount = 0;
-        m_iNextEncodingDynamicTableHeaderIndex = m_vecEncodingDynamicTable.size() - 1;
-        return;
-    }
-
-    // evict headers to required length
-    int32 iNeedRecoverSize = (m_uiEncodingDynamicTableSize + uiEntrySize) - m_uiSettingsHeaderTableSize;
-    UpdateEncodingDynamicTable(iNeedRecoverSize);
-
-    if (m_uiEncodingDynamicTableHeaderCount + 1 > m_vecEncodingDynamicTable.size()) // need to grow the dynamic table.
-    {
-        Http2Header oHeader("", "");
-        std::vector<Http2Header> vecDynamicTable;
-        vecDynamicTable.assign(m_vecEncodingDynamicTable.size() * 2, oHeader);
-        for (uint32 i = 0; i < m_vecEncodingDynamicTable.size(); ++i)
-        {
-            vecDynamicTable[m_vecEncodingDynamicTable.size() + i] = std::move(m_vecEncodingDynamicTable[i]);
-        }
-        m_iNextEncodingDynamicTableHeaderIndex = m_vecEncodingDynamicTable.size() - 1;
-        m_vecEncodingDynamicTable = std::move(vecDynamicTable);
+        return(uiTableIndex + Http2Header::sc_uiMaxStaticTableIndex);
     }
-    int iCurrent = m_iNextEncodingDynamicTableHeaderIndex--;
-    m_vecEncodingDynamicTable[iCurrent] = std::move(oHeader);
-    ++m_uiEncodingDynamicTableHeaderCount;
-    m_uiEncodingDynamicTableSize += uiEntrySize;
-}
-
-uint32 CodecHttp2::UpdateEncodingDynamicTable(int32 iRecoverSize)
-{
-    uint32 uiEvictHeaderNum = 0;
-    if (iRecoverSize > 0)
+    if (uiNameIndex > 0 && !bNameInStaticTable)
     {
-        int32 iEvictHeaderSize = 0;
-        // determine how many headers need to be evicted.
-        for (int32 i = (int32)m_vecEncodingDynamicTable.size() - 1;
-                iEvictHeaderSize < iRecoverSize; --i)
-        {
-            if (i < 0 || i < m_iNextEncodingDynamicTableHeaderIndex)
-            {
-                break;
-            }
-            iEvictHeaderSize += m_vecEncodingDynamicTable[i].HpackSize();
-            m_uiSettingsHeaderTableSize -= m_vecEncodingDynamicTable[i].HpackSize();
-            --m_uiEncodingDynamicTableHeaderCount;
-            ++uiEvictHeaderNum;
-        }
-
-        // move headers in dynamic table
-        uint32 uiFrom = 0;
-        uint32 uiTo = 0;
-        for (uint32 j = 0; j < uiEvictHeaderNum; ++j)
-        {
-            uiTo = m_vecEncodingDynamicTable.size() - 1 - j;
-            uiFrom = m_vecEncodingDynamicTable.size() - 1 - j - uiEvictHeaderNum;
-            m_vecEncodingDynamicTable[uiTo] = std::move(m_vecEncodingDynamicTable[uiFrom]);
-        }
-        m_iNextEncodingDynamicTableHeaderIndex += uiEvictHeaderNum;
+        uiNameIndex += Http2Header::sc_uiMaxStaticTableIndex;
     }
-    return(uiEvictHeaderNum);
-}
-
-uint32 CodecHttp2::EncodingDynamicTableIndex2VectorIndex(uint32 uiIndex)
-{
-    return(m_iNextEncodingDynamicTableHeaderIndex + 1 + uiIndex);
-}
-
-void CodecHttp2::UpdateDecodingDynamicTable(int32 iVectorIndex, const std::string& strHeaderName, const std::string& strHeaderValue)
-{
-    Http2Header oHeader(strHeaderName, strHeaderValue);
-    uint32 uiEntrySize = oHeader.HpackSize();
-
-    if (iVectorIndex < 0 || iVectorIndex >= (int32)m_vecDecodingDynamicTable.size())    // new header
-    {
-        // if the new header is too big, drop all entries.
-        if (uiEntrySize > m_uiSettingsHeaderTableSize)
-        {
-            m_uiDecodingDynamicTableSize = 0;
-            m_uiDecodingDynamicTableHeaderCount = 0;
-            m_iNextDecodingDynamicTableHeaderIndex = m_vecDecodingDynamicTable.size() - 1;
-            return;
-        }
-        // evict headers to required length.
-        int32 uiNeedRecoverSize = (m_uiDecodingDynamicTableSize + uiEntrySize) - m_uiSettingsHeaderTableSize;
-        UpdateDecodingDynamicTable(uiNeedRecoverSize);
-        if (m_uiDecodingDynamicTableHeaderCount + 1 > m_vecDecodingDynamicTable.size()) // need to grow the dynamic table.
-        {
-            Http2Header oHeader("", "");
-            std::vector<Http2Header> vecDynamicTable;
-            vecDynamicTable.assign(m_vecDecodingDynamicTable.size() * 2, oHeader);
-            for (uint32 i = 0; i < m_vecDecodingDynamicTable.size(); ++i)
-            {
-                vecDynamicTable[m_vecDecodingDynamicTable.size() + i] = std::move(m_vecDecodingDynamicTable[i]);
-            }
-            m_iNextDecodingDynamicTableHeaderIndex = m_vecDecodingDynamicTable.size() - 1;
-            m_vecDecodingDynamicTable = std::move(vecDynamicTable);
-        }
-        int iCurrent = m_iNextDecodingDynamicTableHeaderIndex--;
-        m_vecDecodingDynamicTable[iCurrent] = std::move(oHeader);
-        ++m_uiDecodingDynamicTableHeaderCount;
-        m_uiDecodingDynamicTableSize += uiEntrySize;
-    }
-    else
-    {
-        int32 iAddSize = uiEntrySize - m_vecDecodingDynamicTable[iVectorIndex].HpackSize();
-        // if the replacement header is too big, drop all entries.
-        if (iAddSize > (int32)m_uiSettingsHeaderTableSize)
-        {
-            m_uiDecodingDynamicTableSize = 0;
-            m_uiDecodingDynamicTableHeaderCount = 0;
-            m_iNextDecodingDynamicTableHeaderIndex = m_vecDecodingDynamicTable.size() - 1;
-            return;
-        }
-        // evict headers to the required length.
-        int32 iNeedRecoverSize = (m_uiDecodingDynamicTableSize + iAddSize) - m_uiSettingsHeaderTableSize;
-        uint32 uiEvictedNum = UpdateDecodingDynamicTable(iNeedRecoverSize);
-        iVectorIndex += uiEvictedNum;
-        m_vecDecodingDynamicTable[iVectorIndex] = std::move(oHeader);
-        m_uiDecodingDynamicTableSize += iAddSize;
-    }
-}
-
-uint32 CodecHttp2::UpdateDecodingDynamicTable(int32 iRecoverSize)
-{
-    uint32 uiEvictHeaderNum = 0;
-    if (iRecoverSize > 0)
-    {
-        int32 iEvictHeaderSize = 0;
-        // determine how many headers need to be evicted.
-        for (int32 i = (int32)m_vecDecodingDynamicTable.size() - 1;
-                iEvictHeaderSize < iRecoverSize; --i)
-        {
-            if (i < 0 || i < m_iNextDecodingDynamicTableHeaderIndex)
-            {
-                break;
-            }
-            iEvictHeaderSize += m_vecDecodingDynamicTable[i].HpackSize();
-            m_uiDecodingDynamicTableSize -= m_vecDecodingDynamicTable[i].HpackSize();
-            --m_uiDecodingDynamicTableHeaderCount;
-            ++uiEvictHeaderNum;
-        }
-
-        // move headers in dynamic table
-        uint32 uiFrom = 0;
-        uint32 uiTo = 0;
-        for (uint32 j = 0; j < uiEvictHeaderNum; ++j)
-        {
-            uiTo = m_vecDecodingDynamicTable.size() - 1 - j;
-            uiFrom = m_vecDecodingDynamicTable.size() - 1 - j - uiEvictHeaderNum;
-            m_vecDecodingDynamicTable[uiTo] = std::move(m_vecDecodingDynamicTable[uiFrom]);
-        }
-        m_iNextDecodingDynamicTableHeaderIndex += uiEvictHeaderNum;
-    }
-    return(uiEvictHeaderNum);
-}
-
-uint32 CodecHttp2::DecodingDynamicTableIndex2VectorIndex(uint32 uiIndex)
-{
-    return(m_iNextDecodingDynamicTableHeaderIndex + 1 + uiIndex);
+    return(0);
 }
 
 void CodecHttp2::CloseStream(uint32 uiStreamId)
@@ -17,6 +17,7 @@
 #include "H2Comm.hpp"
 #include "Tree.hpp"
 #include "Http2Header.hpp"
+#include "Http2DynamicTable.hpp"
 
 namespace neb
 {
@@ -82,11 +83,20 @@ public:
     void SetGoaway(uint32 uiLastStreamId)
     {
         m_uiGoawayLastStreamId = uiLastStreamId;
+        m_bGoaway = true;
     }
     uint32 GetLastStreamId()
     {
         return(m_uiStreamIdGenerate);
     }
+    uint32 GetMaxConcurrentStreams() const
+    {
+        return(m_uiSettingsMaxConcurrentStreams);
+    }
+    bool IsGoaway() const
+    {
+        return(m_bGoaway);
+    }
 
     E_CODEC_STATUS SendWaittingFrameData(CBuffer* pBuff);
     E_CODEC_STATUS SendWaittingFrameData(TreeNode<tagStreamWeight>* pStreamWeightNode,
@@ -117,23 +127,18 @@ protected:
             const std::string& strHeaderValue, uint32 uiHeaderNameIndex, bool bWithHuffman, CBuffer* pBuff);
     void PackHeaderDynamicTableSize(uint32 uiDynamicTableSize, CBuffer* pBuff);
     uint32 GetEncodingTableIndex(const std::string& strHeaderName, const std::string& strHeaderValue, uint32& uiNameIndex);
-    uint32 GetDecodingTableIndex(const std::string& strHeaderName, const std::string& strHeaderValue, uint32& uiNameIndex);
-    void UpdateEncodingDynamicTable(const std::string& strHeaderName, const std::string& strHeaderValue);
-    uint32 UpdateEncodingDynamicTable(int32 iRecoverSize);
-    uint32 EncodingDynamicTableIndex2VectorIndex(uint32 uiIndex);
-    void UpdateDecodingDynamicTable(int32 iVectorIndex, const std::string& strHeaderName, const std::string& strHeaderValue);
-    uint32 UpdateDecodingDynamicTable(int32 iRecoverSize);
-    uint32 DecodingDynamicTableIndex2VectorIndex(uint32 uiIndex);
     void CloseStream(uint32 uiStreamId);
 
 private:
     bool m_bChannelIsClient = false;    // 当前编解码器所在channel是作为http客户端还是作为http服务端
     bool m_bWantMagic = true;
     bool m_bHasWaittingFrame = false;
+    bool m_bGoaway = false;             // 是否收到GOAWAY（last stream id可以为0）
     uint32 m_uiStreamIdGenerate = 0;
     uint32 m_uiGoawayLastStreamId = 0;
     uint32 m_uiSettingsEnablePush = 1;
-    uint32 m_uiSettingsHeaderTableSize = 4096;
+    uint32 m_uiSettingsHeaderTableSize = 4096;          // 本端解码动态表尺寸上限
+    uint32 m_uiSettingsEncodeHeaderTableSize = 4096;    // 对端SETTINGS_HEADER_TABLE_SIZE，编码动态表尺寸上限
     uint32 m_uiSettingsMaxConcurrentStreams = 100;
     uint32 m_uiSettingsMaxWindowSize = DEFAULT_SETTINGS_MAX_INITIAL_WINDOW_SIZE;
     uint32 m_uiSettingsMaxEncodeFrameSize = DEFAULT_SETTINGS_MAX_FRAME_SIZE;
@@ -148,14 +153,10 @@ private:
     std::unordered_map<uint32, Http2Stream*> m_mapStream;
     TreeNode<tagStreamWeight>* m_pStreamWeightRoot = nullptr;
 
-    std::vector<Http2Header> m_vecEncodingDynamicTable;
-    uint32 m_uiEncodingDynamicTableSize = 0;
-    uint32 m_uiEncodingDynamicTableHeaderCount = 0;
-    int32 m_iNextEncodingDynamicTableHeaderIndex = 0;
-    std::vector<Http2Header> m_vecDecodingDynamicTable;
-    uint32 m_uiDecodingDynamicTableSize = 0;
-    uint32 m_uiDecodingDynamicTableHeaderCount = 0;
-    int32 m_iNextDecodingDynamicTableHeaderIndex = 0;
+    Http2DynamicTable m_oEncodingDynamicTable;
+    Http2DynamicTable m_oDecodingDynamicTable;
+    bool m_bEncodingTableSizeUpdate = false;        // 编码端动态表尺寸已变化，须在下一个header block开头通知对端
+    uint32 m_uiEncodingTableSizeUpdateMin = 0;      // 两次通知之间编码端动态表的最小尺寸（rfc7541 4.2）
     std::unordered_set<std::string> m_setEncodingWithoutIndexHeaders;
     std::unordered_set<std::string> m_setEncodingNeverIndexHeaders;
 };
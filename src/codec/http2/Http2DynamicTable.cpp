@@ -0,0 +1,144 @@
+/*******************************************************************************
+ * Project:  Nebula
+ * @file     Http2DynamicTable.cpp
+ * @brief    HPACK动态表
+ * @author   Bwar
+ * @date:    2026年10月17日
+ * @note
+ * Modify history:
+ ******************************************************************************/
+#include "Http2DynamicTable.hpp"
+#include <utility>
+
+namespace neb
+{
+
+Http2DynamicTable::Http2DynamicTable(bool bWithIndex, uint32 uiMaxSize)
+    : m_bWithIndex(bWithIndex), m_uiMaxSize(uiMaxSize), m_uiSize(0),
+      m_ullMask(7), m_ullInsertCount(0), m_ullEvictCount(0)
+{
+    m_vecEntry.assign(m_ullMask + 1, Http2Header("", ""));
+}
+
+Http2DynamicTable::~Http2DynamicTable()
+{
+}
+
+void Http2DynamicTable::SetMaxSize(uint32 uiMaxSize)
+{
+    m_uiMaxSize = uiMaxSize;
+    while (m_uiSize > m_uiMaxSize)
+    {
+        Evict();
+    }
+}
+
+void Http2DynamicTable::Add(const std::string& strName, const std::string& strValue)
+{
+    Http2Header oHeader(strName, strValue);
+    uint32 uiEntrySize = oHeader.HpackSize();
+    if (uiEntrySize > m_uiMaxSize)
+    {
+        Clear();
+        return;
+    }
+    while (m_uiSize + uiEntrySize > m_uiMaxSize)
+    {
+        Evict();
+    }
+    if (m_ullInsertCount - m_ullEvictCount > m_ullMask)
+    {
+        Grow();
+    }
+    uint64 ullAbsIndex = m_ullInsertCount++;
+    m_vecEntry[ullAbsIndex & m_ullMask] = std::move(oHeader);
+    m_uiSize += uiEntrySize;
+    if (m_bWithIndex)
+    {
+        m_mapHeaderIndex[MakeHeaderKey(strName, strValue)] = ullAbsIndex;
+        m_mapNameIndex[strName] = ullAbsIndex;
+    }
+}
+
+const Http2Header* Http2DynamicTable::Get(uint32 uiIndex) const
+{
+    if (uiIndex >= m_ullInsertCount - m_ullEvictCount)
+    {
+        return(nullptr);
+    }
+    return(&m_vecEntry[(m_ullInsertCount - 1 - uiIndex) & m_ullMask]);
+}
+
+uint32 Http2DynamicTable::Find(const std::string& strName, const std::string& strValue, uint32& uiNameIndex)
+{
+    if (!m_bWithIndex || m_ullInsertCount == m_ullEvictCount)
+    {
+        return(0);
+    }
+    auto header_iter = m_mapHeaderIndex.find(MakeHeaderKey(strName, strValue));
+    if (header_iter != m_mapHeaderIndex.end())
+    {
+        return((uint32)(m_ullInsertCount - header_iter->second));
+    }
+    if (uiNameIndex == 0)
+    {
+        auto name_iter = m_mapNameIndex.find(strName);
+        if (name_iter != m_mapNameIndex.end())
+        {
+            uiNameIndex = (uint32)(m_ullInsertCount - name_iter->second);
+        }
+    }
+    return(0);
+}
+
+void Http2DynamicTable::Clear()
+{
+    while (m_ullEvictCount < m_ullInsertCount)
+    {
+        Evict();
+    }
+}
+
+void Http2DynamicTable::Evict()
+{
+    uint64 ullAbsIndex = m_ullEvictCount++;
+    Http2Header& oHeader = m_vecEntry[ullAbsIndex & m_ullMask];
+    m_uiSize -= oHeader.HpackSize();
+    if (m_bWithIndex)
+    {
+        // 同一键被更新的表项覆盖过时，索引指向的是更新的表项，不能删除
+        auto header_iter = m_mapHeaderIndex.find(MakeHeaderKey(oHeader.Name(), oHeader.Value()));
+        if (header_iter != m_mapHeaderIndex.end() && header_iter->second == ullAbsIndex)
+        {
+            m_mapHeaderIndex.erase(header_iter);
+        }
+        auto name_iter = m_mapNameIndex.find(oHeader.Name());
+        if (name_iter != m_mapNameIndex.end() && name_iter->second == ullAbsIndex)
+        {
+            m_mapNameIndex.erase(name_iter);
+        }
+    }
+}
+
+void Http2DynamicTable::Grow()
+{
+    uint64 ullNewMask = (m_ullMask << 1) | 1;
+    std::vector<Http2Header> vecEntry;
+    vecEntry.assign(ullNewMask + 1, Http2Header("", ""));
+    for (uint64 i = m_ullEvictCount; i < m_ullInsertCount; ++i)
+    {
+        vecEntry[i & ullNewMask] = std::move(m_vecEntry[i & m_ullMask]);
+    }
+    m_vecEntry = std::move(vecEntry);
+    m_ullMask = ullNewMask;
+}
+
+const std::string& Http2DynamicTable::MakeHeaderKey(const std::string& strName, const std::string& strValue)
+{
+    m_strKey.assign(strName);
+    m_strKey.push_back('\0');
+    m_strKey.append(strValue);
+    return(m_strKey);
+}
+
+} /* namespace neb */
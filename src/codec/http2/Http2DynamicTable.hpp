@@ -0,0 +1,99 @@
+/*******************************************************************************
+ * Project:  Nebula
+ * @file     Http2DynamicTable.hpp
+ * @brief    HPACK动态表
+ * @author   Bwar
+ * @date:    2026年10月17日
+ * @note     rfc7541 2.3.2。表项存放在容量为2的幂的环形数组中，新表项写在尾部，
+ * 淘汰从头部进行，插入和淘汰都是O(1)，不再搬移表项。每个表项有一个单调递增的
+ * 绝对插入序号，HPACK索引由序号换算：最新的表项相对位置为0。
+ * 编码端（bWithIndex = true）另外维护(name,value)和name到最新绝对序号的哈希索引，
+ * 查找不再线性扫描整个动态表。
+ * Modify history:
+ ******************************************************************************/
+#ifndef SRC_CODEC_HTTP2_HTTP2DYNAMICTABLE_HPP_
+#define SRC_CODEC_HTTP2_HTTP2DYNAMICTABLE_HPP_
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include "Definition.hpp"
+#include "Http2Header.hpp"
+
+namespace neb
+{
+
+class Http2DynamicTable
+{
+public:
+    /**
+     * @param bWithIndex 是否维护查找用的哈希索引（编码端需要，解码端只按位置取表项）
+     * @param uiMaxSize 动态表最大尺寸（rfc7541 4.1定义的表项尺寸之和）
+     */
+    explicit Http2DynamicTable(bool bWithIndex, uint32 uiMaxSize = 4096);
+    Http2DynamicTable(const Http2DynamicTable&) = delete;
+    Http2DynamicTable& operator=(const Http2DynamicTable&) = delete;
+    ~Http2DynamicTable();
+
+    /**
+     * @brief 修改动态表最大尺寸，超出部分从最旧的表项开始淘汰（rfc7541 4.3）
+     */
+    void SetMaxSize(uint32 uiMaxSize);
+
+    uint32 GetMaxSize() const
+    {
+        return(m_uiMaxSize);
+    }
+
+    uint32 GetSize() const
+    {
+        return(m_uiSize);
+    }
+
+    uint32 GetCount() const
+    {
+        return((uint32)(m_ullInsertCount - m_ullEvictCount));
+    }
+
+    /**
+     * @brief 插入表项，必要时先淘汰旧表项；表项尺寸超过最大尺寸时清空动态表（rfc7541 4.4）
+     */
+    void Add(const std::string& strName, const std::string& strValue);
+
+    /**
+     * @brief 按相对位置取表项
+     * @param uiIndex 相对位置，0为最新插入的表项
+     * @return 超出动态表范围时返回nullptr
+     */
+    const Http2Header* Get(uint32 uiIndex) const;
+
+    /**
+     * @brief 查找表项（只有bWithIndex为true的动态表可用）
+     * @param uiNameIndex 未找到完全匹配但找到同名表项时，置为该表项的相对位置加1，否则保持不变
+     * @return 完全匹配表项的相对位置加1，未找到返回0
+     */
+    uint32 Find(const std::string& strName, const std::string& strValue, uint32& uiNameIndex);
+
+    void Clear();
+
+private:
+    void Evict();
+    void Grow();
+    const std::string& MakeHeaderKey(const std::string& strName, const std::string& strValue);
+
+private:
+    bool m_bWithIndex;
+    uint32 m_uiMaxSize;
+    uint32 m_uiSize;
+    uint64 m_ullMask;
+    uint64 m_ullInsertCount;            ///< 已插入的表项数量，即下一个表项的绝对序号
+    uint64 m_ullEvictCount;             ///< 已淘汰的表项数量，即最旧表项的绝对序号
+    std::vector<Http2Header> m_vecEntry;
+    std::unordered_map<std::string, uint64> m_mapHeaderIndex;  ///< name + '\0' + value到最新绝对序号
+    std::unordered_map<std::string, uint64> m_mapNameIndex;    ///< name到最新绝对序号
+    std::string m_strKey;               ///< 拼接查找键的复用缓冲
+};
+
+} /* namespace neb */
+
+#endif /* SRC_CODEC_HTTP2_HTTP2DYNAMICTABLE_HPP_ */
@@ -82,12 +82,16 @@ const std::vector<std::pair<std::string, std::string>> Http2Header::sc_vecStatic
 
 const std::unordered_map<std::string, uint32> Http2Header::sc_mapStaticTable = {
         {":authority", 1},
+        {":method", 2},                         ///< 只有名字的查找键取同名表项中的第一个
         {":method GET", 2},
         {":method POST", 3},
+        {":path", 4},
         {":path /", 4},
         {":path /index.html", 5},
+        {":scheme", 6},
         {":scheme http", 6},
         {":scheme https", 7},
+        {":status", 8},
         {":status 200", 8},
         {":status 204", 9},
         {":status 206", 10},
@@ -96,6 +100,7 @@ const std::unordered_map<std::string, uint32> Http2Header::sc_mapStaticTable = {
         {":status 404", 13},
         {":status 500", 14},
         {"accept-charset", 15},
+        {"accept-encoding", 16},
         {"accept-encoding gzip, deflate", 16},
         {"accept-language", 17},
         {"accept-ranges", 18},
@@ -240,13 +245,12 @@ void Http2Header::EncodeStringLiteral(const std::string& strLiteral, CBuffer* pB
 
 void Http2Header::EncodeStringLiteralWithHuffman(const std::string& strLiteral, CBuffer* pBuff)
 {
-    CBuffer oBuff;
-    Huffman::Instance()->Encode(strLiteral, &oBuff);
-    if (oBuff.ReadableBytes() < strLiteral.size())
+    size_t uiEncodedLength = Huffman::EncodedLength(strLiteral);
+    if (uiEncodedLength <= strLiteral.size())
     {
-        Http2Header::EncodeInt(oBuff.ReadableBytes(), (uint32)H2_HPACK_PREFIX_7_BITS,
+        Http2Header::EncodeInt(uiEncodedLength, (uint32)H2_HPACK_PREFIX_7_BITS,
                 (char)0x80, pBuff);
-        pBuff->Write(oBuff.GetRawReadBuffer(), oBuff.ReadableBytes());
+        Huffman::Instance()->Encode(strLiteral, pBuff);
     }
     else
     {
@@ -10,75 +10,33 @@
 #ifndef SRC_CODEC_HTTP2_HUFFMAN_HPP_
 #define SRC_CODEC_HTTP2_HUFFMAN_HPP_
 
+#include <cstdint>
 #include <string>
-#include <vector>
 #include "util/CBuffer.hpp"
 
 namespace neb
 {
 
-struct Node
+/**
+ * @brief 解码状态机的一次转移（每次输入4个bit）
+ */
+struct tagHuffmanDecodeEntry
 {
-    // Terminal nodes have a symbol.
-    uint8_t ucSymbol;
-    // Number of bits represented in the terminal node.
-    uint8_t ucTerminalBits;
-    // size() = 0 if terminal.
-    std::vector<Node*> vecChildren;
-
-    Node()
-    {
-        ucSymbol = 0;
-        ucTerminalBits = 0;
-        vecChildren.resize(256, nullptr);
-    }
-
-    Node(uint8_t ucSym, uint8_t ucBits)
-    {
-        ucSymbol = ucSym;
-        uint8_t b = ucBits & 0x07;
-        ucTerminalBits = (b == 0) ? 8 : b;
-    }
-
-    Node(const Node& stNode) = delete;
-
-    Node(Node&& stNode)
-    {
-        ucSymbol = stNode.ucSymbol;
-        stNode.ucSymbol = 0;
-        ucTerminalBits = stNode.ucTerminalBits;
-        stNode.ucTerminalBits = 0;
-        vecChildren = std::move(stNode.vecChildren);
-    }
-
-    virtual ~Node()
-    {
-        for (auto it = vecChildren.begin(); it != vecChildren.end(); ++it)
-        {
-            if (*it != nullptr)
-            {
-                delete (*it);
-            }
-        }
-        vecChildren.clear();
-    }
-
-    Node& operator=(const Node& stNode) = delete;
-
-    Node& operator=(Node&& stNode)
-    {
-        ucSymbol = stNode.ucSymbol;
-        stNode.ucSymbol = 0;
-        ucTerminalBits = stNode.ucTerminalBits;
-        stNode.ucTerminalBits = 0;
-        vecChildren = std::move(stNode.vecChildren);
-        return(*this);
-    }
+    uint8_t ucState;        ///< 转移后的状态（Huffman树的内部节点）
+    uint8_t ucFlags;        ///< HUFFMAN_ACCEPTED | HUFFMAN_SYM | HUFFMAN_FAIL
+    uint8_t ucSymbol;       ///< 有HUFFMAN_SYM标志时输出的字符
 };
 
 class Huffman
 {
 public:
+    enum E_HUFFMAN_DECODE_FLAG
+    {
+        HUFFMAN_ACCEPTED    = 1,    ///< 已输入的bit在此结束是合法的（其后未成码的bit全为1且不超过7个，即EOS编码的前缀）
+        HUFFMAN_SYM         = 2,    ///< 输出一个字符
+        HUFFMAN_FAIL        = 4,    ///< 解出EOS，解码错误
+    };
+
     virtual ~Huffman();
 
     static Huffman* Instance();
@@ -86,16 +44,24 @@ public:
     void Encode(const std::string& strData, CBuffer* pBuff);
     bool Decode(CBuffer* pBuff, int iBuffLength, std::string& strData);
 
-protected:
-    void BuildTree();
+    /**
+     * @brief Huffman编码后的长度（字节）
+     */
+    static size_t EncodedLength(const std::string& strData);
+
+    /**
+     * @brief 从原始数据解码
+     * @note 按RFC 7541 5.2节校验：含EOS、填充超过7个bit或填充不是EOS编码的前缀均为解码错误。
+     * @param[out] strData 解码结果追加在strData之后
+     */
+    static bool Decode(const char* pData, size_t uiDataLen, std::string& strData);
 
 private:
     Huffman();
-    Node* m_pRoot;
 
-    static Huffman* m_pInstance;
     static const uint32_t CODES[];
     static const uint8_t CODE_LENGTHS[];
+    static const tagHuffmanDecodeEntry DECODE_TABLE[256][16];
 };
 
 } /* namespace neb */
@@ -0,0 +1,124 @@
+/*******************************************************************************
+ * Project:  Nebula
+ * @file     ConnRateLimiter.cpp
+ * @brief    按客户端IP地址限制连接频率
+ * @author   Bwar
+ * @date:    2026年10月17日
+ * @note
+ * Modify history:
+ ******************************************************************************/
+#include <netinet/in.h>
+#include <climits>
+#include <cstring>
+#include <random>
+#include "ConnRateLimiter.hpp"
+
+namespace neb
+{
+
+ConnRateLimiter::ConnRateLimiter(uint32 uiMaxMemory)
+    : m_uiMask(0), m_ullSeed(0)
+{
+    uint32 uiSlotNum = sc_uiMinSlotNum;
+    while ((uint64)uiSlotNum * 2 * sizeof(tagAddrSlot) <= uiMaxMemory)
+    {
+        uiSlotNum *= 2;
+    }
+    m_vecSlot.resize(uiSlotNum);
+    m_uiMask = uiSlotNum - 1;
+    std::random_device oRandom;
+    m_ullSeed = ((uint64)oRandom() << 32) | oRandom();
+}
+
+ConnRateLimiter::~ConnRateLimiter()
+{
+}
+
+bool ConnRateLimiter::Check(const struct sockaddr* pAddr, ev_tstamp dNow, ev_tstamp dInterval, uint32 uiPermitNum)
+{
+    uint64 aullAddr[2];
+    if (0 == uiPermitNum || dInterval <= 0.0 || !ToAddrKey(pAddr, aullAddr))
+    {
+        return(true);
+    }
+    ev_tstamp dWindow = dNow / dInterval;
+    uint64 ullWindow = (uint64)dWindow;
+    tagAddrSlot& stSlot = FindSlot(aullAddr, ullWindow);
+    if (stSlot.ullWindow != ullWindow)
+    {
+        stSlot.uiPrevCount = (stSlot.ullWindow + 1 == ullWindow) ? stSlot.uiCurCount : 0;
+        stSlot.uiCurCount = 0;
+        stSlot.ullWindow = ullWindow;
+    }
+    if (stSlot.uiCurCount < UINT_MAX)
+    {
+        ++stSlot.uiCurCount;
+    }
+    stSlot.dLastTime = dNow;
+    // 上一窗口的连接视为均匀分布，只计入仍在最近dInterval秒内的部分
+    double dCount = stSlot.uiPrevCount * (1.0 - (dWindow - (ev_tstamp)ullWindow)) + stSlot.uiCurCount;
+    return(dCount <= (double)uiPermitNum);
+}
+
+bool ConnRateLimiter::ToAddrKey(const struct sockaddr* pAddr, uint64 aullAddr[2])
+{
+    unsigned char aucAddr[16] = {0};
+    if (AF_INET6 == pAddr->sa_family)
+    {
+        memcpy(aucAddr, &((const struct sockaddr_in6*)pAddr)->sin6_addr, 16);
+    }
+    else if (AF_INET == pAddr->sa_family)
+    {
+        aucAddr[10] = 0xff;
+        aucAddr[11] = 0xff;
+        memcpy(aucAddr + 12, &((const struct sockaddr_in*)pAddr)->sin_addr, 4);
+    }
+    else
+    {
+        return(false);
+    }
+    memcpy(aullAddr, aucAddr, 16);
+    return(true);
+}
+
+uint32 ConnRateLimiter::Hash(const uint64 aullAddr[2]) const
+{
+    uint64 ullHash = (aullAddr[0] ^ m_ullSeed) * 0x9E3779B97F4A7C15ULL;
+    ullHash ^= aullAddr[1] + (ullHash >> 29);
+    ullHash *= 0xBF58476D1CE4E5B9ULL;
+    ullHash ^= ullHash >> 32;
+    return((uint32)ullHash & m_uiMask);
+}
+
+ConnRateLimiter::tagAddrSlot& ConnRateLimiter::FindSlot(const uint64 aullAddr[2], uint64 ullWindow)
+{
+    uint32 uiIndex = Hash(aullAddr);
+    tagAddrSlot* pVictim = nullptr;
+    for (uint32 i = 0; i < sc_uiProbeNum; ++i)
+    {
+        tagAddrSlot& stSlot = m_vecSlot[(uiIndex + i) & m_uiMask];
+        if (stSlot.aullAddr[0] == aullAddr[0] && stSlot.aullAddr[1] == aullAddr[1] && stSlot.dLastTime > 0.0)
+        {
+            return(stSlot);
+        }
+        if (stSlot.dLastTime <= 0.0)
+        {
+            // 槽位不会被清空，地址总是放在探测范围内的第一个空槽，空槽之后不会再有该地址
+            pVictim = &stSlot;
+            break;
+        }
+        // 计数已过期的地址最近连接时间必然早于仍在计数的地址，按最久未连接选择即可
+        if (pVictim == nullptr || stSlot.dLastTime < pVictim->dLastTime)
+        {
+            pVictim = &stSlot;
+        }
+    }
+    pVictim->aullAddr[0] = aullAddr[0];
+    pVictim->aullAddr[1] = aullAddr[1];
+    pVictim->ullWindow = ullWindow;
+    pVictim->uiCurCount = 0;
+    pVictim->uiPrevCount = 0;
+    return(*pVictim);
+}
+
+} /* namespace neb */
@@ -0,0 +1,73 @@
+/*******************************************************************************
+ * Project:  Nebula
+ * @file     ConnRateLimiter.hpp
+ * @brief    按客户端IP地址限制连接频率
+ * @author   Bwar
+ * @date:    2026年10月17日
+ * @note     固定大小的开放寻址表，key为16字节二进制地址（IPv4转为IPv4映射的IPv6
+ * 地址），内存在构造时一次分配。每个地址用滑动窗口计数：保留当前和上一个统计窗口
+ * 的连接次数，估算值 = 上一窗口次数 x 上一窗口仍落在滑动窗口内的比例 + 当前窗口
+ * 次数。窗口在检查时按当前时间惰性切换，不需要定时器。地址在起始槽位之后的若干个
+ * 槽位中线性探测，探测范围内没有空槽时替换计数已过期或最久未连接的地址。
+ * Modify history:
+ ******************************************************************************/
+#ifndef SRC_IOS_CONNRATELIMITER_HPP_
+#define SRC_IOS_CONNRATELIMITER_HPP_
+
+#include <sys/socket.h>
+#include <vector>
+#include "Definition.hpp"
+
+namespace neb
+{
+
+class ConnRateLimiter
+{
+public:
+    /**
+     * @param uiMaxMemory 地址表最多占用的内存（字节），槽位数量取不超过此内存的2的幂
+     */
+    explicit ConnRateLimiter(uint32 uiMaxMemory);
+    ConnRateLimiter(const ConnRateLimiter&) = delete;
+    ConnRateLimiter& operator=(const ConnRateLimiter&) = delete;
+    ~ConnRateLimiter();
+
+    /**
+     * @brief 记录一次来自pAddr的连接并检查连接频率
+     * @param dInterval 统计时间（秒）
+     * @param uiPermitNum 统计时间内允许的连接次数（被拒绝的连接也计数），0为不限制
+     * @return 超出允许次数时返回false
+     */
+    bool Check(const struct sockaddr* pAddr, ev_tstamp dNow, ev_tstamp dInterval, uint32 uiPermitNum);
+
+    uint32 Capacity() const
+    {
+        return((uint32)m_vecSlot.size());
+    }
+
+protected:
+    struct tagAddrSlot
+    {
+        uint64 aullAddr[2]  = {0, 0};       ///< IPv6地址或IPv4映射的IPv6地址
+        uint64 ullWindow    = 0;            ///< 当前统计窗口序号（时间 / 统计时间）
+        uint32 uiCurCount   = 0;            ///< 当前窗口连接次数
+        uint32 uiPrevCount  = 0;            ///< 上一窗口连接次数
+        ev_tstamp dLastTime = 0.0;          ///< 最近一次连接时间，0表示空槽
+    };
+
+    static bool ToAddrKey(const struct sockaddr* pAddr, uint64 aullAddr[2]);
+    uint32 Hash(const uint64 aullAddr[2]) const;
+    tagAddrSlot& FindSlot(const uint64 aullAddr[2], uint64 ullWindow);
+
+private:
+    uint32 m_uiMask;
+    uint64 m_ullSeed;                       ///< 随机哈希种子，避免构造同一槽位的攻击地址
+    std::vector<tagAddrSlot> m_vecSlot;
+
+    static const uint32 sc_uiProbeNum = 8;  ///< 线性探测的槽位数量
+    static const uint32 sc_uiMinSlotNum = 1024;
+};
+
+} /* namespace neb */
+
+#endif /* SRC_IOS_CONNRATELIMITER_HPP_ */
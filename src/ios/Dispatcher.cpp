@@ -9,6 +9,8 @@
  ******************************************************************************/
 
 #include "Dispatcher.hpp"
+#include <linux/filter.h>
+#include <strings.h>
 #include <algorithm>
 #include "Definition.hpp"
 #include "labor/Manager.hpp"
@@ -17,13 +19,16 @@
 #include "actor/step/Step.hpp"
 #include "actor/step/RedisStep.hpp"
 #include "actor/session/sys_session/manager/SessionManager.hpp"
+#include "codec/CodecHttp.hpp"
+#include "codec/RedisReplyView.hpp"
 
 namespace neb
 {
 
 Dispatcher::Dispatcher(Labor* pLabor, std::shared_ptr<NetLogger> pLogger)
-   : m_pErrBuff(NULL), m_pLabor(pLabor), m_loop(NULL), m_iClientNum(0), m_lLastCheckNodeTime(0),
-     m_pLogger(pLogger), m_pSessionNode(nullptr)
+   : m_pErrBuff(NULL), m_pLabor(pLabor), m_loop(NULL), m_iClientNum(0), m_uiTransferredNum(0), m_lLastCheckNodeTime(0),
+     m_pLogger(pLogger), m_pSessionNode(nullptr), m_pTimingWheel(nullptr), m_pTimingWheelWatcher(NULL),
+     m_pMailboxWatcher(NULL), m_pDnsWatcher(NULL), m_pCorkWatcher(NULL)
 {
     m_pErrBuff = (char*)malloc(gc_iErrBuffLen);
 
@@ -86,6 +91,11 @@ void Dispatcher::PeriodicTaskCallback(struct ev_loop* loop, ev_timer* watcher, i
             ((Worker*)(pDispatcher->m_pLabor))->CheckParent();
         }
         pDispatcher->CheckFailedNode();
+        CBufferPool* pBufferPool = CBufferPool::Instance();
+        if (nullptr != pBufferPool)
+        {
+            pBufferPool->Shrink();
+        }
     }
     ev_timer_stop (loop, watcher);
     ev_timer_set (watcher, NODE_BEAT + ev_time() - ev_now(loop), 0);
@@ -108,18 +118,53 @@ void Dispatcher::SignalCallback(struct ev_loop* loop, struct ev_signal* watcher,
     }
 }
 
-void Dispatcher::ClientConnFrequencyTimeoutCallback(struct ev_loop* loop, ev_timer* watcher, int revents)
+void Dispatcher::TimingWheelCallback(struct ev_loop* loop, ev_timer* watcher, int revents)
+{
+    if (watcher->data != NULL)
+    {
+        Dispatcher* pDispatcher = (Dispatcher*)(watcher->data);
+        pDispatcher->m_pTimingWheel->Advance(ev_now(loop));
+        if (0 == pDispatcher->m_pTimingWheel->Size())
+        {
+            ev_timer_stop (loop, watcher);
+        }
+    }
+}
+
+void Dispatcher::MailboxCallback(struct ev_loop* loop, struct ev_io* watcher, int revents)
+{
+    if (watcher->data != NULL)
+    {
+        Dispatcher* pDispatcher = (Dispatcher*)(watcher->data);
+        pDispatcher->OnMailbox();
+    }
+}
+
+void Dispatcher::DnsCallback(struct ev_loop* loop, struct ev_io* watcher, int revents)
+{
+    if (watcher->data != NULL)
+    {
+        Dispatcher* pDispatcher = (Dispatcher*)(watcher->data);
+        pDispatcher->OnDnsResolved();
+    }
+}
+
+void Dispatcher::CorkCallback(struct ev_loop* loop, struct ev_prepare* watcher, int revents)
 {
     if (watcher->data != NULL)
     {
-        tagClientConnWatcherData* pData = (tagClientConnWatcherData*)watcher->data;
-        pData->pDispatcher->OnClientConnFrequencyTimeout(pData, watcher);
+        Dispatcher* pDispatcher = (Dispatcher*)(watcher->data);
+        pDispatcher->OnCorkFlush();
     }
 }
 
 bool Dispatcher::OnIoRead(std::shared_ptr<SocketChannel> pChannel)
 {
     LOG4_TRACE("fd[%d]", pChannel->m_pImpl->GetFd());
+    if (CHANNEL_STATUS_TRY_CONNECT == pChannel->m_pImpl->GetChannelStatus() && ConnectFailover(pChannel, false))
+    {
+        return(true);
+    }
     m_pLastActivityChannel = pChannel;
     if (Labor::LABOR_MANAGER == m_pLabor->GetLaborType())
     {
@@ -144,6 +189,10 @@ bool Dispatcher::OnIoRead(std::shared_ptr<SocketChannel> pChannel)
         {
             return(FdTransfer(pChannel->m_pImpl->GetFd()));
         }
+        else if (pChannel->m_pImpl->GetFd() == ((Worker*)m_pLabor)->GetWorkerInfo().iC2SListenFd)
+        {
+            return(AcceptClientConn(pChannel->m_pImpl->GetFd(), ((Worker*)m_pLabor)->GetWorkerInfo().iC2SFamily));
+        }
         else
         {
             return(DataRecvAndHandle(pChannel));
@@ -158,6 +207,10 @@ bool Dispatcher::OnIoRead(std::shared_ptr<SocketChannel> pChannel)
 bool Dispatcher::DataRecvAndHandle(std::shared_ptr<SocketChannel> pChannel)
 {
     LOG4_TRACE(" ");
+    if (nullptr != m_pMailbox && nullptr != pChannel->m_pImpl->GetPeerMailbox())
+    {
+        FlushMailbox();
+    }
     E_CODEC_STATUS eCodecStatus;
     switch(pChannel->GetCodecType())
     {
@@ -165,7 +218,7 @@ bool Dispatcher::DataRecvAndHandle(std::shared_ptr<SocketChannel> pChannel)
         case CODEC_HTTP2:
             for (int i = 0; ; ++i)
             {
-                HttpMsg oHttpMsg;
+                HttpMsg& oHttpMsg = m_pInboundMsgCache->HttpMsgForDecode();
                 if (0 == i)
                 {
                     eCodecStatus = pChannel->m_pImpl->Recv(oHttpMsg);
@@ -206,20 +259,20 @@ bool Dispatcher::DataRecvAndHandle(std::shared_ptr<SocketChannel> pChannel)
         case CODEC_RESP:
             for (int i = 0; ; ++i)
             {
-                RedisMsg oRedisMsg;
+                const RedisReplyView* pReplyView = nullptr;
                 if (0 == i)
                 {
-                    eCodecStatus = pChannel->m_pImpl->Recv(oRedisMsg);
+                    eCodecStatus = pChannel->m_pImpl->Recv(pReplyView);
                 }
                 else
                 {
-                    eCodecStatus = pChannel->m_pImpl->Fetch(oRedisMsg);
+                    eCodecStatus = pChannel->m_pImpl->Fetch(pReplyView);
                 }
 
                 if (CODEC_STATUS_OK == eCodecStatus)
                 {
                     m_pLabor->IoStatAddRecvNum(pChannel->GetFd());
-                    m_pLabor->GetActorBuilder()->OnMessage(pChannel, oRedisMsg);
+                    m_pLabor->GetActorBuilder()->OnMessage(pChannel, *pReplyView);
                 }
                 else
                 {
@@ -232,7 +285,6 @@ bool Dispatcher::DataRecvAndHandle(std::shared_ptr<SocketChannel> pChannel)
             CBuffer oBuff;
             for (int i = 0; ; ++i)
             {
-                RedisMsg oRedisMsg;
                 if (0 == i)
                 {
                     eCodecStatus = pChannel->m_pImpl->Recv(oBuff);
@@ -257,8 +309,8 @@ bool Dispatcher::DataRecvAndHandle(std::shared_ptr<SocketChannel> pChannel)
         default:
             for (int i = 0; ; ++i)
             {
-                MsgHead oMsgHead;
-                MsgBody oMsgBody;
+                MsgHead& oMsgHead = m_pInboundMsgCache->MsgHeadForDecode();
+                MsgBody& oMsgBody = m_pInboundMsgCache->MsgBodyForDecode();
                 if (0 == i)
                 {
                     eCodecStatus = pChannel->m_pImpl->Recv(oMsgHead, oMsgBody);
@@ -348,7 +400,7 @@ bool Dispatcher::DataFetchAndHandle(std::shared_ptr<SocketChannel> pChannel)
         case CODEC_HTTP:
         case CODEC_HTTP2:
             {
-                HttpMsg oHttpMsg;
+                HttpMsg& oHttpMsg = m_pInboundMsgCache->HttpMsgForDecode();
                 eCodecStatus = pChannel->m_pImpl->Fetch(oHttpMsg);
                 while (CODEC_STATUS_OK == eCodecStatus
                         || CODEC_STATUS_PART_OK == eCodecStatus)
@@ -378,12 +430,12 @@ bool Dispatcher::DataFetchAndHandle(std::shared_ptr<SocketChannel> pChannel)
         case CODEC_RESP:
             for (int i = 0; ; ++i)
             {
-                RedisMsg oRedisMsg;
-                eCodecStatus = pChannel->m_pImpl->Fetch(oRedisMsg);
+                const RedisReplyView* pReplyView = nullptr;
+                eCodecStatus = pChannel->m_pImpl->Fetch(pReplyView);
                 if (CODEC_STATUS_OK == eCodecStatus)
                 {
                     m_pLabor->IoStatAddRecvNum(pChannel->GetFd());
-                    m_pLabor->GetActorBuilder()->OnMessage(pChannel, oRedisMsg);
+                    m_pLabor->GetActorBuilder()->OnMessage(pChannel, *pReplyView);
                 }
                 else
                 {
@@ -396,7 +448,6 @@ bool Dispatcher::DataFetchAndHandle(std::shared_ptr<SocketChannel> pChannel)
             CBuffer oBuff;
             for (int i = 0; ; ++i)
             {
-                RedisMsg oRedisMsg;
                 eCodecStatus = pChannel->m_pImpl->Fetch(oBuff);
                 if (CODEC_STATUS_OK == eCodecStatus)
                 {
@@ -413,8 +464,8 @@ bool Dispatcher::DataFetchAndHandle(std::shared_ptr<SocketChannel> pChannel)
         default:
             for (int i = 0; ; ++i)
             {
-                MsgHead oMsgHead;
-                MsgBody oMsgBody;
+                MsgHead& oMsgHead = m_pInboundMsgCache->MsgHeadForDecode();
+                MsgBody& oMsgBody = m_pInboundMsgCache->MsgBodyForDecode();
                 eCodecStatus = pChannel->m_pImpl->Fetch(oMsgHead, oMsgBody);
                 if (CODEC_STATUS_OK == eCodecStatus)
                 {
@@ -490,10 +541,9 @@ bool Dispatcher::DataFetchAndHandle(std::shared_ptr<SocketChannel> pChannel)
 bool Dispatcher::FdTransfer(int iFd)
 {
     LOG4_TRACE(" ");
-    int iAcceptFd = -1;
-    int iAiFamily = AF_INET;
-    int iCodec = 0;
-    int iErrno = SocketChannel::RecvChannelFd(iFd, iAcceptFd, iAiFamily, iCodec, m_pLogger);
+    SocketChannel::tagChannelCtx aChannelCtx[SocketChannel::MAX_TRANSFER_FD_NUM];
+    int iFdNum = 0;
+    int iErrno = SocketChannel::RecvChannelFds(iFd, aChannelCtx, iFdNum, m_pLogger);
     if (iErrno != ERR_OK)
     {
         if (iErrno == ERR_CHANNEL_EOF)
@@ -502,121 +552,198 @@ bool Dispatcher::FdTransfer(int iFd)
             Destroy();
             exit(2); // manager与worker通信fd已关闭，worker进程退出
         }
+        return(false);
     }
-    else
+    bool bResult = true;
+    m_uiTransferredNum += iFdNum;
+    for (int i = 0; i < iFdNum; ++i)
     {
-        if (iAiFamily != PF_UNIX)
+        if (!AddAcceptedChannel(aChannelCtx[i].iFd, aChannelCtx[i].iAiFamily, aChannelCtx[i].iCodecType))
         {
-            int iKeepAlive = 1;
-            int iKeepIdle = 60;
-            int iKeepInterval = 5;
-            int iKeepCount = 3;
-            int iTcpNoDelay = 1;
-            if (setsockopt(iAcceptFd, SOL_SOCKET, SO_KEEPALIVE, (void*)&iKeepAlive, sizeof(iKeepAlive)) < 0)
-            {
-                LOG4_WARNING("fail to set SO_KEEPALIVE");
-            }
-            if (setsockopt(iAcceptFd, IPPROTO_TCP, TCP_KEEPIDLE, (void*) &iKeepIdle, sizeof(iKeepIdle)) < 0)
-            {
-                LOG4_WARNING("fail to set TCP_KEEPIDLE");
-            }
-            if (setsockopt(iAcceptFd, IPPROTO_TCP, TCP_KEEPINTVL, (void *)&iKeepInterval, sizeof(iKeepInterval)) < 0)
-            {
-                LOG4_WARNING("fail to set TCP_KEEPINTVL");
-            }
-            if (setsockopt(iAcceptFd, IPPROTO_TCP, TCP_KEEPCNT, (void*)&iKeepCount, sizeof (iKeepCount)) < 0)
+            bResult = false;
+        }
+    }
+    return(bResult);
+}
+
+bool Dispatcher::OnMailbox()
+{
+    m_pMailbox->ClearNotify();
+    tagMailItem stItem;
+    while (m_pMailbox->Fetch(stItem))
+    {
+        HandleMailItem(stItem);
+    }
+    return(true);
+}
+
+void Dispatcher::FlushMailbox()
+{
+    uint64 ullEnqueuePos = m_pMailbox->GetEnqueuePos();
+    tagMailItem stItem;
+    while (m_pMailbox->FetchUntil(stItem, ullEnqueuePos))
+    {
+        HandleMailItem(stItem);
+    }
+}
+
+void Dispatcher::HandleMailItem(tagMailItem& stItem)
+{
+    if (stItem.iTransferFd >= 0)
+    {
+        ++m_uiTransferredNum;
+        AddAcceptedChannel(stItem.iTransferFd, stItem.iAiFamily, stItem.iCodecType,
+                stItem.strRemoteAddr.empty() ? nullptr : stItem.strRemoteAddr.c_str());
+        return;
+    }
+    auto iter = m_mapSocketChannel.find(stItem.iFd);
+    if (iter == m_mapSocketChannel.end())
+    {
+        LOG4_WARNING("no channel found for fd %d, drop message cmd[%d] seq[%u].",
+                stItem.iFd, stItem.oMsgHead.cmd(), stItem.oMsgHead.seq());
+        return;
+    }
+    m_pLastActivityChannel = iter->second;
+    m_pLabor->IoStatAddRecvNum(stItem.iFd);
+    m_pLabor->GetActorBuilder()->OnMessage(iter->second, stItem.oMsgHead, stItem.oMsgBody);
+}
+
+bool Dispatcher::OnDnsResolved()
+{
+    m_pDnsResolver->ClearNotify();
+    std::string strHost;
+    const tagDnsRecord* pDnsRecord = nullptr;
+    while (m_pDnsResolver->Fetch(ev_now(m_loop), strHost, pDnsRecord))
+    {
+        auto pending_iter = m_mapDnsPendingChannel.find(strHost);
+        if (pending_iter == m_mapDnsPendingChannel.end())
+        {
+            continue;   // 缓存过期后的刷新查询
+        }
+        std::vector<tagDnsPendingChannel> vecPending;
+        vecPending.swap(pending_iter->second);
+        m_mapDnsPendingChannel.erase(pending_iter);
+        int iError = pDnsRecord->iError;
+        std::vector<tagDnsAddr> vecAddr = pDnsRecord->vecAddr;  // 销毁通道的回调中可能再次查询，不引用缓存
+        if (0 != iError)
+        {
+            LOG4_ERROR("resolve \"%s\" error %d: %s", strHost.c_str(), iError, gai_strerror(iError));
+        }
+        for (auto& stPending : vecPending)
+        {
+            if (stPending.pChannel->m_pImpl->GetSequence() != stPending.uiChannelSeq
+                    || CHANNEL_STATUS_CLOSED == stPending.pChannel->m_pImpl->GetChannelStatus())
             {
-                LOG4_WARNING("fail to set TCP_KEEPCNT");
+                continue;   // 等待解析期间已被关闭
             }
-            if (setsockopt(iAcceptFd, IPPROTO_TCP, TCP_NODELAY, (void*)&iTcpNoDelay, sizeof(iTcpNoDelay)) < 0)
+            if (0 != iError || !ConnectChannel(stPending.pChannel, vecAddr, 0, stPending.iPort))
             {
-                LOG4_WARNING("fail to set TCP_NODELAY");
+                LOG4_ERROR("Could not connect to \"%s:%d\"", strHost.c_str(), stPending.iPort);
+                DiscardSocketChannel(stPending.pChannel);
             }
         }
+    }
+    return(true);
+}
+
+bool Dispatcher::AddAcceptedChannel(int iAcceptFd, int iAiFamily, int iCodec, const char* szRemoteAddr)
+{
+    // TCP连接的keepalive和TCP_NODELAY选项继承自监听socket（见CreateListenFd()），
+    // O_NONBLOCK由accept4()设置且属于打开文件描述，经SCM_RIGHTS传递后依然有效
+    if (iAiFamily == PF_UNIX)
+    {
         x_sock_set_block(iAcceptFd, 0);
-        std::shared_ptr<SocketChannel> pChannel = nullptr;
-        LOG4_TRACE("fd[%d] transfer successfully.", iAcceptFd);
-        if ((CODEC_NEBULA != iCodec) && (CODEC_NEBULA_IN_NODE != iCodec) && m_pLabor->WithSsl())
-        {
-            pChannel = CreateSocketChannel(iAcceptFd, E_CODEC_TYPE(iCodec), false, true);
-        }
-        else
+    }
+    std::shared_ptr<SocketChannel> pChannel = nullptr;
+    LOG4_TRACE("fd[%d] transfer successfully.", iAcceptFd);
+    if ((CODEC_NEBULA != iCodec) && (CODEC_NEBULA_IN_NODE != iCodec) && m_pLabor->WithSsl())
+    {
+        pChannel = CreateSocketChannel(iAcceptFd, E_CODEC_TYPE(iCodec), false, true);
+    }
+    else
+    {
+        pChannel = CreateSocketChannel(iAcceptFd, E_CODEC_TYPE(iCodec), false, false);
+    }
+    if (nullptr != pChannel)
+    {
+        if (nullptr != szRemoteAddr)
         {
-            pChannel = CreateSocketChannel(iAcceptFd, E_CODEC_TYPE(iCodec), false, false);
+            pChannel->m_pImpl->SetRemoteAddr(std::string(szRemoteAddr));
         }
-        if (nullptr != pChannel)
+        else if (AF_INET == iAiFamily)
         {
-            if (AF_INET == iAiFamily)
+            char szClientAddr[64] = {0};
+            int z;                          /* status return code */
+            struct sockaddr_in stClientAddr;
+            socklen_t iClientAddrSize = sizeof(stClientAddr);
+            z = getpeername(iAcceptFd, (struct sockaddr *)&stClientAddr, &iClientAddrSize);
+            if (z == 0)
             {
-                char szClientAddr[64] = {0};
-                int z;                          /* status return code */
-                struct sockaddr_in stClientAddr;
-                socklen_t iClientAddrSize = sizeof(stClientAddr);
-                z = getpeername(iAcceptFd, (struct sockaddr *)&stClientAddr, &iClientAddrSize);
-                if (z == 0)
-                {
-                    inet_ntop(AF_INET, &stClientAddr.sin_addr, szClientAddr, sizeof(szClientAddr));
-                    LOG4_TRACE("set fd %d's remote addr \"%s\"", iAcceptFd, szClientAddr);
-                    pChannel->m_pImpl->SetRemoteAddr(std::string(szClientAddr));
-                }
-                else
-                {
-                    LOG4_ERROR("getpeername error %d", errno);
-                }
+                inet_ntop(AF_INET, &stClientAddr.sin_addr, szClientAddr, sizeof(szClientAddr));
+                LOG4_TRACE("set fd %d's remote addr \"%s\"", iAcceptFd, szClientAddr);
+                pChannel->m_pImpl->SetRemoteAddr(std::string(szClientAddr));
             }
-            else if (AF_INET6 == iAiFamily)  // AF_INET6
+            else
             {
-                char szClientAddr[64] = {0};
-                int z;                          /* status return code */
-                struct sockaddr_in6 stClientAddr;
-                socklen_t iClientAddrSize = sizeof(stClientAddr);
-                z = getpeername(iAcceptFd, (struct sockaddr *)&stClientAddr, &iClientAddrSize);
-                if (z == 0)
-                {
-                    inet_ntop(AF_INET6, &stClientAddr.sin6_addr, szClientAddr, sizeof(szClientAddr));
-                    LOG4_TRACE("set fd %d's remote addr \"%s\"", iAcceptFd, szClientAddr);
-                    pChannel->m_pImpl->SetRemoteAddr(std::string(szClientAddr));
-                }
-                else
-                {
-                    LOG4_ERROR("getpeername error %d", errno);
-                }
+                LOG4_ERROR("getpeername error %d", errno);
             }
-            AddIoReadEvent(pChannel);
-            if (CODEC_NEBULA == iCodec)
+        }
+        else if (AF_INET6 == iAiFamily)  // AF_INET6
+        {
+            char szClientAddr[64] = {0};
+            int z;                          /* status return code */
+            struct sockaddr_in6 stClientAddr;
+            socklen_t iClientAddrSize = sizeof(stClientAddr);
+            z = getpeername(iAcceptFd, (struct sockaddr *)&stClientAddr, &iClientAddrSize);
+            if (z == 0)
             {
-                AddIoTimeout(pChannel, m_pLabor->GetNodeInfo().dIoTimeout);
-                std::shared_ptr<Step> pStepTellWorker
-                    = m_pLabor->GetActorBuilder()->MakeSharedStep(nullptr, "neb::StepTellWorker", pChannel);
-                if (nullptr == pStepTellWorker)
-                {
-                    return(false);
-                }
-                pStepTellWorker->Emit(ERR_OK);
+                inet_ntop(AF_INET6, &stClientAddr.sin6_addr, szClientAddr, sizeof(szClientAddr));
+                LOG4_TRACE("set fd %d's remote addr \"%s\"", iAcceptFd, szClientAddr);
+                pChannel->m_pImpl->SetRemoteAddr(std::string(szClientAddr));
             }
-            else if (CODEC_NEBULA_IN_NODE == iCodec)
+            else
             {
-                pChannel->m_pImpl->SetChannelStatus(CHANNEL_STATUS_ESTABLISHED);
-                m_mapLoaderAndWorkerChannel.insert(std::make_pair(pChannel->GetFd(), pChannel));
-                m_iterLoaderAndWorkerChannel = m_mapLoaderAndWorkerChannel.begin();
+                LOG4_ERROR("getpeername error %d", errno);
             }
-            else
+        }
+        AddIoReadEvent(pChannel);
+        if (CODEC_NEBULA == iCodec)
+        {
+            AddIoTimeout(pChannel, m_pLabor->GetNodeInfo().dIoTimeout);
+            std::shared_ptr<Step> pStepTellWorker
+                = m_pLabor->GetActorBuilder()->MakeSharedStep(nullptr, "neb::StepTellWorker", pChannel);
+            if (nullptr == pStepTellWorker)
             {
-                pChannel->m_pImpl->SetChannelStatus(CHANNEL_STATUS_ESTABLISHED);
-                AddIoTimeout(pChannel, 1.0);     // 为了防止大量连接攻击，初始化连接只有一秒即超时，在正常发送第一个数据包之后才采用正常配置的网络IO超时检查
+                return(false);
             }
-            return(true);
+            pStepTellWorker->Emit(ERR_OK);
         }
-        else    // 没有足够资源分配给新连接，直接close掉
+        else if (CODEC_NEBULA_IN_NODE == iCodec)
         {
-            close(iAcceptFd);
+            pChannel->m_pImpl->SetChannelStatus(CHANNEL_STATUS_ESTABLISHED);
+            m_mapLoaderAndWorkerChannel.insert(std::make_pair(pChannel->GetFd(), pChannel));
+            m_iterLoaderAndWorkerChannel = m_mapLoaderAndWorkerChannel.begin();
+        }
+        else
+        {
+            pChannel->m_pImpl->SetChannelStatus(CHANNEL_STATUS_ESTABLISHED);
+            AddIoTimeout(pChannel, 1.0);     // 为了防止大量连接攻击，初始化连接只有一秒即超时，在正常发送第一个数据包之后才采用正常配置的网络IO超时检查
         }
+        return(true);
+    }
+    else    // 没有足够资源分配给新连接，直接close掉
+    {
+        close(iAcceptFd);
     }
     return(false);
 }
 
 bool Dispatcher::OnIoWrite(std::shared_ptr<SocketChannel> pChannel)
 {
+    if (CHANNEL_STATUS_TRY_CONNECT == pChannel->m_pImpl->GetChannelStatus() && ConnectFailover(pChannel, false))
+    {
+        return(true);
+    }
     if (CODEC_NEBULA == pChannel->m_pImpl->GetCodecType())  // 系统内部Server间通信
     {
         if (pChannel->m_pImpl->GetRemoteWorkerIndex() < 0) // connect to Manager
@@ -690,8 +817,17 @@ bool Dispatcher::OnIoError(std::shared_ptr<SocketChannel> pChannel)
 
 bool Dispatcher::OnIoTimeout(std::shared_ptr<SocketChannel> pChannel)
 {
+    if (CHANNEL_STATUS_TRY_CONNECT == pChannel->m_pImpl->GetChannelStatus() && ConnectFailover(pChannel, true))
+    {
+        return(true);
+    }
     //ev_tstamp after = pChannel->m_pImpl->GetActiveTime() - ev_now(m_loop) + m_pLabor->GetNodeInfo().dIoTimeout;
-    ev_tstamp after = pChannel->m_pImpl->GetActiveTime() - ev_now(m_loop) + pChannel->m_pImpl->GetKeepAlive();
+    ev_tstamp dKeepAlive = pChannel->m_pImpl->GetKeepAlive();
+    if (m_pLabor->GetNodeInfo().dHttpPoolIdleTimeout > 0.0 && IsIdleHttpChannel(pChannel))
+    {
+        dKeepAlive = std::min(dKeepAlive, m_pLabor->GetNodeInfo().dHttpPoolIdleTimeout);
+    }
+    ev_tstamp after = pChannel->m_pImpl->GetActiveTime() - ev_now(m_loop) + dKeepAlive;
     if (after > 0)    // IO在定时时间内被重新刷新过，重新设置定时器
     {
         ev_timer_stop (m_loop, pChannel->m_pImpl->MutableTimerWatcher());
@@ -730,29 +866,6 @@ bool Dispatcher::OnIoTimeout(std::shared_ptr<SocketChannel> pChannel)
     return(true);
 }
 
-bool Dispatcher::OnClientConnFrequencyTimeout(tagClientConnWatcherData* pData, ev_timer* watcher)
-{
-    bool bRes = false;
-    auto iter = m_mapClientConnFrequency.find(std::string(pData->pAddr));
-    if (iter == m_mapClientConnFrequency.end())
-    {
-        bRes = false;
-    }
-    else
-    {
-        m_mapClientConnFrequency.erase(iter);
-        bRes = true;
-    }
-
-    DelEvent(watcher);
-    pData->pDispatcher = nullptr;
-    delete pData;
-    watcher->data = NULL;
-    delete watcher;
-    watcher = NULL;
-    return(bRes);
-}
-
 void Dispatcher::EventRun()
 {
     ev_run (m_loop, 0);
@@ -1098,6 +1211,62 @@ void Dispatcher::SetClientData(std::shared_ptr<SocketChannel> pChannel, const st
     pChannel->m_pImpl->SetClientData(strClientData);
 }
 
+void Dispatcher::SetChannelCork(std::shared_ptr<SocketChannel> pChannel, bool bCork)
+{
+    pChannel->m_pImpl->SetCork(bCork);
+}
+
+bool Dispatcher::AddCorkedChannel(std::shared_ptr<SocketChannel> pChannel)
+{
+    if (NULL == m_pCorkWatcher)
+    {
+        return(false);
+    }
+    m_vecCorkedChannel.push_back(pChannel);
+    if (!ev_is_active(m_pCorkWatcher))
+    {
+        ev_prepare_start (m_loop, m_pCorkWatcher);
+    }
+    return(true);
+}
+
+bool Dispatcher::OnCorkFlush()
+{
+    std::vector<std::shared_ptr<SocketChannel> > vecCorkedChannel;
+    while (!m_vecCorkedChannel.empty())     // 发送失败时的回调可能又产生合并写数据
+    {
+        vecCorkedChannel.swap(m_vecCorkedChannel);
+        for (auto& pChannel : vecCorkedChannel)
+        {
+            if (CHANNEL_STATUS_CLOSED == pChannel->m_pImpl->GetChannelStatus())
+            {
+                continue;
+            }
+            E_CODEC_STATUS eStatus = pChannel->m_pImpl->Uncork();
+            switch (eStatus)
+            {
+                case CODEC_STATUS_OK:
+                    break;
+                case CODEC_STATUS_PAUSE:
+                case CODEC_STATUS_WANT_WRITE:
+                case CODEC_STATUS_PART_OK:
+                    AddIoWriteEvent(pChannel);
+                    break;
+                case CODEC_STATUS_WANT_READ:
+                    RemoveIoWriteEvent(pChannel);
+                    break;
+                default:
+                    LOG4_TRACE("eStatus = %d, %s", eStatus, pChannel->GetIdentify().c_str());
+                    DiscardSocketChannel(pChannel);
+                    break;
+            }
+        }
+        vecCorkedChannel.clear();
+    }
+    ev_prepare_stop (m_loop, m_pCorkWatcher);
+    return(true);
+}
+
 bool Dispatcher::IsNodeType(const std::string& strNodeIdentify, const std::string& strNodeType)
 {
     return(m_pSessionNode->IsNodeType(strNodeIdentify, strNodeType));
@@ -1168,12 +1337,47 @@ bool Dispatcher::DelEvent(ev_timer* timer_watcher)
     return(true);
 }
 
+bool Dispatcher::AddEvent(tagWheelTimer* wheel_timer, wheel_timer_callback pFunc, ev_tstamp dTimeout)
+{
+    if (NULL == wheel_timer)
+    {
+        return(false);
+    }
+    wheel_timer->cb = pFunc;
+    return(RefreshEvent(wheel_timer, dTimeout));
+}
+
+bool Dispatcher::RefreshEvent(tagWheelTimer* wheel_timer, ev_tstamp dTimeout)
+{
+    if (NULL == wheel_timer || nullptr == m_pTimingWheel)
+    {
+        return(false);
+    }
+    m_pTimingWheel->Add(wheel_timer, ev_now(m_loop) + dTimeout);
+    if (!ev_is_active(m_pTimingWheelWatcher))
+    {
+        ev_timer_set (m_pTimingWheelWatcher, m_pTimingWheel->GetTick(), m_pTimingWheel->GetTick());
+        ev_timer_start (m_loop, m_pTimingWheelWatcher);
+    }
+    return(true);
+}
+
+bool Dispatcher::DelEvent(tagWheelTimer* wheel_timer)
+{
+    if (NULL == wheel_timer || nullptr == m_pTimingWheel)
+    {
+        return(false);
+    }
+    m_pTimingWheel->Del(wheel_timer);
+    return(true);
+}
+
 int Dispatcher::SendFd(int iSocketFd, int iSendFd, int iAiFamily, int iCodecType)
 {
     return(SocketChannel::SendChannelFd(iSocketFd, iSendFd, iAiFamily, iCodecType, m_pLogger));
 }
 
-bool Dispatcher::CreateListenFd(const std::string& strHost, int32 iPort, int& iFd, int& iFamily)
+bool Dispatcher::CreateListenFd(const std::string& strHost, int32 iPort, int& iFd, int& iFamily, bool bReusePort)
 {
     int queueLen = 100;
     int reuse = 1;
@@ -1219,6 +1423,17 @@ bool Dispatcher::CreateListenFd(const std::string& strHost, int32 iPort, int& iF
             iFd = -1;
             continue;
         }
+        if (bReusePort && -1 == ::setsockopt(iFd,
+                    SOL_SOCKET, SO_REUSEPORT, &reuse, sizeof(int)))
+        {
+            close(iFd);
+            iFd = -1;
+            continue;
+        }
+        if (SOCK_STREAM == pAddrCurrent->ai_socktype)
+        {
+            SetTcpConnOpt(iFd);     // accept的连接继承这些选项，无须逐个连接设置
+        }
         if (-1 == bind(iFd,
                     pAddrCurrent->ai_addr, pAddrCurrent->ai_addrlen))
         {
@@ -1250,76 +1465,692 @@ bool Dispatcher::CreateListenFd(const std::string& strHost, int32 iPort, int& iF
     return(true);
 }
 
-std::shared_ptr<SocketChannel> Dispatcher::GetChannel(int iFd)
+void Dispatcher::SetTcpConnOpt(int iFd)
 {
-    auto iter = m_mapSocketChannel.find(iFd);
-    if (iter != m_mapSocketChannel.end())
+    int iKeepAlive = 1;
+    int iKeepIdle = 60;
+    int iKeepInterval = 5;
+    int iKeepCount = 3;
+    int iTcpNoDelay = 1;
+    if (setsockopt(iFd, SOL_SOCKET, SO_KEEPALIVE, (void*)&iKeepAlive, sizeof(iKeepAlive)) < 0)
     {
-        return(iter->second);
+        LOG4_WARNING("fail to set SO_KEEPALIVE");
     }
-    return(nullptr);
-}
-
-int32 Dispatcher::GetConnectionNum() const
-{
-    return((int32)m_mapSocketChannel.size());
-}
-int32 Dispatcher::GetClientNum() const
-{
-    return(m_iClientNum);
-}
-
-bool Dispatcher::Init()
-{
-#if __cplusplus >= 201401L
-    m_pSessionNode = std::make_unique<Nodes>();
-#else
-    m_pSessionNode = std::unique_ptr<Nodes>(new Nodes());
-#endif
-    Codec::AddAutoSwitchCodecType(CODEC_HTTP);
-    Codec::AddAutoSwitchCodecType(CODEC_PROTO);
-    Codec::AddAutoSwitchCodecType(CODEC_RESP);
-    Codec::AddAutoSwitchCodecType(CODEC_HTTP2);
-    Codec::AddAutoSwitchCodecType(CODEC_PRIVATE);
-    return(true);
-}
-
-void Dispatcher::Destroy()
-{
-    m_mapSocketChannel.clear();
-    m_mapNamedSocketChannel.clear();
-    if (m_loop != NULL)
+    if (setsockopt(iFd, IPPROTO_TCP, TCP_KEEPIDLE, (void*) &iKeepIdle, sizeof(iKeepIdle)) < 0)
     {
-        ev_loop_destroy(m_loop);
-        m_loop = NULL;
+        LOG4_WARNING("fail to set TCP_KEEPIDLE");
     }
-    if (m_pErrBuff != NULL)
+    if (setsockopt(iFd, IPPROTO_TCP, TCP_KEEPINTVL, (void *)&iKeepInterval, sizeof(iKeepInterval)) < 0)
     {
-        free(m_pErrBuff);
-        m_pErrBuff = NULL;
+        LOG4_WARNING("fail to set TCP_KEEPINTVL");
+    }
+    if (setsockopt(iFd, IPPROTO_TCP, TCP_KEEPCNT, (void*)&iKeepCount, sizeof (iKeepCount)) < 0)
+    {
+        LOG4_WARNING("fail to set TCP_KEEPCNT");
+    }
+    if (setsockopt(iFd, IPPROTO_TCP, TCP_NODELAY, (void*)&iTcpNoDelay, sizeof(iTcpNoDelay)) < 0)
+    {
+        LOG4_WARNING("fail to set TCP_NODELAY");
     }
-    m_pLabor = nullptr;
 }
 
-std::shared_ptr<SocketChannel> Dispatcher::CreateSocketChannel(int iFd, E_CODEC_TYPE eCodecType, bool bIsClient, bool bWithSsl)
+int Dispatcher::CreateClientSocket(int iFamily, int iSocketType)
 {
-    LOG4_TRACE("iFd %d, codec_type %d, with_ssl = %d", iFd, eCodecType, bWithSsl);
-
-    auto iter = m_mapSocketChannel.find(iFd);
+    int iFd = socket(iFamily, iSocketType, IPPROTO_IP);
+    if (iFd == -1)
+    {
+        return(-1);
+    }
+    x_sock_set_block(iFd, 0);
+    int nREUSEADDR = 1;
+    int iKeepAlive = 1;
+    int iKeepIdle = 60;
+    int iKeepInterval = 5;
+    int iKeepCount = 3;
+    int iTcpNoDelay = 1;
+    int iTcpQuickAck = 1;
+    setsockopt(iFd, SOL_SOCKET, SO_REUSEADDR, (const char*)&nREUSEADDR, sizeof(int));
+    setsockopt(iFd, SOL_SOCKET, SO_KEEPALIVE, (void*)&iKeepAlive, sizeof(iKeepAlive));
+    setsockopt(iFd, IPPROTO_TCP, TCP_KEEPIDLE, (void*) &iKeepIdle, sizeof(iKeepIdle));
+    setsockopt(iFd, IPPROTO_TCP, TCP_KEEPINTVL, (void *)&iKeepInterval, sizeof(iKeepInterval));
+    setsockopt(iFd, IPPROTO_TCP, TCP_KEEPCNT, (void*)&iKeepCount, sizeof (iKeepCount));
+    setsockopt(iFd, IPPROTO_TCP, TCP_NODELAY, (void*)&iTcpNoDelay, sizeof(iTcpNoDelay));
+    setsockopt(iFd, IPPROTO_TCP, TCP_QUICKACK, (void*)&iTcpQuickAck, sizeof(iTcpQuickAck));
+    return(iFd);
+}
+
+bool Dispatcher::ConnectChannel(std::shared_ptr<SocketChannel> pChannel, const std::vector<tagDnsAddr>& vecAddr, uint32 uiFrom, int iPort)
+{
+    int iFd = pChannel->GetFd();
+    for (uint32 i = uiFrom; i < vecAddr.size(); ++i)
+    {
+        tagDnsAddr stAddr = vecAddr[i];
+        if (!RenewSocket(pChannel, stAddr.stAddr.ss_family, (i > 0)))
+        {
+            continue;
+        }
+        if (AF_INET6 == stAddr.stAddr.ss_family)
+        {
+            ((struct sockaddr_in6*)&stAddr.stAddr)->sin6_port = htons(iPort);
+        }
+        else
+        {
+            ((struct sockaddr_in*)&stAddr.stAddr)->sin_port = htons(iPort);
+        }
+        if (0 != connect(iFd, (struct sockaddr*)&stAddr.stAddr, stAddr.uiAddrLen) && EINPROGRESS != errno)
+        {
+            LOG4_WARNING("connect to %s:%d (address %u of %u) error %d: %s", pChannel->m_pImpl->GetRemoteAddr().c_str(),
+                    iPort, i + 1, (uint32)vecAddr.size(), errno, strerror_r(errno, m_pErrBuff, gc_iErrBuffLen));
+            continue;
+        }
+        if (i + 1 < vecAddr.size())
+        {
+            tagConnectAttempt& stAttempt = m_mapConnectAttempt[iFd];
+            if (&stAttempt.vecAddr != &vecAddr)
+            {
+                stAttempt.vecAddr = vecAddr;
+            }
+            stAttempt.uiChannelSeq = pChannel->m_pImpl->GetSequence();
+            stAttempt.uiNext = i + 1;
+            stAttempt.iPort = iPort;
+            AddIoTimeout(pChannel, m_pLabor->GetNodeInfo().dConnectAttemptTimeout);
+        }
+        else
+        {
+            m_mapConnectAttempt.erase(iFd);     // vecAddr可能就是被删除的记录中的地址，之后不再访问
+            AddIoTimeout(pChannel, 1.5);
+        }
+        AddIoReadEvent(pChannel);
+        AddIoWriteEvent(pChannel);
+        return(true);
+    }
+    m_mapConnectAttempt.erase(iFd);
+    return(false);
+}
+
+bool Dispatcher::ConnectFailover(std::shared_ptr<SocketChannel> pChannel, bool bTimeout)
+{
+    if (m_mapConnectAttempt.empty())
+    {
+        return(false);
+    }
+    auto attempt_iter = m_mapConnectAttempt.find(pChannel->GetFd());
+    if (attempt_iter == m_mapConnectAttempt.end()
+            || attempt_iter->second.uiChannelSeq != pChannel->m_pImpl->GetSequence())
+    {
+        return(false);
+    }
+    int iError = 0;
+    socklen_t uiErrorLen = sizeof(iError);
+    getsockopt(pChannel->GetFd(), SOL_SOCKET, SO_ERROR, &iError, &uiErrorLen);
+    if (0 == iError)
+    {
+        struct sockaddr_storage stPeerAddr;
+        socklen_t uiPeerAddrLen = sizeof(stPeerAddr);
+        if (!bTimeout || 0 == getpeername(pChannel->GetFd(), (struct sockaddr*)&stPeerAddr, &uiPeerAddrLen))
+        {
+            m_mapConnectAttempt.erase(attempt_iter);    // 已连接，按正常事件处理
+            return(false);
+        }
+        iError = ETIMEDOUT;
+    }
+    LOG4_WARNING("connect to %s:%d (address %u of %u) error %d: %s, try next address.",
+            pChannel->m_pImpl->GetRemoteAddr().c_str(), attempt_iter->second.iPort,
+            attempt_iter->second.uiNext, (uint32)attempt_iter->second.vecAddr.size(),
+            iError, strerror_r(iError, m_pErrBuff, gc_iErrBuffLen));
+    if (!ConnectChannel(pChannel, attempt_iter->second.vecAddr, attempt_iter->second.uiNext, attempt_iter->second.iPort))
+    {
+        DiscardSocketChannel(pChannel);
+    }
+    return(true);
+}
+
+bool Dispatcher::RenewSocket(std::shared_ptr<SocketChannel> pChannel, int iFamily, bool bForce)
+{
+    int iFd = pChannel->GetFd();
+    int iDomain = 0;
+    int iType = SOCK_STREAM;
+    socklen_t uiOptLen = sizeof(iDomain);
+    getsockopt(iFd, SOL_SOCKET, SO_DOMAIN, &iDomain, &uiOptLen);
+    if (!bForce && iDomain == iFamily)
+    {
+        return(true);
+    }
+    uiOptLen = sizeof(iType);
+    getsockopt(iFd, SOL_SOCKET, SO_TYPE, &iType, &uiOptLen);
+    int iNewFd = CreateClientSocket(iFamily, iType);
+    if (iNewFd == -1)
+    {
+        return(false);
+    }
+    // 先停止fd上的事件，dup2()替换fd背后的socket之后重新启动事件时libev会重新注册到epoll
+    ev_io_stop(m_loop, pChannel->m_pImpl->MutableIoWatcher());
+    int iResult = dup2(iNewFd, iFd);
+    close(iNewFd);
+    return(iResult == iFd);
+}
+
+bool Dispatcher::SendHttpRequest(const std::string& strHost, int iPort, bool bWithSsl, const HttpMsg& oHttpMsg, uint32 uiStepSeq)
+{
+    LOG4_TRACE("host %s port %d", strHost.c_str(), iPort);
+    std::ostringstream ossIdentify;
+    ossIdentify << strHost << ":" << iPort;
+    std::string strIdentify = ossIdentify.str();
+    E_CODEC_TYPE eCodecType = (oHttpMsg.http_major() == 2) ? CODEC_HTTP2 : CODEC_HTTP;
+    tagHttpUpstream& stUpstream = m_mapHttpUpstream[strIdentify];
+    stUpstream.strHost = strHost;
+    stUpstream.iPort = iPort;
+    stUpstream.bWithSsl = bWithSsl;
+    // 有空闲名额却仍有排队请求（之前为其新建连接失败）时先为排队请求建连接
+    while (!stUpstream.dequeWaiting.empty()
+            && (0 == m_pLabor->GetNodeInfo().uiHttpPoolMaxTotal
+                || stUpstream.mapChannel.size() < m_pLabor->GetNodeInfo().uiHttpPoolMaxTotal))
+    {
+        if (!ConnectHttpWaiting(strIdentify))
+        {
+            break;
+        }
+    }
+    if (stUpstream.dequeWaiting.empty())    // 已有排队请求时新请求排在其后
+    {
+        std::shared_ptr<SocketChannel> pChannel = AcquireHttpChannel(strIdentify, eCodecType, bWithSsl);
+        if (nullptr != pChannel)
+        {
+            return(SendTo(pChannel, oHttpMsg, uiStepSeq));
+        }
+        if (0 == m_pLabor->GetNodeInfo().uiHttpPoolMaxTotal
+                || stUpstream.mapChannel.size() < m_pLabor->GetNodeInfo().uiHttpPoolMaxTotal)
+        {
+            return(ConnectHttpUpstream(strIdentify, eCodecType, oHttpMsg, uiStepSeq));
+        }
+    }
+    if (stUpstream.dequeWaiting.size() >= m_pLabor->GetNodeInfo().uiHttpPoolMaxWaiting)
+    {
+        LOG4_WARNING("%s connection pool exhausted, %u connections, %u requests waiting.", strIdentify.c_str(),
+                (uint32)stUpstream.mapChannel.size(), (uint32)stUpstream.dequeWaiting.size());
+        return(false);
+    }
+    stUpstream.dequeWaiting.emplace_back();
+    stUpstream.dequeWaiting.back().uiStepSeq = uiStepSeq;
+    stUpstream.dequeWaiting.back().oHttpMsg = oHttpMsg;
+    return(true);
+}
+
+void Dispatcher::ReleaseHttpChannel(std::shared_ptr<SocketChannel> pChannel, const HttpMsg& oHttpRsp)
+{
+    // 对端即将关闭的连接不再发送请求，连接关闭时（DiscardSocketChannel）释放名额并为排队请求新建连接
+    bool bKeepAlive = (CODEC_HTTP2 == pChannel->m_pImpl->GetCodecType()) || IsHttpKeepAlive(oHttpRsp);
+    auto upstream_iter = m_mapHttpUpstream.find(pChannel->m_pImpl->GetIdentify());
+    if (upstream_iter == m_mapHttpUpstream.end()
+            || upstream_iter->second.mapChannel.find(pChannel->GetFd()) == upstream_iter->second.mapChannel.end())
+    {   // 不经连接池发出的请求
+        if (bKeepAlive && !pChannel->IsPipeline() && pChannel->m_pImpl->GetPipelineStepSeq().empty())
+        {
+            AddNamedSocketChannel(pChannel->GetIdentify(), pChannel);
+        }
+        return;
+    }
+    if (!bKeepAlive)
+    {
+        return;
+    }
+    std::string strIdentify = upstream_iter->first;
+    DrainHttpWaiting(strIdentify, pChannel);
+    if (pChannel->IsPipeline() || !pChannel->m_pImpl->GetPipelineStepSeq().empty()
+            || CHANNEL_STATUS_ESTABLISHED != pChannel->m_pImpl->GetChannelStatus())
+    {
+        return;
+    }
+    upstream_iter = m_mapHttpUpstream.find(strIdentify);
+    if (upstream_iter != m_mapHttpUpstream.end() && !upstream_iter->second.dequeWaiting.empty())
+    {   // 排队的是HTTP/2请求，关闭这个HTTP/1.x连接把名额让出来
+        DiscardSocketChannel(pChannel, false);
+        return;
+    }
+    auto named_iter = m_mapNamedSocketChannel.find(strIdentify);
+    if (m_pLabor->GetNodeInfo().uiHttpPoolMaxIdle > 0 && named_iter != m_mapNamedSocketChannel.end()
+            && named_iter->second.size() >= m_pLabor->GetNodeInfo().uiHttpPoolMaxIdle)
+    {
+        DiscardSocketChannel(pChannel, false);
+        return;
+    }
+    AddNamedSocketChannel(strIdentify, pChannel);
+    if (m_pLabor->GetNodeInfo().dHttpPoolIdleTimeout > 0.0)
+    {
+        AddIoTimeout(pChannel, std::min(m_pLabor->GetNodeInfo().dHttpPoolIdleTimeout, pChannel->m_pImpl->GetKeepAlive()));
+    }
+}
+
+std::shared_ptr<SocketChannel> Dispatcher::AcquireHttpChannel(const std::string& strIdentify, E_CODEC_TYPE eCodecType, bool bWithSsl)
+{
+    auto named_iter = m_mapNamedSocketChannel.find(strIdentify);
+    if (CODEC_HTTP2 == eCodecType)
+    {
+        if (named_iter != m_mapNamedSocketChannel.end())
+        {
+            for (auto& pNamedChannel : named_iter->second)
+            {
+                if (CODEC_HTTP2 == pNamedChannel->m_pImpl->GetCodecType()
+                        && CHANNEL_STATUS_CLOSED != pNamedChannel->m_pImpl->GetChannelStatus()
+                        && CHANNEL_STATUS_BROKEN != pNamedChannel->m_pImpl->GetChannelStatus()
+                        && pNamedChannel->m_pImpl->IsStreamAvailable())
+                {
+                    return(pNamedChannel);
+                }
+            }
+        }
+        return(nullptr);
+    }
+
+    while (named_iter != m_mapNamedSocketChannel.end())
+    {
+        std::shared_ptr<SocketChannel> pChannel = nullptr;
+        for (auto& pNamedChannel : named_iter->second)
+        {
+            if (CODEC_HTTP == pNamedChannel->m_pImpl->GetCodecType() && !pNamedChannel->IsPipeline())
+            {
+                pChannel = pNamedChannel;
+                break;
+            }
+        }
+        if (nullptr == pChannel)
+        {
+            return(nullptr);
+        }
+        named_iter->second.erase(pChannel);
+        if (named_iter->second.empty())
+        {
+            m_mapNamedSocketChannel.erase(named_iter);
+        }
+        if (IsHttpChannelReusable(pChannel, bWithSsl))
+        {
+            return(pChannel);
+        }
+        LOG4_TRACE("idle channel %d to %s is not reusable.", pChannel->GetFd(), strIdentify.c_str());
+        DiscardSocketChannel(pChannel, false);
+        named_iter = m_mapNamedSocketChannel.find(strIdentify);
+    }
+    return(nullptr);
+}
+
+bool Dispatcher::IsHttpKeepAlive(const HttpMsg& oHttpRsp)
+{
+    bool bKeepAlive = (oHttpRsp.http_major() > 1 || (1 == oHttpRsp.http_major() && oHttpRsp.http_minor() >= 1));
+    for (auto iter = oHttpRsp.headers().begin(); iter != oHttpRsp.headers().end(); ++iter)
+    {
+        if (0 != strcasecmp(iter->first.c_str(), "Connection"))
+        {
+            continue;
+        }
+        std::string strValue = iter->second;
+        std::transform(strValue.begin(), strValue.end(), strValue.begin(), [](unsigned char c)->unsigned char{return std::tolower(c);});
+        if (std::string::npos != strValue.find("close"))
+        {
+            return(false);
+        }
+        if (std::string::npos != strValue.find("keep-alive"))
+        {
+            bKeepAlive = true;
+        }
+    }
+    return(bKeepAlive);
+}
+
+bool Dispatcher::IsHttpChannelReusable(std::shared_ptr<SocketChannel> pChannel, bool bWithSsl)
+{
+    if (CHANNEL_STATUS_ESTABLISHED != pChannel->m_pImpl->GetChannelStatus())
+    {
+        return(false);
+    }
+    ev_tstamp dIdleTime = ev_now(m_loop) - pChannel->m_pImpl->GetActiveTime();
+    if (m_pLabor->GetNodeInfo().dHttpPoolIdleTimeout > 0.0 && dIdleTime >= m_pLabor->GetNodeInfo().dHttpPoolIdleTimeout)
+    {
+        return(false);
+    }
+    // 对端关闭连接的可读事件可能还未处理，窥探一下socket；空闲的HTTP/1.x连接上不应有数据，
+    // 但SSL连接上可能有对端发来的会话票据等记录
+    char cPeek = 0;
+    ssize_t iPeekLen = recv(pChannel->GetFd(), &cPeek, 1, MSG_PEEK | MSG_DONTWAIT);
+    if (0 == iPeekLen)
+    {
+        return(false);
+    }
+    if (iPeekLen < 0)
+    {
+        return(EAGAIN == errno || EWOULDBLOCK == errno || EINTR == errno);
+    }
+    return(bWithSsl);
+}
+
+bool Dispatcher::IsIdleHttpChannel(std::shared_ptr<SocketChannel> pChannel)
+{
+    if (CODEC_HTTP != pChannel->m_pImpl->GetCodecType() || !pChannel->IsClient() || pChannel->IsPipeline()
+            || !pChannel->m_pImpl->GetPipelineStepSeq().empty())
+    {
+        return(false);
+    }
+    auto named_iter = m_mapNamedSocketChannel.find(pChannel->m_pImpl->GetIdentify());
+    return(named_iter != m_mapNamedSocketChannel.end() && named_iter->second.count(pChannel) > 0);
+}
+
+bool Dispatcher::ConnectHttpUpstream(const std::string& strIdentify, E_CODEC_TYPE eCodecType, const HttpMsg& oHttpMsg, uint32 uiStepSeq)
+{
+    auto upstream_iter = m_mapHttpUpstream.find(strIdentify);
+    if (upstream_iter == m_mapHttpUpstream.end())
+    {
+        return(false);
+    }
+    bool bPipeline = (CODEC_HTTP2 == eCodecType);
+    if (!AutoSend(strIdentify, upstream_iter->second.strHost, upstream_iter->second.iPort, 0,
+            SOCKET_STREAM, eCodecType, upstream_iter->second.bWithSsl, bPipeline, oHttpMsg, uiStepSeq))
+    {
+        return(false);
+    }
+    std::shared_ptr<SocketChannel> pChannel = m_pLastActivityChannel;   // AutoSend()新建的连接
+    if (nullptr == pChannel || GetChannel(pChannel->GetFd()) != pChannel)
+    {
+        return(true);
+    }
+    upstream_iter->second.mapChannel[pChannel->GetFd()] = pChannel->m_pImpl->GetSequence();
+    if (bPipeline)
+    {
+        DrainHttpWaiting(strIdentify, pChannel);
+    }
+    return(true);
+}
+
+void Dispatcher::DrainHttpWaiting(const std::string& strIdentify, std::shared_ptr<SocketChannel> pChannel)
+{
+    auto upstream_iter = m_mapHttpUpstream.find(strIdentify);
+    if (upstream_iter == m_mapHttpUpstream.end())
+    {
+        return;
+    }
+    std::deque<tagHttpWaiting>& dequeWaiting = upstream_iter->second.dequeWaiting;
+    while (!dequeWaiting.empty())
+    {
+        if (CHANNEL_STATUS_CLOSED == pChannel->m_pImpl->GetChannelStatus()
+                || CHANNEL_STATUS_BROKEN == pChannel->m_pImpl->GetChannelStatus())
+        {
+            return;
+        }
+        if (pChannel->IsPipeline())
+        {
+            if (!pChannel->m_pImpl->IsStreamAvailable())
+            {
+                return;
+            }
+        }
+        else if (!pChannel->m_pImpl->GetPipelineStepSeq().empty())
+        {
+            return;
+        }
+        if ((dequeWaiting.front().oHttpMsg.http_major() == 2) != (CODEC_HTTP2 == pChannel->m_pImpl->GetCodecType()))
+        {
+            return;
+        }
+        tagHttpWaiting stWaiting = std::move(dequeWaiting.front());
+        dequeWaiting.pop_front();
+        if (!m_pLabor->GetActorBuilder()->HasCallbackStep(stWaiting.uiStepSeq))
+        {
+            LOG4_TRACE("step %u timeout while waiting for connection to %s.", stWaiting.uiStepSeq, strIdentify.c_str());
+            continue;
+        }
+        SendTo(pChannel, stWaiting.oHttpMsg, stWaiting.uiStepSeq);
+    }
+}
+
+void Dispatcher::RemoveHttpPoolChannel(std::shared_ptr<SocketChannel> pChannel)
+{
+    auto upstream_iter = m_mapHttpUpstream.find(pChannel->m_pImpl->GetIdentify());
+    if (upstream_iter == m_mapHttpUpstream.end())
+    {
+        return;
+    }
+    auto channel_iter = upstream_iter->second.mapChannel.find(pChannel->GetFd());
+    if (channel_iter == upstream_iter->second.mapChannel.end()
+            || channel_iter->second != pChannel->m_pImpl->GetSequence())
+    {
+        return;
+    }
+    upstream_iter->second.mapChannel.erase(channel_iter);
+    if (!upstream_iter->second.dequeWaiting.empty())
+    {
+        ConnectHttpWaiting(upstream_iter->first);
+    }
+}
+
+bool Dispatcher::ConnectHttpWaiting(const std::string& strIdentify)
+{
+    auto upstream_iter = m_mapHttpUpstream.find(strIdentify);
+    if (upstream_iter == m_mapHttpUpstream.end())
+    {
+        return(false);
+    }
+    std::deque<tagHttpWaiting>& dequeWaiting = upstream_iter->second.dequeWaiting;
+    while (!dequeWaiting.empty())
+    {
+        tagHttpWaiting stWaiting = std::move(dequeWaiting.front());
+        dequeWaiting.pop_front();
+        if (m_pLabor->GetActorBuilder()->HasCallbackStep(stWaiting.uiStepSeq))
+        {
+            return(ConnectHttpUpstream(strIdentify, (stWaiting.oHttpMsg.http_major() == 2) ? CODEC_HTTP2 : CODEC_HTTP,
+                    stWaiting.oHttpMsg, stWaiting.uiStepSeq));
+        }
+    }
+    return(true);
+}
+
+bool Dispatcher::AttachReusePortCpuSteering(int iFd, uint32 uiGroupSize)
+{
+#ifdef SO_ATTACH_REUSEPORT_CBPF
+    if (uiGroupSize == 0)
+    {
+        return(false);
+    }
+    struct sock_filter aCode[] = {
+        { BPF_LD | BPF_W | BPF_ABS, 0, 0, (uint32)(SKF_AD_OFF + SKF_AD_CPU) },     // A = 当前CPU
+        { BPF_ALU | BPF_ADD | BPF_K, 0, 0, uiGroupSize - 1 },                     // Worker序号从1开始
+        { BPF_ALU | BPF_MOD | BPF_K, 0, 0, uiGroupSize },
+        { BPF_RET | BPF_A, 0, 0, 0 }
+    };
+    struct sock_fprog stProg;
+    stProg.len = sizeof(aCode) / sizeof(aCode[0]);
+    stProg.filter = aCode;
+    if (-1 == ::setsockopt(iFd, SOL_SOCKET, SO_ATTACH_REUSEPORT_CBPF, &stProg, sizeof(stProg)))
+    {
+        LOG4_WARNING("SO_ATTACH_REUSEPORT_CBPF error %d: %s", errno, strerror_r(errno, m_pErrBuff, gc_iErrBuffLen));
+        return(false);
+    }
+    return(true);
+#else
+    LOG4_WARNING("SO_ATTACH_REUSEPORT_CBPF is not supported.");
+    return(false);
+#endif
+}
+
+std::shared_ptr<SocketChannel> Dispatcher::GetChannel(int iFd)
+{
+    auto iter = m_mapSocketChannel.find(iFd);
+    if (iter != m_mapSocketChannel.end())
+    {
+        return(iter->second);
+    }
+    return(nullptr);
+}
+
+int32 Dispatcher::GetConnectionNum() const
+{
+    return((int32)m_mapSocketChannel.size());
+}
+int32 Dispatcher::GetClientNum() const
+{
+    return(m_iClientNum);
+}
+
+bool Dispatcher::Init()
+{
+#if __cplusplus >= 201401L
+    m_pSessionNode = std::make_unique<Nodes>(HASH_murmur3_32, 200, m_pLabor->GetNodeInfo().iNodeLocate);
+#else
+    m_pSessionNode = std::unique_ptr<Nodes>(new Nodes(HASH_murmur3_32, 200, m_pLabor->GetNodeInfo().iNodeLocate));
+#endif
+    m_pTimingWheel = std::unique_ptr<TimingWheel>(
+            new TimingWheel(m_pLabor->GetNodeInfo().dTimingWheelTick, ev_now(m_loop)));
+    m_pTimingWheelWatcher = (ev_timer*)malloc(sizeof(ev_timer));
+    if (NULL == m_pTimingWheelWatcher)
+    {
+        return(false);
+    }
+    ev_timer_init (m_pTimingWheelWatcher, TimingWheelCallback, m_pTimingWheel->GetTick(), m_pTimingWheel->GetTick());
+    m_pTimingWheelWatcher->data = (void*)this;
+    if (m_pLabor->GetNodeInfo().uiChannelPoolSize > 0)
+    {
+        m_pChannelPool = std::make_shared<SocketChannelPool>(m_pLogger, m_pLabor->GetNodeInfo().uiChannelPoolSize);
+    }
+    m_pInboundMsgCache = std::unique_ptr<InboundMsgCache>(
+            new InboundMsgCache(m_pLabor->GetNodeInfo().uiInboundMsgCacheSize));
+    Codec::AddAutoSwitchCodecType(CODEC_HTTP);
+    Codec::AddAutoSwitchCodecType(CODEC_PROTO);
+    Codec::AddAutoSwitchCodecType(CODEC_RESP);
+    Codec::AddAutoSwitchCodecType(CODEC_HTTP2);
+    Codec::AddAutoSwitchCodecType(CODEC_PRIVATE);
+    CodecHttp::SetMessageLimit(m_pLabor->GetNodeInfo().uiHttpMaxHeaderSize,
+            m_pLabor->GetNodeInfo().uiHttpMaxBodySize);
+    m_pDnsResolver = std::unique_ptr<DnsResolver>(new DnsResolver(m_pLabor->GetNodeInfo().uiDnsThreadNum,
+            m_pLabor->GetNodeInfo().dDnsMinTtl, m_pLabor->GetNodeInfo().dDnsMaxTtl,
+            m_pLabor->GetNodeInfo().dDnsNegativeTtl));
+    if (!m_pDnsResolver->Init())
+    {
+        LOG4_ERROR("eventfd error %d: %s", errno, strerror_r(errno, m_pErrBuff, gc_iErrBuffLen));
+        return(false);
+    }
+    m_pDnsWatcher = (ev_io*)malloc(sizeof(ev_io));
+    if (NULL == m_pDnsWatcher)
+    {
+        return(false);
+    }
+    ev_io_init (m_pDnsWatcher, DnsCallback, m_pDnsResolver->GetEventFd(), EV_READ);
+    m_pDnsWatcher->data = (void*)this;
+    ev_io_start (m_loop, m_pDnsWatcher);
+    m_pCorkWatcher = (ev_prepare*)malloc(sizeof(ev_prepare));
+    if (NULL == m_pCorkWatcher)
+    {
+        return(false);
+    }
+    ev_prepare_init (m_pCorkWatcher, CorkCallback);
+    m_pCorkWatcher->data = (void*)this;
+    if (m_pLabor->GetNodeInfo().bThreadMode)
+    {
+        m_pMailbox = std::make_shared<ThreadMailbox>(m_pLabor->GetNodeInfo().uiThreadMailboxSize);
+        if (!m_pMailbox->Init())
+        {
+            LOG4_ERROR("eventfd error %d: %s", errno, strerror_r(errno, m_pErrBuff, gc_iErrBuffLen));
+            return(false);
+        }
+        m_pMailboxWatcher = (ev_io*)malloc(sizeof(ev_io));
+        if (NULL == m_pMailboxWatcher)
+        {
+            return(false);
+        }
+        ev_io_init (m_pMailboxWatcher, MailboxCallback, m_pMailbox->GetEventFd(), EV_READ);
+        m_pMailboxWatcher->data = (void*)this;
+        ev_io_start (m_loop, m_pMailboxWatcher);
+    }
+    return(true);
+}
+
+void Dispatcher::Destroy()
+{
+    for (auto& pChannel : m_vecCorkedChannel)  // 退出前发出合并写待发送的数据
+    {
+        if (CHANNEL_STATUS_ESTABLISHED == pChannel->m_pImpl->GetChannelStatus())
+        {
+            pChannel->m_pImpl->Uncork();
+        }
+    }
+    m_vecCorkedChannel.clear();
+    m_mapSocketChannel.clear();
+    m_mapNamedSocketChannel.clear();
+    m_pLastActivityChannel = nullptr;
+    m_pChannelPool.reset();
+    m_pInboundMsgCache.reset();
+    m_pTimingWheel.reset();
+    if (m_pTimingWheelWatcher != NULL)
+    {
+        if (m_loop != NULL)
+        {
+            ev_timer_stop (m_loop, m_pTimingWheelWatcher);
+        }
+        free(m_pTimingWheelWatcher);
+        m_pTimingWheelWatcher = NULL;
+    }
+    if (m_pMailboxWatcher != NULL)
+    {
+        if (m_loop != NULL)
+        {
+            ev_io_stop (m_loop, m_pMailboxWatcher);
+        }
+        free(m_pMailboxWatcher);
+        m_pMailboxWatcher = NULL;
+    }
+    m_pMailbox.reset();
+    if (m_pDnsWatcher != NULL)
+    {
+        if (m_loop != NULL)
+        {
+            ev_io_stop (m_loop, m_pDnsWatcher);
+        }
+        free(m_pDnsWatcher);
+        m_pDnsWatcher = NULL;
+    }
+    m_mapDnsPendingChannel.clear();
+    m_mapConnectAttempt.clear();
+    if (m_pCorkWatcher != NULL)
+    {
+        if (m_loop != NULL)
+        {
+            ev_prepare_stop (m_loop, m_pCorkWatcher);
+        }
+        free(m_pCorkWatcher);
+        m_pCorkWatcher = NULL;
+    }
+    m_mapHttpUpstream.clear();
+    m_pDnsResolver.reset();
+    m_pConnRateLimiter.reset();
+    if (m_loop != NULL)
+    {
+        ev_loop_destroy(m_loop);
+        m_loop = NULL;
+    }
+    if (m_pErrBuff != NULL)
+    {
+        free(m_pErrBuff);
+        m_pErrBuff = NULL;
+    }
+    m_pLabor = nullptr;
+}
+
+std::shared_ptr<SocketChannel> Dispatcher::CreateSocketChannel(int iFd, E_CODEC_TYPE eCodecType, bool bIsClient, bool bWithSsl)
+{
+    LOG4_TRACE("iFd %d, codec_type %d, with_ssl = %d", iFd, eCodecType, bWithSsl);
+
+    auto iter = m_mapSocketChannel.find(iFd);
     if (iter == m_mapSocketChannel.end())
     {
         std::shared_ptr<SocketChannel> pChannel = nullptr;
+        ev_tstamp dKeepAlive = (m_pLabor->GetNodeInfo().dConnectionProtection > 0)
+                ? m_pLabor->GetNodeInfo().dConnectionProtection : m_pLabor->GetNodeInfo().dIoTimeout;
         try
         {
-            if (m_pLabor->GetNodeInfo().dConnectionProtection > 0)
+            if (!bWithSsl && nullptr != m_pChannelPool)
             {
-                pChannel = std::make_shared<SocketChannel>(m_pLogger, iFd,
-                        m_pLabor->GetSequence(), bWithSsl, m_pLabor->GetNodeInfo().dConnectionProtection);
+                pChannel = m_pChannelPool->Acquire(iFd, m_pLabor->GetSequence(), dKeepAlive);
             }
             else
             {
                 pChannel = std::make_shared<SocketChannel>(m_pLogger, iFd,
-                        m_pLabor->GetSequence(), bWithSsl, m_pLabor->GetNodeInfo().dIoTimeout);
+                        m_pLabor->GetSequence(), bWithSsl, dKeepAlive);
             }
         }
         catch(std::bad_alloc& e)
@@ -1377,6 +2208,12 @@ bool Dispatcher::DiscardSocketChannel(std::shared_ptr<SocketChannel> pChannel, b
        }
     }
 
+    // 合并写的数据还在发送队列中，关闭前先发出（与未合并时同一回调内已写入内核一致）
+    if (pChannel->m_pImpl->IsCorkPending()
+            && CHANNEL_STATUS_ESTABLISHED == pChannel->m_pImpl->GetChannelStatus())
+    {
+        pChannel->m_pImpl->Uncork();
+    }
     bool bCloseResult = pChannel->m_pImpl->Close();
     if (bCloseResult)
     {
@@ -1393,6 +2230,12 @@ bool Dispatcher::DiscardSocketChannel(std::shared_ptr<SocketChannel> pChannel, b
         {
             ev_timer_stop (m_loop, pChannel->m_pImpl->MutableTimerWatcher());
         }
+        auto attempt_iter = m_mapConnectAttempt.find(pChannel->m_pImpl->GetFd());
+        if (attempt_iter != m_mapConnectAttempt.end()
+                && attempt_iter->second.uiChannelSeq == pChannel->m_pImpl->GetSequence())
+        {
+            m_mapConnectAttempt.erase(attempt_iter);
+        }
 
         if (CODEC_NEBULA_IN_NODE == pChannel->m_pImpl->GetCodecType())
         {
@@ -1416,6 +2259,7 @@ bool Dispatcher::DiscardSocketChannel(std::shared_ptr<SocketChannel> pChannel, b
             LOG4_TRACE("erase channel %d channel_seq %u from m_mapSocketChannel.",
                     pChannel->m_pImpl->GetFd(), pChannel->m_pImpl->GetSequence());
         }
+        RemoveHttpPoolChannel(pChannel);    // 可能新建连接，须在fd从m_mapSocketChannel中移除之后
         return(true);
     }
     else
@@ -1495,200 +2339,200 @@ void Dispatcher::SetChannelStatus(std::shared_ptr<SocketChannel> pChannel, E_CHA
     pChannel->m_pImpl->SetChannelStatus(eStatus);
 }
 
-bool Dispatcher::AddClientConnFrequencyTimeout(const char* pAddr, ev_tstamp dTimeout)
-{
-    LOG4_TRACE(" ");
-    ev_timer* timeout_watcher = new ev_timer();
-    if (timeout_watcher == NULL)
-    {
-        LOG4_ERROR("new timeout_watcher error!");
-        return(false);
-    }
-    tagClientConnWatcherData* pData = new tagClientConnWatcherData();
-    if (pData == NULL)
-    {
-        LOG4_ERROR("new tagClientConnWatcherData error!");
-        delete timeout_watcher;
-        return(false);
-    }
-    ev_timer_init (timeout_watcher, ClientConnFrequencyTimeoutCallback, dTimeout + ev_time() - ev_now(m_loop), 0.);
-    pData->pDispatcher = this;
-    snprintf(pData->pAddr, gc_iAddrLen, "%s", pAddr);
-    timeout_watcher->data = (void*)pData;
-    ev_timer_start (m_loop, timeout_watcher);
-    return(true);
-}
-
 bool Dispatcher::AcceptFdAndTransfer(int iFd, int iFamily)
 {
+    struct sockaddr_storage stClientAddr;
     char szClientAddr[64] = {0};
-    int iAcceptFd = -1;
-    if (AF_INET == iFamily)
+    bool bPosted = false;
+    m_vecAcceptedFd.clear();
+    for (uint32 i = 0; i < m_pLabor->GetNodeInfo().uiAcceptBatch; ++i)
     {
-        struct sockaddr_in stClientAddr;
-        socklen_t clientAddrSize = sizeof(stClientAddr);
-        iAcceptFd = accept(iFd, (struct sockaddr*) &stClientAddr, &clientAddrSize);
+        int iAcceptFd = AcceptConn(iFd, iFamily, stClientAddr, szClientAddr, sizeof(szClientAddr));
         if (iAcceptFd < 0)
         {
-            LOG4_ERROR("error %d: %s", errno, strerror_r(errno, m_pErrBuff, gc_iErrBuffLen));
-            return(false);
+            break;
+        }
+        LOG4_TRACE("accept connect from \"%s\"", szClientAddr);
+        if (!CheckClientConnFrequency(stClientAddr, szClientAddr))
+        {
+            close(iAcceptFd);
+            continue;
         }
-        int iKeepAlive = 1;
-        int iKeepIdle = 60;
-        int iKeepInterval = 5;
-        int iKeepCount = 3;
-        int iTcpNoDelay = 1;
-        if (setsockopt(iAcceptFd, SOL_SOCKET, SO_KEEPALIVE, (void*)&iKeepAlive, sizeof(iKeepAlive)) < 0)
+        int iWorkerDataFd = ((Manager*)m_pLabor)->GetSessionManager()->GetNextWorkerDataFd();
+        if (iWorkerDataFd <= 0)
         {
-            LOG4_WARNING("fail to set SO_KEEPALIVE");
+            LOG4_WARNING("GetNextWorkerDataFd() found worker data fd = %d", iWorkerDataFd);
+            close(iAcceptFd);
+            continue;
         }
-        if (setsockopt(iAcceptFd, IPPROTO_TCP, TCP_KEEPIDLE, (void*) &iKeepIdle, sizeof(iKeepIdle)) < 0)
+        // 线程模型下连接fd直接投递给Worker线程，无需经SCM_RIGHTS复制后再关闭
+        if (nullptr != m_pMailbox && PostAcceptedFd(iWorkerDataFd, iAcceptFd, iFamily, szClientAddr))
         {
-            LOG4_WARNING("fail to set SO_KEEPIDLE");
+            bPosted = true;
+            continue;
         }
-        if (setsockopt(iAcceptFd, IPPROTO_TCP, TCP_KEEPINTVL, (void *)&iKeepInterval, sizeof(iKeepInterval)) < 0)
+        m_vecAcceptedFd.push_back(std::make_pair(iWorkerDataFd, iAcceptFd));
+    }
+    if (m_vecAcceptedFd.empty())
+    {
+        return(bPosted);
+    }
+
+    // 本轮accept的连接按Worker归并，每个Worker一次sendmsg传递多个文件描述符
+    std::stable_sort(m_vecAcceptedFd.begin(), m_vecAcceptedFd.end(),
+            [](const std::pair<int, int>& a, const std::pair<int, int>& b){ return(a.first < b.first); });
+    int aSendFds[SocketChannel::MAX_TRANSFER_FD_NUM];
+    int iCodec = m_pLabor->GetNodeInfo().eCodec;
+    size_t uiIndex = 0;
+    while (uiIndex < m_vecAcceptedFd.size())
+    {
+        int iWorkerDataFd = m_vecAcceptedFd[uiIndex].first;
+        int iFdNum = 0;
+        while (uiIndex < m_vecAcceptedFd.size() && m_vecAcceptedFd[uiIndex].first == iWorkerDataFd
+                && iFdNum < SocketChannel::MAX_TRANSFER_FD_NUM)
         {
-            LOG4_WARNING("fail to set SO_KEEPINTVL");
+            aSendFds[iFdNum++] = m_vecAcceptedFd[uiIndex++].second;
         }
-        if (setsockopt(iAcceptFd, IPPROTO_TCP, TCP_KEEPCNT, (void*)&iKeepCount, sizeof (iKeepCount)) < 0)
+        LOG4_TRACE("send %d new fd to worker communication fd %d", iFdNum, iWorkerDataFd);
+        int iErrno = SocketChannel::SendChannelFds(iWorkerDataFd, aSendFds, iFdNum, iFamily, iCodec, m_pLogger);
+        if (iErrno != ERR_OK)
         {
-            LOG4_WARNING("fail to set SO_KEEPALIVE");
+            LOG4_ERROR("error %d: %s", iErrno, strerror_r(iErrno, m_pErrBuff, gc_iErrBuffLen));
+            ((Manager*)m_pLabor)->GetSessionManager()->CancelPlacement(iWorkerDataFd, iFdNum);
         }
-        if (setsockopt(iAcceptFd, IPPROTO_TCP, TCP_NODELAY, (void*)&iTcpNoDelay, sizeof(iTcpNoDelay)) < 0)
+        for (int i = 0; i < iFdNum; ++i)
         {
-            LOG4_WARNING("fail to set TCP_NODELAY");
+            close(aSendFds[i]);
         }
-        x_sock_set_block(iAcceptFd, 0);
-        inet_ntop(AF_INET, &stClientAddr.sin_addr, szClientAddr, sizeof(szClientAddr));
-        LOG4_TRACE("accept connect from \"%s\"", szClientAddr);
     }
-    else    // AF_INET6
+    m_vecAcceptedFd.clear();
+    return(true);
+}
+
+bool Dispatcher::PostAcceptedFd(int iWorkerDataFd, int iAcceptFd, int iFamily, const char* szClientAddr)
+{
+    auto iter = m_mapSocketChannel.find(iWorkerDataFd);
+    if (iter == m_mapSocketChannel.end() || nullptr == iter->second->m_pImpl->GetPeerMailbox())
     {
-        struct sockaddr_in6 stClientAddr;
-        socklen_t clientAddrSize = sizeof(stClientAddr);
-        iAcceptFd = accept(iFd, (struct sockaddr*) &stClientAddr, &clientAddrSize);
+        return(false);
+    }
+    tagMailItem stItem;
+    stItem.iFd = iter->second->m_pImpl->GetPeerFd();
+    stItem.iTransferFd = iAcceptFd;
+    stItem.iAiFamily = iFamily;
+    stItem.iCodecType = m_pLabor->GetNodeInfo().eCodec;
+    stItem.strRemoteAddr = szClientAddr;
+    if (iter->second->m_pImpl->GetPeerMailbox()->Post(stItem))
+    {
+        LOG4_TRACE("post fd %d to worker communication fd %d", iAcceptFd, iWorkerDataFd);
+        return(true);
+    }
+    return(false);
+}
+
+void Dispatcher::SetThreadPeer(std::shared_ptr<SocketChannel> pChannel,
+        std::shared_ptr<ThreadMailbox> pPeerMailbox, int iPeerFd)
+{
+    pChannel->m_pImpl->SetThreadPeer(pPeerMailbox, iPeerFd);
+}
+
+bool Dispatcher::AcceptClientConn(int iFd, int iFamily)
+{
+    struct sockaddr_storage stClientAddr;
+    char szClientAddr[64] = {0};
+    bool bAccepted = false;
+    for (uint32 i = 0; i < m_pLabor->GetNodeInfo().uiAcceptBatch; ++i)
+    {
+        int iAcceptFd = AcceptConn(iFd, iFamily, stClientAddr, szClientAddr, sizeof(szClientAddr));
         if (iAcceptFd < 0)
         {
-            LOG4_ERROR("error %d: %s", errno, strerror_r(errno, m_pErrBuff, gc_iErrBuffLen));
-            return(false);
-        }
-        int iKeepAlive = 1;
-        int iKeepIdle = 60;
-        int iKeepInterval = 5;
-        int iKeepCount = 3;
-        int iTcpNoDelay = 1;
-        if (setsockopt(iAcceptFd, SOL_SOCKET, SO_KEEPALIVE, (void*)&iKeepAlive, sizeof(iKeepAlive)) < 0)
-        {
-            LOG4_WARNING("fail to set SO_KEEPALIVE");
+            break;
         }
-        if (setsockopt(iAcceptFd, IPPROTO_TCP, TCP_KEEPIDLE, (void*) &iKeepIdle, sizeof(iKeepIdle)) < 0)
+        LOG4_TRACE("accept connect from \"%s\"", szClientAddr);
+        if (!CheckClientConnFrequency(stClientAddr, szClientAddr))
         {
-            LOG4_WARNING("fail to set SO_KEEPIDLE");
+            close(iAcceptFd);
+            continue;
         }
-        if (setsockopt(iAcceptFd, IPPROTO_TCP, TCP_KEEPINTVL, (void *)&iKeepInterval, sizeof(iKeepInterval)) < 0)
+        bAccepted |= AddAcceptedChannel(iAcceptFd, iFamily, m_pLabor->GetNodeInfo().eCodec, szClientAddr);
+    }
+    return(bAccepted);
+}
+
+int Dispatcher::AcceptConn(int iListenFd, int iFamily, struct sockaddr_storage& stClientAddr, char* szClientAddr, size_t uiAddrLen)
+{
+    while (true)
+    {
+        socklen_t clientAddrSize = sizeof(stClientAddr);
+        int iAcceptFd = accept4(iListenFd, (struct sockaddr*) &stClientAddr, &clientAddrSize,
+                SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (iAcceptFd >= 0)
         {
-            LOG4_WARNING("fail to set SO_KEEPINTVL");
+            if (AF_INET6 == stClientAddr.ss_family)
+            {
+                inet_ntop(AF_INET6, &((struct sockaddr_in6*)&stClientAddr)->sin6_addr, szClientAddr, uiAddrLen);
+            }
+            else
+            {
+                inet_ntop(AF_INET, &((struct sockaddr_in*)&stClientAddr)->sin_addr, szClientAddr, uiAddrLen);
+            }
+            return(iAcceptFd);
         }
-        if (setsockopt(iAcceptFd, IPPROTO_TCP, TCP_KEEPCNT, (void*)&iKeepCount, sizeof (iKeepCount)) < 0)
+        if (EINTR == errno || ECONNABORTED == errno)
         {
-            LOG4_WARNING("fail to set SO_KEEPALIVE");
+            continue;
         }
-        if (setsockopt(iAcceptFd, IPPROTO_TCP, TCP_NODELAY, (void*)&iTcpNoDelay, sizeof(iTcpNoDelay)) < 0)
+        // EAGAIN：已取完（reuseport模式下也可能被组内其他Worker取走）；EMFILE等错误待下次可读事件重试
+        if (EAGAIN != errno && EWOULDBLOCK != errno)
         {
-            LOG4_WARNING("fail to set TCP_NODELAY");
+            LOG4_ERROR("accept4 error %d: %s", errno, strerror_r(errno, m_pErrBuff, gc_iErrBuffLen));
         }
-        x_sock_set_block(iAcceptFd, 0);
-        inet_ntop(AF_INET6, &stClientAddr.sin6_addr, szClientAddr, sizeof(szClientAddr));
-        LOG4_TRACE("accept connect from \"%s\"", szClientAddr);
+        return(-1);
     }
+}
 
-    auto iter = m_mapClientConnFrequency.find(std::string(szClientAddr));
-    if (iter == m_mapClientConnFrequency.end())
+bool Dispatcher::CheckClientConnFrequency(const struct sockaddr_storage& stClientAddr, const char* szClientAddr)
+{
+    if (m_pLabor->GetNodeInfo().iAddrPermitNum <= 0)
     {
-        m_mapClientConnFrequency.insert(std::make_pair(std::string(szClientAddr), 1));
-        AddClientConnFrequencyTimeout(szClientAddr, m_pLabor->GetNodeInfo().dAddrStatInterval);
+        return(true);
     }
-    else
+    if (nullptr == m_pConnRateLimiter)     // 只在接受客户端连接的Labor中创建
     {
-        iter->second++;
-        if (((Manager*)m_pLabor)->GetManagerInfo().iC2SListenFd > 2 && iter->second > (uint32)m_pLabor->GetNodeInfo().iAddrPermitNum)
-        {
-            LOG4_WARNING("client addr %s had been connected more than %u times in %f seconds, it's not permitted",
-                            szClientAddr, m_pLabor->GetNodeInfo().iAddrPermitNum, m_pLabor->GetNodeInfo().dAddrStatInterval);
-            close(iAcceptFd);
-            return(false);
-        }
+        m_pConnRateLimiter = std::unique_ptr<ConnRateLimiter>(
+                new ConnRateLimiter(m_pLabor->GetNodeInfo().uiAddrPermitMemory));
     }
-
-    int iWorkerDataFd = -1;
-    //std::pair<int, int> worker_pid_fd = ((Manager*)m_pLabor)->GetSessionManager()->GetMinLoadWorkerDataFd();
-    //iWorkerDataFd = worker_pid_fd.second;
-    iWorkerDataFd = ((Manager*)m_pLabor)->GetSessionManager()->GetNextWorkerDataFd();
-    if (iWorkerDataFd > 0)
+    if (m_pConnRateLimiter->Check((const struct sockaddr*)&stClientAddr, ev_now(m_loop),
+            m_pLabor->GetNodeInfo().dAddrStatInterval, (uint32)m_pLabor->GetNodeInfo().iAddrPermitNum))
     {
-        LOG4_TRACE("send new fd %d to worker communication fd %d",
-                        iAcceptFd, iWorkerDataFd);
-        int iCodec = m_pLabor->GetNodeInfo().eCodec;
-        int iErrno = SocketChannel::SendChannelFd(iWorkerDataFd, iAcceptFd, iFamily, iCodec, m_pLogger);
-        if (iErrno != ERR_OK)
-        {
-            LOG4_ERROR("error %d: %s", iErrno, strerror_r(iErrno, m_pErrBuff, gc_iErrBuffLen));
-        }
-        close(iAcceptFd);
         return(true);
     }
-    LOG4_WARNING("GetMinLoadWorkerDataFd() found worker_pid_fd.second = %d", iWorkerDataFd);
-    close(iAcceptFd);
+    LOG4_WARNING("client addr %s had been connected more than %u times in %f seconds, it's not permitted",
+                    szClientAddr, m_pLabor->GetNodeInfo().iAddrPermitNum, m_pLabor->GetNodeInfo().dAddrStatInterval);
     return(false);
 }
 
 bool Dispatcher::AcceptServerConn(int iFd)
 {
-    struct sockaddr_in stClientAddr;
-    socklen_t clientAddrSize = sizeof(stClientAddr);
-    int iAcceptFd = accept(iFd, (struct sockaddr*) &stClientAddr, &clientAddrSize);
-    if (iAcceptFd < 0)
-    {
-        LOG4_ERROR("error %d: %s", errno, strerror_r(errno, m_pErrBuff, gc_iErrBuffLen));
-        return(false);
-    }
-    else
+    struct sockaddr_storage stClientAddr;
+    char szClientAddr[64] = {0};
+    bool bAccepted = false;
+    for (uint32 i = 0; i < m_pLabor->GetNodeInfo().uiAcceptBatch; ++i)
     {
-        /* tcp连接检测 */
-        int iKeepAlive = 1;
-        int iKeepIdle = 60;
-        int iKeepInterval = 5;
-        int iKeepCount = 3;
-        int iTcpNoDelay = 1;
-        if (setsockopt(iAcceptFd, SOL_SOCKET, SO_KEEPALIVE, (void*)&iKeepAlive, sizeof(iKeepAlive)) < 0)
-        {
-            LOG4_WARNING("fail to set SO_KEEPALIVE");
-        }
-        if (setsockopt(iAcceptFd, IPPROTO_TCP, TCP_KEEPIDLE, (void*) &iKeepIdle, sizeof(iKeepIdle)) < 0)
-        {
-            LOG4_WARNING("fail to set SO_KEEPIDLE");
-        }
-        if (setsockopt(iAcceptFd, IPPROTO_TCP, TCP_KEEPINTVL, (void *)&iKeepInterval, sizeof(iKeepInterval)) < 0)
-        {
-            LOG4_WARNING("fail to set SO_KEEPINTVL");
-        }
-        if (setsockopt(iAcceptFd, IPPROTO_TCP, TCP_KEEPCNT, (void*)&iKeepCount, sizeof (iKeepCount)) < 0)
-        {
-            LOG4_WARNING("fail to set SO_KEEPALIVE");
-        }
-        if (setsockopt(iAcceptFd, IPPROTO_TCP, TCP_NODELAY, (void*)&iTcpNoDelay, sizeof(iTcpNoDelay)) < 0)
+        int iAcceptFd = AcceptConn(iFd, AF_INET, stClientAddr, szClientAddr, sizeof(szClientAddr));
+        if (iAcceptFd < 0)
         {
-            LOG4_WARNING("fail to set TCP_NODELAY");
+            break;
         }
-        x_sock_set_block(iAcceptFd, 0);
         std::shared_ptr<SocketChannel> pChannel = CreateSocketChannel(iAcceptFd, CODEC_NEBULA);
         if (NULL != pChannel)
         {
             AddIoTimeout(pChannel, 1.0);     // 初始化连接只有一秒即超时，在正常发送第一个数据包之后才采用正常配置的网络IO超时检查
             AddIoReadEvent(pChannel);
+            bAccepted = true;
         }
     }
-    return(false);
+    return(bAccepted);
 }
 
 void Dispatcher::CheckFailedNode()
@@ -1759,6 +2603,16 @@ bool Dispatcher::Deliver(std::shared_ptr<SelfChannel> pSelfChannel, const RedisM
     return(m_pLabor->GetActorBuilder()->OnSelfMessage(pChannel, oRedisMsg));
 }
 
+bool Dispatcher::Deliver(std::shared_ptr<SelfChannel> pSelfChannel, const std::vector<const RedisMsg*>& vecRedisMsg, uint32 uiStepSeq)
+{
+    bool bResult = true;
+    for (size_t i = 0; i < vecRedisMsg.size(); ++i)
+    {
+        bResult &= Deliver(pSelfChannel, *vecRedisMsg[i], uiStepSeq);
+    }
+    return(bResult);
+}
+
 bool Dispatcher::Deliver(std::shared_ptr<SelfChannel> pSelfChannel, const char* pRaw, uint32 uiRawSize, uint32 uiStepSeq)
 {
     if (uiStepSeq > 0)
@@ -42,6 +42,8 @@ extern "C" {
 
 #include <string>
 #include <unordered_map>
+#include <vector>
+#include <deque>
 #include <sstream>
 #include <memory>
 
@@ -50,8 +52,14 @@ extern "C" {
 #include "labor/Labor.hpp"
 #include "channel/SocketChannel.hpp"
 #include "channel/SelfChannel.hpp"
+#include "channel/SocketChannelPool.hpp"
+#include "channel/ThreadMailbox.hpp"
 #include "logger/NetLogger.hpp"
 #include "Nodes.hpp"
+#include "TimingWheel.hpp"
+#include "InboundMsgCache.hpp"
+#include "DnsResolver.hpp"
+#include "ConnRateLimiter.hpp"
 
 namespace neb
 {
@@ -62,7 +70,6 @@ class Worker;
 class LoadStress;  // not in Nebula project
 class Actor;
 class ActorBuilder;
-struct tagClientConnWatcherData;
 
 typedef void (*signal_callback)(struct ev_loop*,ev_signal*,int);
 typedef void (*timer_callback)(struct ev_loop*,ev_timer*,int);
@@ -71,23 +78,6 @@ typedef void (*idle_callback)(struct ev_loop*,ev_idle*,int);
 class Dispatcher
 {
 public:
-    struct tagClientConnWatcherData
-    {
-        char* pAddr;
-        Dispatcher* pDispatcher;     // 不在结构体析构时回收
-
-        tagClientConnWatcherData() : pAddr(NULL), pDispatcher(nullptr)
-        {
-            pAddr = (char*)malloc(gc_iAddrLen);
-        }
-
-        ~tagClientConnWatcherData()
-        {
-            free(pAddr);
-            pAddr = nullptr;
-        }
-    };
-
     Dispatcher(Labor* pLabor, std::shared_ptr<NetLogger> pLogger);
     virtual ~Dispatcher();
     bool Init();
@@ -97,19 +87,33 @@ public:
     static void IoTimeoutCallback(struct ev_loop* loop, ev_timer* watcher, int revents);
     static void PeriodicTaskCallback(struct ev_loop* loop, ev_timer* watcher, int revents);
     static void SignalCallback(struct ev_loop* loop, struct ev_signal* watcher, int revents);
-    static void ClientConnFrequencyTimeoutCallback(struct ev_loop* loop, ev_timer* watcher, int revents);
+    static void TimingWheelCallback(struct ev_loop* loop, ev_timer* watcher, int revents);
+    static void MailboxCallback(struct ev_loop* loop, struct ev_io* watcher, int revents);
+    static void DnsCallback(struct ev_loop* loop, struct ev_io* watcher, int revents);
+    static void CorkCallback(struct ev_loop* loop, struct ev_prepare* watcher, int revents);
 
     bool OnIoRead(std::shared_ptr<SocketChannel> pChannel);
     bool DataRecvAndHandle(std::shared_ptr<SocketChannel> pChannel);
     bool DataFetchAndHandle(std::shared_ptr<SocketChannel> pChannel);
     bool FdTransfer(int iFd);
+    bool OnMailbox();
+    /**
+     * @brief 分发信箱中已投递的全部消息
+     * @note 对端信箱满时改经socket发送，socket上的消息必然晚于之前投递到信箱的消息，
+     * 处理进程内socket通道上收到的消息之前先调用，保证同一发送方的消息按发送顺序处理。
+     */
+    void FlushMailbox();
+    void HandleMailItem(tagMailItem& stItem);
+    bool OnDnsResolved();
+    bool OnCorkFlush();
+    bool AddAcceptedChannel(int iAcceptFd, int iAiFamily, int iCodec, const char* szRemoteAddr = nullptr);
     bool OnIoWrite(std::shared_ptr<SocketChannel> pChannel);
     bool OnIoError(std::shared_ptr<SocketChannel> pChannel);
     bool OnIoTimeout(std::shared_ptr<SocketChannel> pChannel);
-    bool OnClientConnFrequencyTimeout(tagClientConnWatcherData* pData, ev_timer* watcher);
 
     template <typename ...Targs>
     void Logger(int iLogLevel, const char* szFileName, unsigned int uiFileLine, const char* szFunction, Targs&&... args);
+    bool IsLogEnabled(int iLogLevel) const;
 
     void EventRun();
 
@@ -136,6 +140,21 @@ public:
             bool bWithSsl, bool bPipeline, const std::string& strFactor, Targs&&... args);
     template <typename ...Targs>
     bool Broadcast(const std::string& strNodeType, int iSocketType, E_CODEC_TYPE eCodecType, bool bWithSsl, bool bPipeline, Targs&&... args);
+    /**
+     * @brief 经上游（host:port）连接池发送HTTP请求
+     * @note HTTP/1.x请求优先复用空闲连接（复用前检查连接是否已被对端关闭），HTTP/2请求复用
+     * 并发流未满的连接；没有可用连接且连接数未达到http_client_pool.max_total时新建连接，
+     * 否则排队，在有连接完成响应或关闭时按先后顺序发出。
+     * @return 已发送、已进入新建连接的待发送缓冲或已排队时返回true
+     */
+    bool SendHttpRequest(const std::string& strHost, int iPort, bool bWithSsl, const HttpMsg& oHttpMsg, uint32 uiStepSeq);
+    /**
+     * @brief HTTP客户端连接收到一个完整响应后调用：有排队请求时在该连接上发送，否则
+     * HTTP/1.x连接放回空闲连接（超出max_idle时关闭）
+     * @note 响应不允许保持连接（Connection: close或HTTP/1.0未声明keep-alive）时连接
+     * 不再复用，等对端关闭后释放连接池名额
+     */
+    void ReleaseHttpChannel(std::shared_ptr<SocketChannel> pChannel, const HttpMsg& oHttpRsp);
     bool SendDataReport(int32 iCmd, uint32 uiSeq, const MsgBody& oMsgBody);
     std::shared_ptr<SocketChannel> StressSend(const std::string& strIdentify, int32 iCmd, uint32 uiSeq, const MsgBody& oMsgBody, E_CODEC_TYPE eCodecType = CODEC_NEBULA);
 
@@ -157,6 +176,14 @@ public:
     void DelNodeIdentify(const std::string& strNodeType, const std::string& strIdentify);
     void CircuitBreak(const std::string& strIdentify);
     void SetClientData(std::shared_ptr<SocketChannel> pChannel, const std::string& strClientData);
+    /**
+     * @brief 设置连接是否合并写（覆盖write_coalescing配置），关闭时已暂存的数据仍在本轮事件循环结束前发送
+     */
+    void SetChannelCork(std::shared_ptr<SocketChannel> pChannel, bool bCork);
+    /**
+     * @brief 登记有暂存数据的合并写连接，在本轮事件循环进入等待前统一发送
+     */
+    bool AddCorkedChannel(std::shared_ptr<SocketChannel> pChannel);
     bool IsNodeType(const std::string& strNodeIdentify, const std::string& strNodeType);
 
     time_t GetNowTime() const
@@ -169,10 +196,30 @@ public:
     }
     std::shared_ptr<SocketChannel> CreateSocketChannel(int iFd, E_CODEC_TYPE eCodecType, bool bIsClient = false, bool bWithSsl = false);
     bool DiscardSocketChannel(std::shared_ptr<SocketChannel> pChannel, bool bChannelNotice = true);
-    bool CreateListenFd(const std::string& strHost, int32 iPort, int& iFd, int& iFamily);
+    bool CreateListenFd(const std::string& strHost, int32 iPort, int& iFd, int& iFamily, bool bReusePort = false);
+
+    /**
+     * @brief 给reuseport组挂载按CPU分派连接的cBPF程序
+     * @note 在CPU c上收到的连接分派给组内第(c + uiGroupSize - 1) % uiGroupSize个监听socket，
+     * 即序号为c % uiGroupSize的Worker（cpu_affinity把序号为i的Worker绑定在CPU i上）。
+     */
+    bool AttachReusePortCpuSteering(int iFd, uint32 uiGroupSize);
     std::shared_ptr<SocketChannel> GetChannel(int iFd);
     int SendFd(int iSocketFd, int iSendFd, int iAiFamily, int iCodecType);
 
+    /**
+     * @brief 线程模型下本线程的信箱，非线程模型时为nullptr
+     */
+    std::shared_ptr<ThreadMailbox> GetMailbox() const
+    {
+        return(m_pMailbox);
+    }
+
+    /**
+     * @brief 线程模型下把本线程的进程内通道绑定到对端线程的信箱（见SocketChannelImpl::SetThreadPeer()）
+     */
+    void SetThreadPeer(std::shared_ptr<SocketChannel> pChannel, std::shared_ptr<ThreadMailbox> pPeerMailbox, int iPeerFd);
+
 protected:
     void Destroy();
     bool AddIoReadEvent(std::shared_ptr<SocketChannel> pChannel);
@@ -184,11 +231,91 @@ protected:
     bool RefreshEvent(ev_timer* timer_watcher, ev_tstamp dTimeout);
     bool DelEvent(ev_io* io_watcher);
     bool DelEvent(ev_timer* timer_watcher);
+    /**
+     * @brief 时间轮定时器（Step、Session、Chain超时用），精度由timing_wheel_tick配置
+     */
+    bool AddEvent(tagWheelTimer* wheel_timer, wheel_timer_callback pFunc, ev_tstamp dTimeout);
+    bool RefreshEvent(tagWheelTimer* wheel_timer, ev_tstamp dTimeout);
+    bool DelEvent(tagWheelTimer* wheel_timer);
     int32 GetConnectionNum() const;
     int32 GetClientNum() const;
+    uint32 GetTransferredNum() const
+    {
+        return(m_uiTransferredNum);
+    }
+    SocketChannelPool* GetSocketChannelPool()
+    {
+        return(m_pChannelPool.get());
+    }
+    InboundMsgCache* GetInboundMsgCache()
+    {
+        return(m_pInboundMsgCache.get());
+    }
     void SetChannelStatus(std::shared_ptr<SocketChannel> pChannel, E_CHANNEL_STATUS eStatus);
-    bool AddClientConnFrequencyTimeout(const char* pAddr, ev_tstamp dTimeout = 60.0);
     bool AcceptFdAndTransfer(int iFd, int iFamily = AF_INET);
+    /**
+     * @brief 线程模型下把accept到的连接fd直接投递到目标Worker的信箱
+     * @return 目标通道未绑定信箱或信箱已满时返回false，由调用方经SCM_RIGHTS传递
+     */
+    bool PostAcceptedFd(int iWorkerDataFd, int iAcceptFd, int iFamily, const char* szClientAddr);
+    bool AcceptClientConn(int iFd, int iFamily = AF_INET);      ///< reuseport模式下Worker直接accept客户端连接
+    /**
+     * @brief accept4一个连接（非阻塞、close-on-exec）
+     * @param stClientAddr 客户端地址
+     * @param szClientAddr 客户端地址的文本形式
+     * @return 监听队列已空或出错时返回-1
+     */
+    int AcceptConn(int iListenFd, int iFamily, struct sockaddr_storage& stClientAddr, char* szClientAddr, size_t uiAddrLen);
+    void SetTcpConnOpt(int iFd);
+    /**
+     * @brief 创建非阻塞的客户端socket并设置TCP选项
+     * @return 失败时返回-1
+     */
+    int CreateClientSocket(int iFamily, int iSocketType);
+    /**
+     * @brief 从vecAddr[uiFrom]开始依次向各地址发起连接，直到有一个connect()成功或进行中
+     * @note 后面还有备选地址时记录下来，本次连接在connect_attempt_timeout内未成功或出错
+     * 时由ConnectFailover()换下一个地址。
+     */
+    bool ConnectChannel(std::shared_ptr<SocketChannel> pChannel, const std::vector<tagDnsAddr>& vecAddr, uint32 uiFrom, int iPort);
+    /**
+     * @brief 连接中的通道出错或超时时改连下一个地址
+     * @return 通道已被改连或已销毁时返回true，调用方不再处理该事件
+     */
+    bool ConnectFailover(std::shared_ptr<SocketChannel> pChannel, bool bTimeout);
+    /**
+     * @brief 用iFamily地址族的新socket替换通道的socket（fd号不变）
+     * @param bForce 地址族相同时是否也替换（已connect过的socket不能再次connect）
+     */
+    bool RenewSocket(std::shared_ptr<SocketChannel> pChannel, int iFamily, bool bForce);
+    /**
+     * @brief 从连接池取一个可用的连接：HTTP/1.x取出空闲连接，HTTP/2取并发流未满的连接
+     */
+    std::shared_ptr<SocketChannel> AcquireHttpChannel(const std::string& strIdentify, E_CODEC_TYPE eCodecType, bool bWithSsl);
+    /**
+     * @brief 空闲HTTP/1.x连接能否复用（未超过空闲时间，且跨事件循环空闲过的连接未被对端关闭）
+     */
+    bool IsHttpChannelReusable(std::shared_ptr<SocketChannel> pChannel, bool bWithSsl);
+    static bool IsHttpKeepAlive(const HttpMsg& oHttpRsp);
+    bool IsIdleHttpChannel(std::shared_ptr<SocketChannel> pChannel);
+    bool ConnectHttpUpstream(const std::string& strIdentify, E_CODEC_TYPE eCodecType, const HttpMsg& oHttpMsg, uint32 uiStepSeq);
+    /**
+     * @brief 在连接上发送排队的请求（HTTP/1.x最多一个，HTTP/2直到并发流满）
+     */
+    void DrainHttpWaiting(const std::string& strIdentify, std::shared_ptr<SocketChannel> pChannel);
+    /**
+     * @brief 连接池中的连接关闭后释放名额，有排队请求时新建连接
+     */
+    void RemoveHttpPoolChannel(std::shared_ptr<SocketChannel> pChannel);
+    /**
+     * @brief 为第一个仍在等待回调的排队请求新建连接（跳过排队期间已超时的请求）
+     */
+    bool ConnectHttpWaiting(const std::string& strIdentify);
+    /**
+     * @brief 检查客户端地址的连接频率
+     * @return 统计时间内连接次数超过addr_permit配置时返回false
+     */
+    bool CheckClientConnFrequency(const struct sockaddr_storage& stClientAddr, const char* szClientAddr);
     bool AcceptServerConn(int iFd);
     void CheckFailedNode();
     void EvBreak();
@@ -196,17 +323,62 @@ protected:
     bool Deliver(std::shared_ptr<SelfChannel> pSelfChannel, int32 iCmd, uint32 uiSeq, const MsgBody& oMsgBody, uint32 uiStepSeq = 0);
     bool Deliver(std::shared_ptr<SelfChannel> pSelfChannel, const HttpMsg& oHttpMsg, uint32 uiStepSeq = 0);
     bool Deliver(std::shared_ptr<SelfChannel> pSelfChannel, const RedisMsg& oRedisMsg, uint32 uiStepSeq = 0);
+    bool Deliver(std::shared_ptr<SelfChannel> pSelfChannel, const std::vector<const RedisMsg*>& vecRedisMsg, uint32 uiStepSeq = 0);
     bool Deliver(std::shared_ptr<SelfChannel> pSelfChannel, const char* pRaw, uint32 uiRawSize, uint32 uiStepSeq = 0);
 
 private:
+    struct tagDnsPendingChannel
+    {
+        std::shared_ptr<SocketChannel> pChannel;
+        uint32 uiChannelSeq;
+        int iPort;
+    };
+
+    struct tagConnectAttempt
+    {
+        uint32 uiChannelSeq = 0;
+        uint32 uiNext = 0;                  ///< 下一个备选地址
+        int iPort = 0;
+        std::vector<tagDnsAddr> vecAddr;
+    };
+
+    struct tagHttpWaiting
+    {
+        uint32 uiStepSeq = 0;
+        HttpMsg oHttpMsg;
+    };
+
+    struct tagHttpUpstream
+    {
+        std::string strHost;
+        int iPort = 0;
+        bool bWithSsl = false;
+        std::unordered_map<int32, uint32> mapChannel;   ///< 属于本上游的连接（连接中、使用中和空闲），key为fd，value为通道seq
+        std::deque<tagHttpWaiting> dequeWaiting;        ///< 连接数达到上限时排队的请求
+    };
+
     char* m_pErrBuff;
     Labor* m_pLabor;
     struct ev_loop* m_loop;
     int32 m_iClientNum;
+    uint32 m_uiTransferredNum;                              ///< 累计收到Manager分派的连接数量，随心跳上报供Manager核销已分派数
     time_t m_lLastCheckNodeTime;
     std::shared_ptr<NetLogger> m_pLogger;
     std::unique_ptr<Nodes> m_pSessionNode;
+    std::unique_ptr<TimingWheel> m_pTimingWheel;
+    ev_timer* m_pTimingWheelWatcher;                        ///< 驱动时间轮的定时器，时间轮为空时停止
     std::shared_ptr<SocketChannel> m_pLastActivityChannel;  // 最近一个发送或接收过数据的channel
+    std::shared_ptr<SocketChannelPool> m_pChannelPool;      ///< 非SSL连接的SocketChannel对象池
+    std::unique_ptr<InboundMsgCache> m_pInboundMsgCache;    ///< 解码入站消息复用的消息对象
+    std::shared_ptr<ThreadMailbox> m_pMailbox;              ///< 线程模型下接收其他Labor线程消息和连接的信箱
+    ev_io* m_pMailboxWatcher;                               ///< 信箱eventfd的可读事件
+    std::unique_ptr<DnsResolver> m_pDnsResolver;
+    ev_io* m_pDnsWatcher;                                   ///< 解析器eventfd的可读事件
+    std::unordered_map<std::string, std::vector<tagDnsPendingChannel> > m_mapDnsPendingChannel; ///< 等待域名解析结果的连接，key为域名
+    std::unordered_map<int, tagConnectAttempt> m_mapConnectAttempt;     ///< 还有备选地址的连接中的通道，key为fd
+    ev_prepare* m_pCorkWatcher;                             ///< 事件循环进入等待前发送合并写的数据，没有待发送连接时停止
+    std::vector<std::shared_ptr<SocketChannel> > m_vecCorkedChannel;    ///< 本轮事件循环中有合并写数据待发送的连接
+    std::unordered_map<std::string, tagHttpUpstream> m_mapHttpUpstream; ///< HTTP客户端连接池，key为host:port，空闲连接在m_mapNamedSocketChannel中
 
     // Channel
     std::unordered_map<int32, std::shared_ptr<SocketChannel> > m_mapSocketChannel;
@@ -216,7 +388,8 @@ private:
     std::unordered_map<int32, std::shared_ptr<SocketChannel> > m_mapLoaderAndWorkerChannel;     ///< Loader和Worker之间通信通道
     std::unordered_map<int32, std::shared_ptr<SocketChannel> >::iterator m_iterLoaderAndWorkerChannel;
 
-    std::unordered_map<std::string, uint32> m_mapClientConnFrequency;   ///< 客户端连接频率
+    std::unique_ptr<ConnRateLimiter> m_pConnRateLimiter;               ///< 客户端连接频率
+    std::vector<std::pair<int, int> > m_vecAcceptedFd;                  ///< 一轮accept得到的连接（Worker数据通道fd, 连接fd）
 
     friend class Manager;
     friend class Worker;
@@ -224,6 +397,11 @@ private:
     friend class LoadStress;
 };
 
+inline bool Dispatcher::IsLogEnabled(int iLogLevel) const
+{
+    return(m_pLogger->IsLevelEnabled(iLogLevel));
+}
+
 template <typename ...Targs>
 void Dispatcher::Logger(int iLogLevel, const char* szFileName, unsigned int uiFileLine, const char* szFunction, Targs&&... args)
 {
@@ -399,65 +577,43 @@ bool Dispatcher::AutoSend(
         int iRemoteWorkerIndex, int iSocketType, E_CODEC_TYPE eCodecType, bool bWithSsl, bool bPipeline, Targs&&... args)
 {
     LOG4_TRACE("%s", strIdentify.c_str());
-    struct addrinfo stAddrHints;
-    struct addrinfo* pAddrResult;
-    struct addrinfo* pAddrCurrent;
-    memset(&stAddrHints, 0, sizeof(struct addrinfo));
-    stAddrHints.ai_family = AF_UNSPEC;
-    stAddrHints.ai_socktype = iSocketType;
-    stAddrHints.ai_protocol = IPPROTO_IP;
-    int iCode = getaddrinfo(strHost.c_str(), std::to_string(iPort).c_str(), &stAddrHints, &pAddrResult);
-    if (0 != iCode)
-    {
-        LOG4_ERROR("getaddrinfo(\"%s\", \"%d\") error %d: %s",
-                strHost.c_str(), iPort, iCode, gai_strerror(iCode));
-        return(false);
-    }
-    int iFd = -1;
-    for (pAddrCurrent = pAddrResult;
-            pAddrCurrent != NULL; pAddrCurrent = pAddrCurrent->ai_next)
+    const tagDnsRecord* pDnsRecord = nullptr;
+    int iLookup = m_pDnsResolver->Lookup(strHost, ev_now(m_loop), pDnsRecord);
+    if (DNS_LOOKUP_FAILED == iLookup)
     {
-        iFd = socket(pAddrCurrent->ai_family,
-                pAddrCurrent->ai_socktype, pAddrCurrent->ai_protocol);
-        if (iFd == -1)
-        {
-            continue;
-        }
-
-        break;
+        LOG4_ERROR("resolve \"%s\" error %d: %s",
+                strHost.c_str(), pDnsRecord->iError, gai_strerror(pDnsRecord->iError));
+        return(false);
     }
 
-    /* No address succeeded */
-    if (pAddrCurrent == NULL)
+    // 解析结果返回之前先按IPv4创建socket，结果为IPv6地址时在ConnectChannel()中替换
+    int iFamily = (DNS_LOOKUP_OK == iLookup) ? pDnsRecord->vecAddr[0].stAddr.ss_family : AF_INET;
+    int iFd = CreateClientSocket(iFamily, iSocketType);
+    if (iFd == -1)
     {
         LOG4_ERROR("Could not connect to \"%s:%d\"", strHost.c_str(), iPort);
-        freeaddrinfo(pAddrResult);           /* No longer needed */
         return(false);
     }
-
-    x_sock_set_block(iFd, 0);
-    int nREUSEADDR = 1;
-    int iKeepAlive = 1;
-    int iKeepIdle = 60;
-    int iKeepInterval = 5;
-    int iKeepCount = 3;
-    int iTcpNoDelay = 1;
-    int iTcpQuickAck = 1;
-    setsockopt(iFd, SOL_SOCKET, SO_REUSEADDR, (const char*)&nREUSEADDR, sizeof(int));
-    setsockopt(iFd, SOL_SOCKET, SO_KEEPALIVE, (void*)&iKeepAlive, sizeof(iKeepAlive));
-    setsockopt(iFd, IPPROTO_TCP, TCP_KEEPIDLE, (void*) &iKeepIdle, sizeof(iKeepIdle));
-    setsockopt(iFd, IPPROTO_TCP, TCP_KEEPINTVL, (void *)&iKeepInterval, sizeof(iKeepInterval));
-    setsockopt(iFd, IPPROTO_TCP, TCP_KEEPCNT, (void*)&iKeepCount, sizeof (iKeepCount));
-    setsockopt(iFd, IPPROTO_TCP, TCP_NODELAY, (void*)&iTcpNoDelay, sizeof(iTcpNoDelay));
-    setsockopt(iFd, IPPROTO_TCP, TCP_QUICKACK, (void*)&iTcpQuickAck, sizeof(iTcpQuickAck));
     std::shared_ptr<SocketChannel> pChannel = CreateSocketChannel(iFd, eCodecType, true, bWithSsl);
     if (nullptr != pChannel)
     {
-        connect(iFd, pAddrCurrent->ai_addr, pAddrCurrent->ai_addrlen);
-        freeaddrinfo(pAddrResult);           /* No longer needed */
-        AddIoTimeout(pChannel, 1.5);
-        AddIoReadEvent(pChannel);
-        AddIoWriteEvent(pChannel);
+        if (DNS_LOOKUP_OK == iLookup)
+        {
+            if (!ConnectChannel(pChannel, pDnsRecord->vecAddr, 0, iPort))
+            {
+                LOG4_ERROR("Could not connect to \"%s:%d\"", strHost.c_str(), iPort);
+                DiscardSocketChannel(pChannel, false);
+                return(false);
+            }
+        }
+        else    // 消息先编码进通道的待发送缓冲，解析完成后再连接
+        {
+            tagDnsPendingChannel stPending;
+            stPending.pChannel = pChannel;
+            stPending.uiChannelSeq = pChannel->m_pImpl->GetSequence();
+            stPending.iPort = iPort;
+            m_mapDnsPendingChannel[strHost].push_back(stPending);
+        }
         pChannel->m_pImpl->SetIdentify(strIdentify);
         pChannel->m_pImpl->SetRemoteAddr(strHost);
         pChannel->m_pImpl->SetPipeline(bPipeline);
@@ -482,7 +638,6 @@ bool Dispatcher::AutoSend(
     }
     else    // 没有足够资源分配给新连接，直接close掉
     {
-        freeaddrinfo(pAddrResult);           /* No longer needed */
         close(iFd);
         return(false);
     }
@@ -522,9 +677,10 @@ bool Dispatcher::SendOriented(const std::string& strNodeType, int iSocketType, E
     {
         SendTo(strOnlineNode, iSocketType, eCodecType, bWithSsl, bPipeline);
     }
-    if (m_pSessionNode->GetNode(strNodeType, uiFactor, strOnlineNode))
+    const std::string* pOnlineNode = nullptr;
+    if (m_pSessionNode->GetNode(strNodeType, uiFactor, pOnlineNode))
     {
-        return(SendTo(strOnlineNode, iSocketType, eCodecType, bWithSsl, bPipeline, std::forward<Targs>(args)...));
+        return(SendTo(*pOnlineNode, iSocketType, eCodecType, bWithSsl, bPipeline, std::forward<Targs>(args)...));
     }
     else
     {
@@ -547,9 +703,10 @@ bool Dispatcher::SendOriented(const std::string& strNodeType, int iSocketType, E
     {
         SendTo(strOnlineNode, iSocketType, eCodecType, bWithSsl, bPipeline);
     }
-    if (m_pSessionNode->GetNode(strNodeType, strFactor, strOnlineNode))
+    const std::string* pOnlineNode = nullptr;
+    if (m_pSessionNode->GetNode(strNodeType, strFactor, pOnlineNode))
     {
-        return(SendTo(strOnlineNode, iSocketType, eCodecType, bWithSsl, bPipeline, std::forward<Targs>(args)...));
+        return(SendTo(*pOnlineNode, iSocketType, eCodecType, bWithSsl, bPipeline, std::forward<Targs>(args)...));
     }
     else
     {
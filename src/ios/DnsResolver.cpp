@@ -0,0 +1,349 @@
+/*******************************************************************************
+ * Project:  Nebula
+ * @file     DnsResolver.cpp
+ * @brief    异步域名解析及解析结果缓存
+ * @author   Bwar
+ * @date:    2026年10月17日
+ * @note
+ * Modify history:
+ ******************************************************************************/
+#include <unistd.h>
+#include <netdb.h>
+#include <strings.h>
+#include <sys/eventfd.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <arpa/nameser.h>
+#include <resolv.h>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#undef DELETE       // arpa/nameser_compat.h中的同名宏与Definition.hpp中的DELETE冲突
+#include "DnsResolver.hpp"
+
+namespace neb
+{
+
+DnsResolver::DnsResolver(uint32 uiThreadNum, ev_tstamp dMinTtl, ev_tstamp dMaxTtl, ev_tstamp dNegativeTtl)
+    : m_uiThreadNum(uiThreadNum), m_dMinTtl(dMinTtl), m_dMaxTtl(dMaxTtl), m_dNegativeTtl(dNegativeTtl),
+      m_iEventFd(-1), m_bStop(false)
+{
+    if (m_uiThreadNum == 0)
+    {
+        m_uiThreadNum = 1;
+    }
+    if (m_dMaxTtl < m_dMinTtl)
+    {
+        m_dMaxTtl = m_dMinTtl;
+    }
+}
+
+DnsResolver::~DnsResolver()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_bStop = true;
+    }
+    m_cond.notify_all();
+    for (auto& oThread : m_vecThread)
+    {
+        oThread.join();     // 正在进行的查询最多等待resolv.conf配置的超时时间
+    }
+    if (m_iEventFd >= 0)
+    {
+        close(m_iEventFd);
+    }
+}
+
+bool DnsResolver::Init()
+{
+    m_iEventFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    return(m_iEventFd >= 0);
+}
+
+int DnsResolver::Lookup(const std::string& strHost, ev_tstamp dNow, const tagDnsRecord*& pRecord)
+{
+    m_stNumericRecord.vecAddr.resize(1);
+    if (ParseNumericHost(strHost, m_stNumericRecord.vecAddr[0]))
+    {
+        pRecord = &m_stNumericRecord;
+        return(DNS_LOOKUP_OK);
+    }
+
+    auto iter = m_mapCache.find(strHost);
+    if (iter == m_mapCache.end())
+    {
+        if (m_mapCache.size() >= sc_uiMaxCacheNum)
+        {
+            EvictExpired(dNow);
+        }
+        tagDnsRecord& stRecord = m_mapCache[strHost];
+        stRecord.bQuerying = true;
+        Query(strHost);
+        pRecord = &stRecord;
+        return(DNS_LOOKUP_PENDING);
+    }
+
+    pRecord = &iter->second;
+    if (!iter->second.bQuerying)
+    {
+        if (dNow < iter->second.dExpireTime)
+        {
+            return((0 == iter->second.iError) ? DNS_LOOKUP_OK : DNS_LOOKUP_FAILED);
+        }
+        iter->second.bQuerying = true;
+        Query(strHost);
+    }
+    // 过期的地址在刷新完成之前继续使用，否定结果不保留地址
+    return(iter->second.vecAddr.empty() ? DNS_LOOKUP_PENDING : DNS_LOOKUP_OK);
+}
+
+bool DnsResolver::Fetch(ev_tstamp dNow, std::string& strHost, const tagDnsRecord*& pRecord)
+{
+    tagDnsResult stResult;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_dequeResult.empty())
+        {
+            return(false);
+        }
+        stResult = std::move(m_dequeResult.front());
+        m_dequeResult.pop_front();
+    }
+    tagDnsRecord& stRecord = m_mapCache[stResult.strHost];
+    stRecord.bQuerying = false;
+    stRecord.iError = stResult.iError;
+    stRecord.vecAddr.swap(stResult.vecAddr);
+    if (0 == stRecord.iError)
+    {
+        stRecord.dExpireTime = dNow + std::min(std::max((ev_tstamp)stResult.uiTtl, m_dMinTtl), m_dMaxTtl);
+    }
+    else
+    {
+        stRecord.dExpireTime = dNow + m_dNegativeTtl;
+    }
+    strHost.swap(stResult.strHost);
+    pRecord = &stRecord;
+    return(true);
+}
+
+void DnsResolver::ClearNotify()
+{
+    uint64 ullCount = 0;
+    while (read(m_iEventFd, &ullCount, sizeof(ullCount)) < 0 && EINTR == errno)
+    {
+    }
+}
+
+bool DnsResolver::ParseNumericHost(const std::string& strHost, tagDnsAddr& stAddr)
+{
+    memset(&stAddr.stAddr, 0, sizeof(stAddr.stAddr));
+    struct sockaddr_in* pAddr4 = (struct sockaddr_in*)&stAddr.stAddr;
+    if (1 == inet_pton(AF_INET, strHost.c_str(), &pAddr4->sin_addr))
+    {
+        pAddr4->sin_family = AF_INET;
+        stAddr.uiAddrLen = sizeof(struct sockaddr_in);
+        return(true);
+    }
+    struct sockaddr_in6* pAddr6 = (struct sockaddr_in6*)&stAddr.stAddr;
+    if (1 == inet_pton(AF_INET6, strHost.c_str(), &pAddr6->sin6_addr))
+    {
+        pAddr6->sin6_family = AF_INET6;
+        stAddr.uiAddrLen = sizeof(struct sockaddr_in6);
+        return(true);
+    }
+    return(false);
+}
+
+void DnsResolver::Query(const std::string& strHost)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_dequeQuery.push_back(strHost);
+        if (m_vecThread.empty())    // 不访问域名的Labor不创建解析线程
+        {
+            for (uint32 i = 0; i < m_uiThreadNum; ++i)
+            {
+                m_vecThread.push_back(std::thread(&DnsResolver::ThreadRun, this));
+            }
+        }
+    }
+    m_cond.notify_one();
+}
+
+void DnsResolver::ThreadRun()
+{
+    tagDnsResult stResult;
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_cond.wait(lock, [this]{ return(m_bStop || !m_dequeQuery.empty()); });
+            if (m_bStop)
+            {
+                return;
+            }
+            stResult.strHost = std::move(m_dequeQuery.front());
+            m_dequeQuery.pop_front();
+        }
+        Resolve(stResult);
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_dequeResult.push_back(std::move(stResult));
+        }
+        stResult = tagDnsResult();
+        uint64 ullOne = 1;
+        while (write(m_iEventFd, &ullOne, sizeof(ullOne)) < 0 && EINTR == errno)
+        {
+        }
+    }
+}
+
+void DnsResolver::Resolve(tagDnsResult& stResult) const
+{
+    std::vector<tagDnsAddr> vecAddr;
+    if (LookupHostsFile(stResult.strHost, vecAddr))
+    {
+        stResult.iError = 0;
+        stResult.uiTtl = (uint32)m_dMaxTtl;
+        stResult.vecAddr.swap(vecAddr);
+        return;
+    }
+
+    struct __res_state stRes;
+    memset(&stRes, 0, sizeof(stRes));
+    if (0 != res_ninit(&stRes))
+    {
+        stResult.iError = EAI_SYSTEM;
+        return;
+    }
+    std::vector<tagDnsAddr> vecAddr4;
+    std::vector<tagDnsAddr> vecAddr6;
+    uint32 uiTtl = (uint32)m_dMaxTtl;
+    int iHerrno = HOST_NOT_FOUND;
+    unsigned char szAnswer[4096];
+    const int aiType[2] = {ns_t_aaaa, ns_t_a};
+    for (int t = 0; t < 2; ++t)
+    {
+        int iLen = res_nsearch(&stRes, stResult.strHost.c_str(), ns_c_in, aiType[t], szAnswer, sizeof(szAnswer));
+        if (iLen < 0)
+        {
+            if (TRY_AGAIN == stRes.res_h_errno || NO_RECOVERY == stRes.res_h_errno)
+            {
+                iHerrno = stRes.res_h_errno;
+            }
+            continue;
+        }
+        ns_msg oMsg;
+        if (ns_initparse(szAnswer, std::min(iLen, (int)sizeof(szAnswer)), &oMsg) < 0)
+        {
+            continue;
+        }
+        for (int i = 0; i < ns_msg_count(oMsg, ns_s_an); ++i)
+        {
+            ns_rr oRr;
+            if (ns_parserr(&oMsg, ns_s_an, i, &oRr) < 0)
+            {
+                break;
+            }
+            tagDnsAddr stAddr;
+            memset(&stAddr.stAddr, 0, sizeof(stAddr.stAddr));
+            if (ns_t_a == ns_rr_type(oRr) && 4 == ns_rr_rdlen(oRr))
+            {
+                struct sockaddr_in* pAddr4 = (struct sockaddr_in*)&stAddr.stAddr;
+                pAddr4->sin_family = AF_INET;
+                memcpy(&pAddr4->sin_addr, ns_rr_rdata(oRr), 4);
+                stAddr.uiAddrLen = sizeof(struct sockaddr_in);
+                vecAddr4.push_back(stAddr);
+            }
+            else if (ns_t_aaaa == ns_rr_type(oRr) && 16 == ns_rr_rdlen(oRr))
+            {
+                struct sockaddr_in6* pAddr6 = (struct sockaddr_in6*)&stAddr.stAddr;
+                pAddr6->sin6_family = AF_INET6;
+                memcpy(&pAddr6->sin6_addr, ns_rr_rdata(oRr), 16);
+                stAddr.uiAddrLen = sizeof(struct sockaddr_in6);
+                vecAddr6.push_back(stAddr);
+            }
+            else if (ns_t_cname != ns_rr_type(oRr))
+            {
+                continue;
+            }
+            uiTtl = std::min(uiTtl, (uint32)ns_rr_ttl(oRr));   // 包括CNAME链上的记录
+        }
+    }
+    res_nclose(&stRes);
+
+    // IPv6与IPv4地址交替排列，首选IPv6，某一地址族不通时很快能轮到另一地址族
+    for (size_t i = 0; i < vecAddr6.size() || i < vecAddr4.size(); ++i)
+    {
+        if (i < vecAddr6.size())
+        {
+            vecAddr.push_back(vecAddr6[i]);
+        }
+        if (i < vecAddr4.size())
+        {
+            vecAddr.push_back(vecAddr4[i]);
+        }
+    }
+    if (vecAddr.empty())
+    {
+        stResult.iError = (TRY_AGAIN == iHerrno) ? EAI_AGAIN : ((NO_RECOVERY == iHerrno) ? EAI_FAIL : EAI_NONAME);
+        return;
+    }
+    stResult.iError = 0;
+    stResult.uiTtl = uiTtl;
+    stResult.vecAddr.swap(vecAddr);
+}
+
+bool DnsResolver::LookupHostsFile(const std::string& strHost, std::vector<tagDnsAddr>& vecAddr) const
+{
+    std::ifstream fin("/etc/hosts");
+    std::string strLine;
+    while (std::getline(fin, strLine))
+    {
+        size_t uiCommentPos = strLine.find('#');
+        if (uiCommentPos != std::string::npos)
+        {
+            strLine.resize(uiCommentPos);
+        }
+        std::istringstream issLine(strLine);
+        std::string strAddr;
+        std::string strName;
+        if (!(issLine >> strAddr))
+        {
+            continue;
+        }
+        while (issLine >> strName)
+        {
+            if (0 == strcasecmp(strName.c_str(), strHost.c_str()))
+            {
+                tagDnsAddr stAddr;
+                if (ParseNumericHost(strAddr, stAddr))
+                {
+                    vecAddr.push_back(stAddr);
+                }
+                break;
+            }
+        }
+    }
+    return(!vecAddr.empty());
+}
+
+void DnsResolver::EvictExpired(ev_tstamp dNow)
+{
+    for (auto iter = m_mapCache.begin(); iter != m_mapCache.end();)
+    {
+        if (!iter->second.bQuerying && iter->second.dExpireTime <= dNow)
+        {
+            iter = m_mapCache.erase(iter);
+        }
+        else
+        {
+            ++iter;
+        }
+    }
+}
+
+} /* namespace neb */
@@ -0,0 +1,133 @@
+/*******************************************************************************
+ * Project:  Nebula
+ * @file     DnsResolver.hpp
+ * @brief    异步域名解析及解析结果缓存
+ * @author   Bwar
+ * @date:    2026年10月17日
+ * @note     每个Dispatcher拥有一个解析器：事件循环线程查缓存，未命中时把域名交给
+ * 解析线程（首次需要时才创建），解析线程依次查/etc/hosts和DNS（res_nsearch，
+ * 取得记录的TTL），结果放入完成队列并写eventfd唤醒事件循环，由事件循环线程取出
+ * 更新缓存。同一域名同一时刻只有一个查询在进行。缓存过期后先继续使用旧地址，
+ * 同时发起刷新查询。
+ * Modify history:
+ ******************************************************************************/
+#ifndef SRC_IOS_DNSRESOLVER_HPP_
+#define SRC_IOS_DNSRESOLVER_HPP_
+
+#include <sys/socket.h>
+#include <string>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <unordered_map>
+#include "Definition.hpp"
+
+namespace neb
+{
+
+enum E_DNS_LOOKUP
+{
+    DNS_LOOKUP_OK           = 0,        ///< 得到地址（数字地址、缓存命中或缓存过期正在刷新）
+    DNS_LOOKUP_PENDING      = 1,        ///< 正在解析，结果通过eventfd通知
+    DNS_LOOKUP_FAILED       = 2,        ///< 解析失败（否定缓存命中）
+};
+
+struct tagDnsAddr
+{
+    socklen_t uiAddrLen = 0;
+    struct sockaddr_storage stAddr;
+};
+
+struct tagDnsRecord
+{
+    int iError              = 0;        ///< 0或getaddrinfo的EAI_*错误码
+    bool bQuerying          = false;    ///< 是否有查询正在进行
+    ev_tstamp dExpireTime   = 0.0;
+    std::vector<tagDnsAddr> vecAddr;    ///< 按IPv6、IPv4交替排列（rfc8305 4）
+};
+
+class DnsResolver
+{
+public:
+    /**
+     * @param uiThreadNum 解析线程数量
+     * @param dMinTtl 缓存时间下限（秒）
+     * @param dMaxTtl 缓存时间上限（秒），/etc/hosts中的地址按此缓存
+     * @param dNegativeTtl 解析失败结果的缓存时间（秒）
+     */
+    DnsResolver(uint32 uiThreadNum, ev_tstamp dMinTtl, ev_tstamp dMaxTtl, ev_tstamp dNegativeTtl);
+    DnsResolver(const DnsResolver&) = delete;
+    DnsResolver& operator=(const DnsResolver&) = delete;
+    ~DnsResolver();
+
+    /**
+     * @brief 创建eventfd
+     */
+    bool Init();
+
+    int GetEventFd() const
+    {
+        return(m_iEventFd);
+    }
+
+    /**
+     * @brief 查询域名（只能由事件循环线程调用）
+     * @param pRecord 返回DNS_LOOKUP_OK或DNS_LOOKUP_FAILED时指向地址记录，在下次Lookup()或Fetch()之前有效
+     * @return E_DNS_LOOKUP
+     */
+    int Lookup(const std::string& strHost, ev_tstamp dNow, const tagDnsRecord*& pRecord);
+
+    /**
+     * @brief 取出一个完成的查询并更新缓存（只能由事件循环线程调用）
+     * @return 没有完成的查询时返回false
+     */
+    bool Fetch(ev_tstamp dNow, std::string& strHost, const tagDnsRecord*& pRecord);
+
+    /**
+     * @brief 消费eventfd上的唤醒通知（须在Fetch()取空完成队列之前调用）
+     */
+    void ClearNotify();
+
+    /**
+     * @brief 解析数字形式的IPv4、IPv6地址
+     */
+    static bool ParseNumericHost(const std::string& strHost, tagDnsAddr& stAddr);
+
+protected:
+    struct tagDnsResult
+    {
+        int iError = 0;
+        uint32 uiTtl = 0;
+        std::string strHost;
+        std::vector<tagDnsAddr> vecAddr;
+    };
+
+    void Query(const std::string& strHost);
+    void ThreadRun();
+    void Resolve(tagDnsResult& stResult) const;
+    bool LookupHostsFile(const std::string& strHost, std::vector<tagDnsAddr>& vecAddr) const;
+    void EvictExpired(ev_tstamp dNow);
+
+private:
+    uint32 m_uiThreadNum;
+    ev_tstamp m_dMinTtl;
+    ev_tstamp m_dMaxTtl;
+    ev_tstamp m_dNegativeTtl;
+    int m_iEventFd;
+    bool m_bStop;
+    std::mutex m_mutex;
+    std::condition_variable m_cond;
+    std::deque<std::string> m_dequeQuery;                       ///< 待解析的域名
+    std::deque<tagDnsResult> m_dequeResult;                     ///< 完成的查询
+    std::vector<std::thread> m_vecThread;
+    tagDnsRecord m_stNumericRecord;                             ///< 数字地址不进缓存，复用此记录返回
+    std::unordered_map<std::string, tagDnsRecord> m_mapCache;   ///< 只由事件循环线程访问
+
+    static const uint32 sc_uiMaxCacheNum = 4096;                ///< 超过时插入前清理过期的缓存
+};
+
+} /* namespace neb */
+
+#endif /* SRC_IOS_DNSRESOLVER_HPP_ */
@@ -0,0 +1,73 @@
+/*******************************************************************************
+ * Project:  Nebula
+ * @file     InboundMsgCache.cpp
+ * @brief    入站消息对象复用
+ * @author   Bwar
+ * @date:    2026年10月17日
+ * @note
+ * Modify history:
+ ******************************************************************************/
+#include "InboundMsgCache.hpp"
+
+namespace neb
+{
+
+InboundMsgCache::InboundMsgCache(uint32 uiMaxBytesHeld)
+    : m_uiMaxBytesHeld(uiMaxBytesHeld),
+      m_pMsgHead(new MsgHead()), m_pMsgBody(new MsgBody()),
+      m_pHttpMsg(new HttpMsg()), m_pRedisMsg(new RedisMsg())
+{
+}
+
+InboundMsgCache::~InboundMsgCache()
+{
+}
+
+MsgHead& InboundMsgCache::MsgHeadForDecode()
+{
+    m_pMsgHead->Clear();
+    return(*m_pMsgHead);
+}
+
+MsgBody& InboundMsgCache::MsgBodyForDecode()
+{
+    ++m_stStat.ullReuse;
+    m_pMsgBody->Clear();
+    return(*m_pMsgBody);
+}
+
+HttpMsg& InboundMsgCache::HttpMsgForDecode()
+{
+    ++m_stStat.ullReuse;
+    m_pHttpMsg->Clear();
+    return(*m_pHttpMsg);
+}
+
+RedisMsg& InboundMsgCache::RedisMsgForDecode()
+{
+    ++m_stStat.ullReuse;
+    m_pRedisMsg->Clear();
+    return(*m_pRedisMsg);
+}
+
+uint64 InboundMsgCache::GetBytesHeld() const
+{
+    return((uint64)m_pMsgHead->SpaceUsed() + (uint64)m_pMsgBody->SpaceUsed()
+            + (uint64)m_pHttpMsg->SpaceUsed() + (uint64)m_pRedisMsg->SpaceUsed());
+}
+
+uint64 InboundMsgCache::Trim()
+{
+    uint64 ullBytesHeld = GetBytesHeld();
+    if (ullBytesHeld <= m_uiMaxBytesHeld)
+    {
+        return(ullBytesHeld);
+    }
+    m_pMsgBody.reset(new MsgBody());
+    m_pHttpMsg.reset(new HttpMsg());
+    m_pRedisMsg.reset(new RedisMsg());
+    ++m_stStat.ullTrim;
+    return(ullBytesHeld);
+}
+
+} /* namespace neb */
@@ -0,0 +1,84 @@
+/*******************************************************************************
+ * Project:  Nebula
+ * @file     InboundMsgCache.hpp
+ * @brief    入站消息对象复用
+ * @author   Bwar
+ * @date:    2026年10月17日
+ * @note     Dispatcher解码入站数据时不再为每个消息新建MsgHead/MsgBody、HttpMsg、
+ * RedisMsg，而是复用这里的对象：每次解码前Clear()，protobuf的Clear()保留字符串
+ * 容量和repeated字段中已分配的子消息（如RedisReply数组元素），下一个消息直接复用
+ * 这些内存。消息只在ActorBuilder::OnMessage()回调期间有效（回调参数本就是const
+ * 引用），需要在回调之后保留的须自行拷贝。
+ * 每个Dispatcher一个，只在Dispatcher所在线程使用。
+ * Modify history:
+ ******************************************************************************/
+#ifndef SRC_IOS_INBOUNDMSGCACHE_HPP_
+#define SRC_IOS_INBOUNDMSGCACHE_HPP_
+
+#include <memory>
+#include "Definition.hpp"
+#include "pb/msg.pb.h"
+#include "pb/http.pb.h"
+#include "pb/redis.pb.h"
+
+namespace neb
+{
+
+typedef RedisReply RedisMsg;
+
+class InboundMsgCache
+{
+public:
+    struct tagStat
+    {
+        uint64 ullReuse = 0;            ///< 复用对象解码的消息数量
+        uint64 ullTrim = 0;             ///< 因占用内存超限而释放重建的次数
+    };
+
+    explicit InboundMsgCache(uint32 uiMaxBytesHeld);
+    InboundMsgCache(const InboundMsgCache&) = delete;
+    InboundMsgCache& operator=(const InboundMsgCache&) = delete;
+    ~InboundMsgCache();
+
+    /**
+     * @brief 取已清空的消息对象用于解码
+     */
+    MsgHead& MsgHeadForDecode();
+    MsgBody& MsgBodyForDecode();
+    HttpMsg& HttpMsgForDecode();
+    RedisMsg& RedisMsgForDecode();
+
+    /**
+     * @brief 复用对象当前占用的内存（遍历消息计算，只在数据上报时调用）
+     */
+    uint64 GetBytesHeld() const;
+
+    /**
+     * @brief 占用内存超过上限时释放重建，避免一个超大消息之后长期占着内存
+     * @return 释放前占用的内存
+     */
+    uint64 Trim();
+
+    const tagStat& GetStat() const
+    {
+        return(m_stStat);
+    }
+
+    void ResetStat()
+    {
+        m_stStat.ullReuse = 0;
+        m_stStat.ullTrim = 0;
+    }
+
+private:
+    uint32 m_uiMaxBytesHeld;
+    std::unique_ptr<MsgHead> m_pMsgHead;
+    std::unique_ptr<MsgBody> m_pMsgBody;
+    std::unique_ptr<HttpMsg> m_pHttpMsg;
+    std::unique_ptr<RedisMsg> m_pRedisMsg;
+    tagStat m_stStat;
+};
+
+} /* namespace neb */
+
+#endif /* SRC_IOS_INBOUNDMSGCACHE_HPP_ */
@@ -10,6 +10,7 @@
  ******************************************************************************/
 #include "Nodes.hpp"
 #include <cstring>
+#include <algorithm>
 #define CRYPTOPP_ENABLE_NAMESPACE_WEAK 1
 #include "cryptopp/md5.h"
 #include "cryptopp/hex.h"
@@ -20,300 +21,191 @@
 namespace neb
 {
 
-Nodes::Nodes(int iHashAlgorithm, int iVirtualNodeNum)
-    : m_iHashAlgorithm(iHashAlgorithm), m_iVirtualNodeNum(iVirtualNodeNum)
+/**
+ * @brief 无分支二分查找（比较结果编译为条件传送，避免分支预测失败）
+ * @return 第一个不小于uiHash的位置，均小于uiHash时返回uiNum
+ */
+static inline uint32 RingLowerBound(const uint32* pRing, uint32 uiNum, uint32 uiHash)
+{
+    const uint32* pBase = pRing;
+    uint32 uiLen = uiNum;
+    while (uiLen > 1)
+    {
+        uint32 uiHalf = uiLen / 2;
+        pBase = (pBase[uiHalf] < uiHash) ? pBase + uiHalf : pBase;
+        uiLen -= uiHalf;
+    }
+    return((pBase - pRing) + (*pBase < uiHash));
+}
+
+Nodes::Nodes(int iHashAlgorithm, int iVirtualNodeNum, int iLocateMode)
+    : m_iHashAlgorithm(iHashAlgorithm), m_iVirtualNodeNum(iVirtualNodeNum),
+      m_iLocateMode(iLocateMode), m_pLastNode(nullptr)
 {
 }
 
 Nodes::~Nodes()
 {
+    m_pLastNode = nullptr;
     m_mapNode.clear();
     m_mapNodeType.clear();
 }
 
 bool Nodes::GetNode(const std::string& strNodeType, const std::string& strHashKey, std::string& strNodeIdentify)
 {
-    uint32 uiKeyHash = 0;
-    switch (m_iHashAlgorithm)
+    const std::string* pNodeIdentify = nullptr;
+    if (GetNode(strNodeType, HashKey(strHashKey.c_str(), strHashKey.size()), pNodeIdentify))
     {
-        case HASH_cityhash_32:
-            uiKeyHash = CityHash32(strHashKey.c_str(), strHashKey.size());
-            break;
-        case HASH_fnv1_64:
-            uiKeyHash = hash_fnv1_64(strHashKey.c_str(), strHashKey.size());
-            break;
-        case HASH_murmur3_32:
-            uiKeyHash = murmur3_32(strHashKey.c_str(), strHashKey.size(), 0x000001b3);
-            break;
-        default:
-            uiKeyHash = hash_fnv1a_64(strHashKey.c_str(), strHashKey.size());
+        strNodeIdentify = *pNodeIdentify;
+        return(true);
     }
+    return(false);
+}
 
-    auto node_type_iter = m_mapNode.find(strNodeType);
-    if (node_type_iter == m_mapNode.end())
-    {
-        return(false);
-    }
-    else
+bool Nodes::GetNode(const std::string& strNodeType, uint32 uiHash, std::string& strNodeIdentify)
+{
+    const std::string* pNodeIdentify = nullptr;
+    if (GetNode(strNodeType, uiHash, pNodeIdentify))
     {
-        if (node_type_iter->second->mapHash2Node.size() == 0)
-        {
-            if (node_type_iter->second->setFailedNode.size() > 0)
-            {
-                if (node_type_iter->second->itPollingFailed == node_type_iter->second->setFailedNode.end())
-                {
-                    node_type_iter->second->itPollingFailed = node_type_iter->second->setFailedNode.begin();
-                }
-                strNodeIdentify = *(node_type_iter->second->itPollingFailed);
-                node_type_iter->second->itPollingFailed++;
-                return(true);
-            }
-            return(false);
-        }
-        auto c_iter = node_type_iter->second->mapHash2Node.lower_bound(uiKeyHash);
-        if (c_iter == node_type_iter->second->mapHash2Node.end())
-        {
-            strNodeIdentify = node_type_iter->second->mapHash2Node.begin()->second;
-        }
-        else
-        {
-            strNodeIdentify = c_iter->second;
-            node_type_iter->second->itHashRing = c_iter;
-        }
+        strNodeIdentify = *pNodeIdentify;
         return(true);
     }
+    return(false);
 }
 
-bool Nodes::GetNode(const std::string& strNodeType, uint32 uiHash, std::string& strNodeIdentify)
+bool Nodes::GetNode(const std::string& strNodeType, const std::string& strHashKey, const std::string*& pNodeIdentify)
 {
-    auto node_type_iter = m_mapNode.find(strNodeType);
-    if (node_type_iter == m_mapNode.end())
+    return(GetNode(strNodeType, HashKey(strHashKey.c_str(), strHashKey.size()), pNodeIdentify));
+}
+
+bool Nodes::GetNode(const std::string& strNodeType, uint32 uiHash, const std::string*& pNodeIdentify)
+{
+    tagNode* pNode = FindNode(strNodeType);
+    if (nullptr == pNode)
     {
         return(false);
     }
-    else
+    if (pNode->vecRingHash.empty())
     {
-        if (node_type_iter->second->mapHash2Node.size() == 0)
-        {
-            if (node_type_iter->second->setFailedNode.size() > 0)
-            {
-                if (node_type_iter->second->itPollingFailed == node_type_iter->second->setFailedNode.end())
-                {
-                    node_type_iter->second->itPollingFailed = node_type_iter->second->setFailedNode.begin();
-                }
-                strNodeIdentify = *(node_type_iter->second->itPollingFailed);
-                node_type_iter->second->itPollingFailed++;
-                return(true);
-            }
-            return(false);
-        }
-        auto c_iter = node_type_iter->second->mapHash2Node.lower_bound(uiHash);
-        if (c_iter == node_type_iter->second->mapHash2Node.end())
-        {
-            strNodeIdentify = node_type_iter->second->mapHash2Node.begin()->second;
-        }
-        else
-        {
-            strNodeIdentify = c_iter->second;
-            node_type_iter->second->itHashRing = c_iter;
-        }
+        return(GetFailedNode(pNode, pNodeIdentify));
+    }
+    if (NODE_LOCATE_MAGLEV == m_iLocateMode)
+    {
+        pNodeIdentify = &m_dequeIdentify[pNode->vecMaglevNode[uiHash % sc_uiMaglevTableSize]];
         return(true);
     }
+    uint32 uiPos = RingLowerBound(&pNode->vecRingHash[0], pNode->vecRingHash.size(), uiHash);
+    if (uiPos == pNode->vecRingHash.size())
+    {
+        uiPos = 0;
+    }
+    else
+    {
+        pNode->uiHashRingPos = uiPos;
+    }
+    pNodeIdentify = &m_dequeIdentify[pNode->vecRingNode[uiPos]];
+    return(true);
 }
 
 bool Nodes::GetNodeInHashRing(const std::string& strNodeType, std::string& strNodeIdentify)
 {
-    auto node_type_iter = m_mapNode.find(strNodeType);
-    if (node_type_iter == m_mapNode.end())
+    tagNode* pNode = FindNode(strNodeType);
+    if (nullptr == pNode || pNode->vecRingHash.empty())
     {
         return(false);
     }
-    else
+    if (pNode->uiHashRingPos >= pNode->vecRingHash.size())
     {
-        if (node_type_iter->second->mapHash2Node.size() == 0)
-        {
-            return(false);
-        }
-        if (node_type_iter->second->itHashRing == node_type_iter->second->mapHash2Node.end())
-        {
-            node_type_iter->second->itHashRing = node_type_iter->second->mapHash2Node.begin();
-        }
-        strNodeIdentify = node_type_iter->second->itHashRing->first;
-        node_type_iter->second->itHashRing++;
-        return(true);
+        pNode->uiHashRingPos = 0;
     }
+    strNodeIdentify = m_dequeIdentify[pNode->vecRingNode[pNode->uiHashRingPos]];
+    pNode->uiHashRingPos++;
+    return(true);
 }
 
 bool Nodes::GetNode(const std::string& strNodeType, std::string& strNodeIdentify)
 {
-    auto node_type_iter = m_mapNode.find(strNodeType);
-    if (node_type_iter == m_mapNode.end())
+    tagNode* pNode = FindNode(strNodeType);
+    if (nullptr == pNode)
     {
         return(false);
     }
-    else
+    if (pNode->vecRingHash.empty())
     {
-        if (node_type_iter->second->mapHash2Node.size() == 0)
+        const std::string* pNodeIdentify = nullptr;
+        if (GetFailedNode(pNode, pNodeIdentify))
         {
-            if (node_type_iter->second->setFailedNode.size() > 0)
-            {
-                if (node_type_iter->second->itPollingFailed == node_type_iter->second->setFailedNode.end())
-                {
-                    node_type_iter->second->itPollingFailed = node_type_iter->second->setFailedNode.begin();
-                }
-                strNodeIdentify = *(node_type_iter->second->itPollingFailed);
-                node_type_iter->second->itPollingFailed++;
-                return(true);
-            }
-            return(false);
-        }
-        if (node_type_iter->second->itPollingNode == node_type_iter->second->mapNode2Hash.end())
-        {
-            node_type_iter->second->itPollingNode = node_type_iter->second->mapNode2Hash.begin();
+            strNodeIdentify = *pNodeIdentify;
+            return(true);
         }
-        strNodeIdentify = node_type_iter->second->itPollingNode->first;
-        node_type_iter->second->itPollingNode++;
-        return(true);
+        return(false);
+    }
+    if (pNode->itPollingNode == pNode->mapNode2Hash.end())
+    {
+        pNode->itPollingNode = pNode->mapNode2Hash.begin();
     }
+    strNodeIdentify = pNode->itPollingNode->first;
+    pNode->itPollingNode++;
+    return(true);
 }
 
 bool Nodes::GetNode(const std::string& strNodeType, std::unordered_set<std::string>& setNodeIdentify)
 {
-    auto node_type_iter = m_mapNode.find(strNodeType);
-    if (node_type_iter == m_mapNode.end())
+    tagNode* pNode = FindNode(strNodeType);
+    if (nullptr == pNode)
     {
         return(false);
     }
-    else
+    for (auto iter = pNode->mapNode2Hash.begin(); iter != pNode->mapNode2Hash.end(); ++iter)
     {
-        for (auto iter = node_type_iter->second->mapNode2Hash.begin(); iter != node_type_iter->second->mapNode2Hash.end(); ++iter)
-        {
-            setNodeIdentify.insert(iter->first);
-        }
-        return(true);
+        setNodeIdentify.insert(iter->first);
     }
+    return(true);
 }
 
 bool Nodes::NodeDetect(const std::string& strNodeType, std::string& strNodeIdentify)
 {
-    auto node_type_iter = m_mapNode.find(strNodeType);
-    if (node_type_iter == m_mapNode.end())
+    tagNode* pNode = FindNode(strNodeType);
+    if (nullptr == pNode)
     {
         return(false);
     }
-    else
+    if (pNode->bCheckFailedNode)
     {
-        if (node_type_iter->second->bCheckFailedNode)
+        pNode->bCheckFailedNode = false;
+        const std::string* pNodeIdentify = nullptr;
+        if (GetFailedNode(pNode, pNodeIdentify))
         {
-            node_type_iter->second->bCheckFailedNode = false;
-            if (node_type_iter->second->setFailedNode.size() > 0)
-            {
-                if (node_type_iter->second->itPollingFailed == node_type_iter->second->setFailedNode.end())
-                {
-                    node_type_iter->second->itPollingFailed = node_type_iter->second->setFailedNode.begin();
-                }
-                strNodeIdentify = *(node_type_iter->second->itPollingFailed);
-                node_type_iter->second->itPollingFailed++;
-                return(true);
-            }
+            strNodeIdentify = *pNodeIdentify;
+            return(true);
         }
-        return(false);
     }
+    return(false);
 }
 
 void Nodes::AddNode(const std::string& strNodeType, const std::string& strNodeIdentify)
 {
-    auto node_type_iter = m_mapNode.find(strNodeType);
-    if (node_type_iter == m_mapNode.end())
+    tagNode* pNode = MutableNode(strNodeType);
+    if (pNode->mapNode2Hash.find(strNodeIdentify) == pNode->mapNode2Hash.end())
     {
-        std::shared_ptr<tagNode> pNode = std::make_shared<tagNode>();
-        m_mapNode.insert(std::make_pair(strNodeType, pNode));
-        pNode->strNodeType = strNodeType;
-        std::string strHashKey;
         char szVirtualNodeIdentify[40] = {0};
-        uint32 uiKeyHash = 0;
         std::vector<uint32> vecHash;
+        vecHash.reserve(m_iVirtualNodeNum);
         for (int i = 0; i < m_iVirtualNodeNum; ++i)
         {
             snprintf(szVirtualNodeIdentify, 40, "%d@%s#%d", m_iVirtualNodeNum - i, strNodeIdentify.c_str(), i);
-            strHashKey = szVirtualNodeIdentify;
-            switch (m_iHashAlgorithm)
-            {
-                case HASH_cityhash_32:
-                    uiKeyHash = CityHash32(strHashKey.c_str(), strHashKey.size());
-                    break;
-                case HASH_fnv1_64:
-                    uiKeyHash = hash_fnv1_64(strHashKey.c_str(), strHashKey.size());
-                    break;
-                case HASH_murmur3_32:
-                    uiKeyHash = murmur3_32(strHashKey.c_str(), strHashKey.size(), 0x000001b3);
-                    break;
-                default:
-                    uiKeyHash = hash_fnv1a_64(strHashKey.c_str(), strHashKey.size());
-            }
-            vecHash.push_back(uiKeyHash);
-            pNode->mapHash2Node.insert(std::make_pair(uiKeyHash, strNodeIdentify));
-        }
-        pNode->mapNode2Hash.insert(std::make_pair(strNodeIdentify, std::move(vecHash)));
-        pNode->itPollingNode = pNode->mapNode2Hash.begin();
-        pNode->itHashRing = pNode->mapHash2Node.begin();
-    }
-    else
-    {
-        auto node_iter = node_type_iter->second->mapNode2Hash.find(strNodeIdentify);
-        if (node_iter == node_type_iter->second->mapNode2Hash.end())
-        {
-            std::string strHashKey;
-            char szVirtualNodeIdentify[40] = {0};
-            uint32 uiKeyHash = 0;
-            std::vector<uint32> vecHash;
-            for (int i = 0; i < m_iVirtualNodeNum; ++i)
-            {
-                snprintf(szVirtualNodeIdentify, 40, "%d@%s#%d", m_iVirtualNodeNum - i, strNodeIdentify.c_str(), i);
-                strHashKey = szVirtualNodeIdentify;
-                switch (m_iHashAlgorithm)
-                {
-                    case HASH_cityhash_32:
-                        uiKeyHash = CityHash32(strHashKey.c_str(), strHashKey.size());
-                        break;
-                    case HASH_fnv1_64:
-                        uiKeyHash = hash_fnv1_64(strHashKey.c_str(), strHashKey.size());
-                        break;
-                    case HASH_murmur3_32:
-                        uiKeyHash = murmur3_32(strHashKey.c_str(), strHashKey.size(), 0x000001b3);
-                        break;
-                    default:
-                        uiKeyHash = hash_fnv1a_64(strHashKey.c_str(), strHashKey.size());
-                }
-                vecHash.push_back(uiKeyHash);
-                node_type_iter->second->mapHash2Node.insert(std::make_pair(uiKeyHash, strNodeIdentify));
-            }
-            node_type_iter->second->mapNode2Hash.insert(std::make_pair(strNodeIdentify, std::move(vecHash)));
-            node_type_iter->second->itPollingNode = node_type_iter->second->mapNode2Hash.begin();
-            node_type_iter->second->itHashRing = node_type_iter->second->mapHash2Node.begin();
+            vecHash.push_back(HashKey(szVirtualNodeIdentify, strlen(szVirtualNodeIdentify)));
         }
+        AddNodeHash(pNode, strNodeIdentify, std::move(vecHash));
     }
-    auto node_id_iter = m_mapNodeType.find(strNodeIdentify);
-    if (node_id_iter == m_mapNodeType.end())
-    {
-        std::unordered_set<std::string> setNodeType;
-        setNodeType.insert(strNodeType);
-        m_mapNodeType.insert(std::make_pair(strNodeIdentify, std::move(setNodeType)));
-    }
-    else
-    {
-        node_id_iter->second.insert(strNodeType);
-    }
+    AddNodeType(strNodeType, strNodeIdentify);
 }
 
 void Nodes::AddNodeKetama(const std::string& strNodeType, const std::string& strNodeIdentify)
 {
-    auto node_type_iter = m_mapNode.find(strNodeType);
-    if (node_type_iter == m_mapNode.end())
+    tagNode* pNode = MutableNode(strNodeType);
+    if (pNode->mapNode2Hash.find(strNodeIdentify) == pNode->mapNode2Hash.end())
     {
-        std::shared_ptr<tagNode> pNode = std::make_shared<tagNode>();
-        m_mapNode.insert(std::make_pair(strNodeType, pNode));
-        pNode->strNodeType = strNodeType;
         std::string strHash;
         char szVirtualNodeIdentify[40] = {0};
         int32 iPointPerHash = 4;
@@ -322,7 +214,6 @@ void Nodes::AddNodeKetama(const std::string& strNodeType, const std::string& str
         {
             snprintf(szVirtualNodeIdentify, 40, "%d@%s#%d", m_iVirtualNodeNum - i, strNodeIdentify.c_str(), i);
             CryptoPP::Weak1::MD5 oMd5;
-            CryptoPP::HexEncoder oHexEncoder;
             oMd5.Update((const CryptoPP::byte*)szVirtualNodeIdentify, strlen(szVirtualNodeIdentify));
             strHash.resize(oMd5.DigestSize());
             oMd5.Final((CryptoPP::byte*)&strHash[0]);
@@ -333,56 +224,11 @@ void Nodes::AddNodeKetama(const std::string& strNodeType, const std::string& str
                        | ((uint32)(strHash[1 + j * iPointPerHash] & 0xFF) << 8)
                        | (strHash[j * iPointPerHash] & 0xFF);
                 vecHash.push_back(k);
-                pNode->mapHash2Node.insert(std::make_pair(k, strNodeIdentify));
             }
         }
-        pNode->mapNode2Hash.insert(std::make_pair(strNodeIdentify, std::move(vecHash)));
-        pNode->itPollingNode = pNode->mapNode2Hash.begin();
-        pNode->itHashRing = pNode->mapHash2Node.begin();
-    }
-    else
-    {
-        auto node_iter = node_type_iter->second->mapNode2Hash.find(strNodeIdentify);
-        if (node_iter == node_type_iter->second->mapNode2Hash.end())
-        {
-            std::string strHash;
-            char szVirtualNodeIdentify[40] = {0};
-            int32 iPointPerHash = 4;
-            std::vector<uint32> vecHash;
-            for (int i = 0; i < m_iVirtualNodeNum / iPointPerHash; ++i)     // distribution: ketama
-            {
-                snprintf(szVirtualNodeIdentify, 40, "%d@%s#%d", m_iVirtualNodeNum - i, strNodeIdentify.c_str(), i);
-                CryptoPP::Weak1::MD5 oMd5;
-                CryptoPP::HexEncoder oHexEncoder;
-                oMd5.Update((const CryptoPP::byte*)szVirtualNodeIdentify, strlen(szVirtualNodeIdentify));
-                strHash.resize(oMd5.DigestSize());
-                oMd5.Final((CryptoPP::byte*)&strHash[0]);
-                for (int j = 0; j < iPointPerHash; ++j)
-                {
-                    uint32 k = ((uint32)(strHash[3 + j * iPointPerHash] & 0xFF) << 24)
-                           | ((uint32)(strHash[2 + j * iPointPerHash] & 0xFF) << 16)
-                           | ((uint32)(strHash[1 + j * iPointPerHash] & 0xFF) << 8)
-                           | (strHash[j * iPointPerHash] & 0xFF);
-                    vecHash.push_back(k);
-                    node_type_iter->second->mapHash2Node.insert(std::make_pair(k, strNodeIdentify));
-                }
-            }
-            node_type_iter->second->mapNode2Hash.insert(std::make_pair(strNodeIdentify, std::move(vecHash)));
-            node_type_iter->second->itPollingNode = node_type_iter->second->mapNode2Hash.begin();
-            node_type_iter->second->itHashRing = node_type_iter->second->mapHash2Node.begin();
-        }
-    }
-    auto node_id_iter = m_mapNodeType.find(strNodeIdentify);
-    if (node_id_iter == m_mapNodeType.end())
-    {
-        std::unordered_set<std::string> setNodeType;
-        setNodeType.insert(strNodeType);
-        m_mapNodeType.insert(std::make_pair(strNodeIdentify, std::move(setNodeType)));
-    }
-    else
-    {
-        node_id_iter->second.insert(strNodeType);
+        AddNodeHash(pNode, strNodeIdentify, std::move(vecHash));
     }
+    AddNodeType(strNodeType, strNodeIdentify);
 }
 
 bool Nodes::SplitAddAndGetNode(const std::string& strNodeType, std::string& strNodeIdentify)
@@ -409,34 +255,30 @@ void Nodes::DelNode(const std::string& strNodeType, const std::string& strNodeId
     auto node_type_iter = m_mapNode.find(strNodeType);
     if (node_type_iter != m_mapNode.end())
     {
-        auto node_iter = node_type_iter->second->mapNode2Hash.find(strNodeIdentify);
-        if (node_iter != node_type_iter->second->mapNode2Hash.end())
+        tagNode* pNode = node_type_iter->second.get();
+        auto node_iter = pNode->mapNode2Hash.find(strNodeIdentify);
+        if (node_iter != pNode->mapNode2Hash.end())
         {
-            for (std::vector<uint32>::iterator hash_iter = node_iter->second.begin();
-                            hash_iter != node_iter->second.end(); ++hash_iter)
-            {
-                auto it = node_type_iter->second->mapHash2Node.find(*hash_iter);
-                if (it != node_type_iter->second->mapHash2Node.end())
-                {
-                    node_type_iter->second->mapHash2Node.erase(it);
-                }
-            }
-            node_type_iter->second->mapNode2Hash.erase(node_iter);
-            node_type_iter->second->itPollingNode = node_type_iter->second->mapNode2Hash.begin();
-            node_type_iter->second->itHashRing = node_type_iter->second->mapHash2Node.begin();
+            pNode->mapNode2Hash.erase(node_iter);
+            pNode->itPollingNode = pNode->mapNode2Hash.begin();
+            BuildRing(pNode);
         }
 
-        if (node_type_iter->second->setFailedNode.size() > 0)
+        if (pNode->setFailedNode.size() > 0)
         {
-            auto it = node_type_iter->second->setFailedNode.find(strNodeIdentify);
-            if (it != node_type_iter->second->setFailedNode.end())
+            auto it = pNode->setFailedNode.find(strNodeIdentify);
+            if (it != pNode->setFailedNode.end())
             {
-                node_type_iter->second->setFailedNode.erase(it);
+                pNode->setFailedNode.erase(it);
             }
         }
 
-        if (node_type_iter->second->mapNode2Hash.empty())
+        if (pNode->mapNode2Hash.empty())
         {
+            if (m_pLastNode == pNode)
+            {
+                m_pLastNode = nullptr;
+            }
             m_mapNode.erase(node_type_iter);
         }
     }
@@ -461,24 +303,16 @@ void Nodes::NodeFailed(const std::string& strNodeIdentify)
             auto node_type_iter = m_mapNode.find(*type_it);
             if (node_type_iter != m_mapNode.end())
             {
-                auto node_iter = node_type_iter->second->mapNode2Hash.find(strNodeIdentify);
-                if (node_iter != node_type_iter->second->mapNode2Hash.end())
+                tagNode* pNode = node_type_iter->second.get();
+                auto node_iter = pNode->mapNode2Hash.find(strNodeIdentify);
+                if (node_iter != pNode->mapNode2Hash.end())
                 {
-                    for (auto hash_iter = node_iter->second.begin();
-                            hash_iter != node_iter->second.end(); ++hash_iter)
-                    {
-                        auto it = node_type_iter->second->mapHash2Node.find(*hash_iter);
-                        if (it != node_type_iter->second->mapHash2Node.end())
-                        {
-                            node_type_iter->second->mapHash2Node.erase(it);
-                        }
-                    }
-                    node_type_iter->second->mapNode2Hash.erase(node_iter);
-                    node_type_iter->second->itPollingNode = node_type_iter->second->mapNode2Hash.begin();
-                    node_type_iter->second->itHashRing = node_type_iter->second->mapHash2Node.begin();
+                    pNode->mapNode2Hash.erase(node_iter);
+                    pNode->itPollingNode = pNode->mapNode2Hash.begin();
+                    BuildRing(pNode);
                 }
-                node_type_iter->second->setFailedNode.insert(strNodeIdentify);
-                node_type_iter->second->itPollingFailed = node_type_iter->second->setFailedNode.begin();
+                pNode->setFailedNode.insert(strNodeIdentify);
+                pNode->itPollingFailed = pNode->setFailedNode.begin();
             }
         }
     }
@@ -514,11 +348,10 @@ void Nodes::NodeRecover(const std::string& strNodeIdentify)
 
 bool Nodes::IsNodeType(const std::string& strNodeIdentify, const std::string& strNodeType)
 {
-    auto node_type_iter = m_mapNode.find(strNodeType);
-    if (node_type_iter != m_mapNode.end())
+    tagNode* pNode = FindNode(strNodeType);
+    if (nullptr != pNode)
     {
-        auto node_iter = node_type_iter->second->mapNode2Hash.find(strNodeIdentify);
-        if (node_iter != node_type_iter->second->mapNode2Hash.end())
+        if (pNode->mapNode2Hash.find(strNodeIdentify) != pNode->mapNode2Hash.end())
         {
             return(true);
         }
@@ -534,6 +367,187 @@ void Nodes::CheckFailedNode()
     }
 }
 
+Nodes::tagNode* Nodes::FindNode(const std::string& strNodeType)
+{
+    if (nullptr != m_pLastNode && m_pLastNode->strNodeType == strNodeType)
+    {
+        return(m_pLastNode);
+    }
+    auto node_type_iter = m_mapNode.find(strNodeType);
+    if (node_type_iter == m_mapNode.end())
+    {
+        return(nullptr);
+    }
+    m_pLastNode = node_type_iter->second.get();
+    return(m_pLastNode);
+}
+
+Nodes::tagNode* Nodes::MutableNode(const std::string& strNodeType)
+{
+    tagNode* pNode = FindNode(strNodeType);
+    if (nullptr == pNode)
+    {
+        std::shared_ptr<tagNode> pNewNode = std::make_shared<tagNode>();
+        pNewNode->strNodeType = strNodeType;
+        pNewNode->itPollingNode = pNewNode->mapNode2Hash.begin();
+        m_mapNode.insert(std::make_pair(strNodeType, pNewNode));
+        pNode = pNewNode.get();
+    }
+    return(pNode);
+}
+
+bool Nodes::GetFailedNode(tagNode* pNode, const std::string*& pNodeIdentify)
+{
+    if (pNode->setFailedNode.size() > 0)
+    {
+        if (pNode->itPollingFailed == pNode->setFailedNode.end())
+        {
+            pNode->itPollingFailed = pNode->setFailedNode.begin();
+        }
+        pNodeIdentify = &m_dequeIdentify[Intern(*(pNode->itPollingFailed))];
+        pNode->itPollingFailed++;
+        return(true);
+    }
+    return(false);
+}
+
+void Nodes::AddNodeHash(tagNode* pNode, const std::string& strNodeIdentify, std::vector<uint32>&& vecHash)
+{
+    Intern(strNodeIdentify);
+    pNode->mapNode2Hash.insert(std::make_pair(strNodeIdentify, std::move(vecHash)));
+    pNode->itPollingNode = pNode->mapNode2Hash.begin();
+    BuildRing(pNode);
+}
+
+void Nodes::AddNodeType(const std::string& strNodeType, const std::string& strNodeIdentify)
+{
+    auto node_id_iter = m_mapNodeType.find(strNodeIdentify);
+    if (node_id_iter == m_mapNodeType.end())
+    {
+        std::unordered_set<std::string> setNodeType;
+        setNodeType.insert(strNodeType);
+        m_mapNodeType.insert(std::make_pair(strNodeIdentify, std::move(setNodeType)));
+    }
+    else
+    {
+        node_id_iter->second.insert(strNodeType);
+    }
+}
+
+void Nodes::BuildRing(tagNode* pNode)
+{
+    // 节点增删不频繁，每次整体重建；hash值相同的虚拟节点保留节点标识较小者，各进程建出的环一致
+    std::vector<std::pair<uint32, uint32> > vecVirtualNode;
+    for (auto iter = pNode->mapNode2Hash.begin(); iter != pNode->mapNode2Hash.end(); ++iter)
+    {
+        uint32 uiIdentifyIndex = Intern(iter->first);
+        for (auto hash_iter = iter->second.begin(); hash_iter != iter->second.end(); ++hash_iter)
+        {
+            vecVirtualNode.push_back(std::make_pair(*hash_iter, uiIdentifyIndex));
+        }
+    }
+    std::sort(vecVirtualNode.begin(), vecVirtualNode.end(),
+            [this](const std::pair<uint32, uint32>& a, const std::pair<uint32, uint32>& b)
+            {
+                if (a.first != b.first)
+                {
+                    return(a.first < b.first);
+                }
+                return(m_dequeIdentify[a.second] < m_dequeIdentify[b.second]);
+            });
+    pNode->vecRingHash.clear();
+    pNode->vecRingNode.clear();
+    pNode->vecRingHash.reserve(vecVirtualNode.size());
+    pNode->vecRingNode.reserve(vecVirtualNode.size());
+    for (auto iter = vecVirtualNode.begin(); iter != vecVirtualNode.end(); ++iter)
+    {
+        if (!pNode->vecRingHash.empty() && pNode->vecRingHash.back() == iter->first)
+        {
+            continue;
+        }
+        pNode->vecRingHash.push_back(iter->first);
+        pNode->vecRingNode.push_back(iter->second);
+    }
+    pNode->uiHashRingPos = 0;
+    if (NODE_LOCATE_MAGLEV == m_iLocateMode)
+    {
+        BuildMaglevTable(pNode);
+    }
+}
+
+void Nodes::BuildMaglevTable(tagNode* pNode)
+{
+    pNode->vecMaglevNode.clear();
+    if (pNode->mapNode2Hash.empty())
+    {
+        return;
+    }
+    // 节点按标识排序后依次按各自的排列序列抢占查找表空位，各进程建出的表一致
+    std::vector<uint32> vecNode;
+    for (auto iter = pNode->mapNode2Hash.begin(); iter != pNode->mapNode2Hash.end(); ++iter)
+    {
+        vecNode.push_back(Intern(iter->first));
+    }
+    std::sort(vecNode.begin(), vecNode.end(),
+            [this](uint32 a, uint32 b){ return(m_dequeIdentify[a] < m_dequeIdentify[b]); });
+    std::vector<uint32> vecOffset(vecNode.size());
+    std::vector<uint32> vecSkip(vecNode.size());
+    std::vector<uint32> vecNext(vecNode.size(), 0);
+    for (size_t i = 0; i < vecNode.size(); ++i)
+    {
+        const std::string& strIdentify = m_dequeIdentify[vecNode[i]];
+        vecOffset[i] = murmur3_32(strIdentify.c_str(), strIdentify.size(), 0x000001b3) % sc_uiMaglevTableSize;
+        vecSkip[i] = murmur3_32(strIdentify.c_str(), strIdentify.size(), 0x5bd1e995) % (sc_uiMaglevTableSize - 1) + 1;
+    }
+    const uint32 uiEmpty = (uint32)-1;
+    std::vector<uint32> vecEntry(sc_uiMaglevTableSize, uiEmpty);
+    uint32 uiFilled = 0;
+    while (uiFilled < sc_uiMaglevTableSize)
+    {
+        for (size_t i = 0; i < vecNode.size() && uiFilled < sc_uiMaglevTableSize; ++i)
+        {
+            uint32 uiSlot = (vecOffset[i] + (uint64)vecNext[i] * vecSkip[i]) % sc_uiMaglevTableSize;
+            while (vecEntry[uiSlot] != uiEmpty)
+            {
+                vecNext[i]++;
+                uiSlot = (vecOffset[i] + (uint64)vecNext[i] * vecSkip[i]) % sc_uiMaglevTableSize;
+            }
+            vecEntry[uiSlot] = vecNode[i];
+            vecNext[i]++;
+            ++uiFilled;
+        }
+    }
+    pNode->vecMaglevNode.swap(vecEntry);
+}
+
+uint32 Nodes::Intern(const std::string& strNodeIdentify)
+{
+    auto iter = m_mapIdentifyIndex.find(strNodeIdentify);
+    if (iter != m_mapIdentifyIndex.end())
+    {
+        return(iter->second);
+    }
+    uint32 uiIndex = m_dequeIdentify.size();
+    m_dequeIdentify.push_back(strNodeIdentify);
+    m_mapIdentifyIndex.insert(std::make_pair(strNodeIdentify, uiIndex));
+    return(uiIndex);
+}
+
+uint32 Nodes::HashKey(const char* szKey, size_t uiKeyLen)
+{
+    switch (m_iHashAlgorithm)
+    {
+        case HASH_cityhash_32:
+            return(CityHash32(szKey, uiKeyLen));
+        case HASH_fnv1_64:
+            return(hash_fnv1_64(szKey, uiKeyLen));
+        case HASH_murmur3_32:
+            return(murmur3_32(szKey, uiKeyLen, 0x000001b3));
+        default:
+            return(hash_fnv1a_64(szKey, uiKeyLen));
+    }
+}
+
 uint32 Nodes::hash_fnv1_64(const char *key, size_t key_length)
 {
     uint64_t hash = FNV_64_INIT;
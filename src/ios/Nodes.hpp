@@ -12,8 +12,9 @@
 #define SRC_IOS_NODES_HPP_
 
 #include <memory>
+#include <string>
 #include <vector>
-#include <map>
+#include <deque>
 #include <unordered_map>
 #include <unordered_set>
 #include "Definition.hpp"
@@ -34,6 +35,17 @@ enum E_HASH_ALGORITHM
     HASH_cityhash_32        = 3,
 };
 
+/**
+ * @brief 按hash值定位节点的算法
+ * @note 哈希环以虚拟节点分布key；Maglev以固定大小的查找表O(1)定位，节点增删时
+ * 只有少量key改变归属，且key在各节点间的分布更均匀。
+ */
+enum E_NODE_LOCATE
+{
+    NODE_LOCATE_HASH_RING   = 0,
+    NODE_LOCATE_MAGLEV      = 1,
+};
+
 /**
  * @brief 节点管理
  */
@@ -44,8 +56,9 @@ public:
      * @note 节点管理Session构造函数
      * @param iHashAlgorithm hash算法
      * @param iVirtualNodeNum 每个实体节点对应的虚拟节点数量
+     * @param iLocateMode 按hash值定位节点的算法，见E_NODE_LOCATE
      */
-    Nodes(int iHashAlgorithm = HASH_murmur3_32, int iVirtualNodeNum = 200);
+    Nodes(int iHashAlgorithm = HASH_murmur3_32, int iVirtualNodeNum = 200, int iLocateMode = NODE_LOCATE_HASH_RING);
     virtual ~Nodes();
 
     /* 实体节点hash信息
@@ -59,8 +72,10 @@ public:
         std::string strNodeType;
         T_NODE2HASH_MAP mapNode2Hash;
         T_NODE2HASH_MAP::iterator itPollingNode;
-        std::map<uint32, std::string> mapHash2Node;
-        std::map<uint32, std::string>::const_iterator itHashRing;
+        std::vector<uint32> vecRingHash;            ///< 哈希环，虚拟节点hash值升序排列
+        std::vector<uint32> vecRingNode;            ///< 与vecRingHash一一对应的节点（节点标识驻留序号）
+        std::vector<uint32> vecMaglevNode;          ///< Maglev查找表（节点标识驻留序号），仅NODE_LOCATE_MAGLEV模式
+        uint32 uiHashRingPos = 0;
         std::unordered_set<std::string> setFailedNode;
         std::unordered_set<std::string>::const_iterator itPollingFailed;
 
@@ -83,6 +98,14 @@ public:
 
     bool GetNode(const std::string& strNodeType, uint32 uiHash, std::string& strNodeIdentify);
 
+    /**
+     * @brief 获取节点信息，不复制节点标识
+     * @param[out] pNodeIdentify 驻留的节点标识，在Nodes生命周期内始终有效
+     */
+    bool GetNode(const std::string& strNodeType, const std::string& strHashKey, const std::string*& pNodeIdentify);
+
+    bool GetNode(const std::string& strNodeType, uint32 uiHash, const std::string*& pNodeIdentify);
+
     bool GetNodeInHashRing(const std::string& strNodeType, std::string& strNodeIdentify);
 
     bool GetNode(const std::string& strNodeType, std::string& strNodeIdentify);
@@ -137,16 +160,33 @@ public:
     void CheckFailedNode();
 
 protected:
+    uint32 HashKey(const char* szKey, size_t uiKeyLen);
     uint32 hash_fnv1_64(const char *key, size_t key_length);
     uint32 hash_fnv1a_64(const char *key, size_t key_length);
     uint32_t murmur3_32(const char *key, uint32_t len, uint32_t seed);
 
 private:
+    tagNode* FindNode(const std::string& strNodeType);
+    tagNode* MutableNode(const std::string& strNodeType);
+    bool GetFailedNode(tagNode* pNode, const std::string*& pNodeIdentify);
+    void AddNodeHash(tagNode* pNode, const std::string& strNodeIdentify, std::vector<uint32>&& vecHash);
+    void AddNodeType(const std::string& strNodeType, const std::string& strNodeIdentify);
+    void BuildRing(tagNode* pNode);
+    void BuildMaglevTable(tagNode* pNode);
+    uint32 Intern(const std::string& strNodeIdentify);
+
+private:
+    static const uint32 sc_uiMaglevTableSize = 65537;      ///< Maglev查找表大小（素数，应远大于节点数量）
+
     const int m_iHashAlgorithm;
     const int m_iVirtualNodeNum;
+    const int m_iLocateMode;
+    tagNode* m_pLastNode;                                   ///< 最近一次查找的节点类型，连续发往同一类节点时免去按节点类型查找
 
     std::unordered_map<std::string, std::shared_ptr<tagNode> > m_mapNode;
     std::unordered_map<std::string, std::unordered_set<std::string>> m_mapNodeType;  // key为节点标识
+    std::deque<std::string> m_dequeIdentify;                ///< 驻留的节点标识（只增不减，元素地址不变）
+    std::unordered_map<std::string, uint32> m_mapIdentifyIndex;     ///< 节点标识到m_dequeIdentify下标
 };
 
 } /* namespace neb */
@@ -0,0 +1,222 @@
+/*******************************************************************************
+ * Project:  Nebula
+ * @file     TimingWheel.cpp
+ * @brief    分层时间轮
+ * @author   Bwar
+ * @date:    2026年10月17日
+ * @note
+ * Modify history:
+ ******************************************************************************/
+
+#include <cmath>
+#include "TimingWheel.hpp"
+
+namespace neb
+{
+
+TimingWheel::TimingWheel(ev_tstamp dTick, ev_tstamp dNow)
+    : m_dTick(dTick), m_dStartTime(dNow), m_ullCurrentTick(0), m_uiSize(0)
+{
+    if (m_dTick <= 0.0)
+    {
+        m_dTick = 0.01;
+    }
+    for (uint32 i = 0; i < sc_uiRootSize; ++i)
+    {
+        ListInit(&m_aRoot[i]);
+    }
+    for (uint32 i = 0; i < sc_uiLevelNum - 1; ++i)
+    {
+        for (uint32 j = 0; j < sc_uiLevelSize; ++j)
+        {
+            ListInit(&m_aLevel[i][j]);
+        }
+    }
+}
+
+TimingWheel::~TimingWheel()
+{
+    // 时间轮先于Actor销毁时（如进程退出），把所有节点摘下，避免节点析构时访问已销毁的时间轮
+    auto detach = [](tagWheelTimer* pHead)
+    {
+        tagWheelTimer* pTimer = pHead->pNext;
+        while (pTimer != pHead)
+        {
+            tagWheelTimer* pNext = pTimer->pNext;
+            pTimer->pPrev = nullptr;
+            pTimer->pNext = nullptr;
+            pTimer->pWheel = nullptr;
+            pTimer = pNext;
+        }
+        ListInit(pHead);
+    };
+    for (uint32 i = 0; i < sc_uiRootSize; ++i)
+    {
+        detach(&m_aRoot[i]);
+    }
+    for (uint32 i = 0; i < sc_uiLevelNum - 1; ++i)
+    {
+        for (uint32 j = 0; j < sc_uiLevelSize; ++j)
+        {
+            detach(&m_aLevel[i][j]);
+        }
+    }
+    m_uiSize = 0;
+}
+
+void TimingWheel::Add(tagWheelTimer* pTimer, ev_tstamp dExpireAt)
+{
+    if (pTimer->IsActive())
+    {
+        Del(pTimer);
+    }
+    ev_tstamp dTicks = std::ceil((dExpireAt - m_dStartTime) / m_dTick);
+    uint64 ullExpireTick = (dTicks > 0.0) ? (uint64)dTicks : 0;
+    if (ullExpireTick <= m_ullCurrentTick)
+    {
+        ullExpireTick = m_ullCurrentTick + 1;     // 不能落在正在处理的槽里
+    }
+    pTimer->ullExpireTick = ullExpireTick;
+    pTimer->pWheel = this;
+    Link(pTimer);
+    ++m_uiSize;
+}
+
+void TimingWheel::Del(tagWheelTimer* pTimer)
+{
+    if (pTimer->pWheel != this)
+    {
+        return;
+    }
+    ListUnlink(pTimer);
+    pTimer->pWheel = nullptr;
+    --m_uiSize;
+}
+
+void TimingWheel::Advance(ev_tstamp dNow)
+{
+    if (dNow <= m_dStartTime)
+    {
+        return;
+    }
+    uint64 ullTargetTick = (uint64)((dNow - m_dStartTime) / m_dTick);
+    tagWheelTimer oExpired;
+    ListInit(&oExpired);
+    while (m_ullCurrentTick < ullTargetTick)
+    {
+        if (0 == m_uiSize)  // 空轮直接跳到目标tick
+        {
+            m_ullCurrentTick = ullTargetTick;
+            break;
+        }
+        ++m_ullCurrentTick;
+        uint32 uiIndex = m_ullCurrentTick & (sc_uiRootSize - 1);
+        if (0 == uiIndex)
+        {
+            for (uint32 uiLevel = 0; uiLevel < sc_uiLevelNum - 1; ++uiLevel)
+            {
+                uint32 uiLevelIndex = (m_ullCurrentTick >> (sc_uiRootBits + uiLevel * sc_uiLevelBits)) & (sc_uiLevelSize - 1);
+                Cascade(uiLevel, uiLevelIndex);
+                if (0 != uiLevelIndex)
+                {
+                    break;
+                }
+            }
+        }
+        ListSplice(&m_aRoot[uiIndex], &oExpired);
+        while (oExpired.pNext != &oExpired)
+        {
+            tagWheelTimer* pTimer = oExpired.pNext;
+            ListUnlink(pTimer);
+            pTimer->pWheel = nullptr;
+            --m_uiSize;
+            if (nullptr != pTimer->cb)
+            {
+                pTimer->cb(pTimer);     // 回调后pTimer可能已被释放，不能再访问
+            }
+        }
+    }
+}
+
+void TimingWheel::Link(tagWheelTimer* pTimer)
+{
+    uint64 ullExpireTick = (pTimer->ullExpireTick > m_ullCurrentTick)
+            ? pTimer->ullExpireTick : m_ullCurrentTick;
+    uint64 ullDelta = ullExpireTick - m_ullCurrentTick;
+    if (ullDelta < sc_uiRootSize)
+    {
+        ListPushBack(&m_aRoot[ullExpireTick & (sc_uiRootSize - 1)], pTimer);
+        return;
+    }
+    if (ullDelta > sc_ullMaxSpan)  // 超出时间轮跨度的先挂在最高层，级联时重新计算位置
+    {
+        ullExpireTick = m_ullCurrentTick + sc_ullMaxSpan;
+        ullDelta = sc_ullMaxSpan;
+    }
+    for (uint32 uiLevel = 0; uiLevel < sc_uiLevelNum - 1; ++uiLevel)
+    {
+        uint32 uiShift = sc_uiRootBits + uiLevel * sc_uiLevelBits;
+        if (ullDelta < ((uint64)1 << (uiShift + sc_uiLevelBits)) || uiLevel == sc_uiLevelNum - 2)
+        {
+            ListPushBack(Slot(uiLevel, (ullExpireTick >> uiShift) & (sc_uiLevelSize - 1)), pTimer);
+            return;
+        }
+    }
+}
+
+void TimingWheel::Cascade(uint32 uiLevel, uint32 uiIndex)
+{
+    tagWheelTimer oCascade;
+    ListInit(&oCascade);
+    ListSplice(Slot(uiLevel, uiIndex), &oCascade);
+    while (oCascade.pNext != &oCascade)
+    {
+        tagWheelTimer* pTimer = oCascade.pNext;
+        ListUnlink(pTimer);
+        Link(pTimer);
+    }
+}
+
+tagWheelTimer* TimingWheel::Slot(uint32 uiLevel, uint32 uiIndex)
+{
+    return(&m_aLevel[uiLevel][uiIndex]);
+}
+
+void TimingWheel::ListInit(tagWheelTimer* pHead)
+{
+    pHead->pPrev = pHead;
+    pHead->pNext = pHead;
+}
+
+void TimingWheel::ListPushBack(tagWheelTimer* pHead, tagWheelTimer* pTimer)
+{
+    pTimer->pPrev = pHead->pPrev;
+    pTimer->pNext = pHead;
+    pHead->pPrev->pNext = pTimer;
+    pHead->pPrev = pTimer;
+}
+
+void TimingWheel::ListUnlink(tagWheelTimer* pTimer)
+{
+    pTimer->pPrev->pNext = pTimer->pNext;
+    pTimer->pNext->pPrev = pTimer->pPrev;
+    pTimer->pPrev = nullptr;
+    pTimer->pNext = nullptr;
+}
+
+void TimingWheel::ListSplice(tagWheelTimer* pFrom, tagWheelTimer* pTo)
+{
+    if (pFrom->pNext == pFrom)
+    {
+        return;
+    }
+    tagWheelTimer* pFirst = pFrom->pNext;
+    tagWheelTimer* pLast = pFrom->pPrev;
+    pFirst->pPrev = pTo->pPrev;
+    pTo->pPrev->pNext = pFirst;
+    pLast->pNext = pTo;
+    pTo->pPrev = pLast;
+    ListInit(pFrom);
+}
+
+} /* namespace neb */
@@ -0,0 +1,125 @@
+/*******************************************************************************
+ * Project:  Nebula
+ * @file     TimingWheel.hpp
+ * @brief    分层时间轮
+ * @author   Bwar
+ * @date:    2026年10月17日
+ * @note     Step、Session、Chain等Actor的超时定时器统一挂在所属Dispatcher的
+ * 时间轮上，由Dispatcher的一个libev定时器按tick驱动。定时器节点侵入式地嵌入
+ * Actor中，添加、刷新、删除均为O(1)。
+ * Modify history:
+ ******************************************************************************/
+#ifndef SRC_IOS_TIMINGWHEEL_HPP_
+#define SRC_IOS_TIMINGWHEEL_HPP_
+
+#include "Definition.hpp"
+
+namespace neb
+{
+
+class TimingWheel;
+struct tagWheelTimer;
+
+typedef void (*wheel_timer_callback)(tagWheelTimer*);
+
+/**
+ * @brief 时间轮定时器节点
+ * @note 节点由使用者持有（一般作为Actor的成员），时间轮只做链接，不负责分配和回收。
+ */
+struct tagWheelTimer
+{
+    tagWheelTimer* pPrev            = nullptr;
+    tagWheelTimer* pNext            = nullptr;
+    TimingWheel* pWheel             = nullptr;      ///< 非空表示节点已挂在时间轮上
+    uint64 ullExpireTick            = 0;            ///< 到期tick
+    wheel_timer_callback cb         = nullptr;
+    void* data                      = nullptr;      ///< 与ev_timer的data用法一致
+
+    tagWheelTimer(){}
+    tagWheelTimer(const tagWheelTimer&) = delete;
+    tagWheelTimer& operator=(const tagWheelTimer&) = delete;
+    ~tagWheelTimer();
+
+    bool IsActive() const
+    {
+        return(nullptr != pWheel);
+    }
+};
+
+class TimingWheel
+{
+public:
+    /**
+     * @param dTick 时间轮精度（单位：秒）
+     * @param dNow 当前时间，作为tick的计数起点
+     */
+    TimingWheel(ev_tstamp dTick, ev_tstamp dNow);
+    TimingWheel(const TimingWheel&) = delete;
+    TimingWheel& operator=(const TimingWheel&) = delete;
+    virtual ~TimingWheel();
+
+    /**
+     * @brief 添加定时器，若定时器已在时间轮上则重新设置到期时间
+     * @param pTimer 定时器节点
+     * @param dExpireAt 到期的绝对时间，定时器不会早于此时间触发
+     */
+    void Add(tagWheelTimer* pTimer, ev_tstamp dExpireAt);
+
+    /**
+     * @brief 从时间轮上摘除定时器
+     */
+    void Del(tagWheelTimer* pTimer);
+
+    /**
+     * @brief 推进时间轮到dNow，回调所有已到期的定时器
+     * @note 回调中可以安全地添加、删除任意定时器（包括当前回调的定时器）。
+     */
+    void Advance(ev_tstamp dNow);
+
+    size_t Size() const
+    {
+        return(m_uiSize);
+    }
+
+    ev_tstamp GetTick() const
+    {
+        return(m_dTick);
+    }
+
+private:
+    static const uint32 sc_uiLevelNum = 4;
+    static const uint32 sc_uiRootBits = 8;
+    static const uint32 sc_uiLevelBits = 6;
+    static const uint32 sc_uiRootSize = 1 << sc_uiRootBits;
+    static const uint32 sc_uiLevelSize = 1 << sc_uiLevelBits;
+    static const uint64 sc_ullMaxSpan = ((uint64)1 << (sc_uiRootBits + (sc_uiLevelNum - 1) * sc_uiLevelBits)) - 1;
+
+    void Link(tagWheelTimer* pTimer);
+    void Cascade(uint32 uiLevel, uint32 uiIndex);
+    tagWheelTimer* Slot(uint32 uiLevel, uint32 uiIndex);
+
+    static void ListInit(tagWheelTimer* pHead);
+    static void ListPushBack(tagWheelTimer* pHead, tagWheelTimer* pTimer);
+    static void ListUnlink(tagWheelTimer* pTimer);
+    static void ListSplice(tagWheelTimer* pFrom, tagWheelTimer* pTo);
+
+private:
+    ev_tstamp m_dTick;
+    ev_tstamp m_dStartTime;
+    uint64 m_ullCurrentTick;
+    size_t m_uiSize;
+    tagWheelTimer m_aRoot[sc_uiRootSize];                           ///< 第0层，每槽一个tick
+    tagWheelTimer m_aLevel[sc_uiLevelNum - 1][sc_uiLevelSize];      ///< 第1~3层
+};
+
+inline tagWheelTimer::~tagWheelTimer()
+{
+    if (nullptr != pWheel)
+    {
+        pWheel->Del(this);
+    }
+}
+
+} /* namespace neb */
+
+#endif /* SRC_IOS_TIMINGWHEEL_HPP_ */
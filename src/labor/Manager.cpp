@@ -56,6 +56,7 @@ Manager::Manager(const std::string& strConfFile)
     }
     m_stManagerInfo.iWorkerBeat = (gc_iBeatInterval * 2) + 1;
     CreateEvents();
+    CreateReusePortListenFd();
     if (m_stNodeInfo.bThreadMode)
     {
         CreateWorkerThread();   // Loader可能需要用到Worker线程ID，故先创建Worker
@@ -136,6 +137,9 @@ bool Manager::InitLogger(const CJsonObject& oJsonConf)
         int32 iMaxLogFileNum = 0;
         int32 iMaxLogLineLen = 1024;
         bool bAlwaysFlushLog = true;
+        bool bAsyncLog = false;
+        uint32 uiAsyncLogRingSize = 4194304;
+        std::string strAsyncLogOverflow = "drop";
         std::string strLoggingHost;
         std::string strLogPath;
         std::string strLogname;
@@ -163,8 +167,15 @@ bool Manager::InitLogger(const CJsonObject& oJsonConf)
         oJsonConf.Get("log_max_line_len", iMaxLogLineLen);
         oJsonConf.Get("log_level", iLogLevel);
         oJsonConf.Get("always_flush_log", bAlwaysFlushLog);
+        oJsonConf.Get("async_log", bAsyncLog);
+        oJsonConf.Get("async_log_ring_size", uiAsyncLogRingSize);
+        oJsonConf.Get("async_log_overflow", strAsyncLogOverflow);
         m_pLogger = std::make_shared<NetLogger>(strLogname, iLogLevel, iMaxLogFileSize, iMaxLogFileNum, iMaxLogLineLen, bAlwaysFlushLog, this);
         m_pLogger->SetNetLogLevel(iNetLogLevel);
+        if (bAsyncLog && !m_pLogger->EnableAsync(uiAsyncLogRingSize, (strAsyncLogOverflow == "block")))
+        {
+            LOG4_WARNING("failed to enable async log, fall back to sync log.");
+        }
         LOG4_NOTICE("%s program begin, and work path %s...", oJsonConf("server_name").c_str(), m_stNodeInfo.strWorkPath.c_str());
         return(true);
     }
@@ -219,9 +230,10 @@ void Manager::StartService()
                  m_stNodeInfo.iPortForServer, m_stManagerInfo.iS2SListenFd,
                  m_stManagerInfo.iS2SFamily);
 
-        if (m_stNodeInfo.strHostForClient.size() > 0 && m_stNodeInfo.iPortForClient > 0)
+        if (m_stNodeInfo.strHostForClient.size() > 0 && m_stNodeInfo.iPortForClient > 0
+                && m_stManagerInfo.vecC2SReusePortFd.empty())
         {
-            // 接入节点才需要监听客户端连接
+            // 接入节点才需要监听客户端连接（reuseport模式下由Worker监听）
             m_pDispatcher->CreateListenFd(strBindIp,
                   m_stNodeInfo.iPortForClient, m_stManagerInfo.iC2SListenFd,
                   m_stManagerInfo.iC2SFamily);
@@ -233,9 +245,10 @@ void Manager::StartService()
               m_stNodeInfo.iPortForServer, m_stManagerInfo.iS2SListenFd,
               m_stManagerInfo.iS2SFamily);
 
-        if (m_stNodeInfo.strHostForClient.size() > 0 && m_stNodeInfo.iPortForClient > 0)
+        if (m_stNodeInfo.strHostForClient.size() > 0 && m_stNodeInfo.iPortForClient > 0
+                && m_stManagerInfo.vecC2SReusePortFd.empty())
         {
-            // 接入节点才需要监听客户端连接
+            // 接入节点才需要监听客户端连接（reuseport模式下由Worker监听）
             m_pDispatcher->CreateListenFd(m_stNodeInfo.strHostForClient,
                     m_stNodeInfo.iPortForClient, m_stManagerInfo.iC2SListenFd,
                     m_stManagerInfo.iC2SFamily);
@@ -333,6 +346,27 @@ bool Manager::GetConf()
         {
             std::string strSocketType = "TCP";
             m_stNodeInfo.uiWorkerNum = strtoul(m_oCurrentConf("worker_num").c_str(), NULL, 10);
+            m_oCurrentConf.Get("timing_wheel_tick", m_stNodeInfo.dTimingWheelTick);
+            m_oCurrentConf.Get("channel_pool_size", m_stNodeInfo.uiChannelPoolSize);
+            m_oCurrentConf.Get("http_max_header_size", m_stNodeInfo.uiHttpMaxHeaderSize);
+            m_oCurrentConf.Get("http_max_body_size", m_stNodeInfo.uiHttpMaxBodySize);
+            m_oCurrentConf.Get("thread_mailbox_size", m_stNodeInfo.uiThreadMailboxSize);
+            m_oCurrentConf.Get("inbound_msg_cache_size", m_stNodeInfo.uiInboundMsgCacheSize);
+            m_oCurrentConf["write_coalescing"].Get("enable", m_stNodeInfo.bWriteCoalescing);
+            m_oCurrentConf["write_coalescing"].Get("flush_bytes", m_stNodeInfo.uiWriteCoalescingBytes);
+            m_oCurrentConf["http_client_pool"].Get("max_total", m_stNodeInfo.uiHttpPoolMaxTotal);
+            m_oCurrentConf["http_client_pool"].Get("max_idle", m_stNodeInfo.uiHttpPoolMaxIdle);
+            m_oCurrentConf["http_client_pool"].Get("max_waiting", m_stNodeInfo.uiHttpPoolMaxWaiting);
+            m_oCurrentConf["http_client_pool"].Get("idle_timeout", m_stNodeInfo.dHttpPoolIdleTimeout);
+            m_oCurrentConf["dns"].Get("thread_num", m_stNodeInfo.uiDnsThreadNum);
+            m_oCurrentConf["dns"].Get("min_ttl", m_stNodeInfo.dDnsMinTtl);
+            m_oCurrentConf["dns"].Get("max_ttl", m_stNodeInfo.dDnsMaxTtl);
+            m_oCurrentConf["dns"].Get("negative_ttl", m_stNodeInfo.dDnsNegativeTtl);
+            m_oCurrentConf["dns"].Get("connect_attempt_timeout", m_stNodeInfo.dConnectAttemptTimeout);
+            if (m_oCurrentConf("node_locate") == "maglev")
+            {
+                m_stNodeInfo.iNodeLocate = NODE_LOCATE_MAGLEV;
+            }
             m_oCurrentConf.Get("node_type", m_stNodeInfo.strNodeType);
             m_oCurrentConf.Get("host", m_stNodeInfo.strHostForServer);
             m_oCurrentConf.Get("port", m_stNodeInfo.iPortForServer);
@@ -349,6 +383,30 @@ bool Manager::GetConf()
             {
                 m_stNodeInfo.iForClientSocketType = SOCK_STREAM;
             }
+            m_oCurrentConf.Get("accept_batch", m_stNodeInfo.uiAcceptBatch);
+            m_oCurrentConf.Get("reuseport", m_stNodeInfo.bReusePort);
+            m_oCurrentConf.Get("reuseport_cpu_steering", m_stNodeInfo.bReusePortCpuSteering);
+            m_oCurrentConf.Get("cpu_affinity", m_stNodeInfo.bCpuAffinity);
+            if (m_oCurrentConf("worker_placement") == "least_conn")
+            {
+                m_stNodeInfo.iWorkerPlacement = WORKER_PLACEMENT_LEAST_CONN;
+            }
+            else if (m_oCurrentConf("worker_placement") == "power_of_two")
+            {
+                m_stNodeInfo.iWorkerPlacement = WORKER_PLACEMENT_POWER_OF_TWO;
+            }
+            else if (m_oCurrentConf("worker_placement") == "cpu_weighted")
+            {
+                m_stNodeInfo.iWorkerPlacement = WORKER_PLACEMENT_CPU_WEIGHTED;
+            }
+            else
+            {
+                m_stNodeInfo.iWorkerPlacement = WORKER_PLACEMENT_ROUND_ROBIN;
+            }
+            if (m_stNodeInfo.iForClientSocketType != SOCK_STREAM)
+            {
+                m_stNodeInfo.bReusePort = false;    // 只有TCP连接需要accept
+            }
             m_stNodeInfo.strNodeIdentify = m_stNodeInfo.strHostForServer + std::string(":") + std::to_string(m_stNodeInfo.iPortForServer);
         }
         int32 iCodec;
@@ -358,6 +416,7 @@ bool Manager::GetConf()
         }
         m_oCurrentConf["permission"]["addr_permit"].Get("stat_interval", m_stNodeInfo.dAddrStatInterval);
         m_oCurrentConf["permission"]["addr_permit"].Get("permit_num", m_stNodeInfo.iAddrPermitNum);
+        m_oCurrentConf["permission"]["addr_permit"].Get("max_memory", m_stNodeInfo.uiAddrPermitMemory);
     }
     return(true);
 }
@@ -427,6 +486,69 @@ bool Manager::CreateEvents()
     return(true);
 }
 
+void Manager::CreateReusePortListenFd()
+{
+    if (!m_stNodeInfo.bReusePort || m_stNodeInfo.strHostForClient.size() == 0 || m_stNodeInfo.iPortForClient <= 0)
+    {
+        return;
+    }
+    bool bDirectToLoader = false;
+    m_oCurrentConf.Get("new_client_to_loader", bDirectToLoader);
+    if (bDirectToLoader)
+    {
+        LOG4_WARNING("reuseport is ignored because new_client_to_loader is set.");
+        m_stNodeInfo.bReusePort = false;
+        return;
+    }
+    std::string strBindIp;
+    if (!m_oCurrentConf.Get("bind_ip", strBindIp) || strBindIp.length() == 0)
+    {
+        strBindIp = m_stNodeInfo.strHostForClient;
+    }
+    for (uint32 i = 0; i < m_stNodeInfo.uiWorkerNum; ++i)
+    {
+        int iFd = -1;
+        if (!m_pDispatcher->CreateListenFd(strBindIp, m_stNodeInfo.iPortForClient,
+                iFd, m_stManagerInfo.iC2SFamily, true))
+        {
+            LOG4_ERROR("failed to create reuseport listen fd for worker %u, "
+                    "fall back to accept by manager.", i + 1);
+            for (auto iCreatedFd : m_stManagerInfo.vecC2SReusePortFd)
+            {
+                close(iCreatedFd);
+            }
+            m_stManagerInfo.vecC2SReusePortFd.clear();
+            m_stNodeInfo.bReusePort = false;
+            return;
+        }
+        x_sock_set_block(iFd, 0);
+        m_stManagerInfo.vecC2SReusePortFd.push_back(iFd);
+    }
+    if (m_stNodeInfo.bReusePortCpuSteering)
+    {
+        m_pDispatcher->AttachReusePortCpuSteering(m_stManagerInfo.vecC2SReusePortFd[0],
+                m_stManagerInfo.vecC2SReusePortFd.size());
+    }
+    LOG4_NOTICE("%u workers accept on %s:%d with SO_REUSEPORT.", m_stNodeInfo.uiWorkerNum,
+            strBindIp.c_str(), m_stNodeInfo.iPortForClient);
+}
+
+void Manager::CloseListenFdInChild(int iWorkerIndex)
+{
+    close(m_stManagerInfo.iS2SListenFd);
+    if (m_stManagerInfo.iC2SListenFd > 2)
+    {
+        close(m_stManagerInfo.iC2SListenFd);
+    }
+    for (size_t i = 0; i < m_stManagerInfo.vecC2SReusePortFd.size(); ++i)
+    {
+        if ((int)i + 1 != iWorkerIndex)
+        {
+            close(m_stManagerInfo.vecC2SReusePortFd[i]);
+        }
+    }
+}
+
 void Manager::CreateLoader()
 {
     bool bWithLoader = false;
@@ -450,11 +572,7 @@ void Manager::CreateLoader()
     int iPid = fork();
     if (iPid == 0)   // 子进程
     {
-        close(m_stManagerInfo.iS2SListenFd);
-        if (m_stManagerInfo.iC2SListenFd > 2)
-        {
-            close(m_stManagerInfo.iC2SListenFd);
-        }
+        CloseListenFdInChild(0);
         close(iControlFds[0]);
         close(iDataFds[0]);
         x_sock_set_block(iControlFds[1], 0);
@@ -524,6 +642,7 @@ void Manager::CreateLoaderThread()
         return;
     }
     m_pLoaderActorBuilder = pWorker->GetActorBuilder();
+    pWorker->SetManagerMailbox(m_pDispatcher->GetMailbox(), iControlFds[0], iDataFds[0]);
     std::thread t(&Worker::Run, pWorker);
     t.detach();
     m_stNodeInfo.uiLoaderNum = 1;
@@ -532,6 +651,8 @@ void Manager::CreateLoaderThread()
     std::shared_ptr<SocketChannel> pChannelControl = m_pDispatcher->CreateSocketChannel(iDataFds[0], CODEC_NEBULA_IN_NODE);
     m_pDispatcher->SetChannelStatus(pChannelData, CHANNEL_STATUS_ESTABLISHED);
     m_pDispatcher->SetChannelStatus(pChannelControl, CHANNEL_STATUS_ESTABLISHED);
+    m_pDispatcher->SetThreadPeer(pChannelData, pWorker->GetDispatcher()->GetMailbox(), iControlFds[1]);
+    m_pDispatcher->SetThreadPeer(pChannelControl, pWorker->GetDispatcher()->GetMailbox(), iDataFds[1]);
     m_pDispatcher->AddIoReadEvent(pChannelData);
     m_pDispatcher->AddIoReadEvent(pChannelControl);
     m_pSessionManager->SetLoaderActorBuilder(m_pLoaderActorBuilder);
@@ -560,16 +681,16 @@ void Manager::CreateWorker()
         iPid = fork();
         if (iPid == 0)   // 子进程
         {
-            close(m_stManagerInfo.iS2SListenFd);
-            if (m_stManagerInfo.iC2SListenFd > 2)
-            {
-                close(m_stManagerInfo.iC2SListenFd);
-            }
+            CloseListenFdInChild(i);
             close(iControlFds[0]);
             close(iDataFds[0]);
             x_sock_set_block(iControlFds[1], 0);
             x_sock_set_block(iDataFds[1], 0);
             Worker oWorker(m_stNodeInfo.strWorkPath, iControlFds[1], iDataFds[1], i);
+            if (i <= m_stManagerInfo.vecC2SReusePortFd.size())
+            {
+                oWorker.SetClientListenFd(m_stManagerInfo.vecC2SReusePortFd[i - 1], m_stManagerInfo.iC2SFamily);
+            }
             if (!oWorker.Init(m_oCurrentConf))
             {
                 exit(3);
@@ -625,11 +746,16 @@ void Manager::CreateWorkerThread()
         {
             continue;
         }
+        if (i <= m_stManagerInfo.vecC2SReusePortFd.size())
+        {
+            pWorker->SetClientListenFd(m_stManagerInfo.vecC2SReusePortFd[i - 1], m_stManagerInfo.iC2SFamily);
+        }
         if (!pWorker->Init(m_oCurrentConf))
         {
             continue;
         }
         pWorker->SetLoaderActorBuilder(m_pLoaderActorBuilder);
+        pWorker->SetManagerMailbox(m_pDispatcher->GetMailbox(), iControlFds[0], iDataFds[0]);
         std::thread t(&Worker::Run, pWorker);
         t.detach();
         m_pSessionManager->AddWorkerInfo(i, getpid(), iControlFds[0], iDataFds[0]);
@@ -637,6 +763,8 @@ void Manager::CreateWorkerThread()
         std::shared_ptr<SocketChannel> pChannelControl = m_pDispatcher->CreateSocketChannel(iDataFds[0], CODEC_NEBULA_IN_NODE);
         m_pDispatcher->SetChannelStatus(pChannelData, CHANNEL_STATUS_ESTABLISHED);
         m_pDispatcher->SetChannelStatus(pChannelControl, CHANNEL_STATUS_ESTABLISHED);
+        m_pDispatcher->SetThreadPeer(pChannelData, pWorker->GetDispatcher()->GetMailbox(), iControlFds[1]);
+        m_pDispatcher->SetThreadPeer(pChannelControl, pWorker->GetDispatcher()->GetMailbox(), iDataFds[1]);
         m_pDispatcher->AddIoReadEvent(pChannelData);
         m_pDispatcher->AddIoReadEvent(pChannelControl);
         m_pSessionManager->SendOnlineNodesToWorker();  // optional
@@ -666,11 +794,7 @@ bool Manager::RestartWorker(int iDeathPid)
         iNewPid = fork();
         if (iNewPid == 0)   // 子进程
         {
-            close(m_stManagerInfo.iS2SListenFd);
-            if (m_stManagerInfo.iC2SListenFd > 2)
-            {
-                close(m_stManagerInfo.iC2SListenFd);
-            }
+            CloseListenFdInChild((Labor::LABOR_LOADER == eLaborType) ? 0 : iWorkerIndex);
             close(iControlFds[0]);
             close(iDataFds[0]);
             x_sock_set_block(iControlFds[1], 0);
@@ -687,6 +811,10 @@ bool Manager::RestartWorker(int iDeathPid)
             else
             {
                 Worker oWorker(m_stNodeInfo.strWorkPath, iControlFds[1], iDataFds[1], iWorkerIndex);
+                if (iWorkerIndex > 0 && (uint32)iWorkerIndex <= m_stManagerInfo.vecC2SReusePortFd.size())
+                {
+                    oWorker.SetClientListenFd(m_stManagerInfo.vecC2SReusePortFd[iWorkerIndex - 1], m_stManagerInfo.iC2SFamily);
+                }
                 if (!oWorker.Init(m_oCurrentConf))
                 {
                     exit(-1);
@@ -18,6 +18,7 @@
 #include <unordered_map>
 #include <unordered_set>
 #include <list>
+#include <vector>
 #include <thread>
 
 #include "util/json/CJsonObject.hpp"
@@ -52,6 +53,7 @@ public:
         int iS2SFamily      = 0;   ///<
         int iC2SListenFd    = -1;  ///< Client to Server监听文件描述符（Client与Server之间的连接较多，但每个Client只需连接某个Server的某个Worker）
         int iC2SFamily      = 0;   ///<
+        std::vector<int> vecC2SReusePortFd;    ///< reuseport模式下每个Worker一个的Client to Server监听文件描述符，下标为Worker序号-1
     };
 
 public:
@@ -64,6 +66,7 @@ public:
 
     template <typename ...Targs>
         void Logger(int iLogLevel, const char* szFileName, unsigned int uiFileLine, const char* szFunction, Targs&&... args);
+    bool IsLogEnabled(int iLogLevel) const;
 
 public:
     virtual uint32 GetSequence() const
@@ -112,6 +115,19 @@ protected:
     void StartService();
     void Destroy();
 
+    /**
+     * @brief reuseport模式下为每个Worker创建一个SO_REUSEPORT的对Client监听socket
+     * @note 须在创建Worker之前调用：Worker进程继承（线程共享）各自的监听socket，
+     * 监听socket按Worker序号顺序加入reuseport组，组内序号与Worker序号对应。
+     */
+    void CreateReusePortListenFd();
+
+    /**
+     * @brief 子进程关闭从Manager继承的监听文件描述符
+     * @param iWorkerIndex 子进程Worker序号，reuseport模式下保留该Worker的监听socket（Loader传0）
+     */
+    void CloseListenFdInChild(int iWorkerIndex);
+
     bool CreateEvents();
     void CreateLoader();
     void CreateLoaderThread();
@@ -139,6 +155,11 @@ private:
     std::shared_ptr<Step> m_pReportStep = nullptr;
 };
 
+inline bool Manager::IsLogEnabled(int iLogLevel) const
+{
+    return(m_pLogger->IsLevelEnabled(iLogLevel));
+}
+
 template <typename ...Targs>
 void Manager::Logger(int iLogLevel, const char* szFileName, unsigned int uiFileLine, const char* szFunction, Targs&&... args)
 {
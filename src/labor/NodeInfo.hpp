@@ -26,7 +26,21 @@ struct NodeInfo
     uint32 uiNodeId                 = 0;            ///< 节点ID（由beacon分配）
     uint32 uiWorkerNum              = 0;            ///< Worker子进程数量
     uint32 uiLoaderNum              = 0;            ///< Loader子进程数量，有效值为0或1
-    int32 iAddrPermitNum            = 0;            ///< IP地址统计时间内允许连接次数
+    uint32 uiAcceptBatch            = 64;           ///< 监听socket每次可读时最多accept的连接数量
+    int32 iNodeLocate               = 0;            ///< 按hash值定位节点的算法（见ios/Nodes.hpp中E_NODE_LOCATE）
+    int32 iWorkerPlacement          = 0;            ///< 新连接在Worker间的分派策略（见SessionManager.hpp中E_WORKER_PLACEMENT）
+    uint32 uiChannelPoolSize        = 1024;         ///< SocketChannel对象池最多缓存的空闲对象数量，0为不使用对象池
+    uint32 uiHttpMaxHeaderSize      = 65536;        ///< 解码http包时包头长度上限，0为不限制
+    uint32 uiHttpMaxBodySize        = 67108864;     ///< 解码http包时包体长度上限，0为不限制
+    uint32 uiThreadMailboxSize      = 4096;         ///< 线程模型下每个Labor线程信箱（进程内消息队列）的容量
+    uint32 uiInboundMsgCacheSize    = 1048576;      ///< 解码入站消息复用的消息对象最多保留的内存（字节），超出时在数据上报时释放
+    uint32 uiWriteCoalescingBytes   = 65536;        ///< 合并写模式下连接发送队列积压达到此字节数时立即发送
+    uint32 uiHttpPoolMaxTotal       = 0;            ///< 每个上游（host:port）的HTTP客户端连接数上限，0为不限制
+    uint32 uiHttpPoolMaxIdle        = 0;            ///< 每个上游保留的空闲HTTP/1.x连接数上限，0为不限制
+    uint32 uiHttpPoolMaxWaiting     = 1024;         ///< 连接数达到上限时每个上游排队等待连接的请求数上限
+    uint32 uiDnsThreadNum           = 2;            ///< 每个Labor的域名解析线程数量（首次解析域名时创建）
+    uint32 uiAddrPermitMemory       = 16777216;     ///< 连接频率限制的IP地址表最多占用的内存（字节），地址数超出容量时替换最久未连接的地址
+    int32 iAddrPermitNum            = 0;            ///< IP地址统计时间内允许连接次数，0为不限制
     int32 iMsgPermitNum             = 0;            ///< 客户端统计时间内允许发送消息数量
     int32 iPortForServer            = 0;            ///< Server间通信监听端口，对应 iS2SListenFd
     int32 iPortForClient            = 0;            ///< 对Client通信监听端口，对应 iC2SListenFd
@@ -35,12 +49,22 @@ struct NodeInfo
     bool bThreadMode                = 0;            ///< 是否线程模型
     bool bIsAccess                  = false;        ///< 是否接入Server
     bool bChannelVerify             = false;        ///< 是否需要连接验证
+    bool bReusePort                 = false;        ///< 是否由各Worker通过SO_REUSEPORT监听对Client通信端口并直接accept
+    bool bReusePortCpuSteering      = false;        ///< reuseport模式下是否按接收连接的CPU把连接分派给绑定在该CPU上的Worker
+    bool bCpuAffinity               = false;        ///< 是否把序号为i的Worker绑定在CPU i % CPU数量上
+    bool bWriteCoalescing           = false;        ///< 是否合并写：一轮事件循环内发往同一连接的消息在循环进入等待前一次发送
     ev_tstamp dConnectionProtection = 0.0;          ///< >0时为连接保护时间，新建连接会设置成这个时间，接收到第一个数据包之后改设成dIoTimeout
     ev_tstamp dIoTimeout            = 60.0;          ///< IO（连接）超时配置
     ev_tstamp dDataReportInterval   = 60.0;         ///< 统计数据上报时间间隔
     ev_tstamp dMsgStatInterval      = 60.0;          ///< 客户端连接发送数据包统计时间间隔
     ev_tstamp dAddrStatInterval     = 60.0;          ///< IP地址数据统计时间间隔
     ev_tstamp dStepTimeout          = 1.5;          ///< 步骤超时
+    ev_tstamp dTimingWheelTick      = 0.01;         ///< 时间轮精度（Step、Session、Chain超时）
+    ev_tstamp dDnsMinTtl            = 1.0;          ///< 域名解析结果缓存时间下限
+    ev_tstamp dDnsMaxTtl            = 300.0;        ///< 域名解析结果缓存时间上限（/etc/hosts中的地址按此缓存）
+    ev_tstamp dDnsNegativeTtl       = 5.0;          ///< 域名解析失败结果的缓存时间
+    ev_tstamp dHttpPoolIdleTimeout  = 0.0;          ///< 空闲HTTP/1.x客户端连接的回收时间，0为按连接的keep alive时间
+    ev_tstamp dConnectAttemptTimeout = 0.3;         ///< 域名有多个地址时，每个地址的连接超时，超时后改连下一个地址
     std::string strWorkPath;                        ///< 工作路径
     std::string strConfFile;                        ///< 配置文件
     std::string strNodeType;                        ///< 节点类型
@@ -59,6 +83,8 @@ struct WorkerInfo
     int iWorkerIndex        = 0;                    ///< 工作进程序号
     int iControlFd          = -1;                   ///< 与Manager进程通信的文件描述符（控制流）
     int iDataFd             = -1;                   ///< 与Manager进程通信的文件描述符（数据流）
+    int iC2SListenFd        = -1;                   ///< reuseport模式下Worker自己accept的Client to Server监听文件描述符
+    int iC2SFamily          = 0;
     uint32 uiLoad             = 0;                    ///< 负载
     uint32 uiConnect          = 0;                    ///< 连接数量
     uint32 uiRecvNum          = 0;                    ///< 接收数据包数量
@@ -66,6 +92,9 @@ struct WorkerInfo
     uint32 uiSendNum          = 0;                    ///< 发送数据包数量
     uint32 uiSendByte         = 0;                    ///< 发送字节数
     uint32 uiClientNum        = 0;                    ///< 客户端数量
+    uint32 uiPlaced           = 0;                    ///< Manager累计分派给该Worker的连接数量
+    uint32 uiPlacedAcked      = 0;                    ///< 最近一次心跳时Worker累计收到的分派连接数量（已计入uiConnect）
+    uint32 uiCpuShare         = 1;                    ///< 与该Worker绑定在同一CPU上的Worker数量（含自身）
     ev_tstamp dBeatTime     = 0.0;                  ///< 心跳时间
     bool bStartBeatCheck    = 0.0;                  ///< 是否需要心跳检查，worker或loader进程启动时可能需要加载数据而处于繁忙状态无法响应Manager的心跳，需等待其就绪之后才开始心跳检查。
 
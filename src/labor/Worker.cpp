@@ -8,6 +8,7 @@
  * Modify history:
  ******************************************************************************/
 #include <algorithm>
+#include <utility>
 #include <sched.h>
 #ifdef __cplusplus
 extern "C" {
@@ -125,6 +126,65 @@ bool Worker::CheckParent()
     pRecord->set_key("send_byte");
     pRecord->set_item("nebula");
     pRecord->add_value(m_stWorkerInfo.uiSendByte);
+    CBufferPool* pBufferPool = CBufferPool::Instance();
+    if (nullptr != pBufferPool)
+    {
+        pRecord = oReport.add_records();
+        pRecord->set_key("buffer_pool_hit");
+        pRecord->set_item("nebula");
+        pRecord->add_value(pBufferPool->GetStat().ullHit);
+        pRecord = oReport.add_records();
+        pRecord->set_key("buffer_pool_miss");
+        pRecord->set_item("nebula");
+        pRecord->add_value(pBufferPool->GetStat().ullMiss);
+        pRecord = oReport.add_records();
+        pRecord->set_key("buffer_pool_bytes_held");
+        pRecord->set_item("nebula");
+        pRecord->add_value(pBufferPool->GetStat().ullBytesHeld);
+        pRecord->set_value_type(ReportRecord::VALUE_FIXED);
+        pBufferPool->ResetHitMiss();
+    }
+    SocketChannelPool* pChannelPool = m_pDispatcher->GetSocketChannelPool();
+    if (nullptr != pChannelPool)
+    {
+        pRecord = oReport.add_records();
+        pRecord->set_key("channel_pool_reuse");
+        pRecord->set_item("nebula");
+        pRecord->add_value(pChannelPool->GetStat().ullReuse);
+        pRecord = oReport.add_records();
+        pRecord->set_key("channel_pool_new");
+        pRecord->set_item("nebula");
+        pRecord->add_value(pChannelPool->GetStat().ullNew);
+        pRecord = oReport.add_records();
+        pRecord->set_key("channel_pool_recycle");
+        pRecord->set_item("nebula");
+        pRecord->add_value(pChannelPool->GetStat().ullRecycle);
+        pRecord = oReport.add_records();
+        pRecord->set_key("channel_pool_idle");
+        pRecord->set_item("nebula");
+        pRecord->add_value(pChannelPool->GetIdleNum());
+        pRecord->set_value_type(ReportRecord::VALUE_FIXED);
+        pChannelPool->ResetStat();
+    }
+    InboundMsgCache* pInboundMsgCache = m_pDispatcher->GetInboundMsgCache();
+    if (nullptr != pInboundMsgCache)
+    {
+        uint64 ullBytesHeld = pInboundMsgCache->Trim();
+        pRecord = oReport.add_records();
+        pRecord->set_key("inbound_msg_reuse");
+        pRecord->set_item("nebula");
+        pRecord->add_value(pInboundMsgCache->GetStat().ullReuse);
+        pRecord = oReport.add_records();
+        pRecord->set_key("inbound_msg_trim");
+        pRecord->set_item("nebula");
+        pRecord->add_value(pInboundMsgCache->GetStat().ullTrim);
+        pRecord = oReport.add_records();
+        pRecord->set_key("inbound_msg_bytes_held");
+        pRecord->set_item("nebula");
+        pRecord->add_value(ullBytesHeld);
+        pRecord->set_value_type(ReportRecord::VALUE_FIXED);
+        pInboundMsgCache->ResetStat();
+    }
     oJsonLoad.Add("load", int32(m_stWorkerInfo.uiConnect + m_pActorBuilder->GetStepNum()));
     oJsonLoad.Add("connect", m_stWorkerInfo.uiConnect);
     oJsonLoad.Add("recv_num", m_stWorkerInfo.uiRecvNum);
@@ -132,9 +192,10 @@ bool Worker::CheckParent()
     oJsonLoad.Add("send_num", m_stWorkerInfo.uiSendNum);
     oJsonLoad.Add("send_byte", m_stWorkerInfo.uiSendByte);
     oJsonLoad.Add("client", m_stWorkerInfo.uiClientNum);
+    oJsonLoad.Add("transferred", m_pDispatcher->GetTransferredNum());
     oMsgBody.set_data(oJsonLoad.ToString());
     LOG4_TRACE("%s", oJsonLoad.ToString().c_str());
-    m_pDispatcher->SendTo(m_pManagerControlChannel, CMD_REQ_UPDATE_WORKER_LOAD, GetSequence(), oMsgBody);
+    m_pDispatcher->SendTo(m_pManagerControlChannel, CMD_REQ_UPDATE_WORKER_LOAD, GetSequence(), std::move(oMsgBody));
     std::string strReport;
     oReport.SerializeToString(&strReport);
     oMsgBody.set_data(strReport);
@@ -160,6 +221,27 @@ bool Worker::Init(CJsonObject& oJsonConf)
     {
         m_stNodeInfo.dStepTimeout = 0.5;
     }
+    oJsonConf.Get("timing_wheel_tick", m_stNodeInfo.dTimingWheelTick);
+    oJsonConf.Get("channel_pool_size", m_stNodeInfo.uiChannelPoolSize);
+    oJsonConf.Get("http_max_header_size", m_stNodeInfo.uiHttpMaxHeaderSize);
+    oJsonConf.Get("http_max_body_size", m_stNodeInfo.uiHttpMaxBodySize);
+    oJsonConf.Get("thread_mailbox_size", m_stNodeInfo.uiThreadMailboxSize);
+    oJsonConf.Get("inbound_msg_cache_size", m_stNodeInfo.uiInboundMsgCacheSize);
+    oJsonConf["write_coalescing"].Get("enable", m_stNodeInfo.bWriteCoalescing);
+    oJsonConf["write_coalescing"].Get("flush_bytes", m_stNodeInfo.uiWriteCoalescingBytes);
+    oJsonConf["http_client_pool"].Get("max_total", m_stNodeInfo.uiHttpPoolMaxTotal);
+    oJsonConf["http_client_pool"].Get("max_idle", m_stNodeInfo.uiHttpPoolMaxIdle);
+    oJsonConf["http_client_pool"].Get("max_waiting", m_stNodeInfo.uiHttpPoolMaxWaiting);
+    oJsonConf["http_client_pool"].Get("idle_timeout", m_stNodeInfo.dHttpPoolIdleTimeout);
+    oJsonConf["dns"].Get("thread_num", m_stNodeInfo.uiDnsThreadNum);
+    oJsonConf["dns"].Get("min_ttl", m_stNodeInfo.dDnsMinTtl);
+    oJsonConf["dns"].Get("max_ttl", m_stNodeInfo.dDnsMaxTtl);
+    oJsonConf["dns"].Get("negative_ttl", m_stNodeInfo.dDnsNegativeTtl);
+    oJsonConf["dns"].Get("connect_attempt_timeout", m_stNodeInfo.dConnectAttemptTimeout);
+    if (oJsonConf("node_locate") == "maglev")
+    {
+        m_stNodeInfo.iNodeLocate = NODE_LOCATE_MAGLEV;
+    }
     m_stNodeInfo.uiWorkerNum = strtoul(oJsonConf("worker_num").c_str(), NULL, 10);
     oJsonConf.Get("data_report", m_stNodeInfo.dDataReportInterval);
     oJsonConf.Get("node_type", m_stNodeInfo.strNodeType);
@@ -181,6 +263,19 @@ bool Worker::Init(CJsonObject& oJsonConf)
         m_stNodeInfo.bIsAccess = true;
         oJsonConf["permission"]["uin_permit"].Get("stat_interval", m_stNodeInfo.dMsgStatInterval);
         oJsonConf["permission"]["uin_permit"].Get("permit_num", m_stNodeInfo.iMsgPermitNum);
+        if (m_stWorkerInfo.iC2SListenFd >= 0)   // reuseport模式，Worker直接accept客户端连接
+        {
+            int32 iCodec = 0;
+            if (oJsonConf.Get("access_codec", iCodec))
+            {
+                m_stNodeInfo.eCodec = E_CODEC_TYPE(iCodec);
+            }
+            m_stNodeInfo.bReusePort = true;
+            oJsonConf.Get("accept_batch", m_stNodeInfo.uiAcceptBatch);
+            oJsonConf["permission"]["addr_permit"].Get("stat_interval", m_stNodeInfo.dAddrStatInterval);
+            oJsonConf["permission"]["addr_permit"].Get("permit_num", m_stNodeInfo.iAddrPermitNum);
+            oJsonConf["permission"]["addr_permit"].Get("max_memory", m_stNodeInfo.uiAddrPermitMemory);
+        }
     }
     if (!InitLogger(oJsonConf, szProcessName))
     {
@@ -224,6 +319,22 @@ bool Worker::Init(CJsonObject& oJsonConf)
             LOG4_FATAL("SslServerCertificate() failed!");
             return(false);
         }
+        tagSslSessionConf stSessionConf;
+        oJsonConf["with_ssl"].Get("session_cache_size", stSessionConf.uiServerCacheSize);
+        oJsonConf["with_ssl"].Get("session_timeout", stSessionConf.uiSessionTimeout);
+        oJsonConf["with_ssl"].Get("session_ticket_rotate", stSessionConf.uiTicketRotate);
+        oJsonConf["with_ssl"].Get("client_session_cache_size", stSessionConf.uiClientCacheSize);
+        oJsonConf["with_ssl"].Get("ktls", stSessionConf.bKtls);
+        if (oJsonConf["with_ssl"]("session_ticket_key_file").length() > 0)
+        {
+            stSessionConf.strTicketSecretFile = m_stNodeInfo.strWorkPath + "/" + oJsonConf["with_ssl"]("config_path")
+                + "/" + oJsonConf["with_ssl"]("session_ticket_key_file");
+        }
+        if (ERR_OK != SocketChannelSslImpl::SslSessionCreate(m_pLogger, stSessionConf))
+        {
+            LOG4_FATAL("SslSessionCreate() failed!");
+            return(false);
+        }
 #endif
     }
 
@@ -277,6 +388,9 @@ bool Worker::InitLogger(const CJsonObject& oJsonConf, const std::string& strLogN
         int32 iLogLevel = 0;
         int32 iNetLogLevel = 0;
         bool bAlwaysFlushLog = true;
+        bool bAsyncLog = false;
+        uint32 uiAsyncLogRingSize = 4194304;
+        std::string strAsyncLogOverflow = "drop";
         std::string strLogname;
         std::string strLogPath;
         if (oJsonConf.Get("log_path", strLogPath))
@@ -302,8 +416,15 @@ bool Worker::InitLogger(const CJsonObject& oJsonConf, const std::string& strLogN
         oJsonConf.Get("net_log_level", iNetLogLevel);
         oJsonConf.Get("log_level", iLogLevel);
         oJsonConf.Get("always_flush_log", bAlwaysFlushLog);
+        oJsonConf.Get("async_log", bAsyncLog);
+        oJsonConf.Get("async_log_ring_size", uiAsyncLogRingSize);
+        oJsonConf.Get("async_log_overflow", strAsyncLogOverflow);
         m_pLogger = std::make_shared<neb::NetLogger>(strLogname, iLogLevel, iMaxLogFileSize, iMaxLogFileNum, iMaxLogLineLen, bAlwaysFlushLog, this);
         m_pLogger->SetNetLogLevel(iNetLogLevel);
+        if (bAsyncLog && !m_pLogger->EnableAsync(uiAsyncLogRingSize, (strAsyncLogOverflow == "block")))
+        {
+            LOG4_WARNING("failed to enable async log, fall back to sync log.");
+        }
         LOG4_NOTICE("%s program begin...", getproctitle());
         return(true);
     }
@@ -374,6 +495,11 @@ bool Worker::CreateEvents()
     m_pDispatcher->SetChannelStatus(m_pManagerDataChannel, CHANNEL_STATUS_ESTABLISHED);
     m_pManagerControlChannel = m_pDispatcher->CreateSocketChannel(m_stWorkerInfo.iControlFd, CODEC_NEBULA_IN_NODE);
     m_pDispatcher->SetChannelStatus(m_pManagerControlChannel, CHANNEL_STATUS_ESTABLISHED);
+    if (nullptr != m_pManagerMailbox)
+    {
+        m_pDispatcher->SetThreadPeer(m_pManagerControlChannel, m_pManagerMailbox, m_iManagerControlFd);
+        m_pDispatcher->SetThreadPeer(m_pManagerDataChannel, m_pManagerMailbox, m_iManagerDataFd);
+    }
     m_pDispatcher->AddIoReadEvent(m_pManagerDataChannel);
     m_pDispatcher->AddIoReadEvent(m_pManagerControlChannel);
     return(true);
@@ -381,9 +507,17 @@ bool Worker::CreateEvents()
 
 void Worker::StartService()
 {
+    if (m_stWorkerInfo.iC2SListenFd >= 0)
+    {
+        LOG4_TRACE("C2SListenFd[%d]", m_stWorkerInfo.iC2SListenFd);
+        std::shared_ptr<SocketChannel> pChannelListen = m_pDispatcher->CreateSocketChannel(
+                m_stWorkerInfo.iC2SListenFd, m_stNodeInfo.eCodec);
+        m_pDispatcher->SetChannelStatus(pChannelListen, CHANNEL_STATUS_ESTABLISHED);
+        m_pDispatcher->AddIoReadEvent(pChannelListen);
+    }
     MsgBody oMsgBody;
     oMsgBody.set_data(std::to_string(m_stWorkerInfo.iWorkerIndex));
-    m_pDispatcher->SendTo(m_pManagerControlChannel, CMD_REQ_START_SERVICE, GetSequence(), oMsgBody);
+    m_pDispatcher->SendTo(m_pManagerControlChannel, CMD_REQ_START_SERVICE, GetSequence(), std::move(oMsgBody));
 }
 
 void Worker::Destroy()
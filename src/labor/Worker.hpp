@@ -30,6 +30,7 @@ extern "C" {
 #include "util/CBuffer.hpp"
 #include "labor/Labor.hpp"
 #include "channel/SocketChannel.hpp"
+#include "channel/ThreadMailbox.hpp"
 #include "codec/Codec.hpp"
 #include "logger/NetLogger.hpp"
 #include "NodeInfo.hpp"
@@ -97,6 +98,25 @@ public:     // about worker
     virtual const CJsonObject& GetCustomConf() const;
     bool WithSsl();
     const WorkerInfo& GetWorkerInfo() const;
+
+    /**
+     * @brief reuseport模式下设置Worker直接accept的监听socket，须在Init()之前调用
+     */
+    void SetClientListenFd(int iFd, int iFamily)
+    {
+        m_stWorkerInfo.iC2SListenFd = iFd;
+        m_stWorkerInfo.iC2SFamily = iFamily;
+    }
+
+    /**
+     * @brief 线程模型下设置Manager线程的信箱及Manager一端的控制、数据通道fd，须在Run()之前调用
+     */
+    void SetManagerMailbox(std::shared_ptr<ThreadMailbox> pMailbox, int iManagerControlFd, int iManagerDataFd)
+    {
+        m_pManagerMailbox = pMailbox;
+        m_iManagerControlFd = iManagerControlFd;
+        m_iManagerDataFd = iManagerDataFd;
+    }
     std::shared_ptr<SocketChannel> GetManagerControlChannel();
     bool SetCustomConf(const CJsonObject& oJsonConf);
     virtual void IoStatAddRecvNum(int iFd)
@@ -154,6 +174,7 @@ public:     // about worker
 
     template <typename ...Targs>
         void Logger(int iLogLevel, const char* szFileName, unsigned int uiFileLine, const char* szFunction, Targs&&... args);
+    bool IsLogEnabled(int iLogLevel) const;
 
 protected:
     bool InitLogger(const CJsonObject& oJsonConf, const std::string& strLogNameBase = "");
@@ -181,8 +202,16 @@ private:
     std::shared_ptr<NetLogger> m_pLogger = nullptr;
     std::shared_ptr<SocketChannel> m_pManagerControlChannel = nullptr;
     std::shared_ptr<SocketChannel> m_pManagerDataChannel = nullptr;
+    std::shared_ptr<ThreadMailbox> m_pManagerMailbox = nullptr;     ///< 线程模型下Manager线程的信箱
+    int m_iManagerControlFd = -1;
+    int m_iManagerDataFd = -1;
 };
 
+inline bool Worker::IsLogEnabled(int iLogLevel) const
+{
+    return(m_pLogger->IsLevelEnabled(iLogLevel));
+}
+
 template <typename ...Targs>
 void Worker::Logger(int iLogLevel, const char* szFileName, unsigned int uiFileLine, const char* szFunction, Targs&&... args)
 {
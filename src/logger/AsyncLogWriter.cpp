@@ -0,0 +1,243 @@
+/*******************************************************************************
+ * Project:  Nebula
+ * @file     AsyncLogWriter.cpp
+ * @brief    异步日志写入器
+ * @author   Bwar
+ * @date:    2026年10月17日
+ * @note
+ * Modify history:
+ ******************************************************************************/
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <cerrno>
+#include <cstring>
+#include <chrono>
+#include <iostream>
+#include "FileLogger.hpp"
+#include "AsyncLogWriter.hpp"
+
+namespace neb
+{
+
+const size_t AsyncLogWriter::sc_uiMinRingSize;
+const int AsyncLogWriter::sc_iFlushIntervalMs;
+
+AsyncLogWriter::AsyncLogWriter(const std::string& strLogFile, size_t uiRingSize, bool bBlockWhenFull,
+        unsigned int uiMaxFileSize, unsigned int uiMaxRollFileIndex)
+    : m_strLogFile(strLogFile), m_uiMaxFileSize(uiMaxFileSize), m_uiMaxRollFileIndex(uiMaxRollFileIndex),
+      m_bBlockWhenFull(bBlockWhenFull), m_pRing(nullptr), m_uiRingSize(sc_uiMinRingSize),
+      m_uiWakeupBytes(0), m_ullCachedReadPos(0),
+      m_ullWritePos(0), m_ullReadPos(0), m_ullDroppedNum(0),
+      m_bFlusherWaiting(false), m_bStop(false),
+      m_iFd(-1), m_ullFileSize(0), m_ullDroppedReported(0), m_lLastCheckTime(0)
+{
+    while (m_uiRingSize < uiRingSize)     // 取2的幂，位置取模用位运算
+    {
+        m_uiRingSize <<= 1;
+    }
+    m_uiWakeupBytes = m_uiRingSize / 4;
+    m_pRing = new char[m_uiRingSize];
+}
+
+AsyncLogWriter::~AsyncLogWriter()
+{
+    m_bStop.store(true);
+    Wakeup();
+    if (m_oFlusher.joinable())
+    {
+        m_oFlusher.join();      // 刷盘线程退出前会写完缓冲区中的全部日志
+    }
+    if (m_iFd >= 0)
+    {
+        close(m_iFd);
+    }
+    delete[] m_pRing;
+}
+
+bool AsyncLogWriter::Start()
+{
+    if (!OpenLogFile())
+    {
+        return(false);
+    }
+    m_oFlusher = std::thread(&AsyncLogWriter::FlushLoop, this);
+    return(true);
+}
+
+bool AsyncLogWriter::Write(const char* pRecord, size_t uiLen)
+{
+    if (uiLen > m_uiRingSize)
+    {
+        m_ullDroppedNum.fetch_add(1, std::memory_order_relaxed);
+        return(false);
+    }
+    uint64_t ullWritePos = m_ullWritePos.load(std::memory_order_relaxed);
+    while (m_uiRingSize - (ullWritePos - m_ullCachedReadPos) < uiLen)
+    {
+        m_ullCachedReadPos = m_ullReadPos.load(std::memory_order_acquire);
+        if (m_uiRingSize - (ullWritePos - m_ullCachedReadPos) >= uiLen)
+        {
+            break;
+        }
+        if (!m_bBlockWhenFull)
+        {
+            m_ullDroppedNum.fetch_add(1, std::memory_order_relaxed);
+            return(false);
+        }
+        Wakeup();
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+
+    size_t uiOffset = ullWritePos & (m_uiRingSize - 1);
+    size_t uiFirstLen = m_uiRingSize - uiOffset;
+    if (uiFirstLen >= uiLen)
+    {
+        memcpy(m_pRing + uiOffset, pRecord, uiLen);
+    }
+    else
+    {
+        memcpy(m_pRing + uiOffset, pRecord, uiFirstLen);
+        memcpy(m_pRing, pRecord + uiFirstLen, uiLen - uiFirstLen);
+    }
+    m_ullWritePos.store(ullWritePos + uiLen, std::memory_order_release);
+
+    if (m_bFlusherWaiting.load() && (ullWritePos + uiLen - m_ullCachedReadPos) >= m_uiWakeupBytes)
+    {
+        Wakeup();
+    }
+    return(true);
+}
+
+void AsyncLogWriter::Wakeup()
+{
+    std::lock_guard<std::mutex> oLock(m_mutex);
+    m_cond.notify_one();
+}
+
+void AsyncLogWriter::FlushLoop()
+{
+    while (!m_bStop.load())
+    {
+        {
+            std::unique_lock<std::mutex> oLock(m_mutex);
+            m_bFlusherWaiting.store(true);
+            uint64_t ullPending = m_ullWritePos.load(std::memory_order_acquire)
+                    - m_ullReadPos.load(std::memory_order_relaxed);
+            if (ullPending < m_uiWakeupBytes && !m_bStop.load())
+            {
+                m_cond.wait_for(oLock, std::chrono::milliseconds(sc_iFlushIntervalMs));
+            }
+            m_bFlusherWaiting.store(false);
+        }
+        Flush();
+        CheckLogFile();
+    }
+    Flush();
+}
+
+size_t AsyncLogWriter::Flush()
+{
+    uint64_t ullReadPos = m_ullReadPos.load(std::memory_order_relaxed);
+    uint64_t ullWritePos = m_ullWritePos.load(std::memory_order_acquire);
+    size_t uiLen = ullWritePos - ullReadPos;
+    if (uiLen > 0)
+    {
+        size_t uiOffset = ullReadPos & (m_uiRingSize - 1);
+        size_t uiFirstLen = m_uiRingSize - uiOffset;
+        if (uiFirstLen >= uiLen)
+        {
+            WriteFile(m_pRing + uiOffset, uiLen);
+        }
+        else
+        {
+            WriteFile(m_pRing + uiOffset, uiFirstLen);
+            WriteFile(m_pRing, uiLen - uiFirstLen);
+        }
+        m_ullReadPos.store(ullWritePos, std::memory_order_release);
+    }
+
+    uint64_t ullDroppedNum = m_ullDroppedNum.load(std::memory_order_relaxed);
+    if (ullDroppedNum > m_ullDroppedReported)
+    {
+        std::string strNote = "[" + std::to_string(ullDroppedNum - m_ullDroppedReported)
+                + " log records dropped for async log buffer full]\n";
+        WriteFile(strNote.data(), strNote.size());
+        m_ullDroppedReported = ullDroppedNum;
+    }
+
+    // 批量写入的边界总是完整的日志记录，滚动不会把一条日志拆到两个文件
+    if (m_uiMaxFileSize > 0 && m_ullFileSize >= m_uiMaxFileSize)
+    {
+        if (m_iFd >= 0)
+        {
+            close(m_iFd);
+            m_iFd = -1;
+        }
+        FileLogger::RollLogFiles(m_strLogFile, m_uiMaxRollFileIndex);
+        OpenLogFile();
+    }
+    return(uiLen);
+}
+
+bool AsyncLogWriter::OpenLogFile()
+{
+    m_iFd = open(m_strLogFile.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (m_iFd < 0)
+    {
+        std::cerr << "Can not open file: " << m_strLogFile << std::endl;
+        return(false);
+    }
+    struct stat stFileStat;
+    m_ullFileSize = (fstat(m_iFd, &stFileStat) == 0) ? stFileStat.st_size : 0;
+    return(true);
+}
+
+void AsyncLogWriter::CheckLogFile()
+{
+    time_t lNow = time(nullptr);
+    if (lNow == m_lLastCheckTime)
+    {
+        return;
+    }
+    m_lLastCheckTime = lNow;
+    if (m_iFd >= 0)
+    {
+        // 日志文件被外部删除或移走时重新打开
+        struct stat stFileStat;
+        if (fstat(m_iFd, &stFileStat) == 0 && stFileStat.st_nlink > 0)
+        {
+            return;
+        }
+        close(m_iFd);
+        m_iFd = -1;
+    }
+    OpenLogFile();
+}
+
+void AsyncLogWriter::WriteFile(const char* pData, size_t uiLen)
+{
+    if (m_iFd < 0)
+    {
+        return;     // 文件无法打开时丢弃，由CheckLogFile()重试打开
+    }
+    while (uiLen > 0)
+    {
+        ssize_t iWritten = write(m_iFd, pData, uiLen);
+        if (iWritten < 0)
+        {
+            if (EINTR == errno)
+            {
+                continue;
+            }
+            std::cerr << "Write log error: " << strerror(errno) << std::endl;
+            return;
+        }
+        pData += iWritten;
+        uiLen -= iWritten;
+        m_ullFileSize += iWritten;
+    }
+}
+
+} /* namespace neb */
@@ -0,0 +1,97 @@
+/*******************************************************************************
+ * Project:  Nebula
+ * @file     AsyncLogWriter.hpp
+ * @brief    异步日志写入器
+ * @author   Bwar
+ * @date:    2026年10月17日
+ * @note     日志线程（生产者）把格式化好的日志记录写入单生产者单消费者环形缓冲区，
+ * 后台刷盘线程（消费者）把缓冲区中积累的日志一次性写入文件。每个FileLogger只被
+ * 一个Labor线程使用，因此每个生产者线程独占一个环形缓冲区，无需加锁。
+ * Modify history:
+ ******************************************************************************/
+#ifndef LOGGER_ASYNCLOGWRITER_HPP_
+#define LOGGER_ASYNCLOGWRITER_HPP_
+
+#include <cstdint>
+#include <ctime>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace neb
+{
+
+class AsyncLogWriter
+{
+public:
+    AsyncLogWriter(const std::string& strLogFile, size_t uiRingSize, bool bBlockWhenFull,
+            unsigned int uiMaxFileSize, unsigned int uiMaxRollFileIndex);
+    AsyncLogWriter(const AsyncLogWriter&) = delete;
+    AsyncLogWriter& operator=(const AsyncLogWriter&) = delete;
+    ~AsyncLogWriter();
+
+    /**
+     * @brief 打开日志文件并启动刷盘线程
+     */
+    bool Start();
+
+    /**
+     * @brief 写入一条完整的日志记录（只能由生产者线程调用）
+     * @note 缓冲区满时，bBlockWhenFull为true则等待刷盘线程腾出空间，否则丢弃该记录。
+     * @return 记录被丢弃时返回false
+     */
+    bool Write(const char* pRecord, size_t uiLen);
+
+    /**
+     * @brief 唤醒刷盘线程立即刷盘（如写入了严重错误日志）
+     */
+    void Wakeup();
+
+    uint64_t GetDroppedNum() const
+    {
+        return(m_ullDroppedNum.load(std::memory_order_relaxed));
+    }
+
+private:
+    void FlushLoop();
+    size_t Flush();
+    bool OpenLogFile();
+    void CheckLogFile();
+    void WriteFile(const char* pData, size_t uiLen);
+
+private:
+    static const size_t sc_uiMinRingSize = 65536;
+    static const int sc_iFlushIntervalMs = 20;      ///< 缓冲区积累不足唤醒阈值时的刷盘间隔
+
+    std::string m_strLogFile;
+    unsigned int m_uiMaxFileSize;
+    unsigned int m_uiMaxRollFileIndex;
+    bool m_bBlockWhenFull;
+    char* m_pRing;
+    size_t m_uiRingSize;
+    size_t m_uiWakeupBytes;                         ///< 积累到此长度时生产者唤醒刷盘线程
+    uint64_t m_ullCachedReadPos;                    ///< 生产者缓存的读位置，减少对m_ullReadPos的访问
+
+    std::atomic<uint64_t> m_ullWritePos;
+    char m_szPadding[64];                           ///< 读写位置分处不同缓存行，避免伪共享
+    std::atomic<uint64_t> m_ullReadPos;
+    std::atomic<uint64_t> m_ullDroppedNum;
+    std::atomic<bool> m_bFlusherWaiting;
+    std::atomic<bool> m_bStop;
+
+    std::mutex m_mutex;
+    std::condition_variable m_cond;
+    std::thread m_oFlusher;
+
+    // 以下成员只在刷盘线程中访问
+    int m_iFd;
+    uint64_t m_ullFileSize;
+    uint64_t m_ullDroppedReported;
+    time_t m_lLastCheckTime;
+};
+
+} /* namespace neb */
+
+#endif /* LOGGER_ASYNCLOGWRITER_HPP_ */
@@ -18,6 +18,7 @@
 #include <iostream>
 #include <fstream>
 
+#include "AsyncLogWriter.hpp"
 #include "FileLogger.hpp"
 
 namespace neb
@@ -28,20 +29,17 @@ FileLogger* FileLogger::s_pInstance = nullptr;
 FileLogger::FileLogger(const std::string& strLogFile, int iLogLev,
         unsigned int uiMaxFileSize, unsigned int uiMaxRollFileIndex, bool bAlwaysFlush)
     : m_iLogLevel(iLogLev), m_uiLogNum(0), m_uiMaxFileSize(uiMaxFileSize),
-      m_uiMaxRollFileIndex(uiMaxRollFileIndex), m_bAlwaysFlush(bAlwaysFlush), m_strLogFileBase(strLogFile)
+      m_uiMaxRollFileIndex(uiMaxRollFileIndex), m_bAlwaysFlush(bAlwaysFlush), m_strLogFileBase(strLogFile),
+      m_lCachedSecond(0), m_pAsyncWriter(nullptr)
 {
-#if __GNUC__ < 5
-    m_szTime = (char*)malloc(20);
-#endif
+    m_szCachedTime[0] = '\0';
     OpenLogFile(strLogFile);
     WriteLog(Logger::NOTICE, __FILE__, __LINE__, __FUNCTION__, "new log instance.");
 }
 
 FileLogger::~FileLogger()
 {
-#if __GNUC__ < 5
-    free(m_szTime);
-#endif
+    m_pAsyncWriter.reset();     // 等待后台线程写完缓冲区中的日志
     m_fout.close();
 }
 
@@ -52,50 +50,112 @@ int FileLogger::WriteLog(int iLev, const char* szFileName, unsigned int uiFileLi
     {
         return 0;
     }
+    return(WriteRecord(nullptr, iLev, szFileName, uiFileLine, szFunction, strContent));
+}
 
-    if(!m_fout.good())
+int FileLogger::WriteLog(const std::string& strTraceId, int iLev, const char* szFileName,
+            unsigned int uiFileLine, const char* szFunction, const std::string& strContent)
+{
+    if (iLev > m_iLogLevel)
     {
-        std::cerr << "Write log error: no log file handle." << std::endl;
-        return -1;
+        return 0;
     }
+    return(WriteRecord(&strTraceId, iLev, szFileName, uiFileLine, szFunction, strContent));
+}
 
-    AppendLogPattern(iLev, szFileName, uiFileLine, szFunction);
-    Append(strContent);
-    m_fout << "\n";
-
-    if (m_bAlwaysFlush)
+bool FileLogger::EnableAsync(size_t uiRingSize, bool bBlockWhenFull)
+{
+    if (m_pAsyncWriter != nullptr)
     {
-        m_fout.flush();
+        return(true);
     }
-    ++m_uiLogNum;
-
-    return 0;
+    if (m_fout.is_open())
+    {
+        m_fout.close();
+    }
+    std::unique_ptr<AsyncLogWriter> pAsyncWriter(new AsyncLogWriter(
+            m_strLogFileBase, uiRingSize, bBlockWhenFull, m_uiMaxFileSize, m_uiMaxRollFileIndex));
+    if (!pAsyncWriter->Start())
+    {
+        ReOpen();
+        return(false);
+    }
+    m_pAsyncWriter = std::move(pAsyncWriter);
+    return(true);
 }
 
-int FileLogger::WriteLog(const std::string& strTraceId, int iLev, const char* szFileName,
-            unsigned int uiFileLine, const char* szFunction, const std::string& strContent)
+void FileLogger::RollLogFiles(const std::string& strLogFileBase, unsigned int uiMaxRollFileIndex)
 {
-    if (iLev > m_iLogLevel)
+    std::stringstream ssOldestFile(
+            std::stringstream::in | std::stringstream::out);
+    ssOldestFile << strLogFileBase << "." << uiMaxRollFileIndex;
+    remove(ssOldestFile.str().c_str());
+
+    for (int i = uiMaxRollFileIndex - 1; i >= 1; --i)
     {
-        return 0;
+        std::stringstream ssSrcFileName(
+                std::stringstream::in | std::stringstream::out);
+        std::stringstream ssDestFileName(
+                std::stringstream::in | std::stringstream::out);
+
+        ssSrcFileName << strLogFileBase << "." << i;
+        ssDestFileName << strLogFileBase << "." << (i + 1);
+        remove(ssDestFileName.str().c_str());
+        rename(ssSrcFileName.str().c_str(), ssDestFileName.str().c_str());
     }
+    std::stringstream ss(std::stringstream::in | std::stringstream::out);
+    ss << strLogFileBase << ".1";
+    std::string strBackupFile = ss.str();
+    rename(strLogFileBase.c_str(), strBackupFile.c_str());
+}
 
-    if(!m_fout.good())
+int FileLogger::WriteRecord(const std::string* pTraceId, int iLev, const char* szFileName,
+        unsigned int uiFileLine, const char* szFunction, const std::string& strContent)
+{
+    if (m_pAsyncWriter == nullptr)
     {
-        std::cerr << "Write log error: no log file handle." << std::endl;
-        return -1;
+        if (m_uiLogNum % 10000 == 1)
+        {
+            long lFileSize = -1;
+            lFileSize = m_fout.tellp();
+            if (lFileSize < 0)
+            {
+                ReOpen();
+            }
+            else if (lFileSize >= m_uiMaxFileSize)
+            {
+                RollOver();
+                ReOpen();
+            }
+        }
+        if(!m_fout.good())
+        {
+            std::cerr << "Write log error: no log file handle." << std::endl;
+            return -1;
+        }
     }
 
-    AppendLogPattern(strTraceId, iLev, szFileName, uiFileLine, szFunction);
-    Append(strContent);
-    m_fout << "\n";
+    m_strRecord.clear();
+    AppendLogPattern(pTraceId, iLev, szFileName, uiFileLine, szFunction);
+    m_strRecord.append(strContent);
+    m_strRecord.append(1, '\n');
+    ++m_uiLogNum;
+
+    if (m_pAsyncWriter != nullptr)
+    {
+        bool bWritten = m_pAsyncWriter->Write(m_strRecord.data(), m_strRecord.size());
+        if (iLev <= Logger::CRITICAL)
+        {
+            m_pAsyncWriter->Wakeup();
+        }
+        return(bWritten ? 0 : -1);
+    }
 
+    m_fout.write(m_strRecord.data(), m_strRecord.size());
     if (m_bAlwaysFlush)
     {
         m_fout.flush();
     }
-    ++m_uiLogNum;
-
     return 0;
 }
 
@@ -125,104 +185,39 @@ void FileLogger::RollOver()
     {
         m_fout.close();
     }
-    std::stringstream ssOldestFile(
-            std::stringstream::in | std::stringstream::out);
-    ssOldestFile << m_strLogFileBase << "." << m_uiMaxRollFileIndex;
-    remove(ssOldestFile.str().c_str());
-
-    for (int i = m_uiMaxRollFileIndex - 1; i >= 1; --i)
-    {
-        std::stringstream ssSrcFileName(
-                std::stringstream::in | std::stringstream::out);
-        std::stringstream ssDestFileName(
-                std::stringstream::in | std::stringstream::out);
-
-        ssSrcFileName << m_strLogFileBase << "." << i;
-        ssDestFileName << m_strLogFileBase << "." << (i + 1);
-        remove(ssDestFileName.str().c_str());
-        rename(ssSrcFileName.str().c_str(), ssDestFileName.str().c_str());
-    }
-    std::stringstream ss(std::stringstream::in | std::stringstream::out);
-    ss << m_strLogFileBase << ".1";
-    std::string strBackupFile = ss.str();
-    rename(m_strLogFileBase.c_str(), strBackupFile.c_str());
+    RollLogFiles(m_strLogFileBase, m_uiMaxRollFileIndex);
 }
 
-void FileLogger::AppendLogPattern(int iLev, const char* szFileName, unsigned int uiFileLine, const char* szFunction)
+void FileLogger::AppendLogPattern(const std::string* pTraceId, int iLev, const char* szFileName, unsigned int uiFileLine, const char* szFunction)
 {
-    if (m_uiLogNum % 10000 == 1)
-    {
-        long lFileSize = -1;
-        lFileSize = m_fout.tellp();
-        if (lFileSize < 0)
-        {
-            ReOpen();
-        }
-        else if (lFileSize >= m_uiMaxFileSize)
-        {
-            RollOver();
-            ReOpen();
-        }
-        if (!m_fout.good())
-        {
-            return;
-        }
-    }
     auto time_now = std::chrono::system_clock::now();
     auto duration_in_ms = std::chrono::duration_cast<std::chrono::milliseconds>(time_now.time_since_epoch());
-    auto t = std::chrono::system_clock::to_time_t(time_now);
-    std::ostringstream oss;
-// There is a bug: The std::get_time and std::put_time manipulators are still missing in gcc 4.9.
-// See https://gcc.gnu.org/bugzilla/show_bug.cgi?id=54354
-#if __GNUC__ >= 5
-    oss << "[" << std::put_time(std::localtime(&t), "%Y-%m-%d %H:%M:%S") << "."
-        << duration_in_ms.count() % 1000 << "][" << LogLevMsg[iLev] << "]["
-        << szFileName << ":" << uiFileLine << "][" << szFunction << "] ";
-#else
-    strftime(m_szTime, 20, "%Y-%m-%d %H:%M:%S", std::localtime(&t));
-    oss << "[" << m_szTime << "."
-        << duration_in_ms.count() % 1000 << "][" << LogLevMsg[iLev] << "]["
-        << szFileName << ":" << uiFileLine << "][" << szFunction << "] ";
-#endif
-    Append(oss.str());
-}
-
-void FileLogger::AppendLogPattern(const std::string& strTraceId, int iLev, const char* szFileName, unsigned int uiFileLine, const char* szFunction)
-{
-    if (m_uiLogNum % 10000 == 1)
+    time_t lSecond = duration_in_ms.count() / 1000;
+    if (lSecond != m_lCachedSecond)     // localtime_r和strftime每秒只做一次
     {
-        long lFileSize = -1;
-        lFileSize = m_fout.tellp();
-        if (lFileSize < 0)
-        {
-            ReOpen();
-        }
-        else if (lFileSize >= m_uiMaxFileSize)
-        {
-            RollOver();
-            ReOpen();
-        }
-        if (!m_fout.good())
-        {
-            return;
-        }
+        struct tm stTime;
+        localtime_r(&lSecond, &stTime);
+        strftime(m_szCachedTime, sizeof(m_szCachedTime), "%Y-%m-%d %H:%M:%S", &stTime);
+        m_lCachedSecond = lSecond;
     }
-    auto time_now = std::chrono::system_clock::now();
-    auto duration_in_ms = std::chrono::duration_cast<std::chrono::milliseconds>(time_now.time_since_epoch());
-    auto t = std::chrono::system_clock::to_time_t(time_now);
-    std::ostringstream oss;
-#if __GNUC__ >= 5
-    oss << "[" << std::put_time(std::localtime(&t), "%Y-%m-%d %H:%M:%S") << "."
-        << duration_in_ms.count() % 1000 << "][" << LogLevMsg[iLev] << "]["
-        << szFileName << ":" << uiFileLine << "][" << szFunction << "][" << strTraceId << "] ";
-#else
-    strftime(m_szTime, 20, "%Y-%m-%d %H:%M:%S", std::localtime(&t));
-    oss << "[" << m_szTime << "."
-        << duration_in_ms.count() % 1000 << "][" << LogLevMsg[iLev] << "]["
-        << szFileName << ":" << uiFileLine << "][" << szFunction << "][" << strTraceId << "] ";
-#endif
-    Append(oss.str());
+    m_strRecord.append("[");
+    m_strRecord.append(m_szCachedTime);
+    m_strRecord.append(".");
+    m_strRecord.append(std::to_string(duration_in_ms.count() % 1000));
+    m_strRecord.append("][");
+    m_strRecord.append(LogLevMsg[iLev]);
+    m_strRecord.append("][");
+    m_strRecord.append(szFileName);
+    m_strRecord.append(":");
+    m_strRecord.append(std::to_string(uiFileLine));
+    m_strRecord.append("][");
+    m_strRecord.append(szFunction);
+    if (pTraceId != nullptr)
+    {
+        m_strRecord.append("][");
+        m_strRecord.append(*pTraceId);
+    }
+    m_strRecord.append("] ");
 }
 
 } /* namespace neb */
-
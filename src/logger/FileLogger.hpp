@@ -15,11 +15,15 @@
 #include <iostream>
 #include <fstream>
 #include <sstream>
+#include <memory>
+#include <ctime>
 #include "Logger.hpp"
 
 namespace neb
 {
 
+class AsyncLogWriter;
+
 class FileLogger: public Logger
 {
 public:
@@ -48,6 +52,19 @@ public:
         m_iLogLevel = iLev;
     }
 
+    /**
+     * @brief 切换为异步日志模式
+     * @note 切换后日志记录在当前线程格式化，写入环形缓冲区，由后台线程批量写入文件。
+     * @param uiRingSize 环形缓冲区大小（字节）
+     * @param bBlockWhenFull 缓冲区满时阻塞等待（true）还是丢弃日志（false）
+     */
+    bool EnableAsync(size_t uiRingSize, bool bBlockWhenFull);
+
+    /**
+     * @brief 日志文件滚动：log.N-1 -> log.N, ..., log -> log.1
+     */
+    static void RollLogFiles(const std::string& strLogFileBase, unsigned int uiMaxRollFileIndex);
+
     template<typename ...Targs>
     int WriteLog(int iLev, const char* szFileName, unsigned int uiFileLine,
             const char* szFunction, const char* szLogFormat, Targs&&... args);
@@ -69,8 +86,9 @@ protected:
     bool OpenLogFile(const std::string strLogFile);
     void ReOpen();
     void RollOver();
-    void AppendLogPattern(int iLev, const char* szFileName, unsigned int uiFileLine, const char* szFunction);
-    void AppendLogPattern(const std::string& strTraceId, int iLev, const char* szFileName, unsigned int uiFileLine, const char* szFunction);
+    int WriteRecord(const std::string* pTraceId, int iLev, const char* szFileName,
+            unsigned int uiFileLine, const char* szFunction, const std::string& strContent);
+    void AppendLogPattern(const std::string* pTraceId, int iLev, const char* szFileName, unsigned int uiFileLine, const char* szFunction);
     void Append(){}
     template<typename T, typename ...Targs> void Append(T&& arg, Targs&&... args);
     template<typename T> void Append(T&& arg);
@@ -79,9 +97,6 @@ protected:
 
 private:
     static FileLogger* s_pInstance;
-#if __GNUC__ < 5
-    char* m_szTime;
-#endif
     std::ofstream m_fout;
     int m_iLogLevel;
     unsigned int m_uiLogNum;
@@ -89,6 +104,11 @@ private:
     unsigned int m_uiMaxRollFileIndex;  // 滚动日志文件数量
     bool m_bAlwaysFlush;
     std::string m_strLogFileBase;       // 日志文件基本名（如 log/program_name.log）
+    time_t m_lCachedSecond;             // m_szCachedTime对应的秒，同一秒内的日志复用时间前缀
+    char m_szCachedTime[32];
+    std::string m_strRecord;            // 格式化好的一条日志记录
+    std::ostringstream m_ossContent;
+    std::unique_ptr<AsyncLogWriter> m_pAsyncWriter;
 };
 
 template<typename ...Targs>
@@ -99,24 +119,9 @@ int FileLogger::WriteLog(int iLev, const char* szFileName, unsigned int uiFileLi
     {
         return 0;
     }
-
-    if(!m_fout.good())
-    {
-        std::cerr << "Write log error: no log file handle." << std::endl;
-        return -1;
-    }
-
-    AppendLogPattern(iLev, szFileName, uiFileLine, szFunction);
+    m_ossContent.str("");
     Append(szLogFormat, std::forward<Targs>(args)...);
-    m_fout << "\n";
-
-    if (m_bAlwaysFlush)
-    {
-        m_fout.flush();
-    }
-    ++m_uiLogNum;
-
-    return 0;
+    return(WriteRecord(nullptr, iLev, szFileName, uiFileLine, szFunction, m_ossContent.str()));
 }
 
 template<typename ...Targs>
@@ -128,24 +133,9 @@ int FileLogger::WriteLog(const std::string& strTraceId, int iLev,
     {
         return 0;
     }
-
-    if(!m_fout.good())
-    {
-        std::cerr << "Write log error: no log file handle." << std::endl;
-        return -1;
-    }
-
-    AppendLogPattern(strTraceId, iLev, szFileName, uiFileLine, szFunction);
+    m_ossContent.str("");
     Append(szLogFormat, std::forward<Targs>(args)...);
-    m_fout << "\n";
-
-    if (m_bAlwaysFlush)
-    {
-        m_fout.flush();
-    }
-    ++m_uiLogNum;
-
-    return 0;
+    return(WriteRecord(&strTraceId, iLev, szFileName, uiFileLine, szFunction, m_ossContent.str()));
 }
 
 template<typename ...Targs>
@@ -156,24 +146,9 @@ int FileLogger::WriteLog(int iLev, const char* szFileName, unsigned int uiFileLi
     {
         return 0;
     }
-
-    if(!m_fout.good())
-    {
-        std::cerr << "Write log error: no log file handle." << std::endl;
-        return -1;
-    }
-
-    AppendLogPattern(iLev, szFileName, uiFileLine, szFunction);
+    m_ossContent.str("");
     Append(std::forward<Targs>(args)...);
-    m_fout << "\n";
-
-    if (m_bAlwaysFlush)
-    {
-        m_fout.flush();
-    }
-    ++m_uiLogNum;
-
-    return 0;
+    return(WriteRecord(nullptr, iLev, szFileName, uiFileLine, szFunction, m_ossContent.str()));
 }
 
 template<typename ...Targs>
@@ -185,24 +160,9 @@ int FileLogger::WriteLog(const std::string& strTraceId, int iLev,
     {
         return 0;
     }
-
-    if(!m_fout.good())
-    {
-        std::cerr << "Write log error: no log file handle." << std::endl;
-        return -1;
-    }
-
-    AppendLogPattern(strTraceId, iLev, szFileName, uiFileLine, szFunction);
+    m_ossContent.str("");
     Append(std::forward<Targs>(args)...);
-    m_fout << "\n";
-
-    if (m_bAlwaysFlush)
-    {
-        m_fout.flush();
-    }
-    ++m_uiLogNum;
-
-    return 0;
+    return(WriteRecord(&strTraceId, iLev, szFileName, uiFileLine, szFunction, m_ossContent.str()));
 }
 
 template<typename T, typename ...Targs>
@@ -215,7 +175,7 @@ void FileLogger::Append(T&& arg, Targs&&... args)
 template<typename T>
 void FileLogger::Append(T&& arg)
 {
-    m_fout << arg;
+    m_ossContent << arg;
 }
 
 template<typename T, typename ...Targs>
@@ -256,16 +216,16 @@ const char* FileLogger::PrintfAppend(const char* szFormat, T&& arg)
                 if (i > 0)
                 {
                     strOutStr.assign(szFormat, i);
-                    m_fout << strOutStr;
+                    m_ossContent << strOutStr;
                 }
-                m_fout << arg;
+                m_ossContent << arg;
                 return(nullptr);
             case '%':
                 if (bPlaceholder)
                 {
                     strOutStr.append("%");
                     pPos = szFormat + i + 1;
-                    m_fout << strOutStr;
+                    m_ossContent << strOutStr;
                     return(PrintfAppend(pPos, std::forward<T>(arg)));
                 }
                 else
@@ -278,8 +238,8 @@ const char* FileLogger::PrintfAppend(const char* szFormat, T&& arg)
                 if (bPlaceholder)
                 {
                     pPos = szFormat + i + 1;
-                    m_fout << strOutStr;
-                    m_fout << std::fixed << arg;
+                    m_ossContent << strOutStr;
+                    m_ossContent << std::fixed << arg;
                     return(pPos);
                 }
                 break;
@@ -293,8 +253,8 @@ const char* FileLogger::PrintfAppend(const char* szFormat, T&& arg)
                 if (bPlaceholder)
                 {
                     pPos = szFormat + i + 1;
-                    m_fout << strOutStr;
-                    m_fout << arg;
+                    m_ossContent << strOutStr;
+                    m_ossContent << arg;
                     return(pPos);
                 }
                 break;
@@ -304,8 +264,8 @@ const char* FileLogger::PrintfAppend(const char* szFormat, T&& arg)
                 if (bPlaceholder)
                 {
                     pPos = szFormat + i + 1;
-                    m_fout << strOutStr;
-                    m_fout << std::dec << arg;
+                    m_ossContent << strOutStr;
+                    m_ossContent << std::dec << arg;
                     return(pPos);
                 }
                 break;
@@ -313,8 +273,8 @@ const char* FileLogger::PrintfAppend(const char* szFormat, T&& arg)
                 if (bPlaceholder)
                 {
                     pPos = szFormat + i + 1;
-                    m_fout << strOutStr;
-                    m_fout << std::hex << std::nouppercase << arg;
+                    m_ossContent << strOutStr;
+                    m_ossContent << std::hex << std::nouppercase << arg;
                     return(pPos);
                 }
                 break;
@@ -322,8 +282,8 @@ const char* FileLogger::PrintfAppend(const char* szFormat, T&& arg)
                 if (bPlaceholder)
                 {
                     pPos = szFormat + i + 1;
-                    m_fout << strOutStr;
-                    m_fout << std::hex << std::uppercase << arg;
+                    m_ossContent << strOutStr;
+                    m_ossContent << std::hex << std::uppercase << arg;
                     return(pPos);
                 }
                 break;
@@ -331,8 +291,8 @@ const char* FileLogger::PrintfAppend(const char* szFormat, T&& arg)
                 if (bPlaceholder)
                 {
                     pPos = szFormat + i + 1;
-                    m_fout << strOutStr;
-                    m_fout << std::oct << arg;
+                    m_ossContent << strOutStr;
+                    m_ossContent << std::oct << arg;
                     return(pPos);
                 }
                 break;
@@ -341,8 +301,8 @@ const char* FileLogger::PrintfAppend(const char* szFormat, T&& arg)
                 if (bPlaceholder)
                 {
                     pPos = szFormat + i + 1;
-                    m_fout << strOutStr;
-                    m_fout << std::scientific << std::nouppercase << arg;
+                    m_ossContent << strOutStr;
+                    m_ossContent << std::scientific << std::nouppercase << arg;
                     return(pPos);
                 }
                 break;
@@ -351,8 +311,8 @@ const char* FileLogger::PrintfAppend(const char* szFormat, T&& arg)
                 if (bPlaceholder)
                 {
                     pPos = szFormat + i + 1;
-                    m_fout << strOutStr;
-                    m_fout << std::scientific << std::uppercase << arg;
+                    m_ossContent << strOutStr;
+                    m_ossContent << std::scientific << std::uppercase << arg;
                     return(pPos);
                 }
                 break;
@@ -361,7 +321,7 @@ const char* FileLogger::PrintfAppend(const char* szFormat, T&& arg)
         }
     }
     strOutStr.assign(szFormat, i);
-    m_fout << strOutStr;
+    m_ossContent << strOutStr;
     return(nullptr);
 }
 
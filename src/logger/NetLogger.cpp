@@ -10,6 +10,7 @@
 
 #include <cstdio>
 #include <cstdarg>
+#include <cstring>
 #include "pb/msg.pb.h"
 #include "pb/neb_sys.pb.h"
 #include "labor/NodeInfo.hpp"
@@ -36,6 +37,88 @@ NetLogger::~NetLogger()
 {
 }
 
+const char* NetLogger::NextPlaceholder(const char* szFormat)
+{
+    const char* pLiteral = szFormat;
+    const char* pPos = szFormat;
+    while (true)
+    {
+        while (*pPos != '\0' && *pPos != '%')
+        {
+            ++pPos;
+        }
+        if (*pPos == '\0')
+        {
+            m_ossLogContent.write(pLiteral, pPos - pLiteral);
+            return(nullptr);
+        }
+        if (pPos[1] == '%')     // "%%"输出一个'%'
+        {
+            m_ossLogContent.write(pLiteral, pPos + 1 - pLiteral);
+            pPos += 2;
+            pLiteral = pPos;
+            continue;
+        }
+        m_ossLogContent.write(pLiteral, pPos - pLiteral);
+        ++pPos;
+        // 跳过标志、宽度、精度和长度修饰符（如%-8.3lf、%llu、%zu）
+        while (*pPos != '\0' && strchr("-+ #0123456789.*hlLqjzt", *pPos) != nullptr)
+        {
+            ++pPos;
+        }
+        std::ios_base::fmtflags iFlags = std::ios_base::dec;
+        switch (*pPos)
+        {
+            case 'x':
+                iFlags = std::ios_base::hex;
+                break;
+            case 'X':
+                iFlags = std::ios_base::hex | std::ios_base::uppercase;
+                break;
+            case 'o':
+                iFlags = std::ios_base::oct;
+                break;
+            case 'f':
+            case 'F':
+                iFlags = std::ios_base::dec | std::ios_base::fixed;
+                break;
+            case 'e':
+            case 'g':
+                iFlags = std::ios_base::dec | std::ios_base::scientific;
+                break;
+            case 'E':
+            case 'G':
+                iFlags = std::ios_base::dec | std::ios_base::scientific | std::ios_base::uppercase;
+                break;
+            case '\0':
+                m_ossLogContent.flags(iFlags);
+                return(nullptr);
+            default:    // d i u s c p等
+                ;
+        }
+        m_ossLogContent.flags(iFlags);
+        return(pPos + 1);
+    }
+}
+
+void NetLogger::AppendFormatTail(const char* szFormat)
+{
+    const char* pLiteral = szFormat;
+    const char* pPos = szFormat;
+    while (*pPos != '\0')
+    {
+        if (pPos[0] == '%' && pPos[1] == '%')
+        {
+            m_ossLogContent.write(pLiteral, pPos + 1 - pLiteral);
+            pPos += 2;
+            pLiteral = pPos;
+            continue;
+        }
+        ++pPos;
+    }
+    m_ossLogContent.write(pLiteral, pPos - pLiteral);
+}
+
 void NetLogger::SinkLog(int iLev, const char* szFileName, unsigned int uiFileLine,
             const char* szFunction, const std::string& strLogContent, const std::string& strTraceId)
 {
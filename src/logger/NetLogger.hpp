@@ -47,6 +47,11 @@ public:
     int WriteLog(const std::string& strTraceId, int iLev, const char* szFileName,
             unsigned int uiFileLine, const char* szFunction, Targs&&... args);
 
+    bool IsLevelEnabled(int iLev) const
+    {
+        return(iLev <= m_iLogLevel || iLev <= m_iNetLogLevel);
+    }
+
     virtual void SetLogLevel(int iLev)
     {
         m_iLogLevel = iLev;
@@ -63,12 +68,27 @@ public:
         m_bEnableNetLogger = bEnableNetLogger;
     }
 
+    /**
+     * @brief 本地日志文件切换为异步写入，参数含义见FileLogger::EnableAsync()
+     */
+    bool EnableAsync(size_t uiRingSize, bool bBlockWhenFull)
+    {
+        return(m_pLog->EnableAsync(uiRingSize, bBlockWhenFull));
+    }
+
 protected:
     void Append(){}
     template<typename T, typename ...Targs> void Append(T&& arg, Targs&&... args);
     template<typename T> void Append(T&& arg);
     template<typename T, typename ...Targs> void Append(const char* szFormat, T&& arg, Targs&&... args);
     template<typename T> const char* PrintfAppend(const char* szFormat, T&& arg);
+
+    /**
+     * @brief 从szFormat起单趟扫描到下一个占位符，写出之前的文本并按占位符设置输出格式
+     * @return 占位符之后的位置，格式串中已无占位符时返回nullptr（参数直接追加在末尾）
+     */
+    const char* NextPlaceholder(const char* szFormat);
+    void AppendFormatTail(const char* szFormat);
     void SinkLog(int iLev, const char* szFileName, unsigned int uiFileLine,
             const char* szFunction, const std::string& strLogContent, const std::string& strTraceId = "");
 
@@ -92,6 +112,7 @@ int NetLogger::WriteLog(int iLev, const char* szFileName, unsigned int uiFileLin
         return(0);
     }
     m_ossLogContent.str("");
+    m_ossLogContent.flags(std::ios_base::dec);
     Append(szLogFormat, std::forward<Targs>(args)...);
 
     m_pLog->WriteLog(iLev, szFileName, uiFileLine, szFunction, m_ossLogContent.str());
@@ -113,6 +134,7 @@ int NetLogger::WriteLog(const std::string& strTraceId, int iLev, const char* szF
         return(0);
     }
     m_ossLogContent.str("");
+    m_ossLogContent.flags(std::ios_base::dec);
     Append(szLogFormat, std::forward<Targs>(args)...);
 
     m_pLog->WriteLog(strTraceId, iLev, szFileName, uiFileLine, szFunction, m_ossLogContent.str());
@@ -135,6 +157,7 @@ int NetLogger::WriteLog(int iLev, const char* szFileName, unsigned int uiFileLin
         return(0);
     }
     m_ossLogContent.str("");
+    m_ossLogContent.flags(std::ios_base::dec);
     Append(std::forward<Targs>(args)...);
 
     m_pLog->WriteLog(iLev, szFileName, uiFileLine, szFunction, m_ossLogContent.str());
@@ -156,6 +179,7 @@ int NetLogger::WriteLog(const std::string& strTraceId, int iLev, const char* szF
         return(0);
     }
     m_ossLogContent.str("");
+    m_ossLogContent.flags(std::ios_base::dec);
     Append(std::forward<Targs>(args)...);
 
     m_pLog->WriteLog(strTraceId, iLev, szFileName, uiFileLine, szFunction, m_ossLogContent.str());
@@ -189,12 +213,15 @@ void NetLogger::Append(const char* szFormat, T&& arg, Targs&&... args)
     {
         return;
     }
-    const char* pFormat = szFormat;
-    pFormat = PrintfAppend(pFormat, std::forward<T>(arg));
+    const char* pFormat = PrintfAppend(szFormat, std::forward<T>(arg));
     if (pFormat == nullptr)
     {
         Append(std::forward<Targs>(args)...);
     }
+    else if (sizeof...(args) == 0)
+    {
+        AppendFormatTail(pFormat);
+    }
     else
     {
         Append(pFormat, std::forward<Targs>(args)...);
@@ -204,129 +231,9 @@ void NetLogger::Append(const char* szFormat, T&& arg, Targs&&... args)
 template<typename T>
 const char* NetLogger::PrintfAppend(const char* szFormat, T&& arg)
 {
-    if (szFormat == nullptr)
-    {
-        return(nullptr);
-    }
-    const char* pPos = szFormat;
-    bool bPlaceholder = false;
-    std::string strOutStr;
-    int i = 0;
-    for (size_t i = 0; ; ++i)
-    {
-        switch (pPos[i])
-        {
-            case '\0':
-                if (i > 0)
-                {
-                    strOutStr.assign(szFormat, i);
-                    m_ossLogContent << strOutStr;
-                }
-                m_ossLogContent << arg;
-                return(nullptr);
-            case '%':
-                if (bPlaceholder)
-                {
-                    strOutStr.append("%");
-                    pPos = szFormat + i + 1;
-                    m_ossLogContent << strOutStr;
-                    return(PrintfAppend(pPos, std::forward<T>(arg)));
-                }
-                else
-                {
-                    strOutStr.assign(szFormat, i);
-                    bPlaceholder = true;
-                }
-                break;
-            case 'f':
-                if (bPlaceholder)
-                {
-                    pPos = szFormat + i + 1;
-                    m_ossLogContent << strOutStr;
-                    m_ossLogContent << std::fixed << arg;
-                    return(pPos);
-                }
-                break;
-            case 'a':
-            case 'A':
-            case 'c':
-            case 'C':
-            case 'p':
-            case 's':
-            case 'S':
-                if (bPlaceholder)
-                {
-                    pPos = szFormat + i + 1;
-                    m_ossLogContent << strOutStr;
-                    m_ossLogContent << arg;
-                    return(pPos);
-                }
-                break;
-            case 'u':
-            case 'd':
-            case 'i':
-                if (bPlaceholder)
-                {
-                    pPos = szFormat + i + 1;
-                    m_ossLogContent << strOutStr;
-                    m_ossLogContent << std::dec << arg;
-                    return(pPos);
-                }
-                break;
-            case 'x':
-                if (bPlaceholder)
-                {
-                    pPos = szFormat + i + 1;
-                    m_ossLogContent << strOutStr;
-                    m_ossLogContent << std::hex << std::nouppercase << arg;
-                    return(pPos);
-                }
-                break;
-            case 'X':
-                if (bPlaceholder)
-                {
-                    pPos = szFormat + i + 1;
-                    m_ossLogContent << strOutStr;
-                    m_ossLogContent << std::hex << std::uppercase << arg;
-                    return(pPos);
-                }
-                break;
-            case 'o':
-                if (bPlaceholder)
-                {
-                    pPos = szFormat + i + 1;
-                    m_ossLogContent << strOutStr;
-                    m_ossLogContent << std::oct << arg;
-                    return(pPos);
-                }
-                break;
-            case 'e':
-            case 'g':
-                if (bPlaceholder)
-                {
-                    pPos = szFormat + i + 1;
-                    m_ossLogContent << strOutStr;
-                    m_ossLogContent << std::scientific << std::nouppercase << arg;
-                    return(pPos);
-                }
-                break;
-            case 'E':
-            case 'G':
-                if (bPlaceholder)
-                {
-                    pPos = szFormat + i + 1;
-                    m_ossLogContent << strOutStr;
-                    m_ossLogContent << std::scientific << std::uppercase << arg;
-                    return(pPos);
-                }
-                break;
-            default:
-                ;
-        }
-    }
-    strOutStr.assign(szFormat, i);
-    m_ossLogContent << strOutStr;
-    return(nullptr);
+    const char* pNext = NextPlaceholder(szFormat);
+    m_ossLogContent << arg;
+    return(pNext);
 }
 
 } /* namespace neb */
@@ -0,0 +1,133 @@
+/*******************************************************************************
+ * Project:  Nebula
+ * @file     ByteScanner.cpp
+ * @brief    分隔符及短字节串查找
+ * @author   Bwar
+ * @date:    2026年10月17日
+ * @note
+ * Modify history:
+ ******************************************************************************/
+#include <cstring>
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+#include "ByteScanner.hpp"
+
+namespace neb
+{
+
+const char* ByteScanner::Find(const char* pBegin, const char* pEnd, const char* pNeedle, size_t uiNeedleLen)
+{
+    static FindFunc s_pFind = SelectFind();
+    return(s_pFind(pBegin, pEnd, pNeedle, uiNeedleLen));
+}
+
+ByteScanner::FindFunc ByteScanner::SelectFind()
+{
+#if defined(__SSE2__)
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+    {
+        return(&ByteScanner::FindAvx2);
+    }
+#endif
+    return(&ByteScanner::FindSse2);
+#else
+    return(&ByteScanner::FindScalar);
+#endif
+}
+
+const char* ByteScanner::FindScalar(const char* pBegin, const char* pEnd, const char* pNeedle, size_t uiNeedleLen)
+{
+    if (0 == uiNeedleLen)
+    {
+        return(pBegin);
+    }
+    if ((size_t)(pEnd - pBegin) < uiNeedleLen)
+    {
+        return(nullptr);
+    }
+    const char* pLast = pEnd - uiNeedleLen;     // 最后一个可能的匹配起点
+    const char* p = pBegin;
+    while (p <= pLast)
+    {
+        p = (const char*)memchr(p, pNeedle[0], pLast - p + 1);
+        if (p == nullptr)
+        {
+            return(nullptr);
+        }
+        if (0 == memcmp(p + 1, pNeedle + 1, uiNeedleLen - 1))
+        {
+            return(p);
+        }
+        ++p;
+    }
+    return(nullptr);
+}
+
+#if defined(__SSE2__)
+const char* ByteScanner::FindSse2(const char* pBegin, const char* pEnd, const char* pNeedle, size_t uiNeedleLen)
+{
+    if (0 == uiNeedleLen)
+    {
+        return(pBegin);
+    }
+    const char* p = pBegin;
+    const __m128i vFirst = _mm_set1_epi8(pNeedle[0]);
+    const __m128i vLast = _mm_set1_epi8(pNeedle[uiNeedleLen - 1]);
+    // 一次检查16个候选起点，需要读取到p + uiNeedleLen - 1 + 16
+    while ((size_t)(pEnd - p) >= uiNeedleLen + 15)
+    {
+        __m128i vBlockFirst = _mm_loadu_si128((const __m128i*)p);
+        __m128i vBlockLast = _mm_loadu_si128((const __m128i*)(p + uiNeedleLen - 1));
+        unsigned int uiMask = (unsigned int)_mm_movemask_epi8(
+                _mm_and_si128(_mm_cmpeq_epi8(vBlockFirst, vFirst), _mm_cmpeq_epi8(vBlockLast, vLast)));
+        while (uiMask != 0)
+        {
+            int i = __builtin_ctz(uiMask);
+            if (uiNeedleLen <= 2 || 0 == memcmp(p + i + 1, pNeedle + 1, uiNeedleLen - 2))
+            {
+                return(p + i);
+            }
+            uiMask &= uiMask - 1;
+        }
+        p += 16;
+    }
+    return(FindScalar(p, pEnd, pNeedle, uiNeedleLen));
+}
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+__attribute__((target("avx2")))
+const char* ByteScanner::FindAvx2(const char* pBegin, const char* pEnd, const char* pNeedle, size_t uiNeedleLen)
+{
+    if (0 == uiNeedleLen)
+    {
+        return(pBegin);
+    }
+    const char* p = pBegin;
+    const __m256i vFirst = _mm256_set1_epi8(pNeedle[0]);
+    const __m256i vLast = _mm256_set1_epi8(pNeedle[uiNeedleLen - 1]);
+    while ((size_t)(pEnd - p) >= uiNeedleLen + 31)
+    {
+        __m256i vBlockFirst = _mm256_loadu_si256((const __m256i*)p);
+        __m256i vBlockLast = _mm256_loadu_si256((const __m256i*)(p + uiNeedleLen - 1));
+        unsigned int uiMask = (unsigned int)_mm256_movemask_epi8(
+                _mm256_and_si256(_mm256_cmpeq_epi8(vBlockFirst, vFirst), _mm256_cmpeq_epi8(vBlockLast, vLast)));
+        while (uiMask != 0)
+        {
+            int i = __builtin_ctz(uiMask);
+            if (uiNeedleLen <= 2 || 0 == memcmp(p + i + 1, pNeedle + 1, uiNeedleLen - 2))
+            {
+                return(p + i);
+            }
+            uiMask &= uiMask - 1;
+        }
+        p += 32;
+    }
+    return(FindSse2(p, pEnd, pNeedle, uiNeedleLen));
+}
+#endif
+#endif
+
+} /* namespace neb */
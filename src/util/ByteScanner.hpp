@@ -0,0 +1,62 @@
+/*******************************************************************************
+ * Project:  Nebula
+ * @file     ByteScanner.hpp
+ * @brief    分隔符及短字节串查找
+ * @author   Bwar
+ * @date:    2026年10月17日
+ * @note     x86上用SIMD同时比较候选位置的首字节和末字节，两者都相同的位置再用memcmp
+ * 确认，每次处理16（SSE2）或32（AVX2）个候选位置；AVX2在运行时检测CPU支持后启用，
+ * 其他平台及不足一个向量的尾部用memchr逐个候选位置比较。
+ * Modify history:
+ ******************************************************************************/
+#ifndef SRC_UTIL_BYTESCANNER_HPP_
+#define SRC_UTIL_BYTESCANNER_HPP_
+
+#include <cstddef>
+
+namespace neb
+{
+
+class ByteScanner
+{
+public:
+    /**
+     * @brief 在[pBegin, pEnd)中查找第一次出现的pNeedle
+     * @param pNeedle 待查找的字节串
+     * @param uiNeedleLen 字节串长度，为0时返回pBegin
+     * @return 匹配位置，找不到（包括只找到部分匹配的尾部）时返回nullptr
+     */
+    static const char* Find(const char* pBegin, const char* pEnd, const char* pNeedle, size_t uiNeedleLen);
+
+    /**
+     * @brief 查找"\r\n"
+     */
+    static const char* FindCrlf(const char* pBegin, const char* pEnd)
+    {
+        return(Find(pBegin, pEnd, "\r\n", 2));
+    }
+
+    /**
+     * @brief 查找"\r\n\r\n"
+     */
+    static const char* FindCrlfCrlf(const char* pBegin, const char* pEnd)
+    {
+        return(Find(pBegin, pEnd, "\r\n\r\n", 4));
+    }
+
+protected:
+    typedef const char* (*FindFunc)(const char*, const char*, const char*, size_t);
+
+    static FindFunc SelectFind();
+    static const char* FindScalar(const char* pBegin, const char* pEnd, const char* pNeedle, size_t uiNeedleLen);
+#if defined(__SSE2__)
+    static const char* FindSse2(const char* pBegin, const char* pEnd, const char* pNeedle, size_t uiNeedleLen);
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    static const char* FindAvx2(const char* pBegin, const char* pEnd, const char* pNeedle, size_t uiNeedleLen);
+#endif
+#endif
+};
+
+} /* namespace neb */
+
+#endif /* SRC_UTIL_BYTESCANNER_HPP_ */
@@ -10,6 +10,7 @@
 
 #include <sys/socket.h>
 #include "CBuffer.hpp"
+#include "ByteScanner.hpp"
 
 
 namespace neb
@@ -125,41 +126,12 @@ int CBuffer::IndexOf(const void* data, size_t len, size_t start, size_t end)
         return -1;
     }
 
-    char first = ((const char*) data)[0];
-    size_t start_idx = start;
-    while (start_idx < end)
+    const char* p = ByteScanner::Find(m_buffer + start, m_buffer + end, (const char*) data, len);
+    if (p == NULL)
     {
-        char *start_at = m_buffer + start_idx;
-        char* p = (char *) memchr(start_at, first, end - start_idx);
-        if (p)
-        {
-            //start_idx.pos += p - start_at;
-            start_idx += (p - start_at);
-            if (len == 1)
-            {
-                return start_idx;
-            }
-            if (0 == memcmp(p, (const char*) data, len))
-            {
-                if (start_idx + len > end)
-                {
-                    return -1;
-                }
-                else
-                {
-                    return start_idx;
-                }
-
-            }
-            start_idx += len;
-        }
-        else
-        {
-            return -1;
-        }
+        return -1;
     }
-    return -1;
-
+    return p - m_buffer;
 }
 
 int CBuffer::IndexOf(const void* data, size_t len)
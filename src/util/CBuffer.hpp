@@ -21,6 +21,7 @@
 #include <cstdio>
 #include <cstring>
 #include <string>
+#include "CBufferPool.hpp"
 
 namespace neb
 {
@@ -104,24 +105,27 @@ class CBuffer
             uint32_t readableBytes = ReadableBytes();
             uint32_t total = Capacity();
             char* newSpace = NULL;
+            size_t newCapacity = 0;
             if (readableBytes > 0)
             {
-                newSpace = (char*) malloc(readableBytes);
+                newSpace = CBufferPool::Allocate(readableBytes, newCapacity);
                 if (NULL == newSpace)
                 {
                     return 0;
                 }
+                if (newCapacity >= total)
+                {
+                    CBufferPool::Release(newSpace, newCapacity);
+                    return 0;
+                }
                 memcpy(newSpace, m_buffer + m_read_idx, readableBytes);
             }
-            if(NULL != m_buffer)
-            {
-                free(m_buffer);
-            }
+            CBufferPool::Release(m_buffer, m_buffer_len);
             m_read_idx = 0;
             m_write_idx = readableBytes;
-            m_buffer_len = readableBytes;
+            m_buffer_len = newCapacity;
             m_buffer = newSpace;
-            return total - readableBytes;
+            return total - newCapacity;
         }
 
         inline bool EnsureWritableBytes(size_t minWritableBytes)
@@ -149,13 +153,11 @@ class CBuffer
                 }
                 char* tmp = NULL;
 
-                //tmp = (char*) realloc(m_buffer, newCapacity);
-                tmp = (char*)malloc(newCapacity);
+                tmp = CBufferPool::Allocate(newCapacity, newCapacity);
                 if (NULL != tmp)
                 {
                     memcpy(tmp, m_buffer + m_read_idx, ReadableBytes());
-//                    memcpy(tmp, m_buffer, m_buffer_len);
-                    free(m_buffer);
+                    CBufferPool::Release(m_buffer, m_buffer_len);
                     m_buffer = tmp;
                     m_buffer_len = newCapacity;
                     m_write_idx = ReadableBytes();
@@ -182,6 +184,10 @@ class CBuffer
         {
             return m_buffer + m_read_idx;
         }
+        inline char* GetRawReadBuffer()
+        {
+            return m_buffer + m_read_idx;
+        }
         inline size_t Capacity() const
         {
             return m_buffer_len;
@@ -338,10 +344,7 @@ class CBuffer
         }
         inline ~CBuffer()
         {
-            if (m_buffer != NULL)
-            {
-                free(m_buffer);
-            }
+            CBufferPool::Release(m_buffer, m_buffer_len);
             m_buffer = NULL;
         }
 
@@ -0,0 +1,150 @@
+/*******************************************************************************
+ * Project:  Nebula
+ * @file     CBufferPool.cpp
+ * @brief    CBuffer内存池
+ * @author   Bwar
+ * @date:    2026年10月17日
+ * @note
+ * Modify history:
+ ******************************************************************************/
+
+#include <stdlib.h>
+#include "CBufferPool.hpp"
+
+namespace neb
+{
+
+static thread_local bool s_bPoolDestroyed = false;
+
+CBufferPool::CBufferPool()
+{
+}
+
+CBufferPool::~CBufferPool()
+{
+    for (int i = 0; i < sc_iClassNum; ++i)
+    {
+        while (m_aFreeList[i].pHead != nullptr)
+        {
+            free(Pop(i));
+        }
+    }
+    s_bPoolDestroyed = true;    // 线程退出后仍有CBuffer析构时直接free
+}
+
+CBufferPool* CBufferPool::Instance()
+{
+    if (s_bPoolDestroyed)
+    {
+        return(nullptr);
+    }
+    static thread_local CBufferPool s_oPool;
+    return(&s_oPool);
+}
+
+char* CBufferPool::Allocate(size_t uiMinSize, size_t& uiChunkSize)
+{
+    if (uiMinSize > MAX_CHUNK_SIZE)
+    {
+        uiChunkSize = uiMinSize;
+        return((char*)malloc(uiMinSize));
+    }
+    int iClass = 0;
+    uiChunkSize = MIN_CHUNK_SIZE;
+    while (uiChunkSize < uiMinSize)
+    {
+        uiChunkSize <<= 1;
+        ++iClass;
+    }
+    CBufferPool* pPool = Instance();
+    if (nullptr == pPool)
+    {
+        return((char*)malloc(uiChunkSize));
+    }
+    char* pChunk = pPool->Pop(iClass);
+    if (nullptr == pChunk)
+    {
+        ++pPool->m_stStat.ullMiss;
+        return((char*)malloc(uiChunkSize));
+    }
+    ++pPool->m_stStat.ullHit;
+    return(pChunk);
+}
+
+void CBufferPool::Release(char* pChunk, size_t uiChunkSize)
+{
+    if (nullptr == pChunk)
+    {
+        return;
+    }
+    int iClass = ClassIndex(uiChunkSize);
+    CBufferPool* pPool = Instance();
+    if (iClass < 0 || nullptr == pPool || !pPool->Push(iClass, pChunk))
+    {
+        free(pChunk);
+    }
+}
+
+void CBufferPool::Shrink()
+{
+    for (int i = 0; i < sc_iClassNum; ++i)
+    {
+        uint32_t uiIdleNum = m_aFreeList[i].uiLowWater;
+        for (uint32_t j = 0; j < uiIdleNum; ++j)
+        {
+            free(Pop(i));
+        }
+        m_aFreeList[i].uiLowWater = m_aFreeList[i].uiNum;
+    }
+}
+
+int CBufferPool::ClassIndex(size_t uiSize)
+{
+    if (uiSize < MIN_CHUNK_SIZE || uiSize > MAX_CHUNK_SIZE)
+    {
+        return(-1);
+    }
+    int iClass = 0;
+    size_t uiClassSize = MIN_CHUNK_SIZE;
+    while ((uiClassSize << 1) <= uiSize)    // 向下取整，内存块不小于所在分级的大小
+    {
+        uiClassSize <<= 1;
+        ++iClass;
+    }
+    return(iClass);
+}
+
+char* CBufferPool::Pop(int iClass)
+{
+    tagFreeList& stFreeList = m_aFreeList[iClass];
+    char* pChunk = stFreeList.pHead;
+    if (nullptr == pChunk)
+    {
+        return(nullptr);
+    }
+    stFreeList.pHead = *(char**)pChunk;
+    --stFreeList.uiNum;
+    if (stFreeList.uiNum < stFreeList.uiLowWater)
+    {
+        stFreeList.uiLowWater = stFreeList.uiNum;
+    }
+    m_stStat.ullBytesHeld -= (MIN_CHUNK_SIZE << iClass);
+    return(pChunk);
+}
+
+bool CBufferPool::Push(int iClass, char* pChunk)
+{
+    size_t uiChunkSize = MIN_CHUNK_SIZE << iClass;
+    if (m_stStat.ullBytesHeld + uiChunkSize > MAX_BYTES_HELD)
+    {
+        return(false);
+    }
+    tagFreeList& stFreeList = m_aFreeList[iClass];
+    *(char**)pChunk = stFreeList.pHead;
+    stFreeList.pHead = pChunk;
+    ++stFreeList.uiNum;
+    m_stStat.ullBytesHeld += uiChunkSize;
+    return(true);
+}
+
+} /* namespace neb */
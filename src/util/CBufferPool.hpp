@@ -0,0 +1,96 @@
+/*******************************************************************************
+ * Project:  Nebula
+ * @file     CBufferPool.hpp
+ * @brief    CBuffer内存池
+ * @author   Bwar
+ * @date:    2026年10月17日
+ * @note     按2的幂分级（256B ~ 1MB）缓存CBuffer的内存块，每个线程（即每个
+ * Worker）一个池，无锁。大于1MB的内存块直接malloc/free。空闲内存块在一个
+ * 收缩周期内始终未被使用的，在Shrink()时归还系统。
+ * Modify history:
+ ******************************************************************************/
+#ifndef SRC_UTIL_CBUFFERPOOL_HPP_
+#define SRC_UTIL_CBUFFERPOOL_HPP_
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace neb
+{
+
+class CBufferPool
+{
+public:
+    static const size_t MIN_CHUNK_SIZE = 256;
+    static const size_t MAX_CHUNK_SIZE = 1048576;
+    static const size_t MAX_BYTES_HELD = 64 * 1048576;     ///< 单个池最多缓存的空闲内存
+
+    struct tagStat
+    {
+        uint64_t ullHit = 0;            ///< 从池中分配的次数
+        uint64_t ullMiss = 0;           ///< 池中无空闲块而malloc的次数
+        uint64_t ullBytesHeld = 0;      ///< 池中空闲块占用的内存
+    };
+
+    CBufferPool();
+    CBufferPool(const CBufferPool&) = delete;
+    CBufferPool& operator=(const CBufferPool&) = delete;
+    ~CBufferPool();
+
+    /**
+     * @brief 当前线程的内存池
+     * @return 线程退出、池已销毁时返回nullptr
+     */
+    static CBufferPool* Instance();
+
+    /**
+     * @brief 分配不小于uiMinSize的内存块
+     * @param[out] uiChunkSize 实际分配的内存块大小
+     */
+    static char* Allocate(size_t uiMinSize, size_t& uiChunkSize);
+
+    /**
+     * @brief 归还内存块，uiChunkSize须为Allocate()时得到的大小（或更小）
+     */
+    static void Release(char* pChunk, size_t uiChunkSize);
+
+    /**
+     * @brief 把上一周期内一直空闲的内存块归还系统，由定时任务周期性调用
+     */
+    void Shrink();
+
+    const tagStat& GetStat() const
+    {
+        return(m_stStat);
+    }
+
+    void ResetHitMiss()
+    {
+        m_stStat.ullHit = 0;
+        m_stStat.ullMiss = 0;
+    }
+
+private:
+    struct tagFreeList
+    {
+        char* pHead = nullptr;
+        uint32_t uiNum = 0;
+        uint32_t uiLowWater = 0;        ///< 本周期内空闲块数量的最小值
+    };
+
+    static int ClassIndex(size_t uiSize);
+
+    char* Pop(int iClass);
+    bool Push(int iClass, char* pChunk);
+
+private:
+    static const int sc_iMinClassBits = 8;
+    static const int sc_iClassNum = 13;        ///< 2^8 ~ 2^20
+
+    tagFreeList m_aFreeList[sc_iClassNum];
+    tagStat m_stStat;
+};
+
+} /* namespace neb */
+
+#endif /* SRC_UTIL_CBUFFERPOOL_HPP_ */
@@ -0,0 +1,250 @@
+/*******************************************************************************
+ * Project:  Nebula
+ * @file     CSendQueue.cpp
+ * @brief    分段发送队列
+ * @author   Bwar
+ * @date:    2026年10月17日
+ * @note
+ * Modify history:
+ ******************************************************************************/
+
+#include <sys/socket.h>
+#include <climits>
+#include <cerrno>
+#include "CSendQueue.hpp"
+
+#ifndef IOV_MAX
+#define IOV_MAX 1024
+#endif
+
+namespace neb
+{
+
+CSendQueue::CSendQueue()
+{
+}
+
+CSendQueue::~CSendQueue()
+{
+    Clear();
+    for (auto pBuff : m_vecFreeBuff)
+    {
+        delete pBuff;
+    }
+    m_vecFreeBuff.clear();
+}
+
+CBuffer* CSendQueue::MutableTailBuffer()
+{
+    if (m_dequeSlice.empty() || nullptr == m_dequeSlice.back().pBuff)
+    {
+        tagSlice stSlice;
+        stSlice.pBuff = NewBuffer();
+        m_dequeSlice.push_back(std::move(stSlice));
+    }
+    return(m_dequeSlice.back().pBuff);
+}
+
+bool CSendQueue::Reference(const char* pData, size_t uiLen)
+{
+    if (uiLen < REFERENCE_MIN_SIZE)
+    {
+        return(MutableTailBuffer()->Write(pData, uiLen) >= 0);
+    }
+    tagSlice stSlice;
+    stSlice.pData = pData;
+    stSlice.uiLen = uiLen;
+    m_dequeSlice.push_back(std::move(stSlice));
+    return(true);
+}
+
+bool CSendQueue::Reference(std::shared_ptr<const std::string> pData)
+{
+    if (nullptr == pData)
+    {
+        return(false);
+    }
+    if (pData->size() < REFERENCE_MIN_SIZE)
+    {
+        return(MutableTailBuffer()->Write(pData->data(), pData->size()) >= 0);
+    }
+    tagSlice stSlice;
+    stSlice.pData = pData->data();
+    stSlice.uiLen = pData->size();
+    stSlice.pHolder = pData;
+    m_dequeSlice.push_back(std::move(stSlice));
+    return(true);
+}
+
+bool CSendQueue::Append(CBuffer* pBuff)
+{
+    if (nullptr == pBuff || 0 == pBuff->ReadableBytes())
+    {
+        return(true);
+    }
+    return(MutableTailBuffer()->Write(pBuff, pBuff->ReadableBytes()) >= 0);
+}
+
+bool CSendQueue::Retain()
+{
+    for (auto& stSlice : m_dequeSlice)
+    {
+        if (nullptr == stSlice.pBuff && nullptr == stSlice.pHolder)
+        {
+            CBuffer* pBuff = NewBuffer();
+            if (pBuff->Write(stSlice.pData, stSlice.uiLen) < 0)
+            {
+                delete pBuff;
+                return(false);
+            }
+            stSlice.pBuff = pBuff;
+            stSlice.pData = nullptr;
+            stSlice.uiLen = 0;
+        }
+    }
+    return(true);
+}
+
+size_t CSendQueue::ReadableBytes() const
+{
+    size_t uiReadableBytes = 0;
+    for (auto& stSlice : m_dequeSlice)
+    {
+        uiReadableBytes += (nullptr == stSlice.pBuff) ? stSlice.uiLen : stSlice.pBuff->ReadableBytes();
+    }
+    return(uiReadableBytes);
+}
+
+const char* CSendQueue::Front(size_t& uiLen) const
+{
+    for (auto& stSlice : m_dequeSlice)
+    {
+        if (nullptr == stSlice.pBuff)
+        {
+            if (stSlice.uiLen > 0)
+            {
+                uiLen = stSlice.uiLen;
+                return(stSlice.pData);
+            }
+        }
+        else if (stSlice.pBuff->ReadableBytes() > 0)
+        {
+            uiLen = stSlice.pBuff->ReadableBytes();
+            return(stSlice.pBuff->GetRawReadBuffer());
+        }
+    }
+    uiLen = 0;
+    return(nullptr);
+}
+
+void CSendQueue::Skip(size_t uiLen)
+{
+    while (!m_dequeSlice.empty())
+    {
+        tagSlice& stSlice = m_dequeSlice.front();
+        size_t uiSliceLen = (nullptr == stSlice.pBuff) ? stSlice.uiLen : stSlice.pBuff->ReadableBytes();
+        if (uiLen < uiSliceLen)
+        {
+            if (nullptr == stSlice.pBuff)
+            {
+                stSlice.pData += uiLen;
+                stSlice.uiLen -= uiLen;
+            }
+            else
+            {
+                stSlice.pBuff->SkipBytes(uiLen);
+            }
+            return;
+        }
+        uiLen -= uiSliceLen;
+        PopFront();
+    }
+}
+
+void CSendQueue::Clear()
+{
+    while (!m_dequeSlice.empty())
+    {
+        PopFront();
+    }
+}
+
+int CSendQueue::WriteFD(int iFd, int& iErrno)
+{
+    m_vecIov.clear();
+    for (auto& stSlice : m_dequeSlice)
+    {
+        if (m_vecIov.size() >= IOV_MAX)
+        {
+            break;
+        }
+        struct iovec stIov;
+        if (nullptr == stSlice.pBuff)
+        {
+            stIov.iov_base = (void*)stSlice.pData;
+            stIov.iov_len = stSlice.uiLen;
+        }
+        else
+        {
+            stIov.iov_base = (void*)stSlice.pBuff->GetRawReadBuffer();
+            stIov.iov_len = stSlice.pBuff->ReadableBytes();
+        }
+        if (stIov.iov_len > 0)
+        {
+            m_vecIov.push_back(stIov);
+        }
+    }
+    if (m_vecIov.empty())
+    {
+        return(0);
+    }
+
+    struct msghdr stMsg;
+    memset(&stMsg, 0, sizeof(stMsg));
+    stMsg.msg_iov = &m_vecIov[0];
+    stMsg.msg_iovlen = m_vecIov.size();
+    int iWrittenLen = (int)sendmsg(iFd, &stMsg, MSG_NOSIGNAL);
+    if (iWrittenLen < 0)
+    {
+        iErrno = errno;
+    }
+    else
+    {
+        Skip(iWrittenLen);
+    }
+    return(iWrittenLen);
+}
+
+CBuffer* CSendQueue::NewBuffer()
+{
+    if (m_vecFreeBuff.empty())
+    {
+        return(new CBuffer());
+    }
+    CBuffer* pBuff = m_vecFreeBuff.back();
+    m_vecFreeBuff.pop_back();
+    return(pBuff);
+}
+
+void CSendQueue::PopFront()
+{
+    CBuffer* pBuff = m_dequeSlice.front().pBuff;
+    m_dequeSlice.pop_front();
+    if (nullptr == pBuff)
+    {
+        return;
+    }
+    if (m_vecFreeBuff.size() >= sc_uiMaxFreeBuffNum)
+    {
+        delete pBuff;
+        return;
+    }
+    pBuff->Clear();
+    if (pBuff->Capacity() > CBuffer::BUFFER_MAX_READ)
+    {
+        pBuff->Compact(0);      // 释放大块内存，避免单个大包长期占用
+    }
+    m_vecFreeBuff.push_back(pBuff);
+}
+
+} /* namespace neb */
@@ -0,0 +1,111 @@
+/*******************************************************************************
+ * Project:  Nebula
+ * @file     CSendQueue.hpp
+ * @brief    分段发送队列
+ * @author   Bwar
+ * @date:    2026年10月17日
+ * @note     发送队列由若干分片组成：分片要么是队列持有的CBuffer（编解码器直接
+ * 往队尾CBuffer写入），要么是对外部数据的引用（如HttpMsg::body()、MsgBody::data()），
+ * 引用不拷贝数据。发送时以sendmsg一次提交最多IOV_MAX个分片，部分写入后从断点续发。
+ * Modify history:
+ ******************************************************************************/
+#ifndef SRC_UTIL_CSENDQUEUE_HPP_
+#define SRC_UTIL_CSENDQUEUE_HPP_
+
+#include <sys/uio.h>
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+#include "CBuffer.hpp"
+
+namespace neb
+{
+
+class CSendQueue
+{
+public:
+    static const size_t REFERENCE_MIN_SIZE = 4096;     ///< 小于此长度的数据直接拷贝，引用不划算
+
+    CSendQueue();
+    CSendQueue(const CSendQueue&) = delete;
+    CSendQueue& operator=(const CSendQueue&) = delete;
+    ~CSendQueue();
+
+    /**
+     * @brief 获取队尾的可写缓冲区
+     * @note 返回的指针在下一次Reference()、Skip()、Clear()调用之前有效。
+     */
+    CBuffer* MutableTailBuffer();
+
+    /**
+     * @brief 引用外部数据（借用）
+     * @note 借用的数据须在调用者返回前发送完毕，否则调用者须先调用Retain()
+     * 把未发送的借用数据拷贝到队列中。长度小于REFERENCE_MIN_SIZE时直接拷贝。
+     */
+    bool Reference(const char* pData, size_t uiLen);
+
+    /**
+     * @brief 引用外部数据（引用计数持有，发送完毕后释放）
+     */
+    bool Reference(std::shared_ptr<const std::string> pData);
+
+    /**
+     * @brief 把pBuff中的可读数据拷贝到队尾
+     */
+    bool Append(CBuffer* pBuff);
+
+    /**
+     * @brief 把队列中尚未发送的借用数据拷贝到队列持有的缓冲区
+     */
+    bool Retain();
+
+    size_t ReadableBytes() const;
+
+    bool Empty() const
+    {
+        return(0 == ReadableBytes());
+    }
+
+    /**
+     * @brief 获取队首分片的可读数据
+     * @return 队列为空时返回nullptr
+     */
+    const char* Front(size_t& uiLen) const;
+
+    /**
+     * @brief 丢弃队首已发送的uiLen字节
+     */
+    void Skip(size_t uiLen);
+
+    void Clear();
+
+    /**
+     * @brief 以sendmsg发送队列数据，成功发送的数据从队列中移除
+     * @return 与send()一致，-1时iErrno为错误码
+     */
+    int WriteFD(int iFd, int& iErrno);
+
+private:
+    struct tagSlice
+    {
+        CBuffer* pBuff = nullptr;                       ///< 队列持有的缓冲区，非空时数据在pBuff中
+        const char* pData = nullptr;                    ///< 引用的外部数据
+        size_t uiLen = 0;
+        std::shared_ptr<const std::string> pHolder;     ///< 为空表示借用的数据
+    };
+
+    CBuffer* NewBuffer();
+    void PopFront();
+
+private:
+    static const size_t sc_uiMaxFreeBuffNum = 2;
+
+    std::deque<tagSlice> m_dequeSlice;
+    std::vector<CBuffer*> m_vecFreeBuff;
+    std::vector<struct iovec> m_vecIov;
+};
+
+} /* namespace neb */
+
+#endif /* SRC_UTIL_CSENDQUEUE_HPP_ */
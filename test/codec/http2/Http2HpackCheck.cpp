@@ -0,0 +1,288 @@
+/*******************************************************************************
+ * Project:  Nebula
+ * @file     Http2HpackCheck.cpp
+ * @brief    HPACK编解码与动态表的rfc7541附录C.3~C.6示例校验
+ * @author   Bwar
+ * @date:    2026年10月17日
+ * @note     每组示例连续编解码多个header block，共用同一个编码端和解码端：
+ * 编码结果须与示例逐字节一致，解码结果须与示例的header列表一致，每个header block
+ * 之后的动态表（表项及尺寸）须与示例一致。C.5、C.6的动态表尺寸为256，覆盖淘汰；
+ * 解码端在第一个header block前加上动态表尺寸更新指令（示例假定双方已约定该尺寸）。
+ * Modify history:
+ ******************************************************************************/
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include "logger/NetLogger.hpp"
+#include "codec/http2/CodecHttp2.hpp"
+#include "codec/http2/Http2DynamicTable.hpp"
+
+using namespace neb;
+
+typedef std::vector<std::pair<std::string, std::string>> HeaderList;
+
+struct tagHpackBlock
+{
+    const char* szName;         ///< 示例编号
+    HeaderList vecHeader;       ///< 待编码的header列表
+    std::string strHexBlock;    ///< 编码后的header block（十六进制，可含空格）
+    HeaderList vecTable;        ///< 处理该header block之后的动态表，最新的表项在前
+    uint32 uiTableSize;         ///< 处理该header block之后的动态表尺寸
+};
+
+static int s_iFailed = 0;
+
+static std::string HexToBytes(const std::string& strHex)
+{
+    std::string strBytes;
+    std::string strDigit;
+    for (size_t i = 0; i < strHex.size(); ++i)
+    {
+        if (strHex[i] == ' ')
+        {
+            continue;
+        }
+        strDigit.push_back(strHex[i]);
+        if (strDigit.size() == 2)
+        {
+            strBytes.push_back((char)strtol(strDigit.c_str(), nullptr, 16));
+            strDigit.clear();
+        }
+    }
+    return(strBytes);
+}
+
+static std::string BytesToHex(const char* pData, size_t uiLen)
+{
+    std::string strHex;
+    char szByte[4];
+    for (size_t i = 0; i < uiLen; ++i)
+    {
+        snprintf(szByte, sizeof(szByte), "%02x", (uint8)pData[i]);
+        strHex += szByte;
+    }
+    return(strHex);
+}
+
+static void Fail(const char* szName, const char* szWhat, const std::string& strDetail)
+{
+    fprintf(stderr, "FAIL %s %s: %s\n", szName, szWhat, strDetail.c_str());
+    ++s_iFailed;
+}
+
+static void CheckEncode(CodecHttp2& oEncoder, const tagHpackBlock& stBlock, bool bWithHuffman)
+{
+    CBuffer oBuff;
+    for (size_t i = 0; i < stBlock.vecHeader.size(); ++i)
+    {
+        oEncoder.PackHeader(stBlock.vecHeader[i].first, stBlock.vecHeader[i].second, bWithHuffman, &oBuff);
+    }
+    std::string strExpect = HexToBytes(stBlock.strHexBlock);
+    if (oBuff.ReadableBytes() != strExpect.size()
+            || 0 != memcmp(oBuff.GetRawReadBuffer(), strExpect.data(), strExpect.size()))
+    {
+        Fail(stBlock.szName, "encode", "got " + BytesToHex(oBuff.GetRawReadBuffer(), oBuff.ReadableBytes())
+                + ", expect " + BytesToHex(strExpect.data(), strExpect.size()));
+    }
+}
+
+static void CheckDecode(CodecHttp2& oDecoder, const tagHpackBlock& stBlock, const std::string& strPrefix)
+{
+    std::string strInput = strPrefix + HexToBytes(stBlock.strHexBlock);
+    CBuffer oBuff;
+    oBuff.Write(strInput.data(), strInput.size());
+    HttpMsg oHttpMsg;       // 服务端编解码器、stream id为0时:status以外的header都放在headers中
+    if (CODEC_STATUS_PART_OK != oDecoder.UnpackHeader(oBuff.GetWriteIndex(), &oBuff, oHttpMsg))
+    {
+        Fail(stBlock.szName, "decode", "UnpackHeader failed");
+        return;
+    }
+    size_t uiHeaderNum = 0;
+    for (size_t i = 0; i < stBlock.vecHeader.size(); ++i)
+    {
+        const std::string& strName = stBlock.vecHeader[i].first;
+        const std::string& strValue = stBlock.vecHeader[i].second;
+        if (strName == ":status")
+        {
+            if (oHttpMsg.status_code() != atoi(strValue.c_str()))
+            {
+                Fail(stBlock.szName, "decode", ":status " + std::to_string(oHttpMsg.status_code()));
+            }
+            continue;
+        }
+        ++uiHeaderNum;
+        auto iter = oHttpMsg.headers().find(strName);
+        if (iter == oHttpMsg.headers().end() || iter->second != strValue)
+        {
+            Fail(stBlock.szName, "decode", strName + " missing or mismatched");
+        }
+    }
+    if ((size_t)oHttpMsg.headers_size() != uiHeaderNum)
+    {
+        Fail(stBlock.szName, "decode", "header number " + std::to_string(oHttpMsg.headers_size()));
+    }
+}
+
+/**
+ * @brief 按编码端的规则（静态表或动态表中已有完全相同的表项则引用，否则带索引插入）
+ * 更新动态表，再与示例给出的动态表比较
+ */
+static void CheckTable(Http2DynamicTable& oTable, const tagHpackBlock& stBlock)
+{
+    for (size_t i = 0; i < stBlock.vecHeader.size(); ++i)
+    {
+        const std::string& strName = stBlock.vecHeader[i].first;
+        const std::string& strValue = stBlock.vecHeader[i].second;
+        uint32 uiNameIndex = 0;
+        if (Http2Header::GetStaticTableIndex(strName, strValue, uiNameIndex) > 0
+                || oTable.Find(strName, strValue, uiNameIndex) > 0)
+        {
+            continue;
+        }
+        oTable.Add(strName, strValue);
+    }
+    if (oTable.GetCount() != stBlock.vecTable.size())
+    {
+        Fail(stBlock.szName, "table", "entry number " + std::to_string(oTable.GetCount()));
+    }
+    for (size_t i = 0; i < stBlock.vecTable.size(); ++i)
+    {
+        const Http2Header* pHeader = oTable.Get((uint32)i);
+        if (pHeader == nullptr || pHeader->Name() != stBlock.vecTable[i].first
+                || pHeader->Value() != stBlock.vecTable[i].second)
+        {
+            Fail(stBlock.szName, "table", "entry " + std::to_string(i + 1) + " mismatched");
+        }
+    }
+    if (oTable.Get((uint32)stBlock.vecTable.size()) != nullptr)
+    {
+        Fail(stBlock.szName, "table", "unexpected entry after the last one");
+    }
+    if (oTable.GetSize() != stBlock.uiTableSize)
+    {
+        Fail(stBlock.szName, "table", "size " + std::to_string(oTable.GetSize()));
+    }
+}
+
+static void CheckSequence(std::shared_ptr<NetLogger> pLogger, const std::vector<tagHpackBlock>& vecBlock,
+        uint32 uiTableMaxSize, bool bWithHuffman)
+{
+    CodecHttp2 oEncoder(pLogger, CODEC_HTTP2, false);
+    CodecHttp2 oDecoder(pLogger, CODEC_HTTP2, false);
+    Http2DynamicTable oTable(true, uiTableMaxSize);
+    std::string strPrefix;
+    if (uiTableMaxSize != 4096)
+    {
+        std::vector<tagSetting> vecSetting(1);
+        vecSetting[0].unIdentifier = H2_SETTINGS_HEADER_TABLE_SIZE;
+        vecSetting[0].uiValue = uiTableMaxSize;
+        oEncoder.Setting(vecSetting, true);
+        CBuffer oBuff;
+        Http2Header::EncodeInt(uiTableMaxSize, H2_HPACK_PREFIX_5_BITS,
+                (char)H2_HPACK_CONDITION_DYNAMIC_TABLE_SIZE_UPDATE, &oBuff);
+        strPrefix.assign(oBuff.GetRawReadBuffer(), oBuff.ReadableBytes());
+    }
+    for (size_t i = 0; i < vecBlock.size(); ++i)
+    {
+        CheckEncode(oEncoder, vecBlock[i], bWithHuffman);
+        CheckDecode(oDecoder, vecBlock[i], (i == 0) ? strPrefix : std::string());
+        CheckTable(oTable, vecBlock[i]);
+    }
+}
+
+static const HeaderList sc_vecRequest1 = {
+        {":method", "GET"}, {":scheme", "http"}, {":path", "/"}, {":authority", "www.example.com"}};
+static const HeaderList sc_vecRequest2 = {
+        {":method", "GET"}, {":scheme", "http"}, {":path", "/"}, {":authority", "www.example.com"},
+        {"cache-control", "no-cache"}};
+static const HeaderList sc_vecRequest3 = {
+        {":method", "GET"}, {":scheme", "https"}, {":path", "/index.html"}, {":authority", "www.example.com"},
+        {"custom-key", "custom-value"}};
+static const HeaderList sc_vecRequestTable1 = {{":authority", "www.example.com"}};
+static const HeaderList sc_vecRequestTable2 = {{"cache-control", "no-cache"}, {":authority", "www.example.com"}};
+static const HeaderList sc_vecRequestTable3 = {
+        {"custom-key", "custom-value"}, {"cache-control", "no-cache"}, {":authority", "www.example.com"}};
+
+static const HeaderList sc_vecResponse1 = {
+        {":status", "302"}, {"cache-control", "private"}, {"date", "Mon, 21 Oct 2013 20:13:21 GMT"},
+        {"location", "https://www.example.com"}};
+static const HeaderList sc_vecResponse2 = {
+        {":status", "307"}, {"cache-control", "private"}, {"date", "Mon, 21 Oct 2013 20:13:21 GMT"},
+        {"location", "https://www.example.com"}};
+static const HeaderList sc_vecResponse3 = {
+        {":status", "200"}, {"cache-control", "private"}, {"date", "Mon, 21 Oct 2013 20:13:22 GMT"},
+        {"location", "https://www.example.com"}, {"content-encoding", "gzip"},
+        {"set-cookie", "foo=ASDJKHQKBZXOQWEOPIUAXQWEOIU; max-age=3600; version=1"}};
+static const HeaderList sc_vecResponseTable1 = {
+        {"location", "https://www.example.com"}, {"date", "Mon, 21 Oct 2013 20:13:21 GMT"},
+        {"cache-control", "private"}, {":status", "302"}};
+static const HeaderList sc_vecResponseTable2 = {
+        {":status", "307"}, {"location", "https://www.example.com"},
+        {"date", "Mon, 21 Oct 2013 20:13:21 GMT"}, {"cache-control", "private"}};
+static const HeaderList sc_vecResponseTable3 = {
+        {"set-cookie", "foo=ASDJKHQKBZXOQWEOPIUAXQWEOIU; max-age=3600; version=1"},
+        {"content-encoding", "gzip"}, {"date", "Mon, 21 Oct 2013 20:13:22 GMT"}};
+
+int main()
+{
+    std::shared_ptr<NetLogger> pLogger = std::make_shared<NetLogger>("Http2HpackCheck.log", Logger::ERROR);
+
+    // C.3 Request Examples without Huffman Coding
+    CheckSequence(pLogger, {
+        {"C.3.1", sc_vecRequest1, "8286 8441 0f77 7777 2e65 7861 6d70 6c65 2e63 6f6d",
+            sc_vecRequestTable1, 57},
+        {"C.3.2", sc_vecRequest2, "8286 84be 5808 6e6f 2d63 6163 6865",
+            sc_vecRequestTable2, 110},
+        {"C.3.3", sc_vecRequest3, "8287 85bf 400a 6375 7374 6f6d 2d6b 6579 0c63 7573 746f 6d2d 7661 6c75 65",
+            sc_vecRequestTable3, 164}}, 4096, false);
+
+    // C.4 Request Examples with Huffman Coding
+    CheckSequence(pLogger, {
+        {"C.4.1", sc_vecRequest1, "8286 8441 8cf1 e3c2 e5f2 3a6b a0ab 90f4 ff",
+            sc_vecRequestTable1, 57},
+        {"C.4.2", sc_vecRequest2, "8286 84be 5886 a8eb 1064 9cbf",
+            sc_vecRequestTable2, 110},
+        {"C.4.3", sc_vecRequest3, "8287 85bf 4088 25a8 49e9 5ba9 7d7f 8925 a849 e95b b8e8 b4bf",
+            sc_vecRequestTable3, 164}}, 4096, true);
+
+    // C.5 Response Examples without Huffman Coding
+    CheckSequence(pLogger, {
+        {"C.5.1", sc_vecResponse1,
+            "4803 3330 3258 0770 7269 7661 7465 611d 4d6f 6e2c 2032 3120 4f63 7420 3230 3133"
+            " 2032 303a 3133 3a32 3120 474d 546e 1768 7474 7073 3a2f 2f77 7777 2e65 7861 6d70"
+            " 6c65 2e63 6f6d",
+            sc_vecResponseTable1, 222},
+        {"C.5.2", sc_vecResponse2, "4803 3330 37c1 c0bf",
+            sc_vecResponseTable2, 222},
+        {"C.5.3", sc_vecResponse3,
+            "88c1 611d 4d6f 6e2c 2032 3120 4f63 7420 3230 3133 2032 303a 3133 3a32 3220 474d"
+            " 54c0 5a04 677a 6970 7738 666f 6f3d 4153 444a 4b48 514b 425a 584f 5157 454f 5049"
+            " 5541 5851 5745 4f49 553b 206d 6178 2d61 6765 3d33 3630 303b 2076 6572 7369 6f6e"
+            " 3d31",
+            sc_vecResponseTable3, 215}}, 256, false);
+
+    // C.6 Response Examples with Huffman Coding
+    CheckSequence(pLogger, {
+        {"C.6.1", sc_vecResponse1,
+            "4882 6402 5885 aec3 771a 4b61 96d0 7abe 9410 54d4 44a8 2005 9504 0b81 66e0 82a6"
+            " 2d1b ff6e 919d 29ad 1718 63c7 8f0b 97c8 e9ae 82ae 43d3",
+            sc_vecResponseTable1, 222},
+        {"C.6.2", sc_vecResponse2, "4883 640e ffc1 c0bf",
+            sc_vecResponseTable2, 222},
+        {"C.6.3", sc_vecResponse3,
+            "88c1 6196 d07a be94 1054 d444 a820 0595 040b 8166 e084 a62d 1bff c05a 839b d9ab"
+            " 77ad 94e7 821d d7f2 e6c7 b335 dfdf cd5b 3960 d5af 2708 7f36 72c1 ab27 0fb5 291f"
+            " 9587 3160 65c0 03ed 4ee5 b106 3d50 07",
+            sc_vecResponseTable3, 215}}, 256, true);
+
+    if (s_iFailed > 0)
+    {
+        fprintf(stderr, "%d check(s) failed\n", s_iFailed);
+        return(1);
+    }
+    printf("rfc7541 C.3-C.6 passed\n");
+    return(0);
+}